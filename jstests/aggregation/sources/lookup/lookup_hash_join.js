@@ -0,0 +1,91 @@
+/**
+ * Tests that a localField/foreignField $lookup against an unindexed foreign field joins with an
+ * in-memory hash table of the foreign collection, and that it returns the same results as the
+ * batched index lookups it uses when the foreign field is indexed.
+ *
+ * Accessed collections cannot be implicitly sharded because you cannot $lookup into a sharded
+ * collection.
+ * @tags: [assumes_unsharded_collection]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");  // For getAggPlanStage.
+
+    let testDB = db.getSiblingDB("lookup_hash_join");
+    testDB.dropDatabase();
+
+    let local = testDB.getCollection("local");
+    assert.writeOK(local.insert({_id: 0, a: 1}));
+    assert.writeOK(local.insert({_id: 1, a: [2, 3]}));
+    assert.writeOK(local.insert({_id: 2}));
+    assert.writeOK(local.insert({_id: 3, a: null}));
+    assert.writeOK(local.insert({_id: 4, a: [[1, 2]]}));
+    assert.writeOK(local.insert({_id: 5, a: {x: 1}}));
+    assert.writeOK(local.insert({_id: 6, a: "unmatched"}));
+
+    let foreign = testDB.getCollection("foreign");
+    assert.writeOK(foreign.insert({_id: 0, b: 1}));
+    assert.writeOK(foreign.insert({_id: 1, b: [1, 2]}));
+    assert.writeOK(foreign.insert({_id: 2, b: null}));
+    assert.writeOK(foreign.insert({_id: 3}));
+    assert.writeOK(foreign.insert({_id: 4, b: [[1, 2], 3]}));
+    assert.writeOK(foreign.insert({_id: 5, b: NumberLong(2)}));
+    assert.writeOK(foreign.insert({_id: 6, b: {x: 1}}));
+    assert.writeOK(foreign.insert({_id: 7, b: [{c: 1}, {c: 2}]}));
+
+    function byId(x, y) {
+        return tojson(x._id) < tojson(y._id) ? -1 : (tojson(x._id) > tojson(y._id) ? 1 : 0);
+    }
+
+    // Runs several $lookups and returns their results in a deterministic order, since the order in
+    // which the foreign documents are joined depends on how the foreign collection is read.
+    function runLookups() {
+        const pipelines = [
+            [{$lookup: {from: "foreign", localField: "a", foreignField: "b", as: "joined"}}],
+            [{$lookup: {from: "foreign", localField: "a", foreignField: "b.c", as: "joined"}}],
+            [
+              {$lookup: {from: "foreign", localField: "a", foreignField: "b", as: "joined"}},
+              {$unwind: "$joined"},
+              {$match: {"joined._id": {$gt: 0}}},
+              {$project: {joined: ["$joined"]}}
+            ],
+        ];
+        return pipelines.map(function(pipeline) {
+            let results = local.aggregate(pipeline).toArray().map(function(doc) {
+                doc.joined.sort(byId);
+                return doc;
+            });
+            return results.sort(function(x, y) {
+                return byId(x, y) || byId(x.joined[0] || {}, y.joined[0] || {});
+            });
+        });
+    }
+
+    function explainLookup() {
+        const explain = local.explain("executionStats").aggregate([
+            {$lookup: {from: "foreign", localField: "a", foreignField: "b", as: "joined"}}
+        ]);
+        const lookupStage = getAggPlanStage(explain, "$lookup");
+        assert.neq(null, lookupStage, tojson(explain));
+        return lookupStage.$lookup;
+    }
+
+    // Without an index on the foreign field, $lookup builds a hash table of the foreign collection.
+    assert.eq(true, explainLookup().usedHashJoin);
+    const hashJoinResults = runLookups();
+
+    // With an index on the foreign field, $lookup queries the foreign collection once per batch of
+    // input documents and must produce the same results.
+    assert.commandWorked(foreign.createIndex({b: 1}));
+    assert.commandWorked(foreign.createIndex({"b.c": 1}));
+    const lookupStage = explainLookup();
+    assert.eq(false, lookupStage.usedHashJoin);
+    assert.eq(true, lookupStage.usedBatchedLookup);
+    assert.eq(hashJoinResults, runLookups());
+
+    // Spot check the joined documents, including those joined on null and missing values.
+    assert.eq([{_id: 0, b: 1}, {_id: 1, b: [1, 2]}], hashJoinResults[0][0].joined);
+    assert.eq([{_id: 2, b: null}, {_id: 3}], hashJoinResults[0][2].joined);
+    assert.eq([], hashJoinResults[0][6].joined);
+}());
@@ -60,6 +60,16 @@
     let now = (new Date()).getTime();
     checkTimeOfCreation({a: 1, b: 1}, {a: -1}, {_id: 0, a: 1}, now);
 
+    // Running the query again uses the cache entry, which is reported along with its size.
+    assert.eq(1, t.find({a: 1, b: 1}, {_id: 0, a: 1}).sort({a: -1}).itcount());
+    let res = assert.commandWorked(t.runCommand(
+        'planCacheListPlans', {query: {a: 1, b: 1}, sort: {a: -1}, projection: {_id: 0, a: 1}}));
+    assert.gte(res.numHits, 1, tojson(res));
+    assert.gt(res.estimatedSizeBytes, 0, tojson(res));
+    res = assert.commandWorked(t.runCommand('planCacheListQueryShapes'));
+    assert.gte(res.estimatedSizeBytes, 0, tojson(res));
+    assert.gte(res.totalEstimatedSizeBytes, res.estimatedSizeBytes, tojson(res));
+
     // Retrieve plans for valid cache entry.
     let plans = getPlans({a: 1, b: 1}, {a: -1}, {_id: 0, a: 1});
     assert.eq(2, plans.length, 'unexpected number of plans cached for query');
@@ -0,0 +1,76 @@
+/**
+ * Test that materialized views return the same results as the aggregation they are defined by, as
+ * their backing collection changes.
+ * @tags: [assumes_read_concern_unchanged]
+ */
+(function() {
+    "use strict";
+
+    const viewsDB = db.getSiblingDB("views_materialized");
+    assert.commandWorked(viewsDB.dropDatabase());
+
+    const coll = viewsDB.coll;
+    const pipeline = [
+        {$match: {keep: true}},
+        {$group: {_id: "$k", total: {$sum: "$v"}, count: {$sum: 1}}},
+        {$sort: {_id: 1}}
+    ];
+    assert.commandWorked(viewsDB.runCommand(
+        {create: "view", viewOn: "coll", pipeline: pipeline, materialized: true}));
+    const view = viewsDB.view;
+
+    function assertMatchesAggregation() {
+        assert.eq(coll.aggregate(pipeline).toArray(), view.find().toArray());
+        assert.eq(coll.aggregate(pipeline).toArray(), view.aggregate([]).toArray());
+    }
+
+    const info = viewsDB.getCollectionInfos({name: "view"})[0];
+    assert.eq(true, info.options.materialized, tojson(info));
+
+    assertMatchesAggregation();
+
+    let bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 100; i++) {
+        bulk.insert({_id: i, k: i % 5, v: i, keep: i % 3 !== 0});
+    }
+    assert.writeOK(bulk.execute());
+    assertMatchesAggregation();
+
+    assert.writeOK(coll.update({_id: 1}, {$set: {k: 10, v: NumberLong(7)}}));
+    assert.writeOK(coll.update({_id: 2}, {$set: {keep: false}}));
+    assert.writeOK(coll.update({_id: 3}, {$set: {keep: true, v: 2.5}}));
+    assertMatchesAggregation();
+
+    assert.writeOK(coll.remove({k: 4}));
+    assertMatchesAggregation();
+
+    assert.writeOK(coll.remove({_id: 1}));
+    assertMatchesAggregation();
+
+    // Queries on the view apply to its output.
+    assert.eq(coll.aggregate(pipeline.concat([{$match: {_id: {$gt: 1}}}])).toArray(),
+              view.find({_id: {$gt: 1}}).toArray());
+
+    // The view is rebuilt after its backing collection is dropped and recreated.
+    coll.drop();
+    assertMatchesAggregation();
+    assert.writeOK(coll.insert({k: 1, v: 1, keep: true}));
+    assertMatchesAggregation();
+
+    // Only pipelines which can be maintained incrementally may be materialized.
+    assert.commandFailedWithCode(viewsDB.runCommand({
+        create: "badView",
+        viewOn: "coll",
+        pipeline: [{$group: {_id: "$k", m: {$max: "$v"}}}],
+        materialized: true
+    }),
+                                 ErrorCodes.OptionNotSupportedOnView);
+    assert.commandFailedWithCode(viewsDB.runCommand({
+        create: "badView",
+        viewOn: "view",
+        pipeline: pipeline,
+        materialized: true
+    }),
+                                 ErrorCodes.OptionNotSupportedOnView);
+    assert.commandFailed(viewsDB.runCommand({create: "badColl", materialized: true}));
+}());
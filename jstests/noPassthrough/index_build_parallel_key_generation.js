@@ -0,0 +1,80 @@
+/**
+ * Tests that foreground builds of several indexes produce the same indexes, and fail the same way,
+ * whether their keys are generated on worker threads or on the scanning thread.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const coll = testDB.index_build_parallel_key_generation;
+
+    const indexSpecs = [
+        {key: {a: 1}, name: "a_1"},
+        {key: {b: 1, a: -1}, name: "b_1_a_-1"},
+        {key: {arr: 1}, name: "arr_1"},
+        {key: {a: 1}, name: "a_1_partial", partialFilterExpression: {b: {$gt: 500}}},
+        {key: {s: 1}, name: "s_1_collated", collation: {locale: "en", strength: 2}},
+        {
+          key: {loc: "2dsphere"},
+          name: "loc_2dsphere",
+          query: {loc: {$geoWithin: {$centerSphere: [[0, 0], 0.2]}}}
+        },
+    ];
+
+    let bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 5000; i++) {
+        bulk.insert({
+            a: i,
+            b: i % 1000,
+            arr: [i, i + 1],
+            s: (i % 2 ? "X" : "x") + i,
+            loc: {type: "Point", coordinates: [i % 180, i % 90]}
+        });
+    }
+    assert.writeOK(bulk.execute());
+
+    // Returns the documents found through every index, in index order.
+    function scanIndexes() {
+        return indexSpecs.map(function(spec) {
+            const query = spec.query || spec.partialFilterExpression || {};
+            let cursor = coll.find(query, {_id: 1}).hint(spec.name);
+            if (spec.collation) {
+                cursor = cursor.collation(spec.collation);
+            }
+            return cursor.toArray();
+        });
+    }
+
+    // The specs without the test's own 'query' field.
+    const buildSpecs = indexSpecs.map(function(spec) {
+        return Object.extend({}, spec, true);
+    });
+    buildSpecs.forEach(function(spec) {
+        delete spec.query;
+    });
+
+    function buildIndexes(numThreads) {
+        assert.commandWorked(
+            testDB.adminCommand({setParameter: 1, maxIndexBuildKeyGenerationThreads: numThreads}));
+        assert.commandWorked(coll.dropIndexes());
+        assert.commandWorked(
+            testDB.runCommand({createIndexes: coll.getName(), indexes: buildSpecs}));
+        assert.eq(indexSpecs.length + 1, coll.getIndexes().length);
+        return scanIndexes();
+    }
+
+    assert.eq(buildIndexes(1), buildIndexes(4));
+    assert.eq(buildIndexes(1), buildIndexes(2));
+
+    // A key generation error on a worker thread fails the whole build.
+    assert.commandWorked(coll.dropIndexes());
+    assert.writeOK(coll.insert({loc: {type: "Point", coordinates: "not a point"}}));
+    assert.commandFailedWithCode(
+        testDB.runCommand({createIndexes: coll.getName(), indexes: buildSpecs}), 16755);
+    assert.eq(1, coll.getIndexes().length);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,62 @@
+/**
+ * Tests that _id lookups answered from the WiredTiger _id index lookup cache return the same
+ * documents as lookups that search the index, across updates, deletes and re-inserts.
+ */
+(function() {
+    "use strict";
+
+    const storageEngine = jsTest.options().storageEngine || "wiredTiger";
+    if (storageEngine !== "wiredTiger") {
+        print('Skipping test because storageEngine is not "wiredTiger"');
+        return;
+    }
+
+    const conn = MongoRunner.runMongod({setParameter: "wiredTigerIdIndexLookupCacheSizeMB=1"});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+
+    const coll = testDB.wt_id_index_lookup_cache;
+    coll.drop();
+
+    function lookupCacheStats() {
+        return coll.stats({indexDetails: true}).indexDetails._id_.lookupCache;
+    }
+
+    for (let i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, x: i}));
+    }
+
+    // The first lookup of each _id misses the cache and fills it, the second one hits.
+    for (let i = 0; i < 100; i++) {
+        assert.eq({_id: i, x: i}, coll.findOne({_id: i}));
+        assert.eq({_id: i, x: i}, coll.findOne({_id: i}));
+    }
+    let stats = lookupCacheStats();
+    assert.gte(stats.hits, 100, tojson(stats));
+    assert.gt(stats.sizeBytes, 0, tojson(stats));
+
+    // Updates that don't move the document keep the cached record valid.
+    assert.writeOK(coll.update({_id: 1}, {$set: {x: "updated"}}));
+    assert.eq({_id: 1, x: "updated"}, coll.findOne({_id: 1}));
+
+    // Deleted documents are not found, even if their record was cached.
+    assert.writeOK(coll.remove({_id: 2}));
+    assert.eq(null, coll.findOne({_id: 2}));
+
+    // A re-inserted document gets a new record, which is found rather than the cached one.
+    assert.writeOK(coll.insert({_id: 2, x: "reinserted"}));
+    assert.eq({_id: 2, x: "reinserted"}, coll.findOne({_id: 2}));
+    assert.eq({_id: 2, x: "reinserted"}, coll.findOne({_id: 2}));
+
+    // Numerically equal _ids are the same index key.
+    assert.eq({_id: 3, x: 3}, coll.findOne({_id: 3.0}));
+    assert.eq({_id: 3, x: 3}, coll.findOne({_id: NumberLong(3)}));
+
+    // Dropping the collection drops the cache along with the index.
+    assert(coll.drop());
+    assert.writeOK(coll.insert({_id: 4, x: "new collection"}));
+    assert.eq({_id: 4, x: "new collection"}, coll.findOne({_id: 4}));
+
+    MongoRunner.stopMongod(conn);
+})();
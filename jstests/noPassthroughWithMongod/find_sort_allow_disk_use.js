@@ -0,0 +1,80 @@
+// Test that a blocking sort in the find command spills to disk, rather than failing, when it
+// exceeds the internal sort memory limit and the 'allowDiskUse' option is set.
+//
+// Note that this test sets the server parameter "internalQueryExecMaxBlockingSortBytes", and
+// restores the original value of the parameter before exiting.  As a result, this test cannot run
+// in the sharding passthrough (because mongos does not have this parameter), and cannot run in the
+// parallel suite (because the change of the parameter value would interfere with other tests).
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");  // For getPlanStage.
+
+    var coll = db.find_sort_allow_disk_use;
+    coll.drop();
+
+    // Set the internal sort memory limit to 1MB.
+    var result = db.adminCommand({getParameter: 1, internalQueryExecMaxBlockingSortBytes: 1});
+    assert.commandWorked(result);
+    var oldSortLimit = result.internalQueryExecMaxBlockingSortBytes;
+    var newSortLimit = 1024 * 1024;
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryExecMaxBlockingSortBytes: newSortLimit}));
+
+    try {
+        // Insert ~3MB of data.
+        var largeStr = 'x'.repeat(32 * 1024);
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 100; ++i) {
+            bulk.insert({a: largeStr, b: i % 2 ? i : -i});
+        }
+        assert.writeOK(bulk.execute());
+
+        // Without 'allowDiskUse' the sort still fails.
+        assert.commandFailed(
+            db.runCommand({find: coll.getName(), sort: {b: 1}, batchSize: 1000}));
+
+        // With 'allowDiskUse' the sort spills and returns every document in order.
+        result = db.runCommand(
+            {find: coll.getName(), sort: {b: 1}, projection: {a: 0}, allowDiskUse: true});
+        assert.commandWorked(result);
+        var cursor = new DBCommandCursor(db, result);
+        var prev = null;
+        var count = 0;
+        while (cursor.hasNext()) {
+            var doc = cursor.next();
+            if (prev !== null) {
+                assert.lte(prev.b, doc.b, tojson(doc));
+            }
+            prev = doc;
+            ++count;
+        }
+        assert.eq(100, count);
+
+        // A top-k sort which does not fit in memory also spills.
+        result = db.runCommand({
+            find: coll.getName(),
+            sort: {b: -1},
+            limit: 50,
+            projection: {a: 0},
+            allowDiskUse: true
+        });
+        assert.commandWorked(result);
+        var docs = new DBCommandCursor(db, result).toArray();
+        assert.eq(50, docs.length);
+        assert.eq(99, docs[0].b);
+
+        // Explain reports that the sort used disk.
+        var explain = assert.commandWorked(db.runCommand({
+            explain: {find: coll.getName(), sort: {b: 1}, allowDiskUse: true},
+            verbosity: "executionStats"
+        }));
+        var sortStage = getPlanStage(explain.executionStats.executionStages, "SORT");
+        assert.neq(null, sortStage, tojson(explain));
+        assert.eq(true, sortStage.usedDisk, tojson(sortStage));
+    } finally {
+        // Restore the original sort memory limit.
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalQueryExecMaxBlockingSortBytes: oldSortLimit}));
+    }
+}());
@@ -247,7 +247,8 @@ public:
         virtual Status insertDocument(OperationContext* opCtx,
                                       const BSONObj& doc,
                                       const std::vector<MultiIndexBlock*>& indexBlocks,
-                                      bool enforceQuota) = 0;
+                                      bool enforceQuota,
+                                      RecordStoreBulkBuilder* bulkBuilder) = 0;
 
         virtual RecordId updateDocument(OperationContext* opCtx,
                                         const RecordId& oldLocation,
@@ -506,13 +507,17 @@ public:
     /**
      * Inserts a document into the record store and adds it to the MultiIndexBlocks passed in.
      *
+     * If 'bulkBuilder' is non-null, the record is appended through it instead of being inserted
+     * into the record store as part of the current WriteUnitOfWork.
+     *
      * NOTE: It is up to caller to commit the indexes.
      */
     inline Status insertDocument(OperationContext* const opCtx,
                                  const BSONObj& doc,
                                  const std::vector<MultiIndexBlock*>& indexBlocks,
-                                 const bool enforceQuota) {
-        return this->_impl().insertDocument(opCtx, doc, indexBlocks, enforceQuota);
+                                 const bool enforceQuota,
+                                 RecordStoreBulkBuilder* const bulkBuilder = nullptr) {
+        return this->_impl().insertDocument(opCtx, doc, indexBlocks, enforceQuota, bulkBuilder);
     }
 
     /**
@@ -388,7 +388,8 @@ Status CollectionImpl::insertDocument(OperationContext* opCtx,
 Status CollectionImpl::insertDocument(OperationContext* opCtx,
                                       const BSONObj& doc,
                                       const std::vector<MultiIndexBlock*>& indexBlocks,
-                                      bool enforceQuota) {
+                                      bool enforceQuota,
+                                      RecordStoreBulkBuilder* bulkBuilder) {
 
     MONGO_FAIL_POINT_BLOCK(failCollectionInserts, extraData) {
         const BSONObj& data = extraData.getData();
@@ -413,8 +414,10 @@ Status CollectionImpl::insertDocument(OperationContext* opCtx,
 
     // TODO SERVER-30638: using timestamp 0 for these inserts, which are non-oplog so we don't yet
     // care about their correct timestamps.
-    StatusWith<RecordId> loc = _recordStore->insertRecord(
-        opCtx, doc.objdata(), doc.objsize(), Timestamp(), _enforceQuota(enforceQuota));
+    StatusWith<RecordId> loc = bulkBuilder
+        ? bulkBuilder->addRecord(doc.objdata(), doc.objsize())
+        : _recordStore->insertRecord(
+              opCtx, doc.objdata(), doc.objsize(), Timestamp(), _enforceQuota(enforceQuota));
 
     if (!loc.isOK())
         return loc.getStatus();
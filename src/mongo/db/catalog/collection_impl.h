@@ -195,13 +195,15 @@ public:
 
     /**
      * Inserts a document into the record store and adds it to the MultiIndexBlocks passed in.
+     * If 'bulkBuilder' is non-null, the record is appended through it instead.
      *
      * NOTE: It is up to caller to commit the indexes.
      */
     Status insertDocument(OperationContext* opCtx,
                           const BSONObj& doc,
                           const std::vector<MultiIndexBlock*>& indexBlocks,
-                          bool enforceQuota) final;
+                          bool enforceQuota,
+                          RecordStoreBulkBuilder* bulkBuilder) final;
 
     /**
      * Updates the document @ oldLocation with newDoc.
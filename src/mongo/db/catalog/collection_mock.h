@@ -165,7 +165,8 @@ public:
     Status insertDocument(OperationContext* opCtx,
                           const BSONObj& doc,
                           const std::vector<MultiIndexBlock*>& indexBlocks,
-                          bool enforceQuota) {
+                          bool enforceQuota,
+                          RecordStoreBulkBuilder* bulkBuilder) {
         std::abort();
     }
 
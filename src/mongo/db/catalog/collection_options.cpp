@@ -244,6 +244,12 @@ Status CollectionOptions::parse(const BSONObj& options, ParseKind kind) {
             }
 
             pipeline = e.Obj().getOwned();
+        } else if (fieldName == "materialized") {
+            if (e.type() != mongo::Bool) {
+                return Status(ErrorCodes::BadValue, "'materialized' has to be a boolean.");
+            }
+
+            materialized = e.Bool();
         } else if (fieldName == "idIndex" && kind == parseForCommand) {
             if (e.type() != mongo::Object) {
                 return Status(ErrorCodes::TypeMismatch, "'idIndex' has to be an object.");
@@ -267,6 +273,10 @@ Status CollectionOptions::parse(const BSONObj& options, ParseKind kind) {
         return Status(ErrorCodes::BadValue, "'pipeline' cannot be specified without 'viewOn'");
     }
 
+    if (viewOn.empty() && materialized) {
+        return Status(ErrorCodes::BadValue, "'materialized' cannot be specified without 'viewOn'");
+    }
+
     return Status::OK();
 }
 
@@ -335,6 +345,10 @@ void CollectionOptions::appendBSON(BSONObjBuilder* builder) const {
         builder->appendArray("pipeline", pipeline);
     }
 
+    if (materialized) {
+        builder->append("materialized", true);
+    }
+
     if (!idIndex.isEmpty()) {
         builder->append("idIndex", idIndex);
     }
@@ -424,6 +438,10 @@ bool CollectionOptions::matchesStorageOptions(const CollectionOptions& other,
         return false;
     }
 
+    if (materialized != other.materialized) {
+        return false;
+    }
+
     return true;
 }
 }
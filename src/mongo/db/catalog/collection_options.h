@@ -151,5 +151,7 @@ struct CollectionOptions {
     std::string viewOn;
     // The aggregation pipeline that defines this view.
     BSONObj pipeline;
+    // Whether the results of this view are maintained incrementally as its collection is written.
+    bool materialized = false;
 };
 }
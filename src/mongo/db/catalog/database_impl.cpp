@@ -759,7 +759,12 @@ Status DatabaseImpl::createView(OperationContext* opCtx,
         return Status(ErrorCodes::InvalidNamespace,
                       str::stream() << "invalid namespace name for a view: " + nss.toString());
 
-    return _views.createView(opCtx, nss, viewOnNss, BSONArray(options.pipeline), options.collation);
+    return _views.createView(opCtx,
+                             nss,
+                             viewOnNss,
+                             BSONArray(options.pipeline),
+                             options.collation,
+                             options.materialized);
 }
 
 Collection* DatabaseImpl::createCollection(OperationContext* opCtx,
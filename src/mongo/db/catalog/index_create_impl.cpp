@@ -32,6 +32,8 @@
 
 #include "mongo/db/catalog/index_create_impl.h"
 
+#include <algorithm>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/init.h"
 #include "mongo/client/dbclientinterface.h"
@@ -47,8 +49,10 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -99,6 +103,10 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+// Number of threads generating and sorting keys for a foreground build of several indexes. Values
+// below 2 build the indexes from the scanning thread.
+MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildKeyGenerationThreads, int, 4);
+
 
 /**
  * On rollback sets MultiIndexBlockImpl::_needToCleanup to true.
@@ -134,6 +142,153 @@ private:
     MultiIndexBlockImpl* const _indexer;
 };
 
+/**
+ * Inserts the documents of a foreground build into the indexes' BulkBuilders on worker threads,
+ * while the calling thread keeps scanning the collection.
+ *
+ * Documents are handed to the workers in batches. Each worker owns a fixed subset of the indexes,
+ * so a BulkBuilder, its access method and its Sorter are only ever used by a single thread. The
+ * next batch is not handed out until every worker is done with the previous one, which bounds the
+ * memory held by batches to two of them.
+ */
+class MultiIndexBlockImpl::ParallelBulkInserter {
+    MONGO_DISALLOW_COPYING(ParallelBulkInserter);
+
+public:
+    ParallelBulkInserter(std::vector<IndexToBuild>* indexes, size_t numThreads)
+        : _indexes(indexes), _numThreads(numThreads) {
+        for (size_t i = 0; i < _numThreads; i++) {
+            _threads.emplace_back([this, i] { _run(i); });
+        }
+    }
+
+    ~ParallelBulkInserter() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shutdown = true;
+        }
+        _cv.notify_all();
+        for (auto&& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Queues 'doc' for insertion into every index. Returns the first error a worker has hit.
+     */
+    Status insert(const BSONObj& doc, const RecordId& loc) {
+        _pending.docs.emplace_back(doc.getOwned(), loc);
+        _pending.bytes += doc.objsize();
+        if (_pending.docs.size() < kMaxBatchDocs && _pending.bytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _dispatch();
+    }
+
+    /**
+     * Waits until all queued documents have been inserted.
+     */
+    Status done() {
+        Status status = _dispatch();
+        if (!status.isOK()) {
+            return status;
+        }
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [this] { return _numBusy == 0; });
+        return _status;
+    }
+
+private:
+    struct Batch {
+        std::vector<std::pair<BSONObj, RecordId>> docs;
+        size_t bytes = 0;
+    };
+
+    static const size_t kMaxBatchDocs = 1024;
+    static const size_t kMaxBatchBytes = 16 * 1024 * 1024;
+
+    Status _dispatch() {
+        auto batch = std::make_shared<const Batch>(std::move(_pending));
+        _pending = Batch();
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [this] { return _numBusy == 0; });
+        if (!_status.isOK() || batch->docs.empty()) {
+            return _status;
+        }
+        _batch = std::move(batch);
+        _batchNum++;
+        _numBusy = _numThreads;
+        lk.unlock();
+        _cv.notify_all();
+        return Status::OK();
+    }
+
+    void _run(size_t workerNum) {
+        std::uint64_t lastBatchNum = 0;
+        while (true) {
+            std::shared_ptr<const Batch> batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _cv.wait(lk, [&] { return _shutdown || _batchNum != lastBatchNum; });
+                if (_shutdown) {
+                    return;
+                }
+                lastBatchNum = _batchNum;
+                batch = _batch;
+            }
+
+            Status status = Status::OK();
+            try {
+                for (auto&& doc : batch->docs) {
+                    for (size_t i = workerNum; i < _indexes->size() && status.isOK();
+                         i += _numThreads) {
+                        IndexToBuild& index = (*_indexes)[i];
+                        if (index.filterExpression &&
+                            !index.filterExpression->matchesBSON(doc.first)) {
+                            continue;
+                        }
+                        // BulkBuilder::insert() does not use the OperationContext, which belongs
+                        // to the scanning thread.
+                        int64_t unused;
+                        status = index.bulk->insert(
+                            nullptr, doc.first, doc.second, index.options, &unused);
+                    }
+                    if (!status.isOK()) {
+                        break;
+                    }
+                }
+            } catch (const DBException& e) {
+                status = e.toStatus();
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!status.isOK() && _status.isOK()) {
+                _status = status;
+            }
+            if (--_numBusy == 0) {
+                _cv.notify_all();
+            }
+        }
+    }
+
+    std::vector<IndexToBuild>* const _indexes;
+    const size_t _numThreads;
+
+    // Only used by the scanning thread.
+    Batch _pending;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::shared_ptr<const Batch> _batch;  // The batch the workers are inserting.
+    std::uint64_t _batchNum = 0;
+    size_t _numBusy = 0;  // Workers still inserting '_batch'.
+    Status _status = Status::OK();
+    bool _shutdown = false;
+
+    std::vector<stdx::thread> _threads;
+};
+
 MultiIndexBlockImpl::MultiIndexBlockImpl(OperationContext* opCtx, Collection* collection)
     : _collection(collection),
       _opCtx(opCtx),
@@ -315,6 +470,18 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
 
+    // Foreground builds of several indexes generate and sort the keys of each index on its own
+    // worker thread, fed from this scan.
+    std::unique_ptr<ParallelBulkInserter> parallelInserter;
+    const int maxThreads = maxIndexBuildKeyGenerationThreads.load();
+    if (!_buildInBackground && _indexes.size() > 1 && maxThreads > 1 &&
+        std::all_of(_indexes.begin(), _indexes.end(), [](const IndexToBuild& index) {
+            return static_cast<bool>(index.bulk);
+        })) {
+        parallelInserter = stdx::make_unique<ParallelBulkInserter>(
+            &_indexes, std::min(_indexes.size(), static_cast<size_t>(maxThreads)));
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -346,7 +513,8 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
             progress->setTotalWhileRunning(_collection->numRecords(_opCtx));
 
             WriteUnitOfWork wunit(_opCtx);
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = parallelInserter ? parallelInserter->insert(objToIndex.value(), loc)
+                                          : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -392,6 +560,13 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
                 WorkingSetCommon::toStatusString(objToIndex.value()),
             state == PlanExecutor::IS_EOF);
 
+    if (parallelInserter) {
+        Status status = parallelInserter->done();
+        if (!status.isOK())
+            return status;
+        parallelInserter.reset();
+    }
+
     if (MONGO_FAIL_POINT(hangAfterStartingIndexBuildUnlocked)) {
         // Unlock before hanging so replication recognizes we've completed.
         Locker::LockSnapshot lockInfo;
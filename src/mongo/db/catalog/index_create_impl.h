@@ -191,6 +191,7 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelBulkInserter;
 
     struct IndexToBuild {
         std::unique_ptr<IndexCatalogImpl::IndexBuildBlock> block;
@@ -344,7 +344,9 @@ public:
             awaitDataState(opCtx).shouldWaitForInserts = true;
         }
 
-        Status batchStatus = generateBatch(opCtx, cursor, request, &nextBatch, &state, &numResults);
+        bool reachedSortKeyBound = false;
+        Status batchStatus = generateBatch(
+            opCtx, cursor, request, &nextBatch, &state, &numResults, &reachedSortKeyBound);
         if (!batchStatus.isOK()) {
             return CommandHelpers::appendCommandStatus(result, batchStatus);
         }
@@ -365,7 +367,9 @@ public:
             curOp->debug().execStats = execStatsBob.obj();
         }
 
-        if (shouldSaveCursorGetMore(state, exec, cursor->isTailable())) {
+        // A cursor whose next result is beyond the requester's sort key bound has nothing left
+        // to contribute, so it is closed as if it were exhausted.
+        if (!reachedSortKeyBound && shouldSaveCursorGetMore(state, exec, cursor->isTailable())) {
             respondWithId = request.cursorid;
 
             exec->saveState();
@@ -413,6 +417,9 @@ public:
      * Returns the number of documents in the batch in *numResults, which must be initialized to
      * zero by the caller. Returns the final ExecState returned by the cursor in *state.
      *
+     * If the request carries a sort key bound and the cursor produces a result that sorts after
+     * it, the batch ends before that result and *reachedSortKeyBound is set to true.
+     *
      * Returns an OK status if the batch was successfully generated, and a non-OK status if the
      * PlanExecutor encounters a failure.
      */
@@ -421,7 +428,8 @@ public:
                          const GetMoreRequest& request,
                          CursorResponseBuilder* nextBatch,
                          PlanExecutor::ExecState* state,
-                         long long* numResults) {
+                         long long* numResults,
+                         bool* reachedSortKeyBound) {
         PlanExecutor* exec = cursor->getExecutor();
 
         // If an awaitData getMore is killed during this process due to our max time expiring at
@@ -431,6 +439,13 @@ public:
         try {
             while (!FindCommon::enoughForGetMore(request.batchSize.value_or(0), *numResults) &&
                    PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
+                // The results are sorted, so neither this result nor any that follow it are
+                // needed once one sorts after the bound.
+                if (request.sortKeyBound && request.sortKeyBound->isExceededBy(obj)) {
+                    *reachedSortKeyBound = true;
+                    break;
+                }
+
                 // If adding this object will cause us to exceed the message size limit, then we
                 // stash it for later.
                 if (!FindCommon::haveSpaceForNext(obj, *numResults, nextBatch->bytesUsed())) {
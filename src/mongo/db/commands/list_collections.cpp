@@ -141,6 +141,9 @@ BSONObj buildViewBson(const ViewDefinition& view) {
     if (view.defaultCollator()) {
         optionsBuilder.append("collation", view.defaultCollator()->getSpec().toBSON());
     }
+    if (view.materializedView()) {
+        optionsBuilder.append("materialized", true);
+    }
     optionsBuilder.doneFast();
 
     BSONObj info = BSON("readOnly" << true);
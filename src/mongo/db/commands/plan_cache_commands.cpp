@@ -266,6 +266,11 @@ Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder
     }
     arrayBuilder.doneFast();
 
+    // Report the memory used by this collection's cache and by the caches of all collections,
+    // which share the 'internalQueryCacheMaxSizeBytes' budget.
+    bob->appendNumber("estimatedSizeBytes", static_cast<long long>(planCache.estimatedSizeBytes()));
+    bob->appendNumber("totalEstimatedSizeBytes", PlanCache::totalEstimatedSizeBytes());
+
     return Status::OK();
 }
 
@@ -442,6 +447,10 @@ Status PlanCacheListPlans::list(OperationContext* opCtx,
     // Append the time the entry was inserted into the plan cache.
     bob->append("timeOfCreation", entry->timeOfCreation);
 
+    // Append how often the entry has been used and how much memory it takes up.
+    bob->appendNumber("numHits", static_cast<long long>(entry->numHits));
+    bob->appendNumber("estimatedSizeBytes", static_cast<long long>(entry->estimatedSizeBytes));
+
     return Status::OK();
 }
 
@@ -32,12 +32,14 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
@@ -52,6 +54,15 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+
+// The number of collection scans which started at the position of another scan of the collection.
+Counter64 sharedCollectionScansCounter;
+ServerStatusMetricField<Counter64> displaySharedCollectionScans("query.sharedCollectionScans",
+                                                                &sharedCollectionScansCounter);
+
+}  // namespace
+
 // static
 const char* CollectionScan::kStageType = "COLLSCAN";
 
@@ -62,6 +73,7 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
     : PlanStage(kStageType, opCtx),
       _workingSet(workingSet),
       _filter(filter),
+      _compiledFilter(CompiledComparisonFilter::compile(filter)),
       _params(params),
       _isDead(false),
       _wsidForFetch(_workingSet->allocate()) {
@@ -121,6 +133,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
             _cursor = _params.collection->getCursor(getOpCtx(), forward);
 
+            if (_lastSeenId.isNull() && !_sharedScan) {
+                registerSharedScan();
+            }
+
             if (!_lastSeenId.isNull()) {
                 invariant(_params.tailable);
                 // Seek to where we were last time. If it no longer exists, mark us as dead
@@ -146,6 +162,16 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
         if (_lastSeenId.isNull() && !_params.start.isNull()) {
             record = _cursor->seekExact(_params.start);
+        } else if (_lastSeenId.isNull() && !_sharedScanStart.isNull()) {
+            record = _cursor->seekExact(_sharedScanStart);
+            if (!record) {
+                // The record the other scan last read has since been deleted. Scan the collection
+                // from the start instead.
+                _sharedScanStart = RecordId();
+                _cursor = _params.collection->getCursor(getOpCtx(), true);
+                return PlanStage::NEED_TIME;
+            }
+            sharedCollectionScansCounter.increment();
         } else {
             // See if the record we're about to access is in memory. If not, pass a fetch
             // request up.
@@ -168,6 +194,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     }
 
     if (!record) {
+        if (wrapAroundSharedScan()) {
+            return PlanStage::NEED_TIME;
+        }
+
         // We just hit EOF. If we are tailable and have already returned data, leave us in a
         // state to pick up where we left off on the next call to work(). Otherwise EOF is
         // permanent.
@@ -180,6 +210,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (advanceSharedScan(record->id)) {
+        return PlanStage::IS_EOF;
+    }
+
     _lastSeenId = record->id;
     if (_params.shouldTrackLatestOplogTimestamp) {
         auto status = setLatestOplogEntryTimestamp(*record);
@@ -198,6 +232,142 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     return returnIfMatches(member, id, out);
 }
 
+PlanStage::StageState CollectionScan::doWorkBatch(WorkingSet* ws,
+                                                  size_t maxWorks,
+                                                  std::vector<WorkingSetID>* out,
+                                                  WorkingSetID* stateId,
+                                                  size_t* works) {
+    // Creating the cursor, seeking to the start record, enforcing 'maxScan' and tracking the
+    // latest oplog timestamp are all left to doWork(). Once the scan is underway, records are
+    // read in a tight loop below.
+    const bool needToSeekToStart =
+        _lastSeenId.isNull() && (!_params.start.isNull() || !_sharedScanStart.isNull());
+    if (!_cursor || _isDead || _commonStats.isEOF || 0 != _params.maxScan ||
+        _params.shouldTrackLatestOplogTimestamp || needToSeekToStart) {
+        return PlanStage::doWorkBatch(ws, maxWorks, out, stateId, works);
+    }
+
+    invariant(ws == _workingSet);
+    const SnapshotId snapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
+    for (*works = 0; *works < maxWorks;) {
+        ++*works;
+
+        boost::optional<Record> record;
+        try {
+            if (auto fetcher = _cursor->fetcherForNext()) {
+                WorkingSetMember* member = _workingSet->get(_wsidForFetch);
+                member->setFetcher(fetcher.release());
+                *stateId = _wsidForFetch;
+                return PlanStage::NEED_YIELD;
+            }
+
+            record = _cursor->next();
+        } catch (const WriteConflictException&) {
+            *stateId = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        if (!record) {
+            if (wrapAroundSharedScan()) {
+                *stateId = WorkingSet::INVALID_ID;
+                return PlanStage::NEED_TIME;
+            }
+
+            // As in doWork(), a tailable scan which has returned data picks up where it left off.
+            if (_params.tailable && !_lastSeenId.isNull()) {
+                _cursor.reset();
+            } else {
+                _commonStats.isEOF = true;
+            }
+            return PlanStage::IS_EOF;
+        }
+
+        if (advanceSharedScan(record->id)) {
+            return PlanStage::IS_EOF;
+        }
+
+        _lastSeenId = record->id;
+        ++_specificStats.docsTested;
+
+        // Apply the filter to the record before allocating a working set member for it, so that
+        // records which don't match cost nothing beyond the match itself.
+        const BSONObj obj = record->data.toBson();
+        if (!passesFilter(obj)) {
+            if (_endCondition && _endCondition->matchesBSON(obj)) {
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
+            continue;
+        }
+
+        if (_params.stopApplyingFilterAfterFirstMatch) {
+            _filter = nullptr;
+            _compiledFilter.reset();
+        }
+
+        // The cursor may reuse the memory backing 'record' on its next advance, so the results of
+        // a batch must own their data.
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->recordId = record->id;
+        member->obj = {snapshotId, obj.getOwned()};
+        _workingSet->transitionToRecordIdAndObj(id);
+        out->push_back(id);
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
+void CollectionScan::registerSharedScan() {
+    const int minSizeMB = internalQuerySharedCollectionScanMinSizeMB.load();
+    const Collection* collection = _params.collection;
+    if (!_params.allowSharedScan || !internalQueryEnableSharedCollectionScans.load() ||
+        minSizeMB < 0 || _params.direction != CollectionScanParams::FORWARD || _params.tailable ||
+        !_params.start.isNull() || _params.maxTs || collection->isCapped() ||
+        collection->ns().isOplog()) {
+        return;
+    }
+
+    if (collection->dataSize(getOpCtx()) < static_cast<uint64_t>(minSizeMB) * 1024 * 1024) {
+        return;
+    }
+
+    _sharedScan = SharedCollectionScans::get(getOpCtx()->getServiceContext())
+                      .registerScan(collection->ns().ns(), &_sharedScanStart);
+}
+
+bool CollectionScan::advanceSharedScan(const RecordId& id) {
+    if (!_sharedScan) {
+        return false;
+    }
+
+    if (_wrappedAround && id >= _sharedScanStart) {
+        _sharedScan.reset();
+        _commonStats.isEOF = true;
+        return true;
+    }
+
+    _sharedScan->setPosition(id);
+    return false;
+}
+
+bool CollectionScan::wrapAroundSharedScan() {
+    if (!_sharedScan) {
+        return false;
+    }
+
+    if (_sharedScanStart.isNull() || _wrappedAround) {
+        _sharedScan.reset();
+        return false;
+    }
+
+    // The records before the one the scan started at are read from the start of the collection.
+    // The cursor keeps reading from the same snapshot.
+    _wrappedAround = true;
+    _cursor = _params.collection->getCursor(getOpCtx(), true);
+    return true;
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()[repl::OpTime::kTimestampFieldName];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -216,9 +386,10 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    if (passesFilter(member->obj.value())) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
+            _compiledFilter.reset();
         }
         *out = memberID;
         return PlanStage::ADVANCED;
@@ -232,6 +403,20 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
     }
 }
 
+bool CollectionScan::passesFilter(const BSONObj& obj) const {
+    if (!_filter) {
+        return true;
+    }
+
+    if (_compiledFilter) {
+        const auto result = _compiledFilter->matches(obj);
+        if (result != CompiledComparisonFilter::MatchResult::kUnknown) {
+            return result == CompiledComparisonFilter::MatchResult::kMatch;
+        }
+    }
+    return _filter->matchesBSON(obj);
+}
+
 bool CollectionScan::isEOF() {
     return _commonStats.isEOF || _isDead;
 }
@@ -263,6 +448,9 @@ void CollectionScan::doSaveState() {
     if (_cursor) {
         _cursor->save();
     }
+    if (_sharedScan) {
+        _sharedScan->publishPosition();
+    }
 }
 
 void CollectionScan::doRestoreState() {
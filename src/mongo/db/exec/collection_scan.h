@@ -31,7 +31,9 @@
 #include <memory>
 
 #include "mongo/db/exec/collection_scan_common.h"
+#include "mongo/db/exec/compiled_comparison_filter.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/shared_collection_scan.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
 
@@ -56,6 +58,11 @@ public:
                    const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(WorkingSet* ws,
+                           size_t maxWorks,
+                           std::vector<WorkingSetID>* out,
+                           WorkingSetID* stateId,
+                           size_t* works) final;
     bool isEOF() final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
@@ -85,6 +92,11 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Returns whether 'obj' passes '_filter', using '_compiledFilter' where it can.
+     */
+    bool passesFilter(const BSONObj& obj) const;
+
     /**
      * Extracts the timestamp from the 'ts' field of 'record', and sets '_latestOplogEntryTimestamp'
      * to that time if it isn't already greater.  Returns an error if the 'ts' field cannot be
@@ -92,12 +104,33 @@ private:
      */
     Status setLatestOplogEntryTimestamp(const Record& record);
 
+    /**
+     * Registers the scan with the other scans of its collection if it may share its reads with
+     * them, and sets '_sharedScanStart' to the position it should start at.
+     */
+    void registerSharedScan();
+
+    /**
+     * Called when the cursor has returned 'id' as the next record. Returns true if the scan has
+     * wrapped around to where it started, and so is done.
+     */
+    bool advanceSharedScan(const RecordId& id);
+
+    /**
+     * Called when the cursor reaches the end of the collection. Returns true if the scan started
+     * part way through the collection, in which case it has repositioned the cursor at the start.
+     */
+    bool wrapAroundSharedScan();
+
     // WorkingSet is not owned by us.
     WorkingSet* _workingSet;
 
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // If '_filter' is a conjunction of simple comparisons, its compiled form. Null otherwise.
+    std::unique_ptr<CompiledComparisonFilter> _compiledFilter;
+
     // If a document does not pass '_filter' but passes '_endCondition', stop scanning and return
     // IS_EOF.
     BSONObj _endConditionBSON;
@@ -111,6 +144,15 @@ private:
 
     RecordId _lastSeenId;  // Null if nothing has been returned from _cursor yet.
 
+    // Set if the scan's reads may be shared with other scans of the collection. See
+    // SharedCollectionScans.
+    std::unique_ptr<SharedCollectionScans::Registration> _sharedScan;
+
+    // If not null, the scan started at this record rather than at the start of the collection, and
+    // finishes when it wraps around to it.
+    RecordId _sharedScanStart;
+    bool _wrappedAround = false;
+
     // We allocate a working set member with this id on construction of the stage. It gets used for
     // all fetch requests. This should only be used for passing up the Fetcher for a NEED_YIELD, and
     // should remain in the INVALID state.
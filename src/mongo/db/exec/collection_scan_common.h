@@ -69,6 +69,12 @@ struct CollectionScanParams {
 
     // If non-zero, how many documents will we look at?
     size_t maxScan = 0;
+
+    // May the scan return documents in an order other than natural order? If so, a forward scan
+    // of a large collection may start at the position of another scan of the collection which is
+    // already in progress, and wrap around to the start of the collection. See
+    // SharedCollectionScans.
+    bool allowSharedScan = false;
 };
 
 }  // namespace mongo
@@ -0,0 +1,261 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/compiled_comparison_filter.h"
+
+#include <cmath>
+#include <limits>
+
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_tree.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+namespace {
+
+// Integers of larger magnitude may not be exactly representable as doubles.
+const long long kMaxExactDoubleInteger = 1LL << 53;
+
+bool isExactAsDouble(long long value) {
+    return value >= -kMaxExactDoubleInteger && value <= kMaxExactDoubleInteger;
+}
+
+}  // namespace
+
+std::unique_ptr<CompiledComparisonFilter> CompiledComparisonFilter::compile(
+    const MatchExpression* filter) {
+    std::unique_ptr<CompiledComparisonFilter> compiled(new CompiledComparisonFilter());
+    if (!filter || !compiled->addPredicates(filter) || compiled->_numFields == 0) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+bool CompiledComparisonFilter::addPredicates(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                if (!addPredicates(expr->getChild(i))) {
+                    return false;
+                }
+            }
+            return true;
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            return addComparison(static_cast<const ComparisonMatchExpression*>(expr));
+        default:
+            return false;
+    }
+}
+
+bool CompiledComparisonFilter::addComparison(const ComparisonMatchExpression* expr) {
+    const StringData path = expr->path();
+    if (path.empty() || path.find('.') != std::string::npos) {
+        return false;
+    }
+
+    // Only bounds which compare exactly as doubles can be compiled. NaN is excluded too, since it
+    // compares equal to itself in a match.
+    const BSONElement rhs = expr->getData();
+    ValueKind kind;
+    double bound;
+    switch (rhs.type()) {
+        case NumberInt:
+            kind = ValueKind::kNumber;
+            bound = rhs._numberInt();
+            break;
+        case NumberLong:
+            if (!isExactAsDouble(rhs._numberLong())) {
+                return false;
+            }
+            kind = ValueKind::kNumber;
+            bound = rhs._numberLong();
+            break;
+        case NumberDouble:
+            if (std::isnan(rhs._numberDouble())) {
+                return false;
+            }
+            kind = ValueKind::kNumber;
+            bound = rhs._numberDouble();
+            break;
+        case Date:
+            if (!isExactAsDouble(rhs.date().toMillisSinceEpoch())) {
+                return false;
+            }
+            kind = ValueKind::kDate;
+            bound = rhs.date().toMillisSinceEpoch();
+            break;
+        default:
+            return false;
+    }
+
+    size_t field = 0;
+    while (field < _numFields && _fieldNames[field] != path) {
+        ++field;
+    }
+    if (field == _numFields) {
+        if (_numFields == kMaxFields) {
+            return false;
+        }
+        ++_numFields;
+        _fieldNames[field] = path.toString();
+        _kinds[field] = kind;
+        _lower[field] = -std::numeric_limits<double>::infinity();
+        _upper[field] = std::numeric_limits<double>::infinity();
+        _lowerInclusive[field] = true;
+        _upperInclusive[field] = true;
+    } else if (_kinds[field] != kind) {
+        // Comparing one field against both a number and a date is never satisfiable, but is too
+        // unusual to be worth compiling.
+        return false;
+    }
+
+    const MatchExpression::MatchType type = expr->matchType();
+    if (type == MatchExpression::EQ || type == MatchExpression::GT ||
+        type == MatchExpression::GTE) {
+        const bool inclusive = type != MatchExpression::GT;
+        if (bound > _lower[field]) {
+            _lower[field] = bound;
+            _lowerInclusive[field] = inclusive;
+        } else if (bound == _lower[field]) {
+            _lowerInclusive[field] = _lowerInclusive[field] && inclusive;
+        }
+    }
+    if (type == MatchExpression::EQ || type == MatchExpression::LT ||
+        type == MatchExpression::LTE) {
+        const bool inclusive = type != MatchExpression::LT;
+        if (bound < _upper[field]) {
+            _upper[field] = bound;
+            _upperInclusive[field] = inclusive;
+        } else if (bound == _upper[field]) {
+            _upperInclusive[field] = _upperInclusive[field] && inclusive;
+        }
+    }
+    return true;
+}
+
+CompiledComparisonFilter::MatchResult CompiledComparisonFilter::matches(const BSONObj& doc) const {
+    // Gather the value of each filtered field, as getField() would find it, in one pass over the
+    // document. A value of a type which can't compare with its bounds fails the whole conjunction.
+    std::array<double, kMaxFields> values;
+    const uint32_t allFields = (1u << _numFields) - 1;
+    uint32_t found = 0;
+    uint32_t unknown = 0;
+    BSONObjIterator it(doc);
+    while (found != allFields && it.more()) {
+        const BSONElement elem = it.next();
+        const StringData name = elem.fieldNameStringData();
+        for (size_t field = 0; field < _numFields; ++field) {
+            const uint32_t bit = 1u << field;
+            if ((found & bit) || name != _fieldNames[field]) {
+                continue;
+            }
+            found |= bit;
+
+            const bool wantsNumber = _kinds[field] == ValueKind::kNumber;
+            switch (elem.type()) {
+                case NumberInt:
+                    if (!wantsNumber) {
+                        return MatchResult::kNoMatch;
+                    }
+                    values[field] = elem._numberInt();
+                    break;
+                case NumberLong:
+                    if (!wantsNumber) {
+                        return MatchResult::kNoMatch;
+                    }
+                    if (!isExactAsDouble(elem._numberLong())) {
+                        unknown |= bit;
+                    }
+                    values[field] = elem._numberLong();
+                    break;
+                case NumberDouble:
+                    // NaN fails every comparison with a bound, just as in a match.
+                    if (!wantsNumber) {
+                        return MatchResult::kNoMatch;
+                    }
+                    values[field] = elem._numberDouble();
+                    break;
+                case NumberDecimal:
+                    if (!wantsNumber) {
+                        return MatchResult::kNoMatch;
+                    }
+                    unknown |= bit;
+                    values[field] = 0;
+                    break;
+                case Date:
+                    if (wantsNumber) {
+                        return MatchResult::kNoMatch;
+                    }
+                    if (!isExactAsDouble(elem.date().toMillisSinceEpoch())) {
+                        unknown |= bit;
+                    }
+                    values[field] = elem.date().toMillisSinceEpoch();
+                    break;
+                case Array:
+                    // Any element of the array may match.
+                    unknown |= bit;
+                    values[field] = 0;
+                    break;
+                default:
+                    return MatchResult::kNoMatch;
+            }
+            break;
+        }
+    }
+
+    if (found != allFields) {
+        // A missing field never compares with a number or a date.
+        return MatchResult::kNoMatch;
+    }
+
+    // Compare every field with its bounds without branching, so the comparisons can be
+    // vectorized. The results for fields whose values couldn't be read are ignored.
+    uint32_t passed = 0;
+    for (size_t field = 0; field < _numFields; ++field) {
+        const double value = values[field];
+        const bool aboveLower =
+            (value > _lower[field]) | (_lowerInclusive[field] & (value == _lower[field]));
+        const bool belowUpper =
+            (value < _upper[field]) | (_upperInclusive[field] & (value == _upper[field]));
+        passed |= static_cast<uint32_t>(aboveLower & belowUpper) << field;
+    }
+
+    if ((passed | unknown) != allFields) {
+        return MatchResult::kNoMatch;
+    }
+    return unknown ? MatchResult::kUnknown : MatchResult::kMatch;
+}
+
+}  // namespace mongo
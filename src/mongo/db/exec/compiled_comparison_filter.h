@@ -0,0 +1,93 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+class ComparisonMatchExpression;
+class MatchExpression;
+
+/**
+ * A compiled form of a filter which is a conjunction of $eq, $lt, $lte, $gt and $gte predicates
+ * over top-level fields, each comparing against a number or a date. Evaluating it takes a single
+ * pass over the top-level fields of a document, and compares every filtered field against the
+ * bounds merged from its predicates without dispatching on the types of the predicates.
+ *
+ * Some documents can't be evaluated exactly this way, such as those with an array or a
+ * NumberDecimal in a filtered field. For these, matches() returns kUnknown and the caller must
+ * evaluate the original MatchExpression.
+ */
+class CompiledComparisonFilter {
+public:
+    enum class MatchResult { kMatch, kNoMatch, kUnknown };
+
+    // The most fields a compiled filter may compare.
+    static constexpr size_t kMaxFields = 8;
+
+    /**
+     * Returns the compiled form of 'filter', or nullptr if 'filter' is not a conjunction of
+     * comparisons which can be compiled.
+     */
+    static std::unique_ptr<CompiledComparisonFilter> compile(const MatchExpression* filter);
+
+    MatchResult matches(const BSONObj& doc) const;
+
+private:
+    // Numbers of any type compare with each other, but never with dates.
+    enum class ValueKind : uint8_t { kNumber, kDate };
+
+    CompiledComparisonFilter() = default;
+
+    /**
+     * Merges the bounds of 'expr', or of each child of 'expr' if it is an $and, into the bounds of
+     * the compared fields. Returns false if any of them can't be compiled.
+     */
+    bool addPredicates(const MatchExpression* expr);
+    bool addComparison(const ComparisonMatchExpression* expr);
+
+    size_t _numFields = 0;
+    std::array<std::string, kMaxFields> _fieldNames;
+    std::array<ValueKind, kMaxFields> _kinds;
+
+    // Each field must lie within its bounds, which are infinite for a field without a predicate
+    // on that side. All values are exactly representable as doubles.
+    std::array<double, kMaxFields> _lower;
+    std::array<double, kMaxFields> _upper;
+    std::array<bool, kMaxFields> _lowerInclusive;
+    std::array<bool, kMaxFields> _upperInclusive;
+};
+
+}  // namespace mongo
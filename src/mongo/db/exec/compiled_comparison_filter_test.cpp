@@ -0,0 +1,165 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/compiled_comparison_filter.h"
+
+#include <limits>
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using MatchResult = CompiledComparisonFilter::MatchResult;
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& query) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto statusWithMatcher = MatchExpressionParser::parse(query, expCtx);
+    ASSERT_OK(statusWithMatcher.getStatus());
+    return std::move(statusWithMatcher.getValue());
+}
+
+/**
+ * Asserts that the compiled form of 'query' agrees with the MatchExpression on each of 'docs'
+ * whenever it gives an answer.
+ */
+void assertMatchesLikeMatchExpression(const BSONObj& query, const std::vector<BSONObj>& docs) {
+    auto expr = parse(query);
+    auto compiled = CompiledComparisonFilter::compile(expr.get());
+    ASSERT(compiled) << query;
+    for (auto&& doc : docs) {
+        const MatchResult result = compiled->matches(doc);
+        if (result != MatchResult::kUnknown) {
+            ASSERT_EQ(expr->matchesBSON(doc), result == MatchResult::kMatch)
+                << query << " " << doc;
+        }
+    }
+}
+
+TEST(CompiledComparisonFilterTest, DoesNotCompileOtherPredicates) {
+    ASSERT_FALSE(CompiledComparisonFilter::compile(parse(fromjson("{}")).get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(parse(fromjson("{a: 'x'}")).get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(parse(fromjson("{'a.b': 1}")).get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(parse(fromjson("{a: {$in: [1, 2]}}")).get()));
+    ASSERT_FALSE(
+        CompiledComparisonFilter::compile(parse(fromjson("{$or: [{a: 1}, {b: 2}]}")).get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(parse(fromjson("{a: 1, b: {$ne: 2}}")).get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(
+                     parse(BSON("a" << BSON("$lt" << std::numeric_limits<double>::quiet_NaN())))
+                         .get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(
+                     parse(BSON("a" << BSON("$lt" << (1LL << 60)))).get()));
+    ASSERT_FALSE(CompiledComparisonFilter::compile(
+                     parse(BSON("a" << BSON("$gt" << 1 << "$lt" << Date_t()))).get()));
+}
+
+TEST(CompiledComparisonFilterTest, MatchesScalarNumbersWithinMergedBounds) {
+    auto expr = parse(fromjson("{a: {$gt: 1, $gte: 2, $lt: 10}, b: {$lte: 5}, c: 3}"));
+    auto compiled = CompiledComparisonFilter::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT(MatchResult::kMatch == compiled->matches(fromjson("{a: 2, b: 5, c: 3}")));
+    ASSERT(MatchResult::kMatch == compiled->matches(BSON("a" << 9.5 << "b" << -1LL << "c" << 3.0)));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: 1.5, b: 5, c: 3}")));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: 10, b: 5, c: 3}")));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: 2, b: 5.5, c: 3}")));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: 2, b: 5}")));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: 2, b: '5', c: 3}")));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: 2, b: null, c: 3}")));
+}
+
+TEST(CompiledComparisonFilterTest, DefersToMatchExpressionForArraysAndDecimals) {
+    auto compiled = CompiledComparisonFilter::compile(parse(fromjson("{a: {$lt: 5}, b: 1}")).get());
+    ASSERT(compiled);
+    ASSERT(MatchResult::kUnknown == compiled->matches(fromjson("{a: [10, 1], b: 1}")));
+    ASSERT(MatchResult::kUnknown ==
+           compiled->matches(BSON("a" << Decimal128("4.5") << "b" << 1)));
+    ASSERT(MatchResult::kUnknown == compiled->matches(BSON("a" << (1LL << 60) << "b" << 1)));
+
+    // A field which can't match decides the conjunction even if another field is unknown.
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: [10, 1], b: 2}")));
+    ASSERT(MatchResult::kNoMatch == compiled->matches(fromjson("{a: [10, 1]}")));
+}
+
+TEST(CompiledComparisonFilterTest, AgreesWithMatchExpression) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    const std::vector<BSONObj> docs = {
+        BSONObj(),
+        BSON("a" << 0),
+        BSON("a" << -0.0),
+        BSON("a" << 5),
+        BSON("a" << 5LL),
+        BSON("a" << 5.0),
+        BSON("a" << 4.999),
+        BSON("a" << 5.001),
+        BSON("a" << nan),
+        BSON("a" << inf),
+        BSON("a" << -inf),
+        BSON("a" << Date_t::fromMillisSinceEpoch(5)),
+        BSON("a" << Date_t::fromMillisSinceEpoch(-5)),
+        BSON("a" << Timestamp(5, 0)),
+        BSON("a" << true),
+        BSON("a" << "5"),
+        BSON("a" << BSONNULL),
+        BSON("a" << BSONUndefined),
+        BSON("a" << MINKEY),
+        BSON("a" << MAXKEY),
+        BSON("a" << BSON("b" << 5)),
+        BSON("a" << BSON_ARRAY(1 << 6)),
+        BSON("a" << BSONArray()),
+        BSON("a" << 5 << "a" << 100),
+        BSON("a" << 100 << "a" << 5),
+        BSON("b" << 5),
+        BSON("a" << 5 << "b" << 7),
+        BSON("a" << 6 << "b" << Date_t::fromMillisSinceEpoch(7)),
+    };
+
+    for (auto&& query : {fromjson("{a: 5}"),
+                         fromjson("{a: {$lt: 5}}"),
+                         fromjson("{a: {$lte: 5}}"),
+                         fromjson("{a: {$gt: 5}}"),
+                         fromjson("{a: {$gte: 5}}"),
+                         fromjson("{a: {$gte: 0, $lte: 0}}"),
+                         fromjson("{a: {$gt: 4, $lt: 6}, b: {$gte: 7}}"),
+                         fromjson("{$and: [{a: {$gte: 5}}, {a: {$lte: 5}}]}"),
+                         BSON("a" << BSON("$lt" << inf)),
+                         BSON("a" << BSON("$gte" << -inf)),
+                         BSON("a" << BSON("$lte" << Date_t::fromMillisSinceEpoch(5))),
+                         BSON("a" << BSON("$gt" << 4 << "$lt" << 6) << "b"
+                                  << BSON("$gt" << Date_t::fromMillisSinceEpoch(6)))}) {
+        assertMatchesLikeMatchExpression(query, docs);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
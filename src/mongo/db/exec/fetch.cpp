@@ -30,6 +30,8 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <tuple>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
@@ -71,6 +73,11 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_pendingFetch.empty() || _pendingChildState) {
+        // A batch from our child hasn't been fully returned yet.
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -82,12 +89,19 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (!_pendingFetch.empty()) {
+        status = ADVANCED;
+        id = _pendingFetch.front();
+        _pendingFetch.pop_front();
+    } else if (_pendingChildState) {
+        std::tie(status, id) = *_pendingChildState;
+        _pendingChildState = boost::none;
+    } else {
+        status = child()->work(&id);
     }
 
     if (PlanStage::ADVANCED == status) {
@@ -150,9 +164,58 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::doWorkBatch(WorkingSet* ws,
+                                              size_t maxWorks,
+                                              std::vector<WorkingSetID>* out,
+                                              WorkingSetID* stateId,
+                                              size_t* works) {
+    invariant(ws == _ws);
+    *works = 0;
+    while (*works < maxWorks) {
+        if (WorkingSet::INVALID_ID == _idRetrying && _pendingFetch.empty() && !_pendingChildState &&
+            !child()->isEOF()) {
+            // Take a batch of results from our child, to be fetched by doWork() below. Each unit of
+            // our child's work is a unit of ours, but we count the units which produced a result
+            // or ended the batch as we return them.
+            const size_t childWorksBefore = child()->getCommonStats()->works;
+            WorkingSetID childStateId = WorkingSet::INVALID_ID;
+            _childBatch.clear();
+            StageState childState =
+                child()->workBatch(_ws, maxWorks - *works, &_childBatch, &childStateId);
+            const size_t childWorks = child()->getCommonStats()->works - childWorksBefore;
+
+            _pendingFetch.insert(_pendingFetch.end(), _childBatch.begin(), _childBatch.end());
+            size_t numPending = _childBatch.size();
+            if (PlanStage::ADVANCED != childState && PlanStage::NEED_TIME != childState) {
+                _pendingChildState = std::make_pair(childState, childStateId);
+                ++numPending;
+            }
+            *works += childWorks - numPending;
+            continue;
+        }
+
+        ++*works;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = FetchStage::doWork(&id);
+        if (PlanStage::ADVANCED == state) {
+            out->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            *stateId = id;
+            return state;
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
 void FetchStage::doSaveState() {
     if (_cursor)
         _cursor->saveUnpositioned();
+
+    // Our child's results may point into storage engine memory which is released when yielding.
+    for (auto id : _pendingFetch) {
+        _ws->get(id)->makeObjOwnedIfNeeded();
+    }
 }
 
 void FetchStage::doRestoreState() {
@@ -180,6 +243,14 @@ void FetchStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Inval
             WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
         }
     }
+
+    // The same goes for the results from our child which we have yet to fetch.
+    for (auto id : _pendingFetch) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        }
+    }
 }
 
 PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <deque>
 #include <memory>
+#include <utility>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -59,6 +62,11 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(WorkingSet* ws,
+                           size_t maxWorks,
+                           std::vector<WorkingSetID>* out,
+                           WorkingSetID* stateId,
+                           size_t* works) final;
 
     void doSaveState() final;
     void doRestoreState() final;
@@ -98,6 +106,12 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Results taken from our child by doWorkBatch() which have yet to be fetched, and the state
+    // which ended the child's batch, if any. Both are drained before our child is worked again.
+    std::deque<WorkingSetID> _pendingFetch;
+    boost::optional<std::pair<StageState, WorkingSetID>> _pendingChildState;
+    std::vector<WorkingSetID> _childBatch;
+
     // Stats
     FetchStats _specificStats;
 };
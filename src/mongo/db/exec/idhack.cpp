@@ -38,6 +38,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 
@@ -119,8 +120,18 @@ PlanStage::StageState IDHackStage::doWork(WorkingSetID* out) {
 
     WorkingSetID id = WorkingSet::INVALID_ID;
     try {
+        // Generate the key for the _id index, which may depend on its collation, only once for
+        // both lookups.
+        const BSONObj indexKey = _accessMethod->getSingleKey(_key);
+
+        if (_accessMethod->hasLookupCache() && fetchCached(indexKey, &id)) {
+            ++_specificStats.keysExamined;
+            ++_specificStats.docsExamined;
+            return advance(id, _workingSet->get(id), out);
+        }
+
         // Look up the key by going directly to the index.
-        RecordId recordId = _accessMethod->findSingle(getOpCtx(), _key);
+        RecordId recordId = _accessMethod->findSingleByIndexKey(getOpCtx(), indexKey);
 
         // Key not found.
         if (recordId.isNull()) {
@@ -172,6 +183,34 @@ PlanStage::StageState IDHackStage::doWork(WorkingSetID* out) {
     }
 }
 
+bool IDHackStage::fetchCached(const BSONObj& indexKey, WorkingSetID* out) {
+    RecordId recordId = _accessMethod->findSingleCached(getOpCtx(), indexKey);
+    if (recordId.isNull()) {
+        return false;
+    }
+
+    // Set 'out' right away so that the caller frees the WSM if fetching throws.
+    WorkingSetID id = *out = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = recordId;
+    _workingSet->transitionToRecordIdAndIdx(id);
+
+    if (!_recordCursor)
+        _recordCursor = _collection->getCursor(getOpCtx());
+
+    // The cache isn't transactional, so the record must still have the _id we are looking for in
+    // our snapshot. _id is unique, so it is then the record the index would return.
+    const BSONElementComparator eltCmp(BSONElementComparator::FieldNamesMode::kIgnore,
+                                       _collection->getDefaultCollator());
+    if (!WorkingSetCommon::fetch(getOpCtx(), _workingSet, id, _recordCursor) ||
+        !eltCmp.evaluate(member->obj.value()["_id"] == _key.firstElement())) {
+        _workingSet->free(id);
+        *out = WorkingSet::INVALID_ID;
+        return false;
+    }
+    return true;
+}
+
 PlanStage::StageState IDHackStage::advance(WorkingSetID id,
                                            WorkingSetMember* member,
                                            WorkingSetID* out) {
@@ -94,6 +94,14 @@ private:
      */
     StageState advance(WorkingSetID id, WorkingSetMember* member, WorkingSetID* out);
 
+    /**
+     * Fetches the document the _id index's lookup cache remembers for 'indexKey', the _id index's
+     * key for '_key', into a new WSM, whose id is stored in 'out'. Returns false, leaving 'out'
+     * invalid, if the key isn't cached or if the cached record no longer exists or has a different
+     * _id in this snapshot.
+     */
+    bool fetchCached(const BSONObj& indexKey, WorkingSetID* out);
+
     // Not owned here.
     const Collection* _collection;
 
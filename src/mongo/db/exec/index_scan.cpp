@@ -236,6 +236,27 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     return PlanStage::ADVANCED;
 }
 
+PlanStage::StageState IndexScan::doWorkBatch(WorkingSet* ws,
+                                             size_t maxWorks,
+                                             std::vector<WorkingSetID>* out,
+                                             WorkingSetID* stateId,
+                                             size_t* works) {
+    // The keys we return are always owned, so unlike the default implementation there is no need
+    // to copy anything in order for the results to outlive the next unit of work.
+    for (*works = 0; *works < maxWorks;) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ++*works;
+        StageState state = IndexScan::doWork(&id);
+        if (PlanStage::ADVANCED == state) {
+            out->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            *stateId = id;
+            return state;
+        }
+    }
+    return PlanStage::NEED_TIME;
+}
+
 bool IndexScan::isEOF() {
     return _commonStats.isEOF;
 }
@@ -96,6 +96,11 @@ public:
               const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(WorkingSet* ws,
+                           size_t maxWorks,
+                           std::vector<WorkingSetID>* out,
+                           WorkingSetID* stateId,
+                           size_t* works) final;
     bool isEOF() final;
     void doSaveState() final;
     void doRestoreState() final;
@@ -86,6 +86,39 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::doWorkBatch(WorkingSet* ws,
+                                              size_t maxWorks,
+                                              std::vector<WorkingSetID>* out,
+                                              WorkingSetID* stateId,
+                                              size_t* works) {
+    if (0 == _numToReturn) {
+        *works = 1;
+        return PlanStage::IS_EOF;
+    }
+
+    // Each unit of our child's work is a unit of ours. Since our child can't produce more results
+    // than units of work, this never asks it for a result past the limit.
+    const size_t numToRequest = std::min(maxWorks, static_cast<size_t>(_numToReturn));
+    const size_t firstResult = out->size();
+    const size_t childWorksBefore = child()->getCommonStats()->works;
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(ws, numToRequest, out, &id);
+    *works = child()->getCommonStats()->works - childWorksBefore;
+    _numToReturn -= out->size() - firstResult;
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        if (WorkingSet::INVALID_ID == id) {
+            mongoutils::str::stream ss;
+            ss << "limit stage failed to read in results from child";
+            Status status(ErrorCodes::InternalError, ss);
+            id = WorkingSetCommon::allocateStatusMember(_ws, status);
+        }
+    }
+
+    *stateId = id;
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
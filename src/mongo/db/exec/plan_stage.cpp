@@ -56,6 +56,58 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     return workResult;
 }
 
+PlanStage::StageState PlanStage::workBatch(WorkingSet* ws,
+                                           size_t maxWorks,
+                                           std::vector<WorkingSetID>* out,
+                                           WorkingSetID* stateId) {
+    invariant(_opCtx);
+    invariant(maxWorks > 0);
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+
+    const size_t initialSize = out->size();
+    size_t works = 0;
+    *stateId = WorkingSet::INVALID_ID;
+    StageState batchResult = doWorkBatch(ws, maxWorks, out, stateId, &works);
+    invariant(works <= maxWorks);
+
+    const size_t numAdvanced = out->size() - initialSize;
+    const bool stoppedEarly =
+        StageState::ADVANCED != batchResult && StageState::NEED_TIME != batchResult;
+    invariant(numAdvanced + (stoppedEarly ? 1 : 0) <= works);
+
+    _commonStats.works += works;
+    _commonStats.advanced += numAdvanced;
+    _commonStats.needTime += works - numAdvanced - (stoppedEarly ? 1 : 0);
+    if (StageState::NEED_YIELD == batchResult) {
+        ++_commonStats.needYield;
+    }
+
+    if (!stoppedEarly) {
+        batchResult = numAdvanced > 0 ? StageState::ADVANCED : StageState::NEED_TIME;
+    }
+    return batchResult;
+}
+
+PlanStage::StageState PlanStage::doWorkBatch(WorkingSet* ws,
+                                             size_t maxWorks,
+                                             std::vector<WorkingSetID>* out,
+                                             WorkingSetID* stateId,
+                                             size_t* works) {
+    for (*works = 0; *works < maxWorks;) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ++*works;
+        StageState state = doWork(&id);
+        if (StageState::ADVANCED == state) {
+            ws->get(id)->makeObjOwnedIfNeeded();
+            out->push_back(id);
+        } else if (StageState::NEED_TIME != state) {
+            *stateId = id;
+            return state;
+        }
+    }
+    return StageState::NEED_TIME;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
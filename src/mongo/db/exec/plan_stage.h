@@ -188,6 +188,26 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * Performs up to 'maxWorks' units of work on the query, appending the WorkingSetID of each
+     * result produced to 'out'. This is equivalent to calling work() up to 'maxWorks' times, but
+     * lets stages which override doWorkBatch() hand results to their parent in bulk instead of
+     * one virtual call per result. 'ws' must be the WorkingSet shared by the plan.
+     *
+     * Stops early if a unit of work produces a state other than ADVANCED or NEED_TIME, in which
+     * case that state is returned and '*stateId' is set as work() would set its out parameter.
+     * Otherwise returns ADVANCED if at least one result was appended to 'out' and NEED_TIME if
+     * none was. In either case, the results appended to 'out' are owned by the caller exactly as
+     * if each had been returned by work(), and precede the state which ended the batch.
+     *
+     * The results remain valid until the next call to work(), workBatch(), saveState() or
+     * invalidate() on this stage.
+     */
+    StageState workBatch(WorkingSet* ws,
+                         size_t maxWorks,
+                         std::vector<WorkingSetID>* out,
+                         WorkingSetID* stateId);
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -347,6 +367,20 @@ protected:
      */
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs up to 'maxWorks' units of work, setting '*works' to the number performed. See
+     * comment at workBatch() above; returning NEED_TIME after producing results is equivalent to
+     * returning ADVANCED.
+     *
+     * The default implementation calls doWork() repeatedly and makes each result owned, since a
+     * result may point into storage engine memory that a later call to doWork() releases.
+     */
+    virtual StageState doWorkBatch(WorkingSet* ws,
+                                   size_t maxWorks,
+                                   std::vector<WorkingSetID>* out,
+                                   WorkingSetID* stateId,
+                                   size_t* works);
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
@@ -51,6 +51,11 @@ struct SpecificStats {
      * Make a deep copy.
      */
     virtual SpecificStats* clone() const = 0;
+
+    /**
+     * Returns an estimate of the memory used by these stats, including what they own.
+     */
+    virtual uint64_t estimateObjectSizeInBytes() const = 0;
 };
 
 // Every stage has CommonStats.
@@ -121,6 +126,21 @@ struct PlanStageStats {
         return stats;
     }
 
+    /**
+     * Returns an estimate of the memory used by this stats tree.
+     */
+    uint64_t estimateObjectSizeInBytes() const {
+        uint64_t size = sizeof(*this) + common.filter.objsize() +
+            children.capacity() * sizeof(std::unique_ptr<PlanStageStats>);
+        if (specific) {
+            size += specific->estimateObjectSizeInBytes();
+        }
+        for (auto&& child : children) {
+            size += child->estimateObjectSizeInBytes();
+        }
+        return size;
+    }
+
     // See query/stage_type.h
     StageType stageType;
 
@@ -145,6 +165,10 @@ struct AndHashStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + mapAfterChild.capacity() * sizeof(size_t);
+    }
+
     // Invalidation counters.
     // How many results had the AND fully evaluated but were invalidated?
     size_t flaggedButPassed;
@@ -175,6 +199,10 @@ struct AndSortedStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + failedAnd.capacity() * sizeof(size_t);
+    }
+
     // How many results from each child did not pass the AND?
     std::vector<size_t> failedAnd;
 
@@ -189,6 +217,10 @@ struct CachedPlanStats : public SpecificStats {
         return new CachedPlanStats(*this);
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     bool replanned;
 };
 
@@ -200,6 +232,10 @@ struct CollectionScanStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     // How many documents did we check against our filter?
     size_t docsTested;
 
@@ -221,6 +257,10 @@ struct CountStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     // The result of the count.
     long long nCounted;
 
@@ -250,6 +290,12 @@ struct CountScanStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + indexName.capacity() + keyPattern.objsize() + collation.objsize() +
+            startKey.objsize() + endKey.objsize() +
+            multiKeyPaths.capacity() * sizeof(MultikeyPaths::value_type);
+    }
+
     std::string indexName;
 
     BSONObj keyPattern;
@@ -287,6 +333,10 @@ struct DeleteStats : public SpecificStats {
         return new DeleteStats(*this);
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t docsDeleted;
 
     // Invalidated documents can be force-fetched, causing the now invalid RecordId to
@@ -304,6 +354,11 @@ struct DistinctScanStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + indexName.capacity() + keyPattern.objsize() + collation.objsize() +
+            indexBounds.objsize() + multiKeyPaths.capacity() * sizeof(MultikeyPaths::value_type);
+    }
+
     // How many keys did we look at while distinct-ing?
     size_t keysExamined = 0;
 
@@ -340,6 +395,10 @@ struct EnsureSortedStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     // The number of out-of-order results that were dropped.
     long long nDropped;
 };
@@ -352,6 +411,10 @@ struct FetchStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     // Have we seen anything that already had an object?
     size_t alreadyHasObj;
 
@@ -370,6 +433,10 @@ struct GroupStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     // The total number of groups.
     size_t nGroups;
 };
@@ -382,6 +449,10 @@ struct IDHackStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + indexName.capacity();
+    }
+
     std::string indexName;
 
     // Number of entries retrieved from the index while executing the idhack.
@@ -414,6 +485,12 @@ struct IndexScanStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + indexType.capacity() + indexName.capacity() + keyPattern.objsize() +
+            collation.objsize() + indexBounds.objsize() +
+            multiKeyPaths.capacity() * sizeof(MultikeyPaths::value_type);
+    }
+
     // Index type being used.
     std::string indexType;
 
@@ -466,6 +543,10 @@ struct LimitStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t limit;
 };
 
@@ -475,6 +556,10 @@ struct MockStats : public SpecificStats {
     SpecificStats* clone() const final {
         return new MockStats(*this);
     }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
 };
 
 struct MultiPlanStats : public SpecificStats {
@@ -483,6 +568,10 @@ struct MultiPlanStats : public SpecificStats {
     SpecificStats* clone() const final {
         return new MultiPlanStats(*this);
     }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
 };
 
 struct OrStats : public SpecificStats {
@@ -493,6 +582,10 @@ struct OrStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t dupsTested;
     size_t dupsDropped;
 
@@ -508,18 +601,26 @@ struct ProjectionStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + projObj.objsize();
+    }
+
     // Object specifying the projection transformation to apply.
     BSONObj projObj;
 };
 
 struct SortStats : public SpecificStats {
-    SortStats() : forcedFetches(0), memUsage(0), memLimit(0) {}
+    SortStats() : forcedFetches(0), memUsage(0), memLimit(0), usedDisk(false), spills(0) {}
 
     SpecificStats* clone() const final {
         SortStats* specific = new SortStats(*this);
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + sortPattern.objsize();
+    }
+
     // How many records were we forced to fetch as the result of an invalidation?
     size_t forcedFetches;
 
@@ -534,6 +635,12 @@ struct SortStats : public SpecificStats {
 
     // The pattern according to which we are sorting.
     BSONObj sortPattern;
+
+    // Did we exceed our memory limit and spill data to disk?
+    bool usedDisk;
+
+    // The number of files the external sorter spilled to.
+    size_t spills;
 };
 
 struct MergeSortStats : public SpecificStats {
@@ -544,6 +651,10 @@ struct MergeSortStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + sortPattern.objsize();
+    }
+
     size_t dupsTested;
     size_t dupsDropped;
 
@@ -562,6 +673,10 @@ struct ShardingFilterStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t chunkSkips;
 };
 
@@ -573,6 +688,10 @@ struct SkipStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t skip;
 };
 
@@ -597,6 +716,11 @@ struct NearStats : public SpecificStats {
         return new NearStats(*this);
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + intervalStats.capacity() * sizeof(IntervalStats) +
+            indexName.capacity() + keyPattern.objsize();
+    }
+
     std::vector<IntervalStats> intervalStats;
     std::string indexName;
     // btree index version, not geo index version
@@ -617,6 +741,10 @@ struct UpdateStats : public SpecificStats {
         return new UpdateStats(*this);
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + objInserted.objsize();
+    }
+
     // The number of documents which match the query part of the update.
     size_t nMatched;
 
@@ -651,6 +779,11 @@ struct TextStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this) + indexName.capacity() + parsedTextQuery.objsize() +
+            indexPrefix.objsize();
+    }
+
     std::string indexName;
 
     // Human-readable form of the FTSQuery associated with the text stage.
@@ -670,6 +803,10 @@ struct TextMatchStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t docsRejected;
 };
 
@@ -681,6 +818,10 @@ struct TextOrStats : public SpecificStats {
         return specific;
     }
 
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
     size_t fetches;
 };
 
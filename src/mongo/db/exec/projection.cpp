@@ -227,6 +227,44 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(WorkingSet* ws,
+                                                   size_t maxWorks,
+                                                   std::vector<WorkingSetID>* out,
+                                                   WorkingSetID* stateId,
+                                                   size_t* works) {
+    const size_t firstResult = out->size();
+    const size_t childWorksBefore = child()->getCommonStats()->works;
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(ws, maxWorks, out, &id);
+    *works = child()->getCommonStats()->works - childWorksBefore;
+
+    for (size_t i = firstResult; i < out->size(); ++i) {
+        Status projStatus = transform(_ws->get((*out)[i]));
+        if (!projStatus.isOK()) {
+            warning() << "Couldn't execute projection, status = " << redact(projStatus);
+            // The results from this one onwards will never be returned.
+            for (size_t j = i; j < out->size(); ++j) {
+                _ws->free((*out)[j]);
+            }
+            out->resize(i);
+            *stateId = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+            return PlanStage::FAILURE;
+        }
+    }
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        if (WorkingSet::INVALID_ID == id) {
+            mongoutils::str::stream ss;
+            ss << "projection stage failed to read in results from child";
+            Status status(ErrorCodes::InternalError, ss);
+            id = WorkingSetCommon::allocateStatusMember(_ws, status);
+        }
+    }
+
+    *stateId = id;
+    return status;
+}
+
 unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_PROJECTION);
@@ -82,6 +82,11 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(WorkingSet* ws,
+                           size_t maxWorks,
+                           std::vector<WorkingSetID>* out,
+                           WorkingSetID* stateId,
+                           size_t* works) final;
 
     StageType stageType() const final {
         return STAGE_PROJECTION;
@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/shared_collection_scan.h"
+
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const ServiceContext::Decoration<SharedCollectionScans> getSharedCollectionScans =
+    ServiceContext::declareDecoration<SharedCollectionScans>();
+
+}  // namespace
+
+SharedCollectionScans::Registration::~Registration() {
+    _scans->_deregister(_ns);
+}
+
+SharedCollectionScans& SharedCollectionScans::get(ServiceContext* serviceContext) {
+    return getSharedCollectionScans(serviceContext);
+}
+
+std::unique_ptr<SharedCollectionScans::Registration> SharedCollectionScans::registerScan(
+    StringData ns, RecordId* startAt) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& entry = _entries[ns];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+    }
+    ++entry->numScans;
+    *startAt = RecordId(entry->position.load());
+    return stdx::make_unique<Registration>(this, ns.toString(), entry.get());
+}
+
+size_t SharedCollectionScans::numScans(StringData ns) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _entries.find(ns);
+    return it == _entries.end() ? 0 : it->second->numScans;
+}
+
+void SharedCollectionScans::_deregister(StringData ns) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _entries.find(ns);
+    invariant(it != _entries.end());
+    if (--it->second->numScans == 0) {
+        _entries.erase(ns);
+    }
+}
+
+}  // namespace mongo
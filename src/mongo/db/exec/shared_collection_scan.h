@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * Tracks the forward collection scans in progress over each collection, so that a scan which
+ * starts while another is underway can begin reading at the other scan's current position rather
+ * than at the start of the collection. The two scans then read the same records at about the same
+ * time, and the records one reads from disk are still in cache when the other reads them. A scan
+ * which joined another this way wraps around to the start of the collection when it reaches the
+ * end, and stops when it gets back to the position it started at.
+ *
+ * Each scan still reads from its own snapshot and applies its own filter; only the order in which
+ * it visits records changes. Scans must therefore only be shared when their results are not
+ * required to be in natural order.
+ *
+ * This class is thread-safe.
+ */
+class SharedCollectionScans {
+    MONGO_DISALLOW_COPYING(SharedCollectionScans);
+
+    struct Entry {
+        // The repr() of the RecordId most recently read by any scan of the collection.
+        AtomicInt64 position{RecordId().repr()};
+        size_t numScans = 0;
+    };
+
+public:
+    /**
+     * The membership of one scan in the set of scans of a collection. The scan reports its
+     * progress through it, and leaves the set when it is destroyed.
+     */
+    class Registration {
+        MONGO_DISALLOW_COPYING(Registration);
+
+    public:
+        Registration(SharedCollectionScans* scans, std::string ns, Entry* entry)
+            : _scans(scans), _ns(std::move(ns)), _entry(entry) {}
+
+        ~Registration();
+
+        /**
+         * Records that the scan has read the record 'id'. The position is published to the scans
+         * of the collection which start after this only every kPublishInterval records, and by
+         * publishPosition(), so that concurrent scans do not all write it for every record.
+         */
+        void setPosition(const RecordId& id) {
+            _position = id;
+            if (++_recordsSincePublished >= kPublishInterval) {
+                publishPosition();
+            }
+        }
+
+        /**
+         * Lets scans of the collection which start after this start from the record most
+         * recently passed to setPosition().
+         */
+        void publishPosition() {
+            if (_recordsSincePublished > 0) {
+                _entry->position.store(_position.repr());
+                _recordsSincePublished = 0;
+            }
+        }
+
+        static const int kPublishInterval = 128;
+
+    private:
+        SharedCollectionScans* const _scans;
+        const std::string _ns;
+        Entry* const _entry;
+
+        RecordId _position;
+        int _recordsSincePublished = 0;
+    };
+
+    SharedCollectionScans() = default;
+
+    static SharedCollectionScans& get(ServiceContext* serviceContext);
+
+    /**
+     * Registers a forward scan of the collection 'ns'. Sets '*startAt' to the record most recently
+     * read by another scan of 'ns', or to a null RecordId if no other scan of 'ns' has read one.
+     */
+    std::unique_ptr<Registration> registerScan(StringData ns, RecordId* startAt);
+
+    /**
+     * Returns the number of scans of 'ns' which are registered.
+     */
+    size_t numScans(StringData ns) const;
+
+private:
+    void _deregister(StringData ns);
+
+    mutable stdx::mutex _mutex;
+
+    // The scans of each collection with at least one registered scan. An entry is only erased
+    // once no registration refers to it.
+    StringMap<std::shared_ptr<Entry>> _entries;
+};
+
+}  // namespace mongo
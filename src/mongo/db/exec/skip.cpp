@@ -87,6 +87,41 @@ PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState SkipStage::doWorkBatch(WorkingSet* ws,
+                                             size_t maxWorks,
+                                             std::vector<WorkingSetID>* out,
+                                             WorkingSetID* stateId,
+                                             size_t* works) {
+    const size_t firstResult = out->size();
+    const size_t childWorksBefore = child()->getCommonStats()->works;
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(ws, maxWorks, out, &id);
+    *works = child()->getCommonStats()->works - childWorksBefore;
+
+    // Drop as many of the leading results as we have left to skip.
+    const size_t numToDrop = std::min<size_t>(out->size() - firstResult, _toSkip);
+    if (numToDrop > 0) {
+        auto dropBegin = out->begin() + firstResult;
+        for (auto it = dropBegin; it != dropBegin + numToDrop; ++it) {
+            _ws->free(*it);
+        }
+        out->erase(dropBegin, dropBegin + numToDrop);
+        _toSkip -= numToDrop;
+    }
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        if (WorkingSet::INVALID_ID == id) {
+            mongoutils::str::stream ss;
+            ss << "skip stage failed to read in results from child";
+            Status status(ErrorCodes::InternalError, ss);
+            id = WorkingSetCommon::allocateStatusMember(_ws, status);
+        }
+    }
+
+    *stateId = id;
+    return status;
+}
+
 unique_ptr<PlanStageStats> SkipStage::getStats() {
     _commonStats.isEOF = isEOF();
     _specificStats.skip = _toSkip;
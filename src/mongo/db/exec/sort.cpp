@@ -51,6 +51,55 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+
+// Field names used when spilling a WorkingSetMember to disk.
+const char kSpilledObjField[] = "o";
+const char kSpilledRecordIdField[] = "r";
+const char kSpilledTextScoreField[] = "ts";
+const char kSpilledGeoDistanceField[] = "gd";
+const char kSpilledGeoNearPointField[] = "gp";
+const char kSpilledIndexKeyField[] = "ik";
+
+/**
+ * Serializes the document and computed data held by 'member' so that it can be handed to the
+ * external sorter. 'recordId' is only used to break ties between equal sort keys.
+ */
+BSONObj serializeMemberForSpill(const WorkingSetMember& member, const RecordId& recordId) {
+    BSONObjBuilder bob;
+    bob.append(kSpilledObjField, member.obj.value());
+    if (!recordId.isNull()) {
+        bob.append(kSpilledRecordIdField, static_cast<long long>(recordId.repr()));
+    }
+    if (member.hasComputed(WSM_COMPUTED_TEXT_SCORE)) {
+        auto score = static_cast<const TextScoreComputedData*>(
+            member.getComputed(WSM_COMPUTED_TEXT_SCORE));
+        bob.append(kSpilledTextScoreField, score->getScore());
+    }
+    if (member.hasComputed(WSM_COMPUTED_GEO_DISTANCE)) {
+        auto dist = static_cast<const GeoDistanceComputedData*>(
+            member.getComputed(WSM_COMPUTED_GEO_DISTANCE));
+        bob.append(kSpilledGeoDistanceField, dist->getDist());
+    }
+    if (member.hasComputed(WSM_GEO_NEAR_POINT)) {
+        auto point =
+            static_cast<const GeoNearPointComputedData*>(member.getComputed(WSM_GEO_NEAR_POINT));
+        bob.append(kSpilledGeoNearPointField, point->getPoint());
+    }
+    if (member.hasComputed(WSM_INDEX_KEY)) {
+        auto key = static_cast<const IndexKeyComputedData*>(member.getComputed(WSM_INDEX_KEY));
+        bob.append(kSpilledIndexKeyField, key->getKey());
+    }
+    return bob.obj();
+}
+
+RecordId spilledRecordId(const BSONObj& spilled) {
+    BSONElement elt = spilled[kSpilledRecordIdField];
+    return elt.eoo() ? RecordId() : RecordId(elt._numberLong());
+}
+
+}  // namespace
+
 // static
 const char* SortStage::kStageType = "SORT";
 
@@ -67,6 +116,16 @@ bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
     return lhs.recordId < rhs.recordId;
 }
 
+int SortStage::SpillComparator::operator()(const SpillSorter::Data& lhs,
+                                           const SpillSorter::Data& rhs) const {
+    // False means ignore field names.
+    int result = lhs.first.woCompare(rhs.first, pattern, false);
+    if (0 != result) {
+        return result;
+    }
+    return spilledRecordId(lhs.second).compare(spilledRecordId(rhs.second));
+}
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -76,6 +135,8 @@ SortStage::SortStage(OperationContext* opCtx,
       _ws(ws),
       _pattern(params.pattern),
       _limit(params.limit),
+      _allowDiskUse(params.allowDiskUse),
+      _tempDir(params.tempDir),
       _sorted(false),
       _resultIterator(_data.end()),
       _memUsage(0) {
@@ -97,6 +158,9 @@ SortStage::~SortStage() {}
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
+    if (_spillIterator) {
+        return child()->isEOF() && _sorted && !_spillIterator->more();
+    }
     return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
 }
 
@@ -148,14 +212,28 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
                 item.recordId = member->recordId;
             }
 
-            addToBuffer(item);
+            if (_spillSorter) {
+                addToSpillSorter(item);
+            } else {
+                addToBuffer(item);
+
+                // A limit of one only ever buffers a single document, so there is nothing to
+                // gain by spilling it.
+                if (_allowDiskUse && _limit != 1 && _memUsage > maxBytes) {
+                    spill();
+                }
+            }
 
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            if (_spillSorter) {
+                _spillIterator.reset(_spillSorter->done());
+            } else {
+                sortBuffer();
+                _resultIterator = _data.begin();
+            }
             _sorted = true;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::FAILURE == code || PlanStage::DEAD == code) {
@@ -178,8 +256,13 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     }
 
     // Returning results.
-    verify(_resultIterator != _data.end());
     verify(_sorted);
+    if (_spillIterator) {
+        *out = restoreFromSpillSorter();
+        return PlanStage::ADVANCED;
+    }
+
+    verify(_resultIterator != _data.end());
     *out = _resultIterator->wsid;
     _resultIterator++;
 
@@ -224,6 +307,10 @@ unique_ptr<PlanStageStats> SortStage::getStats() {
     _specificStats.memUsage = _memUsage;
     _specificStats.limit = _limit;
     _specificStats.sortPattern = _pattern.getOwned();
+    if (_spillSorter) {
+        _specificStats.usedDisk = true;
+        _specificStats.spills = _spillSorter->numFiles();
+    }
 
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_SORT);
     ret->specific = make_unique<SortStats>(_specificStats);
@@ -340,4 +427,78 @@ void SortStage::sortBuffer() {
     }
 }
 
+void SortStage::spill() {
+    invariant(_allowDiskUse);
+    invariant(_limit != 1);
+
+    if (!_spillSorter) {
+        SortOptions opts;
+        opts.limit = _limit;
+        opts.maxMemoryUsageBytes =
+            static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
+        opts.extSortAllowed = true;
+        opts.tempDir = _tempDir;
+        opts.parallelism = std::max(1, internalQueryExecSorterParallelism.load());
+        opts.readAhead = true;
+        _spillSorter.reset(
+            SpillSorter::make(opts, SpillComparator(_sortKeyComparator->pattern)));
+    }
+
+    if (_limit == 0) {
+        for (auto&& item : _data) {
+            addToSpillSorter(item);
+        }
+        vector<SortableDataItem>().swap(_data);
+    } else {
+        for (auto&& item : *_dataSet) {
+            addToSpillSorter(item);
+        }
+        _dataSet->clear();
+    }
+
+    // The sorter tracks its own memory usage from here on.
+    _memUsage = 0;
+}
+
+void SortStage::addToSpillSorter(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+    _spillSorter->add(item.sortKey, serializeMemberForSpill(*member, item.recordId));
+
+    if (member->hasRecordId()) {
+        _wsidByRecordId.erase(member->recordId);
+    }
+    _ws->free(item.wsid);
+}
+
+WorkingSetID SortStage::restoreFromSpillSorter() {
+    invariant(_spillIterator->more());
+    SpillSorter::Data next = _spillIterator->next();
+
+    // The sorter's output is only valid until the next call into the iterator.
+    const BSONObj& spilled = next.second;
+
+    WorkingSetID id = _ws->allocate();
+    WorkingSetMember* member = _ws->get(id);
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), spilled[kSpilledObjField].Obj().getOwned());
+    _ws->transitionToOwnedObj(id);
+
+    member->addComputed(new SortKeyComputedData(next.first));
+    if (auto elt = spilled[kSpilledTextScoreField]) {
+        member->addComputed(new TextScoreComputedData(elt.Double()));
+    }
+    if (auto elt = spilled[kSpilledGeoDistanceField]) {
+        member->addComputed(new GeoDistanceComputedData(elt.Double()));
+    }
+    if (auto elt = spilled[kSpilledGeoNearPointField]) {
+        member->addComputed(new GeoNearPointComputedData(elt.Obj()));
+    }
+    if (auto elt = spilled[kSpilledIndexKeyField]) {
+        member->addComputed(new IndexKeyComputedData(elt.Obj()));
+    }
+    return id;
+}
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
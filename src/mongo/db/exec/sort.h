@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
@@ -37,6 +39,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -46,7 +49,7 @@ class BtreeKeyGenerator;
 // Parameters that must be provided to a SortStage
 class SortStageParams {
 public:
-    SortStageParams() : collection(NULL), limit(0) {}
+    SortStageParams() : collection(NULL), limit(0), allowDiskUse(false) {}
 
     // Used for resolving RecordIds to BSON
     const Collection* collection;
@@ -56,6 +59,13 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // If true, the sort spills to files in 'tempDir' rather than failing once it exceeds
+    // internalQueryExecMaxBlockingSortBytes.
+    bool allowDiskUse;
+
+    // Directory in which to place spill files. Must be set if 'allowDiskUse' is true.
+    std::string tempDir;
 };
 
 /**
@@ -65,6 +75,10 @@ public:
  *   -- For each field in 'pattern', all inputs in the child must handle a getFieldDotted for that
  *   field.
  *   -- All WSMs produced by the child stage must have the sort key available as WSM computed data.
+ *
+ * If external sorting is allowed, the buffered data is handed off to a Sorter once it grows past
+ * the memory limit. Results which have been spilled to disk no longer refer to an on-disk record
+ * and are returned as OWNED_OBJ members, exactly like results whose RecordId was invalidated.
  */
 class SortStage final : public PlanStage {
 public:
@@ -106,6 +120,10 @@ private:
     // Equal to 0 for no limit.
     size_t _limit;
 
+    // Whether we may spill to disk, and where to put the spill files.
+    bool _allowDiskUse;
+    std::string _tempDir;
+
     //
     // Data storage
     //
@@ -152,10 +170,47 @@ private:
      */
     void sortBuffer();
 
+    /**
+     * Moves everything in the data buffer into the external sorter, creating the sorter if
+     * necessary, and frees the corresponding working set members.
+     */
+    void spill();
+
+    /**
+     * Adds one item to the external sorter and frees its working set member.
+     */
+    void addToSpillSorter(const SortableDataItem& item);
+
+    /**
+     * Allocates a working set member for the next result of the external sorter.
+     */
+    WorkingSetID restoreFromSpillSorter();
+
     // Comparator for data buffer
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
 
+    // The external sorter is fed (sortKey, spilled member) pairs, where the spilled member holds
+    // the document, the RecordId used to break ties, and any other computed data.
+    typedef Sorter<BSONObj, BSONObj> SpillSorter;
+
+    // Comparison object for the external sorter. Orders spilled pairs the same way
+    // WorkingSetComparator orders SortableDataItems.
+    struct SpillComparator {
+        explicit SpillComparator(BSONObj p) : pattern(p) {}
+
+        int operator()(const SpillSorter::Data& lhs, const SpillSorter::Data& rhs) const;
+
+        BSONObj pattern;
+    };
+
+    // Only non-null once we have exceeded our memory limit with external sorting allowed. From
+    // then on, all data from the child is added directly to the sorter.
+    std::unique_ptr<SpillSorter> _spillSorter;
+
+    // Iterates through the output of _spillSorter once all data has been gathered.
+    std::unique_ptr<SpillSorter::Iterator> _spillIterator;
+
     // The data we buffer and sort.
     // _data will contain sorted data when all data is gathered
     // and sorted.
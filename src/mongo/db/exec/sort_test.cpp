@@ -39,9 +39,11 @@
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/query/collation/collator_factory_mock.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 
@@ -71,12 +73,15 @@ public:
      *     {input: [doc1, doc2, doc3, ...]}
      * expectedStr represents the expected sorted data set.
      *     {output: [docA, docB, docC, ...]}
+     * If 'spillDir' is non-empty, the sort stage is allowed to spill to that directory and is
+     * expected to have done so.
      */
     void testWork(const char* patternStr,
                   CollatorInterface* collator,
                   int limit,
                   const char* inputStr,
-                  const char* expectedStr) {
+                  const char* expectedStr,
+                  const std::string& spillDir = "") {
         // WorkingSet is not owned by stages
         // so it's fine to declare
         WorkingSet ws;
@@ -105,6 +110,8 @@ public:
         SortStageParams params;
         params.pattern = fromjson(patternStr);
         params.limit = limit;
+        params.allowDiskUse = !spillDir.empty();
+        params.tempDir = spillDir;
 
         auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
             getOpCtx(), queuedDataStage.release(), &ws, params.pattern, collator);
@@ -140,6 +147,11 @@ public:
         ASSERT_EQUALS(state, PlanStage::IS_EOF);
         ASSERT_TRUE(sort.isEOF());
 
+        // The sort stage should report whether it spilled.
+        auto stats = sort.getStats();
+        const SortStats* sortStats = static_cast<const SortStats*>(stats->specific.get());
+        ASSERT_EQUALS(!spillDir.empty(), sortStats->usedDisk);
+
         // Finally, we get to compare the sorted results against what we expect.
         BSONObj expectedObj = fromjson(expectedStr);
         if (SimpleBSONObjComparator::kInstance.evaluate(outputObj != expectedObj)) {
@@ -300,4 +312,57 @@ TEST_F(SortStageTest, SortDescendingWithCollation) {
              "{input: [{a: 'ba'}, {a: 'aa'}, {a: 'ab'}]}",
              "{output: [{a: 'ab'}, {a: 'ba'}, {a: 'aa'}]}");
 }
+
+//
+// Sorting with a memory limit small enough to force every document to spill to disk.
+// Results should be identical to the in-memory sort.
+//
+
+class SortStageSpillTest : public SortStageTest {
+public:
+    SortStageSpillTest() : _tempDir("SortStageSpillTest") {
+        _originalMaxBytes = internalQueryExecMaxBlockingSortBytes.load();
+        internalQueryExecMaxBlockingSortBytes.store(1);
+    }
+
+    ~SortStageSpillTest() {
+        internalQueryExecMaxBlockingSortBytes.store(_originalMaxBytes);
+    }
+
+    std::string spillDir() {
+        return _tempDir.path();
+    }
+
+private:
+    unittest::TempDir _tempDir;
+    int _originalMaxBytes;
+};
+
+TEST_F(SortStageSpillTest, SortAscendingSpillsToDisk) {
+    testWork("{a: 1}",
+             nullptr,
+             0,
+             "{input: [{a: 2}, {a: 1}, {a: 3}, {a: 0}]}",
+             "{output: [{a: 0}, {a: 1}, {a: 2}, {a: 3}]}",
+             spillDir());
+}
+
+TEST_F(SortStageSpillTest, SortDescendingWithLimitSpillsToDisk) {
+    testWork("{a: -1}",
+             nullptr,
+             2,
+             "{input: [{a: 2}, {a: 1}, {a: 3}, {a: 0}]}",
+             "{output: [{a: 3}, {a: 2}]}",
+             spillDir());
+}
+
+TEST_F(SortStageSpillTest, SortWithCollationSpillsToDisk) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    testWork("{a: 1}",
+             &collator,
+             0,
+             "{input: [{a: 'ba'}, {a: 'aa'}, {a: 'ab'}]}",
+             "{output: [{a: 'aa'}, {a: 'ba'}, {a: 'ab'}]}",
+             spillDir());
+}
 }  // namespace
@@ -48,6 +48,7 @@
 #include "mongo/db/keypattern.h"
 #include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/storage_options.h"
@@ -257,20 +258,26 @@ Status IndexAccessMethod::touch(OperationContext* opCtx) const {
     return _newInterface->touch(opCtx);
 }
 
+BSONObj IndexAccessMethod::getSingleKey(const BSONObj& requestedKey) const {
+    if (!_btreeState->getCollator()) {
+        return requestedKey;
+    }
+
+    // For performance, call get keys only if there is a non-simple collation.
+    BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    MultikeyPaths* multikeyPaths = nullptr;
+    getKeys(requestedKey, GetKeysMode::kEnforceConstraints, &keys, multikeyPaths);
+    invariant(keys.size() == 1);
+    return *keys.begin();
+}
+
 RecordId IndexAccessMethod::findSingle(OperationContext* opCtx, const BSONObj& requestedKey) const {
     // Generate the key for this index.
-    BSONObj actualKey;
-    if (_btreeState->getCollator()) {
-        // For performance, call get keys only if there is a non-simple collation.
-        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
-        MultikeyPaths* multikeyPaths = nullptr;
-        getKeys(requestedKey, GetKeysMode::kEnforceConstraints, &keys, multikeyPaths);
-        invariant(keys.size() == 1);
-        actualKey = *keys.begin();
-    } else {
-        actualKey = requestedKey;
-    }
+    return findSingleByIndexKey(opCtx, getSingleKey(requestedKey));
+}
 
+RecordId IndexAccessMethod::findSingleByIndexKey(OperationContext* opCtx,
+                                                 const BSONObj& actualKey) const {
     std::unique_ptr<SortedDataInterface::Cursor> cursor(_newInterface->newCursor(opCtx));
     const auto requestedInfo = kDebugBuild ? SortedDataInterface::Cursor::kKeyAndLoc
                                            : SortedDataInterface::Cursor::kWantLoc;
@@ -286,6 +293,15 @@ RecordId IndexAccessMethod::findSingle(OperationContext* opCtx, const BSONObj& r
     return RecordId();
 }
 
+bool IndexAccessMethod::hasLookupCache() const {
+    return _newInterface->hasLookupCache();
+}
+
+RecordId IndexAccessMethod::findSingleCached(OperationContext* opCtx,
+                                             const BSONObj& indexKey) const {
+    return _newInterface->findCachedLoc(indexKey);
+}
+
 void IndexAccessMethod::validate(OperationContext* opCtx,
                                  int64_t* numKeys,
                                  ValidateResults* fullResults) {
@@ -431,7 +447,8 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .Parallelism(std::max(1, internalQueryExecSorterParallelism.load())),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -184,6 +184,29 @@ public:
 
     RecordId findSingle(OperationContext* opCtx, const BSONObj& key) const;
 
+    /**
+     * Returns the key findSingle() looks up in this index for 'requestedKey'.
+     */
+    BSONObj getSingleKey(const BSONObj& requestedKey) const;
+
+    /**
+     * Like findSingle(), but takes the key returned by getSingleKey(), so that callers which look
+     * up the same key more than once generate it only once.
+     */
+    RecordId findSingleByIndexKey(OperationContext* opCtx, const BSONObj& indexKey) const;
+
+    /**
+     * Returns true if the index keeps a cache of recent lookups for findSingleCached().
+     */
+    bool hasLookupCache() const;
+
+    /**
+     * Like findSingleByIndexKey(), but only consults the index's cache of recent lookups. The
+     * returned record may have been deleted, or no longer have the key, in the caller's snapshot.
+     * See SortedDataInterface::findCachedLoc().
+     */
+    RecordId findSingleCached(OperationContext* opCtx, const BSONObj& indexKey) const;
+
     /**
      * Attempt compaction to regain disk space if the indexed record store supports
      * compaction-in-place.
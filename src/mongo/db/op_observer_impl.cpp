@@ -48,6 +48,8 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/session_catalog.h"
 #include "mongo/db/views/durable_view_catalog.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/db/views/view_catalog.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/fail_point_service.h"
@@ -62,6 +64,35 @@ using DeleteState = CollectionShardingState::DeleteState;
 const OperationContext::Decoration<DeleteState> getDeleteState =
     OperationContext::declareDecoration<DeleteState>();
 
+/**
+ * The materialized views to be told about the document being deleted, between aboutToDelete()
+ * and onDelete().
+ */
+struct MaterializedViewsDeleteState {
+    std::vector<std::shared_ptr<MaterializedView>> views;
+    BSONObj doc;
+};
+
+const OperationContext::Decoration<MaterializedViewsDeleteState> getMaterializedViewsDeleteState =
+    OperationContext::declareDecoration<MaterializedViewsDeleteState>();
+
+/**
+ * Returns the materialized views whose results are maintained from writes to 'nss'.
+ */
+std::vector<std::shared_ptr<MaterializedView>> getMaterializedViews(OperationContext* opCtx,
+                                                                    const NamespaceString& nss) {
+    // Materialized views are never on system collections. Writes to system.views in particular
+    // are made while holding the view catalog's mutex.
+    if (nss.isSystem()) {
+        return {};
+    }
+    Database* db = dbHolder().get(opCtx, nss.db());
+    if (!db) {
+        return {};
+    }
+    return db->getViewCatalog()->lookupMaterializedViewsOn(opCtx, nss);
+}
+
 /**
  * Returns whether we're a master using master-slave replication.
  */
@@ -331,6 +362,12 @@ void OpObserverImpl::onInserts(OperationContext* opCtx,
         }
     }
 
+    for (auto&& view : getMaterializedViews(opCtx, nss)) {
+        for (auto it = begin; it != end; it++) {
+            view->onInsert(opCtx, it->doc);
+        }
+    }
+
     const auto lastOpTime = opTimeList.empty() ? repl::OpTime() : opTimeList.back();
     if (nss.coll() == "system.js") {
         Scope::storedFuncMod(opCtx);
@@ -392,6 +429,14 @@ void OpObserverImpl::onUpdate(OperationContext* opCtx, const OplogUpdateEntryArg
         }
     }
 
+    for (auto&& view : getMaterializedViews(opCtx, args.nss)) {
+        if (args.preImageDoc) {
+            view->onUpdate(opCtx, *args.preImageDoc, args.updatedDoc);
+        } else {
+            view->invalidate();
+        }
+    }
+
     if (args.nss.coll() == "system.js") {
         Scope::storedFuncMod(opCtx);
     } else if (args.nss.coll() == DurableViewCatalog::viewsCollectionName()) {
@@ -417,6 +462,12 @@ void OpObserverImpl::aboutToDelete(OperationContext* opCtx,
     auto& deleteState = getDeleteState(opCtx);
     auto* css = CollectionShardingState::get(opCtx, nss);
     deleteState = css->makeDeleteState(doc);
+
+    auto& materializedViewsDeleteState = getMaterializedViewsDeleteState(opCtx);
+    materializedViewsDeleteState.views = getMaterializedViews(opCtx, nss);
+    if (!materializedViewsDeleteState.views.empty()) {
+        materializedViewsDeleteState.doc = doc.getOwned();
+    }
 }
 
 void OpObserverImpl::onDelete(OperationContext* opCtx,
@@ -441,6 +492,12 @@ void OpObserverImpl::onDelete(OperationContext* opCtx,
         }
     }
 
+    auto& materializedViewsDeleteState = getMaterializedViewsDeleteState(opCtx);
+    for (auto&& view : materializedViewsDeleteState.views) {
+        view->onDelete(opCtx, materializedViewsDeleteState.doc);
+    }
+    materializedViewsDeleteState = MaterializedViewsDeleteState();
+
     if (nss.coll() == "system.js") {
         Scope::storedFuncMod(opCtx);
     } else if (nss.coll() == DurableViewCatalog::viewsCollectionName()) {
@@ -634,6 +691,10 @@ repl::OpTime OpObserverImpl::onDropCollection(OperationContext* opCtx,
                                  {});
     }
 
+    for (auto&& view : getMaterializedViews(opCtx, collectionName)) {
+        view->invalidate();
+    }
+
     if (collectionName.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, collectionName);
     } else if (collectionName.ns() == FeatureCompatibilityVersion::kCollection) {
@@ -716,6 +777,13 @@ repl::OpTime OpObserverImpl::onRenameCollection(OperationContext* opCtx,
     if (toCollection.isSystemDotViews())
         DurableViewCatalog::onExternalChange(opCtx, toCollection);
 
+    // The views on the source become empty, and those on the target see different documents.
+    for (auto&& nss : {fromCollection, toCollection}) {
+        for (auto&& view : getMaterializedViews(opCtx, nss)) {
+            view->invalidate();
+        }
+    }
+
     AuthorizationManager::get(opCtx->getServiceContext())
         ->logOp(opCtx, "c", cmdNss, cmdObj, nullptr);
 
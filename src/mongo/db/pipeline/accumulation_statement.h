@@ -33,6 +33,7 @@
 #include "mongo/bson/bsonelement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_compiler.h"
 
 namespace mongo {
 
@@ -64,6 +65,25 @@ public:
           expression(std::move(expression)),
           _factory(std::move(factory)) {}
 
+    /**
+     * A copy does not share the program compiled for 'other', since a CompiledExpression may not
+     * be used by several threads at once. It evaluates 'expression' directly until
+     * compileExpression() is called on it.
+     */
+    AccumulationStatement(const AccumulationStatement& other)
+        : fieldName(other.fieldName), expression(other.expression), _factory(other._factory) {}
+
+    AccumulationStatement& operator=(const AccumulationStatement& other) {
+        fieldName = other.fieldName;
+        expression = other.expression;
+        _factory = other._factory;
+        _compiledExpression.reset();
+        return *this;
+    }
+
+    AccumulationStatement(AccumulationStatement&&) = default;
+    AccumulationStatement& operator=(AccumulationStatement&&) = default;
+
     /**
      * Parses a BSONElement that is an accumulated field, and returns an AccumulationStatement for
      * that accumulated field.
@@ -97,12 +117,40 @@ public:
     // The expression to use to obtain the input to the accumulator.
     boost::intrusive_ptr<Expression> expression;
 
+    /**
+     * Compiles 'expression', which should already be optimized, for use by evaluateExpression().
+     */
+    void compileExpression() {
+        _compiledExpression = CompiledExpression::compile(expression);
+    }
+
+    /**
+     * Evaluates 'expression' against 'root', using the program compiled by compileExpression() as
+     * long as 'expression' has not been replaced since.
+     */
+    Value evaluateExpression(const Document& root) const {
+        if (_compiledExpression && _compiledExpression->getSource() == expression.get()) {
+            return _compiledExpression->evaluate(root);
+        }
+        return expression->evaluate(root);
+    }
+
+    /**
+     * Returns true if evaluateExpression() uses a compiled program, for testing.
+     */
+    bool hasCompiledExpression() const {
+        return _compiledExpression && _compiledExpression->getSource() == expression.get();
+    }
+
     // Constructs an Accumulator to do actual accumulation.
     boost::intrusive_ptr<Accumulator> makeAccumulator(
         const boost::intrusive_ptr<ExpressionContext>& expCtx) const;
 
 private:
     Accumulator::Factory _factory;
+
+    // Compiled from 'expression' by compileExpression(). Not used once 'expression' is replaced.
+    std::unique_ptr<CompiledExpression> _compiledExpression;
 };
 
 }  // namespace mongo
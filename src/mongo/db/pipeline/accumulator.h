@@ -322,4 +322,105 @@ public:
 private:
     MutableDocument _output;
 };
+
+/**
+ * Estimates the number of distinct values using a HyperLogLog sketch, whose size does not grow with
+ * the number of values. Until a group has seen more than a handful of distinct values, they are
+ * kept as a sparse list of hashes and counted exactly.
+ */
+class AccumulatorApproxCountDistinct final : public Accumulator {
+public:
+    // The number of hash bits used to pick a register. The 2^14 registers give a standard error of
+    // about 0.8%.
+    static constexpr int kPrecision = 14;
+    static constexpr size_t kNumRegisters = size_t(1) << kPrecision;
+
+    // Past this many distinct hashes, the sparse list is converted into registers.
+    static constexpr size_t kMaxSparseHashes = 1024;
+
+    explicit AccumulatorApproxCountDistinct(const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    void processInternal(const Value& input, bool merging) final;
+    Value getValue(bool toBeMerged) final;
+    const char* getOpName() const final;
+    void reset() final;
+
+    static boost::intrusive_ptr<Accumulator> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    bool isAssociative() const final {
+        return true;
+    }
+
+    bool isCommutative() const final {
+        return true;
+    }
+
+private:
+    void addHash(uint64_t hash);
+    void convertToRegisters();
+    void updateMemUsage();
+
+    // Sorted hashes of the distinct values seen so far. Empty once '_registers' is in use.
+    std::vector<uint64_t> _sparseHashes;
+
+    // For each register, the largest position of the first set bit among the hashes mapped to
+    // it. Empty while the sketch is sparse.
+    std::vector<uint8_t> _registers;
+};
+
+/**
+ * Estimates a percentile of numeric values using a t-digest, which summarizes the values as a
+ * bounded number of weighted centroids, keeping more of them near the tails of the distribution.
+ * Takes an object {input: <expression>, p: <number between 0 and 1>}.
+ */
+class AccumulatorApproxPercentile final : public Accumulator {
+public:
+    // Bounds the number of centroids kept by the digest, which is about twice this value.
+    static constexpr double kCompression = 100;
+
+    explicit AccumulatorApproxPercentile(const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    void processInternal(const Value& input, bool merging) final;
+    Value getValue(bool toBeMerged) final;
+    const char* getOpName() const final;
+    void reset() final;
+
+    static boost::intrusive_ptr<Accumulator> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    bool isAssociative() const final {
+        return true;
+    }
+
+    bool isCommutative() const final {
+        return true;
+    }
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    void setPercentile(const Value& percentile);
+    void addCentroid(double mean, double weight);
+
+    /**
+     * Merges the buffered centroids into '_centroids', combining neighbouring centroids as long as
+     * the size limit of the t-digest allows.
+     */
+    void compress();
+
+    double quantile(double q) const;
+
+    // Sorted by mean. Only up to date after compress().
+    std::vector<Centroid> _centroids;
+    std::vector<Centroid> _buffer;
+
+    double _totalWeight = 0;
+    double _min = 0;
+    double _max = 0;
+    boost::optional<double> _percentile;
+};
 }
@@ -0,0 +1,205 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+REGISTER_ACCUMULATOR(approxCountDistinct, AccumulatorApproxCountDistinct::create);
+
+constexpr int AccumulatorApproxCountDistinct::kPrecision;
+constexpr size_t AccumulatorApproxCountDistinct::kNumRegisters;
+constexpr size_t AccumulatorApproxCountDistinct::kMaxSparseHashes;
+
+namespace {
+
+const char kSparseHashesField[] = "sparse";
+const char kRegistersField[] = "registers";
+
+/**
+ * Spreads the bits of a Value hash, which may be of poor quality in its low bits, over all 64
+ * bits. This is the finalizer of MurmurHash3.
+ */
+uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}  // namespace
+
+const char* AccumulatorApproxCountDistinct::getOpName() const {
+    return "$approxCountDistinct";
+}
+
+void AccumulatorApproxCountDistinct::processInternal(const Value& input, bool merging) {
+    if (!merging) {
+        if (input.missing()) {
+            return;
+        }
+        // Values which compare equal under the collation of the operation hash equally.
+        addHash(mixHash(getExpressionContext()->getValueComparator().hash(input)));
+        return;
+    }
+
+    // This is what getValue(true) produced below.
+    verify(input.getType() == Object);
+    const Value registers = input[kRegistersField];
+    if (registers.missing()) {
+        for (auto&& hash : input[kSparseHashesField].getArray()) {
+            addHash(static_cast<uint64_t>(hash.getLong()));
+        }
+        return;
+    }
+
+    verify(registers.getType() == BinData);
+    const BSONBinData binData = registers.getBinData();
+    verify(static_cast<size_t>(binData.length) == kNumRegisters);
+    convertToRegisters();
+    const uint8_t* otherRegisters = static_cast<const uint8_t*>(binData.data);
+    for (size_t i = 0; i < kNumRegisters; ++i) {
+        _registers[i] = std::max(_registers[i], otherRegisters[i]);
+    }
+}
+
+void AccumulatorApproxCountDistinct::addHash(uint64_t hash) {
+    if (_registers.empty()) {
+        auto it = std::lower_bound(_sparseHashes.begin(), _sparseHashes.end(), hash);
+        if (it != _sparseHashes.end() && *it == hash) {
+            return;
+        }
+        _sparseHashes.insert(it, hash);
+        if (_sparseHashes.size() > kMaxSparseHashes) {
+            convertToRegisters();
+        }
+        updateMemUsage();
+        return;
+    }
+
+    // The top bits of the hash pick the register. The register keeps the largest position of the
+    // first set bit among the remaining bits, counted from 1.
+    const size_t index = hash >> (64 - kPrecision);
+    const uint64_t remainingBits = (hash << kPrecision) | (uint64_t(1) << (kPrecision - 1));
+    uint8_t rank = 1;
+    for (uint64_t mask = uint64_t(1) << 63; !(remainingBits & mask); mask >>= 1) {
+        ++rank;
+    }
+    _registers[index] = std::max(_registers[index], rank);
+}
+
+void AccumulatorApproxCountDistinct::convertToRegisters() {
+    if (!_registers.empty()) {
+        return;
+    }
+
+    _registers.assign(kNumRegisters, 0);
+    std::vector<uint64_t> sparseHashes;
+    sparseHashes.swap(_sparseHashes);
+    for (auto hash : sparseHashes) {
+        addHash(hash);
+    }
+    updateMemUsage();
+}
+
+void AccumulatorApproxCountDistinct::updateMemUsage() {
+    _memUsageBytes = sizeof(*this) + _sparseHashes.capacity() * sizeof(uint64_t) +
+        _registers.capacity() * sizeof(uint8_t);
+}
+
+Value AccumulatorApproxCountDistinct::getValue(bool toBeMerged) {
+    if (toBeMerged) {
+        if (_registers.empty()) {
+            std::vector<Value> hashes;
+            hashes.reserve(_sparseHashes.size());
+            for (auto hash : _sparseHashes) {
+                hashes.emplace_back(static_cast<long long>(hash));
+            }
+            return Value(DOC(kSparseHashesField << Value(std::move(hashes))));
+        }
+        return Value(DOC(kRegistersField << Value(BSONBinData(
+                             _registers.data(), _registers.size(), BinDataGeneral))));
+    }
+
+    if (_registers.empty()) {
+        return Value(static_cast<long long>(_sparseHashes.size()));
+    }
+
+    // This is the estimate of the original HyperLogLog paper, with its correction for small
+    // cardinalities. The correction for large cardinalities is not needed for 64-bit hashes.
+    const double numRegisters = kNumRegisters;
+    double inverseSum = 0;
+    size_t numZeroRegisters = 0;
+    for (auto rank : _registers) {
+        inverseSum += std::ldexp(1.0, -rank);
+        if (rank == 0) {
+            ++numZeroRegisters;
+        }
+    }
+
+    const double alpha = 0.7213 / (1 + 1.079 / numRegisters);
+    double estimate = alpha * numRegisters * numRegisters / inverseSum;
+    if (estimate <= 2.5 * numRegisters && numZeroRegisters > 0) {
+        estimate = numRegisters * std::log(numRegisters / numZeroRegisters);
+    }
+    return Value(std::llround(estimate));
+}
+
+AccumulatorApproxCountDistinct::AccumulatorApproxCountDistinct(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx)
+    : Accumulator(expCtx) {
+    updateMemUsage();
+}
+
+void AccumulatorApproxCountDistinct::reset() {
+    _sparseHashes = {};
+    _registers = {};
+    updateMemUsage();
+}
+
+intrusive_ptr<Accumulator> AccumulatorApproxCountDistinct::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    return new AccumulatorApproxCountDistinct(expCtx);
+}
+
+}  // namespace mongo
@@ -0,0 +1,273 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+REGISTER_ACCUMULATOR(approxPercentile, AccumulatorApproxPercentile::create);
+
+constexpr double AccumulatorApproxPercentile::kCompression;
+
+namespace {
+
+const char kInputField[] = "input";
+const char kPercentileField[] = "p";
+const char kMeansField[] = "means";
+const char kWeightsField[] = "weights";
+const char kMinField[] = "min";
+const char kMaxField[] = "max";
+
+// Centroids are buffered until there are this many, and then merged into the digest.
+const size_t kMaxBufferedCentroids =
+    5 * static_cast<size_t>(AccumulatorApproxPercentile::kCompression);
+
+}  // namespace
+
+const char* AccumulatorApproxPercentile::getOpName() const {
+    return "$approxPercentile";
+}
+
+void AccumulatorApproxPercentile::processInternal(const Value& input, bool merging) {
+    uassert(50702,
+            str::stream() << getOpName() << " requires an object of the form {" << kInputField
+                          << ": <expression>, "
+                          << kPercentileField
+                          << ": <number>}, but found "
+                          << typeName(input.getType()),
+            input.getType() == Object);
+
+    if (!merging) {
+        setPercentile(input[kPercentileField]);
+
+        // Non-numeric types have no impact on percentiles.
+        const Value value = input[kInputField];
+        if (!value.numeric()) {
+            return;
+        }
+
+        const double val = value.coerceToDouble();
+        if (std::isnan(val)) {
+            return;
+        }
+        addCentroid(val, 1);
+        return;
+    }
+
+    // This is what getValue(true) produced below.
+    if (!input[kPercentileField].missing()) {
+        setPercentile(input[kPercentileField]);
+    }
+
+    const std::vector<Value>& means = input[kMeansField].getArray();
+    const std::vector<Value>& weights = input[kWeightsField].getArray();
+    verify(means.size() == weights.size());
+    if (means.empty()) {
+        return;  // This partition had no data to contribute.
+    }
+
+    for (size_t i = 0; i < means.size(); ++i) {
+        addCentroid(means[i].getDouble(), weights[i].getDouble());
+    }
+    // The extremes of the partition may lie outside of its centroids' means.
+    _min = std::min(_min, input[kMinField].getDouble());
+    _max = std::max(_max, input[kMaxField].getDouble());
+}
+
+void AccumulatorApproxPercentile::setPercentile(const Value& percentile) {
+    uassert(50703,
+            str::stream() << "'" << kPercentileField << "' of " << getOpName()
+                          << " must be a number between 0 and 1, but found "
+                          << percentile.toString(),
+            percentile.numeric() && percentile.coerceToDouble() >= 0 &&
+                percentile.coerceToDouble() <= 1);
+
+    const double p = percentile.coerceToDouble();
+    uassert(50704,
+            str::stream() << "'" << kPercentileField << "' of " << getOpName()
+                          << " must be the same for all documents of a group",
+            !_percentile || *_percentile == p);
+    _percentile = p;
+}
+
+void AccumulatorApproxPercentile::addCentroid(double mean, double weight) {
+    if (_totalWeight == 0) {
+        _min = mean;
+        _max = mean;
+    } else {
+        _min = std::min(_min, mean);
+        _max = std::max(_max, mean);
+    }
+    _totalWeight += weight;
+
+    _buffer.push_back({mean, weight});
+    if (_buffer.size() >= kMaxBufferedCentroids) {
+        compress();
+    }
+}
+
+void AccumulatorApproxPercentile::compress() {
+    if (_buffer.empty()) {
+        return;
+    }
+
+    std::vector<Centroid> centroids;
+    centroids.reserve(_centroids.size() + _buffer.size());
+    centroids.insert(centroids.end(), _centroids.begin(), _centroids.end());
+    centroids.insert(centroids.end(), _buffer.begin(), _buffer.end());
+    _buffer.clear();
+    std::sort(centroids.begin(), centroids.end(), [](const Centroid& lhs, const Centroid& rhs) {
+        return lhs.mean < rhs.mean;
+    });
+
+    // A centroid covering the quantiles from q0 to q1 may weigh no more than
+    // 4 * totalWeight * q * (1 - q) / compression at both ends, so that centroids stay small
+    // towards the tails of the distribution, where percentiles need to be most precise.
+    _centroids.clear();
+    double weightSoFar = 0;
+    Centroid current = centroids.front();
+    for (auto it = std::next(centroids.begin()); it != centroids.end(); ++it) {
+        const double proposedWeight = current.weight + it->weight;
+        const double q0 = weightSoFar / _totalWeight;
+        const double q1 = (weightSoFar + proposedWeight) / _totalWeight;
+        const double maxWeight =
+            4 * _totalWeight * std::min(q0 * (1 - q0), q1 * (1 - q1)) / kCompression;
+
+        if (proposedWeight <= maxWeight) {
+            current.mean += (it->mean - current.mean) * it->weight / proposedWeight;
+            current.weight = proposedWeight;
+        } else {
+            weightSoFar += current.weight;
+            _centroids.push_back(current);
+            current = *it;
+        }
+    }
+    _centroids.push_back(current);
+
+    _memUsageBytes = sizeof(*this) +
+        (_centroids.capacity() + _buffer.capacity()) * sizeof(Centroid);
+}
+
+double AccumulatorApproxPercentile::quantile(double q) const {
+    invariant(_buffer.empty() && !_centroids.empty());
+    if (_centroids.size() == 1) {
+        return _centroids.front().mean;
+    }
+
+    // Each centroid is taken to sit at the middle of the quantiles it covers, and the value at 'q'
+    // is interpolated between the two centroids around it, or the extremes at the ends.
+    const double target = q * _totalWeight;
+    const Centroid& first = _centroids.front();
+    if (target < first.weight / 2) {
+        return _min + (first.mean - _min) * target / (first.weight / 2);
+    }
+
+    const Centroid& last = _centroids.back();
+    if (target > _totalWeight - last.weight / 2) {
+        const double fromEnd = _totalWeight - target;
+        return _max - (_max - last.mean) * fromEnd / (last.weight / 2);
+    }
+
+    double weightSoFar = first.weight / 2;
+    for (size_t i = 1; i < _centroids.size(); ++i) {
+        const Centroid& left = _centroids[i - 1];
+        const Centroid& right = _centroids[i];
+        const double gap = (left.weight + right.weight) / 2;
+        if (target <= weightSoFar + gap) {
+            return left.mean + (right.mean - left.mean) * (target - weightSoFar) / gap;
+        }
+        weightSoFar += gap;
+    }
+    return last.mean;
+}
+
+Value AccumulatorApproxPercentile::getValue(bool toBeMerged) {
+    compress();
+
+    if (toBeMerged) {
+        std::vector<Value> means;
+        std::vector<Value> weights;
+        means.reserve(_centroids.size());
+        weights.reserve(_centroids.size());
+        for (auto&& centroid : _centroids) {
+            means.emplace_back(centroid.mean);
+            weights.emplace_back(centroid.weight);
+        }
+
+        MutableDocument partial;
+        if (_percentile) {
+            partial.addField(kPercentileField, Value(*_percentile));
+        }
+        partial.addField(kMeansField, Value(std::move(means)));
+        partial.addField(kWeightsField, Value(std::move(weights)));
+        partial.addField(kMinField, Value(_min));
+        partial.addField(kMaxField, Value(_max));
+        return partial.freezeToValue();
+    }
+
+    if (_centroids.empty()) {
+        return Value(BSONNULL);
+    }
+    return Value(quantile(*_percentile));
+}
+
+AccumulatorApproxPercentile::AccumulatorApproxPercentile(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx)
+    : Accumulator(expCtx) {
+    _memUsageBytes = sizeof(*this);
+}
+
+void AccumulatorApproxPercentile::reset() {
+    _centroids = {};
+    _buffer = {};
+    _totalWeight = 0;
+    _min = 0;
+    _max = 0;
+    _percentile = boost::none;
+    _memUsageBytes = sizeof(*this);
+}
+
+intrusive_ptr<Accumulator> AccumulatorApproxPercentile::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    return new AccumulatorApproxPercentile(expCtx);
+}
+
+}  // namespace mongo
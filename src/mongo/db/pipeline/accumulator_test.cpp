@@ -344,6 +344,136 @@ TEST(Accumulators, AddToSetRespectsCollation) {
                             Value(std::vector<Value>{Value("a"_sd)})}});
 }
 
+TEST(Accumulators, ApproxCountDistinct) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    assertExpectedResults(
+        "$approxCountDistinct",
+        expCtx,
+        {
+            // No documents evaluated.
+            {{}, Value(0LL)},
+            // Small sets are counted exactly, and equal numbers of different types are the same.
+            {{Value(1), Value(1.0), Value(2LL), Value("a"_sd), Value("a"_sd)}, Value(3LL)},
+            // Null values are counted.
+            {{Value(5), Value(BSONNULL)}, Value(2LL)},
+            // Missing values are ignored.
+            {{Value(9), Value()}, Value(1LL)},
+        });
+}
+
+TEST(Accumulators, ApproxCountDistinctRespectsCollation) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    expCtx->setCollator(&collator);
+    assertExpectedResults("$approxCountDistinct",
+                          expCtx,
+                          {{{Value("a"_sd), Value("b"_sd), Value("c"_sd)}, Value(1LL)}});
+}
+
+TEST(Accumulators, ApproxCountDistinctEstimatesLargeCountsAcrossShards) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    auto factory = AccumulationStatement::getFactory("$approxCountDistinct");
+    const int kNumDistinct = 100 * 1000;
+
+    // The first shard sees only a few distinct values, so its partial result stays sparse.
+    intrusive_ptr<Accumulator> merger(factory(expCtx));
+    intrusive_ptr<Accumulator> sparseShard(factory(expCtx));
+    for (int i = 0; i < 10; ++i) {
+        sparseShard->process(Value(i), false);
+    }
+    merger->process(sparseShard->getValue(true), true);
+
+    const int kNumShards = 4;
+    for (int shard = 0; shard < kNumShards; ++shard) {
+        intrusive_ptr<Accumulator> accum(factory(expCtx));
+        for (int i = shard; i < kNumDistinct; i += kNumShards) {
+            // Every value is seen twice.
+            accum->process(Value(i), false);
+            accum->process(Value(static_cast<long long>(i)), false);
+        }
+        merger->process(accum->getValue(true), true);
+    }
+
+    const long long estimate = merger->getValue(false).getLong();
+    ASSERT_LT(std::abs(estimate - kNumDistinct), kNumDistinct * 3 / 100);
+
+    // The sketch does not grow with the number of distinct values.
+    ASSERT_LT(merger->memUsageForSorter(), 64 * 1024);
+}
+
+namespace {
+Value percentileInput(Value input, double percentile) {
+    return Value(DOC("input" << input << "p" << percentile));
+}
+}  // namespace
+
+TEST(Accumulators, ApproxPercentile) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    assertExpectedResults(
+        "$approxPercentile",
+        expCtx,
+        {
+            // No documents evaluated.
+            {{}, Value(BSONNULL)},
+            // Small inputs give the exact values at the centroids, whatever their numeric types.
+            {{percentileInput(Value(3), 0.5),
+              percentileInput(Value(1LL), 0.5),
+              percentileInput(Value(5.0), 0.5),
+              percentileInput(Value(2), 0.5),
+              percentileInput(Value(4), 0.5)},
+             Value(3.0)},
+            // The extreme percentiles are the minimum and maximum.
+            {{percentileInput(Value(3), 0.0), percentileInput(Value(-7), 0.0)}, Value(-7.0)},
+            {{percentileInput(Value(3), 1.0), percentileInput(Value(-7), 1.0)}, Value(3.0)},
+            // Non-numeric and missing values are ignored.
+            {{percentileInput(Value(8), 0.5),
+              percentileInput(Value("a"_sd), 0.5),
+              percentileInput(Value(BSONNULL), 0.5),
+              percentileInput(Value(), 0.5)},
+             Value(8.0)},
+            {{percentileInput(Value("a"_sd), 0.5)}, Value(BSONNULL)},
+        });
+}
+
+TEST(Accumulators, ApproxPercentileEstimatesLargeInputsAcrossShards) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    auto factory = AccumulationStatement::getFactory("$approxPercentile");
+    const int kNumValues = 100 * 1000;
+    const int kNumShards = 4;
+
+    intrusive_ptr<Accumulator> merger(factory(expCtx));
+    for (int shard = 0; shard < kNumShards; ++shard) {
+        intrusive_ptr<Accumulator> accum(factory(expCtx));
+        for (int i = shard; i < kNumValues; i += kNumShards) {
+            accum->process(percentileInput(Value(i), 0.99), false);
+        }
+        merger->process(accum->getValue(true), true);
+    }
+
+    const double estimate = merger->getValue(false).getDouble();
+    ASSERT_LT(std::abs(estimate - 0.99 * kNumValues), kNumValues * 0.001);
+
+    // The digest does not grow with the number of values.
+    ASSERT_LT(merger->memUsageForSorter(), 64 * 1024);
+}
+
+TEST(Accumulators, ApproxPercentileRejectsInvalidPercentiles) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    auto factory = AccumulationStatement::getFactory("$approxPercentile");
+
+    intrusive_ptr<Accumulator> accum(factory(expCtx));
+    ASSERT_THROWS_CODE(accum->process(Value(5), false), AssertionException, 50702);
+    ASSERT_THROWS_CODE(
+        accum->process(percentileInput(Value(5), 1.5), false), AssertionException, 50703);
+    ASSERT_THROWS_CODE(accum->process(Value(DOC("input" << 5 << "p" << "a"_sd)), false),
+                       AssertionException,
+                       50703);
+
+    accum->process(percentileInput(Value(5), 0.5), false);
+    ASSERT_THROWS_CODE(
+        accum->process(percentileInput(Value(6), 0.9), false), AssertionException, 50704);
+}
+
 /* ------------------------- AccumulatorMergeObjects -------------------------- */
 
 namespace AccumulatorMergeObjects {
@@ -30,6 +30,7 @@
 
 #include "mongo/db/pipeline/document.h"
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 
 #include "mongo/bson/bson_depth.h"
@@ -49,6 +50,15 @@ const std::vector<StringData> Document::allMetadataFieldNames = {
     Document::metaFieldTextScore, Document::metaFieldRandVal, Document::metaFieldSortKey};
 
 Position DocumentStorage::findField(StringData requested) const {
+    Position pos = findLoadedField(requested);
+    if (pos.found() || MONGO_likely(!hasUnloadedFields()))
+        return pos;
+
+    // Loading fields does not change the logical contents of the document.
+    return const_cast<DocumentStorage*>(this)->loadLazyFieldsUntil(requested);
+}
+
+Position DocumentStorage::findLoadedField(StringData requested) const {
     int reqSize = requested.size();  // get size calculation out of the way if needed
 
     if (_numFields >= HASH_TAB_MIN) {  // hash lookup
@@ -56,7 +66,7 @@ Position DocumentStorage::findField(StringData requested) const {
 
         Position pos = _hashTab[bucket];
         while (pos.found()) {
-            const ValueElement& elem = getField(pos);
+            const ValueElement& elem = *(_firstElement->plusBytes(pos.index));
             if (elem.nameLen == reqSize && memcmp(requested.rawData(), elem._name, reqSize) == 0) {
                 return pos;
             }
@@ -65,7 +75,7 @@ Position DocumentStorage::findField(StringData requested) const {
             pos = elem.nextCollision;
         }
     } else {  // linear scan
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = iteratorLoaded(); !it.atEnd(); it.advance()) {
             if (it->nameLen == reqSize && memcmp(requested.rawData(), it->_name, reqSize) == 0) {
                 return it.position();
             }
@@ -76,7 +86,43 @@ Position DocumentStorage::findField(StringData requested) const {
     return Position();
 }
 
-Value& DocumentStorage::appendField(StringData name) {
+namespace {
+Value valueFromLazyField(const BSONElement& elem, const BSONObj& owner) {
+    if (elem.type() != Object) {
+        return Value(elem);
+    }
+
+    // Embedded objects are lazy as well, and share the buffer of the enclosing document.
+    BSONObj embedded = elem.embeddedObject();
+    embedded.shareOwnershipWith(owner);
+    return Value(Document::fromBsonLazy(embedded, false));
+}
+}  // namespace
+
+Position DocumentStorage::loadLazyFieldsUntil(StringData requested) {
+    while (hasUnloadedFields()) {
+        const BSONElement elem = _nextBsonField;
+        _nextBsonField = BSONElement(elem.rawdata() + elem.size());
+
+        const Position pos = getNextPosition();
+        const StringData fieldName = elem.fieldNameStringData();
+        appendFieldInternal(fieldName) = valueFromLazyField(elem, _bson);
+        if (fieldName == requested) {
+            return pos;
+        }
+    }
+    return Position();
+}
+
+void DocumentStorage::loadLazyFieldsUntilEnd() {
+    while (hasUnloadedFields()) {
+        const BSONElement elem = _nextBsonField;
+        _nextBsonField = BSONElement(elem.rawdata() + elem.size());
+        appendFieldInternal(elem.fieldNameStringData()) = valueFromLazyField(elem, _bson);
+    }
+}
+
+Value& DocumentStorage::appendFieldInternal(StringData name) {
     Position pos = getNextPosition();
     const int nameSize = name.size();
 
@@ -103,7 +149,7 @@ Value& DocumentStorage::appendField(StringData name) {
 #undef append
 
     // Make sure next field starts where we expect it
-    fassert(16486, getField(pos).next()->ptr() == _buffer + _usedBytes);
+    fassert(16486, fieldAt(pos).next()->ptr() == _buffer + _usedBytes);
 
     _numFields++;
 
@@ -114,12 +160,12 @@ Value& DocumentStorage::appendField(StringData name) {
         rehash();
     }
 
-    return getField(pos).val;
+    return fieldAt(pos).val;
 }
 
 // Call after adding field to _fields and increasing _numFields
 void DocumentStorage::addFieldToHashTable(Position pos) {
-    ValueElement& elem = getField(pos);
+    ValueElement& elem = fieldAt(pos);
     elem.nextCollision = Position();
 
     const unsigned bucket = bucketForKey(elem.nameSD());
@@ -127,7 +173,7 @@ void DocumentStorage::addFieldToHashTable(Position pos) {
     Position* posPtr = &_hashTab[bucket];
     while (posPtr->found()) {
         // collision: walk links and add new to end
-        posPtr = &getField(*posPtr).nextCollision;
+        posPtr = &fieldAt(*posPtr).nextCollision;
     }
     *posPtr = Position(pos.index);
 }
@@ -205,9 +251,11 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     out->_textScore = _textScore;
     out->_randVal = _randVal;
     out->_sortKey = _sortKey.getOwned();
+    out->_bson = _bson;
+    out->_nextBsonField = _nextBsonField;
 
     // Tell values that they have been memcpyed (updates ref counts)
-    for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
+    for (DocumentStorageIterator it = out->iteratorLoaded(); !it.atEnd(); it.advance()) {
         it->val.memcpyed();
     }
 
@@ -217,7 +265,7 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
 DocumentStorage::~DocumentStorage() {
     std::unique_ptr<char[]> deleteBufferAtScopeEnd(_buffer);
 
-    for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+    for (DocumentStorageIterator it = iteratorLoaded(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
     }
 }
@@ -258,12 +306,23 @@ void Document::toBson(BSONObjBuilder* builder, size_t recursionLevel) const {
                           << " levels of nesting",
             recursionLevel <= BSONDepth::getMaxAllowableDepth());
 
+    const BSONObj& unmodifiedBson = storage().getUnmodifiedBson();
+    if (!unmodifiedBson.isEmpty()) {
+        builder->appendElements(unmodifiedBson);
+        return;
+    }
+
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
         it->val.addToBsonObj(builder, it->nameSD(), recursionLevel);
     }
 }
 
 BSONObj Document::toBson() const {
+    const BSONObj& unmodifiedBson = storage().getUnmodifiedBson();
+    if (!unmodifiedBson.isEmpty()) {
+        return unmodifiedBson;
+    }
+
     BSONObjBuilder bb;
     toBson(&bb);
     return bb.obj();
@@ -312,6 +371,43 @@ Document Document::fromBsonWithMetaData(const BSONObj& bson) {
     return md.freeze();
 }
 
+Document Document::fromBsonLazy(const BSONObj& bson, bool parseMetaData) {
+    if (parseMetaData) {
+        // Documents with metadata are rare, so they are simply not made lazy.
+        BSONForEach(elem, bson) {
+            if (elem.fieldName()[0] == '$' &&
+                std::find(allMetadataFieldNames.begin(),
+                          allMetadataFieldNames.end(),
+                          elem.fieldNameStringData()) != allMetadataFieldNames.end()) {
+                return fromBsonWithMetaData(bson);
+            }
+        }
+    }
+
+    boost::intrusive_ptr<DocumentStorage> storage(new DocumentStorage());
+    storage->initLazy(bson.getOwned());
+    return Document(storage.get());
+}
+
+namespace {
+void loadLazyFieldsOfValue(const Value& value) {
+    if (value.getType() == Object) {
+        value.getDocument().loadLazyFields();
+    } else if (value.getType() == Array) {
+        for (auto&& element : value.getArray()) {
+            loadLazyFieldsOfValue(element);
+        }
+    }
+}
+}  // namespace
+
+void Document::loadLazyFields() const {
+    // Documents which are not lazy may still hold lazy ones, so this has to visit every value.
+    for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
+        loadLazyFieldsOfValue(it->val);
+    }
+}
+
 MutableDocument::MutableDocument(size_t expectedFields)
     : _storageHolder(NULL), _storage(_storageHolder) {
     if (expectedFields) {
@@ -383,7 +479,13 @@ size_t Document::getApproximateSize() const {
     size_t size = sizeof(DocumentStorage);
     size += storage().allocatedBytes();
 
-    for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
+    // Don't load the fields of a lazy document just to measure them. Until it is modified, the
+    // BSON it was created from is kept alive as well.
+    if (!storage().getUnmodifiedBson().isEmpty())
+        size += storage().getUnmodifiedBson().objsize();
+    for (DocumentStorageIterator it = storage().iteratorLoaded(); !it.atEnd(); it.advance()) {
+        if (it->val.missing())
+            continue;
         size += it->val.getApproximateSize();
         size -= sizeof(Value);  // already accounted for above
     }
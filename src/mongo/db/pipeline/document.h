@@ -217,6 +217,23 @@ public:
      */
     static Document fromBsonWithMetaData(const BSONObj& bson);
 
+    /**
+     * Like fromBsonWithMetaData(), or Document(BSONObj) if 'parseMetaData' is false, but keeps a
+     * reference to 'bson' and only converts its fields into Values as they are looked up. Embedded
+     * objects are lazy as well. While the document is unmodified, toBson() returns 'bson' without
+     * rebuilding it. Use this for documents of which only a few fields are likely to be read.
+     *
+     * Looking up a field may load more of the document, so unlike other Documents a lazy Document
+     * must not be read by several threads at once.
+     */
+    static Document fromBsonLazy(const BSONObj& bson, bool parseMetaData = true);
+
+    /**
+     * Loads all of the fields of this document and of the documents nested in it which were
+     * created by fromBsonLazy(), so that the document may then be read by several threads at once.
+     */
+    void loadLazyFields() const;
+
     /**
      * Given a BSON object that may have metadata fields added as part of toBsonWithMetadata(),
      * returns the same object without any of the metadata fields.
@@ -235,8 +235,8 @@ public:
 
     // MutableDocument uses these
     ValueElement& getField(Position pos) {
-        verify(pos.found());
-        return *(_firstElement->plusBytes(pos.index));
+        prepareForModification();
+        return fieldAt(pos);
     }
     Value& getField(StringData name) {
         Position pos = findField(name);
@@ -246,7 +246,10 @@ public:
     }
 
     /// Adds a new field with missing Value at the end of the document
-    Value& appendField(StringData name);
+    Value& appendField(StringData name) {
+        prepareForModification();
+        return appendFieldInternal(name);
+    }
 
     /** Preallocates space for fields. Use this to attempt to prevent buffer growth.
      *  This is only valid to call before anything is added to the document.
@@ -255,14 +258,48 @@ public:
 
     /// This skips missing values
     DocumentStorageIterator iterator() const {
+        loadAllLazyFields();
         return DocumentStorageIterator(_firstElement, end(), false);
     }
 
     /// This includes missing values
     DocumentStorageIterator iteratorAll() const {
+        loadAllLazyFields();
+        return iteratorLoaded();
+    }
+
+    /**
+     * Like iteratorAll(), but does not load the fields of a lazy document which have not been
+     * looked up yet.
+     */
+    DocumentStorageIterator iteratorLoaded() const {
         return DocumentStorageIterator(_firstElement, end(), true);
     }
 
+    /**
+     * Makes this document lazily backed by 'bson', which must be owned. Its fields are only
+     * converted into Values when they, or a field after them, are looked up. Must be called on a
+     * new, empty DocumentStorage.
+     */
+    void initLazy(BSONObj bson) {
+        invariant(!_buffer && bson.isOwned());
+        _bson = std::move(bson);
+        _nextBsonField = _bson.firstElement();
+    }
+
+    /**
+     * Returns the BSON object a lazy document was created from, as long as the document has not
+     * been modified since. Otherwise returns an empty object.
+     */
+    const BSONObj& getUnmodifiedBson() const {
+        return _bson;
+    }
+
+    /// Returns true if some fields of a lazy document have not been loaded yet.
+    bool hasUnloadedFields() const {
+        return !_nextBsonField.eoo();
+    }
+
     /// Shallow copy of this. Caller owns memory.
     boost::intrusive_ptr<DocumentStorage> clone() const;
 
@@ -320,6 +357,42 @@ public:
     }
 
 private:
+    ValueElement& fieldAt(Position pos) {
+        verify(pos.found());
+        return *(_firstElement->plusBytes(pos.index));
+    }
+
+    Value& appendFieldInternal(StringData name);
+
+    /// Looks up 'name' among the fields which have already been added to _buffer.
+    Position findLoadedField(StringData name) const;
+
+    /**
+     * Appends the not yet loaded fields of a lazy document to _buffer, in order, until one named
+     * 'name' is appended. Returns its position, or Position() if there is no such field.
+     */
+    Position loadLazyFieldsUntil(StringData name);
+
+    /// Appends all of the not yet loaded fields of a lazy document to _buffer.
+    void loadAllLazyFields() const {
+        if (MONGO_unlikely(hasUnloadedFields())) {
+            // Loading fields does not change the logical contents of the document.
+            const_cast<DocumentStorage*>(this)->loadLazyFieldsUntilEnd();
+        }
+    }
+    void loadLazyFieldsUntilEnd();
+
+    /**
+     * Called before the fields are modified. Loads all of the fields of a lazy document, since new
+     * fields must be appended after them, and drops the BSON it can no longer be converted to.
+     */
+    void prepareForModification() {
+        loadAllLazyFields();
+        if (!_bson.isEmpty()) {
+            _bson = BSONObj();
+        }
+    }
+
     /// Same as lastElement->next() or firstElement() if empty.
     const ValueElement* end() const {
         return _firstElement ? _firstElement->plusBytes(_usedBytes) : nullptr;
@@ -363,7 +436,7 @@ private:
     /// Adds all fields to the hash table
     void rehash() {
         hashTabInit();
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance())
+        for (DocumentStorageIterator it = iteratorLoaded(); !it.atEnd(); it.advance())
             addFieldToHashTable(it.position());
     }
 
@@ -401,6 +474,13 @@ private:
     double _textScore;
     double _randVal;
     BSONObj _sortKey;
+
+    // For a lazy document, the BSON object its fields come from. Reset once the fields are
+    // modified.
+    BSONObj _bson;
+    // The first field of '_bson' which has not been appended to _buffer yet, or EOO once all of
+    // them have.
+    BSONElement _nextBsonField;
     // When adding a field, make sure to update clone() method
 
     // Defined in document.cpp
@@ -32,6 +32,7 @@
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -94,6 +95,8 @@ DocumentSource::GetNextResult DocumentSourceBucketAuto::populateSorter() {
         if (pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
             opts.extSortAllowed = true;
             opts.tempDir = pExpCtx->tempDir;
+            opts.parallelism = std::max(1, internalQueryExecSorterParallelism.load());
+            opts.readAhead = true;
         }
         const auto& valueCmp = pExpCtx->getValueComparator();
         auto comparator = [valueCmp](const Sorter<Value, Document>::Data& lhs,
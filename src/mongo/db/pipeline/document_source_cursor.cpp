@@ -88,7 +88,9 @@ void DocumentSourceCursor::loadBatch() {
                 } else if (_dependencies) {
                     _currentBatch.push_back(_dependencies->extractFields(resultObj));
                 } else {
-                    _currentBatch.push_back(Document::fromBsonWithMetaData(resultObj));
+                    // The whole document is needed, but later stages may still only look at a
+                    // few of its fields, or pass it through unmodified.
+                    _currentBatch.push_back(Document::fromBsonLazy(resultObj));
                 }
 
                 if (_limit) {
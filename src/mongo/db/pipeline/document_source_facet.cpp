@@ -30,6 +30,8 @@
 
 #include "mongo/db/pipeline/document_source_facet.h"
 
+#include <algorithm>
+#include <exception>
 #include <memory>
 #include <vector>
 
@@ -42,11 +44,15 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/pipeline/pipeline_worker_pool.h"
 #include "mongo/db/pipeline/tee_buffer.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -68,6 +74,22 @@ DocumentSourceFacet::DocumentSourceFacet(std::vector<FacetPipeline> facetPipelin
 }
 
 namespace {
+/**
+ * The names of the stages which only compute over their input, and which may therefore run
+ * concurrently with the stages of other sub-pipelines of the same $facet.
+ */
+const StringData kConcurrencySafeStages[] = {"$match"_sd,
+                                             "$project"_sd,
+                                             "$addFields"_sd,
+                                             "$replaceRoot"_sd,
+                                             "$group"_sd,
+                                             "$sort"_sd,
+                                             "$limit"_sd,
+                                             "$skip"_sd,
+                                             "$unwind"_sd,
+                                             "$bucketAuto"_sd,
+                                             "$redact"_sd};
+
 /**
  * Extracts the names of the facets and the vectors of raw BSONObjs representing the stages within
  * that facet's pipeline.
@@ -170,6 +192,11 @@ DocumentSource::GetNextResult DocumentSourceFacet::getNext() {
 
     vector<vector<Value>> results(_facets.size());
     bool allPipelinesEOF = false;
+    if (canRunSubPipelinesConcurrently()) {
+        runSubPipelinesConcurrently(&results);
+        allPipelinesEOF = true;
+    }
+
     while (!allPipelinesEOF) {
         allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
         for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
@@ -191,6 +218,94 @@ DocumentSource::GetNextResult DocumentSourceFacet::getNext() {
     return resultDoc.freeze();
 }
 
+bool DocumentSourceFacet::canRunSubPipelinesConcurrently() const {
+    if (internalQueryFacetMaxParallelism.load() < 2 || _facets.size() < 2) {
+        return false;
+    }
+
+    for (auto&& facet : _facets) {
+        for (auto&& source : facet.pipeline->getSources()) {
+            if (dynamic_cast<DocumentSourceTeeConsumer*>(source.get())) {
+                continue;
+            }
+            if (std::none_of(std::begin(kConcurrencySafeStages),
+                             std::end(kConcurrencySafeStages),
+                             [&](StringData name) { return name == source->getSourceName(); })) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void DocumentSourceFacet::runSubPipelinesConcurrently(vector<vector<Value>>* results) {
+    // Variables are assigned slots when they are parsed, so allocate every slot up front, rather
+    // than letting the sub-pipelines grow the list while others are reading from it.
+    pExpCtx->variables.reserveValuesForGeneratedIds();
+
+    std::vector<char> isEOF(_facets.size(), false);
+    auto runFacet = [&](size_t facetId) {
+        const auto& pipeline = _facets[facetId].pipeline;
+        auto next = pipeline->getSources().back()->getNext();
+        for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+            (*results)[facetId].emplace_back(next.releaseDocument());
+        }
+        isEOF[facetId] = next.isEOF();
+    };
+
+    while (std::find(isEOF.begin(), isEOF.end(), false) != isEOF.end()) {
+        // Worker threads do not check for interrupts, so check once per batch on this thread.
+        pExpCtx->checkForInterrupt();
+
+        std::vector<size_t> activeFacets;
+        for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+            if (!isEOF[facetId]) {
+                activeFacets.push_back(facetId);
+            }
+        }
+
+        _teeBuffer->beginConcurrentConsumption();
+        ON_BLOCK_EXIT([&] { _teeBuffer->endConcurrentConsumption(); });
+
+        // Split the sub-pipelines into round-robin groups. This thread runs the first group, and
+        // each of the others runs on a worker thread.
+        const size_t nGroups = std::min(
+            activeFacets.size(),
+            static_cast<size_t>(std::max(1, internalQueryFacetMaxParallelism.load())));
+        auto runGroup = [&](size_t group) {
+            for (size_t i = group; i < activeFacets.size(); i += nGroups) {
+                runFacet(activeFacets[i]);
+            }
+        };
+
+        std::vector<stdx::future<void>> pending;
+        for (size_t group = 1; group < nGroups; ++group) {
+            pending.push_back(runOnPipelineWorkerPool([&runGroup, group] { runGroup(group); }));
+        }
+
+        std::exception_ptr firstError;
+        try {
+            runGroup(0);
+        } catch (...) {
+            firstError = std::current_exception();
+        }
+
+        // Every worker must stop using the buffer and the sub-pipelines before any error escapes.
+        for (auto&& future : pending) {
+            try {
+                future.get();
+            } catch (...) {
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+        }
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+    }
+}
+
 Value DocumentSourceFacet::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
     MutableDocument serialized;
     for (auto&& facet : _facets) {
@@ -148,6 +148,19 @@ private:
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
 
+    /**
+     * Returns true if the sub-pipelines may each run on their own thread. This requires that the
+     * parallelism knob permits it, and that every stage only computes over the documents it is
+     * given, without touching storage, other collections, or state shared between sub-pipelines.
+     */
+    bool canRunSubPipelinesConcurrently() const;
+
+    /**
+     * Runs the sub-pipelines over each batch of the input at the same time, adding the results of
+     * each sub-pipeline to the corresponding entry of 'results'.
+     */
+    void runSubPipelinesConcurrently(std::vector<std::vector<Value>>* results);
+
     boost::intrusive_ptr<TeeBuffer> _teeBuffer;
     std::vector<FacetPipeline> _facets;
 
@@ -40,11 +40,14 @@
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source_limit.h"
+#include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_skip.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 using std::deque;
@@ -356,6 +359,90 @@ TEST_F(DocumentSourceFacetTest, ShouldBeAbleToEvaluateMultipleStagesWithinOneSub
     ASSERT_DOCUMENT_EQ(output.getDocument(), Document(fromjson("{subPipe: [{_id: 0}, {_id: 1}]}")));
 }
 
+TEST_F(DocumentSourceFacetTest, ShouldProduceSameResultsWhenRunningSubPipelinesConcurrently) {
+    auto ctx = getExpCtx();
+
+    const auto originalParallelism = internalQueryFacetMaxParallelism.load();
+    const auto originalBufferSize = internalQueryFacetBufferSizeBytes.load();
+    ON_BLOCK_EXIT([&] {
+        internalQueryFacetMaxParallelism.store(originalParallelism);
+        internalQueryFacetBufferSizeBytes.store(originalBufferSize);
+    });
+    internalQueryFacetMaxParallelism.store(4);
+    // Use a small buffer so that the input is consumed over several batches.
+    internalQueryFacetBufferSizeBytes.store(50);
+
+    deque<DocumentSource::GetNextResult> inputs;
+    vector<Value> expectedOutputs;
+    for (int i = 0; i < 10; ++i) {
+        inputs.emplace_back(Document{{"_id", i}});
+        expectedOutputs.emplace_back(Document{{"_id", i}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+
+    std::vector<DocumentSourceFacet::FacetPipeline> facets;
+    facets.emplace_back(
+        "all",
+        uassertStatusOK(Pipeline::createFacetPipeline({DocumentSourceSkip::create(ctx, 0)}, ctx)));
+    facets.emplace_back(
+        "skipped",
+        uassertStatusOK(Pipeline::createFacetPipeline({DocumentSourceSkip::create(ctx, 7)}, ctx)));
+    facets.emplace_back(
+        "limited",
+        uassertStatusOK(Pipeline::createFacetPipeline({DocumentSourceLimit::create(ctx, 2)}, ctx)));
+    facets.emplace_back(
+        "matched",
+        uassertStatusOK(Pipeline::createFacetPipeline(
+            {DocumentSourceMatch::create(fromjson("{_id: {$gte: 5}}"), ctx),
+             DocumentSourceLimit::create(ctx, 3)},
+            ctx)));
+    facets.emplace_back(
+        "none",
+        uassertStatusOK(Pipeline::createFacetPipeline(
+            {DocumentSourceMatch::create(fromjson("{_id: {$lt: 0}}"), ctx)}, ctx)));
+    auto facetStage = DocumentSourceFacet::create(std::move(facets), ctx);
+    facetStage->setSource(mock.get());
+
+    auto output = facetStage->getNext();
+    ASSERT(output.isAdvanced());
+    ASSERT_EQ(output.getDocument().size(), 5UL);
+    ASSERT_VALUE_EQ(output.getDocument()["all"], Value(expectedOutputs));
+    ASSERT_VALUE_EQ(output.getDocument()["skipped"],
+                    Value(vector<Value>(expectedOutputs.begin() + 7, expectedOutputs.end())));
+    ASSERT_VALUE_EQ(output.getDocument()["limited"],
+                    Value(vector<Value>(expectedOutputs.begin(), expectedOutputs.begin() + 2)));
+    ASSERT_VALUE_EQ(output.getDocument()["matched"],
+                    Value(vector<Value>(expectedOutputs.begin() + 5, expectedOutputs.begin() + 8)));
+    ASSERT_VALUE_EQ(output.getDocument()["none"], Value(vector<Value>()));
+
+    ASSERT(facetStage->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceFacetTest, ShouldPropagateErrorsFromSubPipelinesRunningConcurrently) {
+    auto ctx = getExpCtx();
+
+    const auto originalParallelism = internalQueryFacetMaxParallelism.load();
+    ON_BLOCK_EXIT([&] { internalQueryFacetMaxParallelism.store(originalParallelism); });
+    internalQueryFacetMaxParallelism.store(4);
+
+    deque<DocumentSource::GetNextResult> inputs = {Document{{"_id", 0}}, Document{{"_id", 1}}};
+    auto mock = DocumentSourceMock::create(inputs);
+
+    std::vector<DocumentSourceFacet::FacetPipeline> facets;
+    facets.emplace_back(
+        "all",
+        uassertStatusOK(Pipeline::createFacetPipeline({DocumentSourceSkip::create(ctx, 0)}, ctx)));
+    facets.emplace_back(
+        "failing",
+        uassertStatusOK(Pipeline::createFacetPipeline(
+            {DocumentSourceMatch::create(fromjson("{$expr: {$divide: ['$_id', 0]}}"), ctx)},
+            ctx)));
+    auto facetStage = DocumentSourceFacet::create(std::move(facets), ctx);
+    facetStage->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(facetStage->getNext(), AssertionException, 16608);
+}
+
 TEST_F(DocumentSourceFacetTest, ShouldPropagateDisposeThroughToSource) {
     auto ctx = getExpCtx();
 
@@ -38,7 +38,9 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
@@ -51,6 +53,19 @@ REGISTER_DOCUMENT_SOURCE(group,
                          LiteParsedDocumentSourceDefault::parse,
                          DocumentSourceGroup::createFromBson);
 
+namespace {
+
+// A partition which still does not fit in memory after being split this many times is
+// re-aggregated in memory regardless of the limit.
+const int kMaxSpillPartitionLevel = 4;
+
+size_t numSpillPartitions() {
+    const int partitions = internalDocumentSourceGroupSpillPartitions.load();
+    return partitions >= 2 ? partitions : 0;
+}
+
+}  // namespace
+
 const char* DocumentSourceGroup::getSourceName() const {
     return "$group";
 }
@@ -70,7 +85,9 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         accum->reset();  // Prep accumulators for a new group.
     }
 
-    if (_spilled) {
+    if (_partitioned) {
+        return getNextPartitioned();
+    } else if (_spilled) {
         return getNextSpilled();
     } else if (_streaming) {
         return getNextStreaming();
@@ -85,22 +102,10 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         return GetNextResult::makeEOF();
 
     _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
+        mergeSpilledAccumulators(_firstPartOfNextGroup.second, &_currentAccumulators);
 
         if (!_sorterIterator->more()) {
             dispose();
@@ -126,48 +131,100 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextPartitioned() {
+    // Spilled to hash partitions. '_groups' holds the partition currently being returned.
+    if (_groups->empty())
+        return GetNextResult::makeEOF();
+
+    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+
+    if (++groupsIterator == _groups->end() && !loadNextPartition())
+        dispose();
+
+    return std::move(out);
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
     // Streaming optimization is active.
-    if (!_firstDocOfNextGroup) {
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
+    if (_streamingRunComplete) {
+        if (groupsIterator != _groups->end()) {
+            Document out =
+                makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+            ++groupsIterator;
+            return std::move(out);
         }
-        _firstDocOfNextGroup = nextInput.releaseDocument();
+        _groups->clear();
+        _streamingRunComplete = false;
     }
 
-    Value id;
-    do {
-        // Add to the current accumulator(s).
-        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
-            _currentAccumulators[i]->process(
-                _accumulatedFields[i].expression->evaluate(*_firstDocOfNextGroup), _doingMerge);
+    // Accumulate the next run into '_groups'. If the input pauses, the run is resumed by the next
+    // call.
+    while (true) {
+        Document input;
+        if (_firstDocOfNextGroup) {
+            input = std::move(*_firstDocOfNextGroup);
+            _firstDocOfNextGroup = boost::none;
+        } else {
+            if (_streamingInputExhausted) {
+                return GetNextResult::makeEOF();
+            }
+            auto nextInput = pSource->getNext();
+            if (nextInput.isPaused()) {
+                return nextInput;
+            }
+            if (nextInput.isEOF()) {
+                _streamingInputExhausted = true;
+                if (_groups->empty()) {
+                    dispose();
+                    return nextInput;
+                }
+                break;
+            }
+            input = nextInput.releaseDocument();
         }
 
-        // Retrieve the next document.
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
+        Value runKey = computeStreamingRunKey(input);
+        if (!_groups->empty() &&
+            pExpCtx->getValueComparator().evaluate(runKey != _streamingRunKey)) {
+            _firstDocOfNextGroup = std::move(input);
+            break;
         }
+        _streamingRunKey = std::move(runKey);
 
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-
-
-        // Compute the id. If it does not match _currentId, we will exit the loop, leaving
-        // _firstDocOfNextGroup set for the next time getNext() is called.
-        id = computeId(*_firstDocOfNextGroup);
-    } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
+        const size_t oldSize = _groups->size();
+        Accumulators& group = (*_groups)[computeId(input)];
+        if (_groups->size() != oldSize) {
+            group.reserve(_accumulatedFields.size());
+            for (auto&& accumulatedField : _accumulatedFields) {
+                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+            }
+        }
+        for (size_t i = 0; i < _accumulatedFields.size(); i++) {
+            group[i]->process(_accumulatedFields[i].evaluateExpression(input), _doingMerge);
+        }
+    }
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
-    _currentId = std::move(id);
+    _streamingRunComplete = true;
+    groupsIterator = _groups->begin();
+    return getNextStreaming();
+}
 
-    return std::move(out);
+Value DocumentSourceGroup::computeStreamingRunKey(const Document& root) const {
+    vector<Value> key;
+    key.reserve(_streamingRunPaths.size());
+    for (auto&& path : _streamingRunPaths) {
+        Value value = root.getNestedField(path);
+        key.push_back(value.nullish() ? Value(BSONNULL) : std::move(value));
+    }
+    return Value(std::move(key));
 }
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _partitionWriters.clear();
+    _partitions.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -185,6 +242,7 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
 
     for (auto&& accumulatedField : _accumulatedFields) {
         accumulatedField.expression = accumulatedField.expression->optimize();
+        accumulatedField.compileExpression();
     }
 
     return this;
@@ -221,10 +279,17 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
         insides["$doingMerge"] = Value(true);
     }
 
-    if (explain && findRelevantInputSort()) {
-        return Value(DOC("$streamingGroup" << insides.freeze()));
+    MutableDocument out;
+    out[explain && findRelevantInputSort() ? "$streamingGroup" : getSourceName()] =
+        insides.freezeToValue();
+
+    if (explain && *explain >= ExplainOptions::Verbosity::kExecStats) {
+        out["usedDisk"] = Value(_spillStats.usedDisk);
+        out["partitionsSpilled"] = Value(static_cast<long long>(_spillStats.partitionsSpilled));
+        out["spilledBytes"] = Value(static_cast<long long>(_spillStats.spilledBytes));
     }
-    return Value(DOC(getSourceName() << insides.freeze()));
+
+    return out.freezeToValue();
 }
 
 DocumentSource::GetDepsReturn DocumentSourceGroup::getDependencies(DepsTracker* deps) const {
@@ -266,7 +331,8 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
-      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos),
+      _numSpillPartitions(numSpillPartitions()) {}
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
     _accumulatedFields.push_back(accumulationStatement);
@@ -457,22 +523,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         _streaming = true;
         _inputSort = *inputSort;
 
-        // Set up accumulators.
-        _currentAccumulators.reserve(numAccumulators);
-        for (auto&& accumulatedField : _accumulatedFields) {
-            _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
-        }
-
-        // We only need to load the first document.
-        auto firstInput = pSource->getNext();
-        if (!firstInput.isAdvanced()) {
-            // Leave '_firstDocOfNextGroup' uninitialized and return.
-            return firstInput;
+        for (auto&& sortField : _inputSort) {
+            _streamingRunPaths.emplace_back(sortField.fieldName());
         }
-        _firstDocOfNextGroup = firstInput.releaseDocument();
 
-        // Compute the _id value.
-        _currentId = computeId(*_firstDocOfNextGroup);
+        // The input is read one run at a time by getNextStreaming().
         _initialized = true;
         return DocumentSource::GetNextResult::makeEOF();
     }
@@ -486,7 +541,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
+            if (_numSpillPartitions) {
+                spillToPartitions(0);
+            } else {
+                _sortedFiles.push_back(spill());
+            }
             _memoryUsageBytes = 0;
         }
 
@@ -521,7 +580,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         dassert(numAccumulators == group.size());
 
         for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
+            group[i]->process(_accumulatedFields[i].evaluateExpression(rootDocument),
                               _doingMerge);
 
             _memoryUsageBytes += group[i]->memUsageForSorter();
@@ -548,7 +607,14 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (!_partitionWriters.empty()) {
+                // Spill what is left so that each partition holds everything for its groups, then
+                // load the first partition to return.
+                _partitioned = true;
+                spillToPartitions(0);
+                finishPartitions(0);
+                loadNextPartition();
+            } else if (!_sortedFiles.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
                     _sortedFiles.push_back(spill());
@@ -591,51 +657,168 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
 
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
-    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+    SortedFileWriter<Value, Value> writer(makeSpillSortOptions());
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        writer.addAlreadySorted(ptrs[i]->first, serializeAccumulators(ptrs[i]->second));
+    }
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+    _groups->clear();
+
+    shared_ptr<Sorter<Value, Value>::Iterator> iterator(writer.done());
+    _spillStats.usedDisk = true;
+    _spillStats.spilledBytes += writer.bytesWritten();
+    return iterator;
+}
+
+void DocumentSourceGroup::spillToPartitions(int level) {
+    // Partition files are read back in the order they were written, so unlike the runs written
+    // by spill() they don't need to be sorted. Groups which are spilled more than once keep the
+    // order in which they were accumulated, which matters for accumulators such as $first.
+    _partitionWriters.resize(_numSpillPartitions);
+    for (auto&& group : *_groups) {
+        auto& writer = _partitionWriters[partitionFor(group.first, level)];
+        if (!writer) {
+            writer = stdx::make_unique<SortedFileWriter<Value, Value>>(makeSpillSortOptions());
+        }
+        writer->addAlreadySorted(group.first, serializeAccumulators(group.second));
+    }
+
+    _groups->clear();
+    _memoryUsageBytes = 0;
+}
+
+void DocumentSourceGroup::finishPartitions(int level) {
+    for (auto&& writer : _partitionWriters) {
+        if (!writer) {
+            continue;  // No group hashed to this partition.
+        }
+
+        _partitions.push_back(
+            {shared_ptr<Sorter<Value, Value>::Iterator>(writer->done()), level});
+        _spillStats.usedDisk = true;
+        _spillStats.partitionsSpilled++;
+        _spillStats.spilledBytes += writer->bytesWritten();
+    }
+    _partitionWriters.clear();
+}
+
+bool DocumentSourceGroup::loadNextPartition() {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    while (!_partitions.empty()) {
+        SpilledPartition partition = std::move(_partitions.back());
+        _partitions.pop_back();
+
+        _groups->clear();
+        _memoryUsageBytes = 0;
+
+        bool split = false;
+        while (partition.iterator->more()) {
+            if (_memoryUsageBytes > _maxMemoryUsageBytes &&
+                partition.level < kMaxSpillPartitionLevel) {
+                // The partition does not fit in memory either, so split it into smaller ones.
+                spillToPartitions(partition.level + 1);
+                split = true;
             }
-            break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+            auto spilledGroup = partition.iterator->next();
+
+            const size_t oldSize = _groups->size();
+            Accumulators& group = (*_groups)[spilledGroup.first];
+            if (_groups->size() != oldSize) {
+                _memoryUsageBytes += spilledGroup.first.getApproximateSize();
+
+                group.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                }
+            } else {
+                for (auto&& accum : group) {
+                    _memoryUsageBytes -= accum->memUsageForSorter();
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
             }
-            break;
+
+            mergeSpilledAccumulators(spilledGroup.second, &group);
+            for (auto&& accum : group) {
+                _memoryUsageBytes += accum->memUsageForSorter();
+            }
+        }
+
+        if (split) {
+            spillToPartitions(partition.level + 1);
+            finishPartitions(partition.level + 1);
+            continue;
+        }
+
+        if (!_groups->empty()) {
+            groupsIterator = _groups->begin();
+            return true;
+        }
     }
 
-    _groups->clear();
+    return false;
+}
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+size_t DocumentSourceGroup::partitionFor(const Value& id, int level) const {
+    // Reusing the hash table's hash would send every group of a partition that is split again to
+    // the same new partition, so mix in the level.
+    const size_t hash = pExpCtx->getValueComparator().hash(id);
+    uint32_t partitionHash;
+    MurmurHash3_x86_32(&hash, sizeof(hash), level, &partitionHash);
+    return partitionHash % _numSpillPartitions;
 }
 
-boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
-    if (true) {
-        // Until streaming $group correctly handles nullish values, the streaming behavior is
-        // disabled. See SERVER-23318.
-        return boost::none;
+Value DocumentSourceGroup::serializeAccumulators(const Accumulators& accums) const {
+    switch (_accumulatedFields.size()) {  // same as accums.size()
+        case 0:                           // no values, essentially a distinct
+            return Value();
+
+        case 1:  // just one value, use optimized serialization as single Value
+            return accums[0]->getValue(/*toBeMerged=*/true);
+
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> values;
+            values.reserve(accums.size());
+            for (auto&& accum : accums) {
+                values.push_back(accum->getValue(/*toBeMerged=*/true));
+            }
+            return Value(std::move(values));
+        }
     }
+}
 
-    if (!pSource) {
+void DocumentSourceGroup::mergeSpilledAccumulators(const Value& state,
+                                                   Accumulators* accums) const {
+    const size_t numAccumulators = _accumulatedFields.size();
+    switch (numAccumulators) {  // mirrors switch in serializeAccumulators()
+        case 1:                 // Single accumulators serialize as a single Value.
+            (*accums)[0]->process(state, true);
+        case 0:  // No accumulators so no Values.
+            break;
+        default: {  // Multiple accumulators serialize as an array of Values.
+            const vector<Value>& accumulatorStates = state.getArray();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                (*accums)[i]->process(accumulatorStates[i], true);
+            }
+        }
+    }
+}
+
+SortOptions DocumentSourceGroup::makeSpillSortOptions() const {
+    return SortOptions()
+        .TempDir(pExpCtx->tempDir)
+        .Parallelism(std::max(1, internalQueryExecSorterParallelism.load()));
+}
+
+boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
+    if (!pSource || _streamableInputSorts.empty()) {
         // Sometimes when performing an explain, or using $group as the merge point, 'pSource' will
-        // not be set.
+        // not be set. Otherwise, only the input sorts declared by setStreamableInputSorts() keep
+        // the documents of each group adjacent.
         return boost::none;
     }
 
-    BSONObjSet sorts = pSource->getOutputSorts();
+    const BSONObjSet& sorts = _streamableInputSorts;
 
     // 'sorts' is a BSONObjSet. We need to check if our group pattern is compatible with one of the
     // input sort patterns.
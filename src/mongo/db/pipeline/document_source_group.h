@@ -30,10 +30,13 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -45,6 +48,15 @@ public:
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    /**
+     * Statistics about spilling to disk, reported by explain at "executionStats" verbosity.
+     */
+    struct SpillStats {
+        bool usedDisk = false;
+        size_t partitionsSpilled = 0;  // Files written by hash partitioning, including re-splits.
+        size_t spilledBytes = 0;
+    };
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -98,6 +110,47 @@ public:
         return _streaming;
     }
 
+    /**
+     * Declares that the input is sorted on each of the patterns in 'sorts', in such a way that the
+     * documents with equal values for the fields of a pattern are adjacent. A $sort does not
+     * guarantee this, since it orders an array by its smallest element. If one of these patterns
+     * is on exactly the fields of the _id, the $group streams its output.
+     */
+    void setStreamableInputSorts(BSONObjSet sorts) {
+        _streamableInputSorts = std::move(sorts);
+    }
+
+    /**
+     * Returns true if this $group streams its output, or will once it starts reading its input.
+     */
+    bool canStream() const {
+        return _streaming || findRelevantInputSort();
+    }
+
+    bool isDoingMerge() const {
+        return _doingMerge;
+    }
+
+    size_t getMaxMemoryUsageBytes() const {
+        return _maxMemoryUsageBytes;
+    }
+
+    /**
+     * Sets the memory the groups may use before they are spilled to disk, or before the $group
+     * fails if it may not use the disk. Must be called before the $group reads any input.
+     */
+    void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) {
+        _maxMemoryUsageBytes = maxMemoryUsageBytes;
+    }
+
+    const std::vector<AccumulationStatement>& getAccumulatedFields() const {
+        return _accumulatedFields;
+    }
+
+    const SpillStats& getSpillStats() const {
+        return _spillStats;
+    }
+
     // Virtuals for SplittableDocumentSource.
     boost::intrusive_ptr<DocumentSource> getShardSource() final;
     std::list<boost::intrusive_ptr<DocumentSource>> getMergeSources() final;
@@ -117,6 +170,7 @@ private:
     GetNextResult getNextStreaming();
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
+    GetNextResult getNextPartitioned();
 
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
@@ -124,6 +178,12 @@ private:
      */
     boost::optional<BSONObj> findRelevantInputSort() const;
 
+    /**
+     * Returns the values of the fields of '_inputSort' in 'root', with nullish values replaced by
+     * null. Documents with equal keys are adjacent in the input of a streaming $group.
+     */
+    Value computeStreamingRunKey(const Document& root) const;
+
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
      * initialize() requests the first document from the previous source, and uses it to prepare the
@@ -143,6 +203,37 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Writes every group in '_groups' to the hash partition of its _id and clears '_groups'. The
+     * partitions written by calls with the same 'level' share files until finishPartitions() is
+     * called. 'level' is the number of times the groups have already been partitioned, and seeds
+     * the partitioning hash so that a partition which is too large can be split again.
+     */
+    void spillToPartitions(int level);
+
+    /**
+     * Closes the partition files written by spillToPartitions() and queues them to be
+     * re-aggregated.
+     */
+    void finishPartitions(int level);
+
+    /**
+     * Re-aggregates queued partitions into '_groups' until one produces results, splitting any
+     * partition which does not fit in memory. Returns false once every partition is exhausted.
+     */
+    bool loadNextPartition();
+
+    size_t partitionFor(const Value& id, int level) const;
+
+    /**
+     * Converts the state of 'accums' into the Value written to spill files, and merges such a
+     * Value back into 'accums'.
+     */
+    Value serializeAccumulators(const Accumulators& accums) const;
+    void mergeSpilledAccumulators(const Value& state, Accumulators* accums) const;
+
+    SortOptions makeSpillSortOptions() const;
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
@@ -168,6 +259,17 @@ private:
     bool _streaming;
     bool _initialized;
 
+    BSONObjSet _streamableInputSorts = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+
+    // Only used when '_streaming' is true. A streaming $group accumulates the run of adjacent input
+    // documents which share the key '_streamingRunKey' into '_groups'. There may be several groups
+    // in a run, since values such as null and missing are adjacent in the input, but are different
+    // group keys. The groups are returned once the run is complete.
+    std::vector<FieldPath> _streamingRunPaths;
+    Value _streamingRunKey;
+    bool _streamingRunComplete = false;
+    bool _streamingInputExhausted = false;
+
     Value _currentId;
     Accumulators _currentAccumulators;
 
@@ -186,8 +288,29 @@ private:
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _allowDiskUse;
 
+    /**
+     * A file of partially aggregated groups whose _ids all hashed to the same partition.
+     */
+    struct SpilledPartition {
+        std::shared_ptr<Sorter<Value, Value>::Iterator> iterator;
+        int level;
+    };
+
+    // Number of hash partitions to spill to, or 0 to spill sorted runs instead.
+    const size_t _numSpillPartitions;
+
+    // The files being written by spillToPartitions(), one per partition. Null until the partition
+    // gets its first group.
+    std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>> _partitionWriters;
+
+    // Partitions waiting to be re-aggregated. Only used when '_partitioned' is true.
+    std::vector<SpilledPartition> _partitions;
+    bool _partitioned = false;
+
+    SpillStats _spillStats;
+
     std::pair<Value, Value> _firstPartOfNextGroup;
-    // Only used when '_sorted' is true.
+    // Only used when '_streaming' is true. The first document of the next run.
     boost::optional<Document> _firstDocOfNextGroup;
 };
 
@@ -31,6 +31,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <deque>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -47,12 +48,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -139,6 +142,101 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+/**
+ * Groups 'numDocs' documents into 'numGroups' groups by {_id: '$key', count: {$sum: 1}, first:
+ * {$first: '$seq'}} with a memory limit small enough to make the $group spill, and checks that
+ * every group is returned with the right values.
+ */
+intrusive_ptr<DocumentSourceGroup> runSpillingGroup(const intrusive_ptr<ExpressionContext>& expCtx,
+                                                    int numDocs,
+                                                    int numGroups) {
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionConstant::create(expCtx, Value(1)),
+                                         AccumulationStatement::getFactory("$sum")};
+    AccumulationStatement firstStatement{"first",
+                                         ExpressionFieldPath::parse(expCtx, "$seq", vps),
+                                         AccumulationStatement::getFactory("$first")};
+    auto group = DocumentSourceGroup::create(expCtx,
+                                             ExpressionFieldPath::parse(expCtx, "$key", vps),
+                                             {countStatement, firstStatement},
+                                             /*maxMemoryUsageBytes=*/1000);
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < numDocs; ++i) {
+        inputs.emplace_back(Document{{"key", i % numGroups}, {"seq", i}});
+    }
+    auto mock = DocumentSourceMock::create(std::move(inputs));
+    group->setSource(mock.get());
+
+    stdx::unordered_set<int> idSet;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        const int id = doc["_id"].coerceToInt();
+        idSet.insert(id);
+        ASSERT_VALUE_EQ(doc["count"], Value(numDocs / numGroups));
+        // $first must see the documents in input order even though the group was spilled.
+        ASSERT_VALUE_EQ(doc["first"], Value(id));
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_EQ(idSet.size(), static_cast<size_t>(numGroups));
+
+    return group;
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldSpillToHashPartitionsWhenAllowedToSpill) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    auto group = runSpillingGroup(expCtx, 400, 50);
+    ASSERT_TRUE(group->getSpillStats().usedDisk);
+    ASSERT_GT(group->getSpillStats().partitionsSpilled, 0U);
+    ASSERT_GT(group->getSpillStats().spilledBytes, 0U);
+
+    // Hash partitioned output is not sorted by _id.
+    ASSERT_EQ(group->getOutputSorts().size(), 0U);
+
+    vector<Value> explained;
+    group->serializeToArray(explained, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_EQ(explained.size(), 1UL);
+    ASSERT_VALUE_EQ(explained[0]["usedDisk"], Value(true));
+    ASSERT_VALUE_EQ(explained[0]["partitionsSpilled"],
+                    Value(static_cast<long long>(group->getSpillStats().partitionsSpilled)));
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldSplitSpilledPartitionsWhichDoNotFitInMemory) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    // With only two partitions, each one holds too many groups to be re-aggregated within the
+    // memory limit.
+    const int originalPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    internalDocumentSourceGroupSpillPartitions.store(2);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(originalPartitions); });
+
+    auto group = runSpillingGroup(expCtx, 400, 100);
+    ASSERT_GT(group->getSpillStats().partitionsSpilled, 2U);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldSpillSortedRunsIfHashPartitioningIsDisabled) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int originalPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    internalDocumentSourceGroupSpillPartitions.store(0);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(originalPartitions); });
+
+    auto group = runSpillingGroup(expCtx, 400, 50);
+    ASSERT_TRUE(group->getSpillStats().usedDisk);
+    ASSERT_EQ(group->getSpillStats().partitionsSpilled, 0U);
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -780,6 +878,7 @@ public:
         createGroup(BSON("_id"
                          << "$a"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         auto res = group()->getNext();
         ASSERT_TRUE(res.isAdvanced());
@@ -815,6 +914,7 @@ public:
 
         createGroup(fromjson("{_id: {x: '$a', y: '$b'}}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         auto res = group()->getNext();
         ASSERT_TRUE(res.isAdvanced());
@@ -855,6 +955,7 @@ public:
 
         createGroup(fromjson("{_id: {x: {y: {z: '$a.b.c', q: '$a.b.d'}}, v: '$d'}}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         auto res = group()->getNext();
         ASSERT_TRUE(res.isAdvanced());
@@ -891,6 +992,7 @@ public:
 
         createGroup(fromjson("{_id: {sub: {x: '$a', y: '$b', z: '$a'}}}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         auto res = group()->getNext();
         ASSERT_TRUE(res.isAdvanced());
@@ -926,6 +1028,7 @@ public:
 
         createGroup(fromjson("{_id: {sub: {x: '$a', y: '$b', z: {$literal: 'c'}}}}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         auto res = group()->getNext();
         ASSERT_TRUE(res.isAdvanced());
@@ -959,6 +1062,7 @@ public:
 
         createGroup(fromjson("{_id: '$$ROOT.a'}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         group()->getNext();
         ASSERT_TRUE(group()->isStreaming());
@@ -979,6 +1083,7 @@ public:
 
         createGroup(fromjson("{_id: 1}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         group()->getNext();
         ASSERT_TRUE(group()->isStreaming());
@@ -996,6 +1101,7 @@ public:
 
         createGroup(fromjson("{_id: {}}"));
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         group()->getNext();
         ASSERT_TRUE(group()->isStreaming());
@@ -1023,6 +1129,7 @@ public:
                     inShard,
                     inMongos);
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         group()->getNext();
         ASSERT_FALSE(group()->isStreaming());
@@ -1050,6 +1157,7 @@ public:
                     inShard,
                     inMongos);
         group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
 
         group()->getNext();
         ASSERT_FALSE(group()->isStreaming());
@@ -1081,6 +1189,85 @@ public:
     }
 };
 
+class NoOptimizationWithoutStreamableInputSorts : public Base {
+public:
+    void run() {
+        auto source = DocumentSourceMock::create({"{a: 1}", "{a: 2}", "{a: 3}"});
+        source->sorts = {BSON("a" << 1)};
+
+        // The sorts of the input are not known to keep equal values adjacent.
+        createGroup(BSON("_id"
+                         << "$a"));
+        group()->setSource(source.get());
+
+        group()->getNext();
+        ASSERT_FALSE(group()->isStreaming());
+    }
+};
+
+class StreamingKeepsNullishGroupsOfOneRunTogether : public Base {
+public:
+    void run() {
+        // An index scan returns documents with a null and a missing 'a' interleaved, but they are
+        // different groups.
+        auto source = DocumentSourceMock::create({"{a: null, b: 1, c: 1}",
+                                                  "{b: 1, c: 2}",
+                                                  "{a: null, b: 1, c: 4}",
+                                                  "{a: 1, b: 1, c: 8}"});
+        source->sorts = {BSON("a" << 1 << "b" << 1)};
+
+        createGroup(fromjson("{_id: {x: '$a', y: '$b'}, sum: {$sum: '$c'}}"));
+        group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
+
+        // The groups of the first run may be returned in any order.
+        std::set<int> firstRunSums;
+        for (int i = 0; i < 2; ++i) {
+            auto res = group()->getNext();
+            ASSERT_TRUE(res.isAdvanced());
+            ASSERT_TRUE(res.getDocument().getField("_id")["x"].nullish());
+            firstRunSums.insert(res.getDocument().getField("sum").coerceToInt());
+        }
+        ASSERT_TRUE(group()->isStreaming());
+        ASSERT_TRUE((firstRunSums == std::set<int>{2, 5}));
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id")["x"], Value(1));
+        ASSERT_VALUE_EQ(res.getDocument().getField("sum"), Value(8));
+
+        assertEOF(group());
+    }
+};
+
+class StreamingResumesRunAfterPause : public Base {
+public:
+    void run() {
+        auto source =
+            DocumentSourceMock::create({Document{{"a", 1}, {"b", 1}},
+                                        DocumentSource::GetNextResult::makePauseExecution(),
+                                        Document{{"a", 1}, {"b", 2}},
+                                        Document{{"a", 2}, {"b", 4}}});
+        source->sorts = {BSON("a" << 1)};
+
+        createGroup(fromjson("{_id: '$a', sum: {$sum: '$b'}}"));
+        group()->setSource(source.get());
+        group()->setStreamableInputSorts(source->sorts);
+
+        ASSERT_TRUE(group()->getNext().isPaused());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.getDocument(), Document(fromjson("{_id: 1, sum: 3}")));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.getDocument(), Document(fromjson("{_id: 2, sum: 4}")));
+
+        assertEOF(group());
+    }
+};
+
 /**
  * A string constant (not a field path) as an _id expression and passed to an accumulator.
  * SERVER-6766
@@ -1157,8 +1344,6 @@ public:
         add<Dependencies>();
         add<StringConstantIdAndAccumulatorExpressions>();
         add<ArrayConstantAccumulatorExpression>();
-#if 0
-        // Disabled tests until SERVER-23318 is implemented.
         add<StreamingOptimization>();
         add<StreamingWithMultipleIdFields>();
         add<NoOptimizationIfMissingDoubleSort>();
@@ -1170,7 +1355,9 @@ public:
         add<StreamingWithRootSubfield>();
         add<StreamingWithConstantAndFieldPath>();
         add<StreamingWithFieldRepeated>();
-#endif
+        add<NoOptimizationWithoutStreamableInputSorts>();
+        add<StreamingKeepsNullishGroupsOfOneRunTogether>();
+        add<StreamingResumesRunAfterPause>();
     }
 };
 
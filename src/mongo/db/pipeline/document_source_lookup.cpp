@@ -26,13 +26,17 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
 #include "mongo/base/init.h"
+#include "mongo/db/bson/dotted_path_support.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
@@ -40,6 +44,8 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/stringutils.h"
 
 namespace mongo {
 
@@ -210,7 +216,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
         return unwindResult();
     }
 
-    auto nextInput = pSource->getNext();
+    auto nextInput = getNextInput(BSONObj());
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
@@ -221,27 +227,44 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
+    std::vector<Value> results;
+    int objsize = 0;
+    auto appendResult = [&](Document result) {
+        objsize += result.getApproximateSize();
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching pipeline "
+                              << getUserPipelineDefinition()
+                              << " exceeds maximum document size",
+                objsize <= BSONObjMaxInternalSize);
+        results.emplace_back(std::move(result));
+    };
+
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
         // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
         _resolvedPipeline.back() = matchStage;
-    }
 
-    auto pipeline = buildPipeline(inputDoc);
+        boost::optional<std::vector<Document>> joined = std::move(_batchedJoinResults);
+        if (!joined && _joinStrategy == JoinStrategy::kHashJoin) {
+            joined = probeHashJoinTable(*_hashJoinTable, inputDoc, matchStage);
+        }
 
-    std::vector<Value> results;
-    int objsize = 0;
+        if (joined) {
+            for (auto&& result : *joined) {
+                appendResult(std::move(result));
+            }
 
+            MutableDocument output(std::move(inputDoc));
+            output.setNestedField(_as, Value(std::move(results)));
+            return output.freeze();
+        }
+    }
+
+    auto pipeline = buildPipeline(inputDoc);
     while (auto result = pipeline->getNext()) {
-        objsize += result->getApproximateSize();
-        uassert(4568,
-                str::stream() << "Total size of documents in " << _fromNs.coll()
-                              << " matching pipeline "
-                              << getUserPipelineDefinition()
-                              << " exceeds maximum document size",
-                objsize <= BSONObjMaxInternalSize);
-        results.emplace_back(std::move(*result));
+        appendResult(std::move(*result));
     }
 
     MutableDocument output(std::move(inputDoc));
@@ -249,6 +272,269 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     return output.freeze();
 }
 
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextInput(const BSONObj& filter) {
+    _batchedJoinResults = boost::none;
+
+    if (_batch.empty() && !_batchEndResult) {
+        if (_joinStrategy == JoinStrategy::kBatched) {
+            loadNextBatch(filter);
+        } else {
+            auto nextInput = pSource->getNext();
+            if (!nextInput.isAdvanced() || _joinStrategy != JoinStrategy::kUndecided) {
+                return nextInput;
+            }
+
+            // Now that there is input to join, decide how to join it.
+            chooseJoinStrategy(filter);
+            if (_joinStrategy != JoinStrategy::kBatched) {
+                return nextInput;
+            }
+
+            _batch.emplace_back(nextInput.releaseDocument());
+            loadNextBatch(filter);
+        }
+    }
+
+    if (_batch.empty()) {
+        auto batchEndResult = std::move(*_batchEndResult);
+        _batchEndResult = boost::none;
+        return batchEndResult;
+    }
+
+    auto next = std::move(_batch.front());
+    _batch.pop_front();
+    _batchedJoinResults = std::move(next.joined);
+    return std::move(next.input);
+}
+
+void DocumentSourceLookUp::chooseJoinStrategy(const BSONObj& filter) {
+    invariant(_joinStrategy == JoinStrategy::kUndecided);
+
+    if (canUseHashJoin()) {
+        auto pipeline = uassertStatusOK(pExpCtx->mongoProcessInterface->makePipeline(
+            {BSON("$match" << filter)}, _fromExpCtx));
+        _hashJoinTable = loadHashJoinTable(pipeline.get());
+        if (_hashJoinTable) {
+            _joinStrategy = JoinStrategy::kHashJoin;
+            return;
+        }
+        LOG(1) << "$lookup from " << _resolvedNs.ns() << " exceeded the hash join limit of "
+               << internalDocumentSourceLookupHashJoinMaxBytes.load() << " bytes";
+    }
+
+    _joinStrategy = canJoinInMemory() && internalDocumentSourceLookupBatchSize.load() > 1
+        ? JoinStrategy::kBatched
+        : JoinStrategy::kPerDocumentQuery;
+}
+
+bool DocumentSourceLookUp::canJoinInMemory() const {
+    if (wasConstructedWithPipelineSyntax() || pExpCtx->inMongos) {
+        return false;
+    }
+
+    for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+        if (parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DocumentSourceLookUp::canUseHashJoin() const {
+    if (!canJoinInMemory() || internalDocumentSourceLookupHashJoinMaxBytes.load() <= 0) {
+        return false;
+    }
+
+    // Unless the foreign namespace is a view, '_resolvedPipeline' holds nothing but the placeholder
+    // for the $match we construct from each input document.
+    if (_resolvedPipeline.size() != 1) {
+        return false;
+    }
+
+    // An index on 'foreignField' answers each per-document query without reading the whole
+    // collection, which is cheaper than materializing the collection in memory.
+    const auto indexes = pExpCtx->mongoProcessInterface->getIndexStats(_fromExpCtx->opCtx,
+                                                                      _resolvedNs);
+    for (auto&& index : indexes) {
+        const auto leadingField = index.second.indexKey.firstElement();
+        if (leadingField && leadingField.fieldNameStringData() == _foreignField->fullPath()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DocumentSourceLookUp::loadNextBatch(const BSONObj& filter) {
+    invariant(!_batchEndResult);
+
+    const size_t batchSize = std::max(1, internalDocumentSourceLookupBatchSize.load());
+    while (_batch.size() < batchSize) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            _batchEndResult = std::move(nextInput);
+            break;
+        }
+        _batch.emplace_back(nextInput.releaseDocument());
+    }
+
+    if (_batch.empty()) {
+        return;
+    }
+
+    // Collect the distinct join values of the whole batch. They are sorted so that an index on
+    // 'foreignField' is scanned in a single ordered pass.
+    auto values = _fromExpCtx->getValueComparator().makeOrderedValueSet();
+    for (auto&& batched : _batch) {
+        bool sawValue = false;
+        document_path_support::visitAllValuesAtPath(
+            batched.input, *_localField, [&](const Value& value) {
+                sawValue = true;
+                values.insert(value);
+            });
+
+        if (!sawValue) {
+            // Missing values are treated as null.
+            values.insert(Value(BSONNULL));
+        }
+    }
+
+    BSONArrayBuilder valuesBuilder;
+    for (auto&& value : values) {
+        valuesBuilder << value;
+    }
+    _resolvedPipeline.back() =
+        makeMatchStageFromValues(valuesBuilder.arr(), _foreignField->fullPath(), filter);
+
+    auto pipeline = buildPipeline(Document());
+    auto table = loadHashJoinTable(pipeline.get());
+    _usedBatchedLookup = true;
+
+    if (!table) {
+        // The documents joined with this batch do not fit in memory at once. Join each input
+        // document on its own from now on.
+        LOG(1) << "$lookup from " << _resolvedNs.ns() << " joined more than "
+               << internalDocumentSourceLookupHashJoinMaxBytes.load()
+               << " bytes with one batch, querying the foreign collection per document";
+        _joinStrategy = JoinStrategy::kPerDocumentQuery;
+        return;
+    }
+
+    for (auto&& batched : _batch) {
+        auto matchStage = makeMatchStageFromInput(
+            batched.input, *_localField, _foreignField->fullPath(), filter);
+        batched.joined = probeHashJoinTable(*table, batched.input, matchStage);
+    }
+}
+
+std::unique_ptr<DocumentSourceLookUp::HashJoinTable> DocumentSourceLookUp::loadHashJoinTable(
+    Pipeline* pipeline) {
+    const size_t maxMemoryUsageBytes = internalDocumentSourceLookupHashJoinMaxBytes.load();
+    const auto foreignPath = _foreignField->fullPath();
+
+    auto table = stdx::make_unique<HashJoinTable>(_fromExpCtx->getValueComparator());
+    auto addKey = [&table](const BSONElement& key, size_t position) {
+        auto& positions = table->positionsByKey[Value(key)];
+        if (positions.empty()) {
+            table->memoryUsageBytes += Value(key).getApproximateSize();
+        }
+        positions.push_back(position);
+        table->memoryUsageBytes += sizeof(size_t);
+    };
+
+    while (auto result = pipeline->getNext()) {
+        const size_t position = table->documents.size();
+        table->documents.push_back(result->toBson());
+        const BSONObj& foreignDoc = table->documents.back();
+        table->memoryUsageBytes += foreignDoc.objsize();
+
+        // Collect each value at 'foreignField', keeping arrays at the end of the path intact so
+        // that both the whole array and its elements can be keyed, as an equality match would.
+        BSONElementSet elements;
+        std::set<size_t> arrayComponents;
+        dotted_path_support::extractAllElementsAlongPath(
+            foreignDoc, foreignPath, elements, false, &arrayComponents);
+
+        // An equality match on null also matches documents on which the path is missing. That is
+        // hard to rule out once an array is traversed, so such documents are always candidates.
+        bool mayMatchNull = elements.empty() || !arrayComponents.empty();
+        for (auto&& elem : elements) {
+            if (elem.isNull() || elem.type() == BSONType::Undefined) {
+                mayMatchNull = true;
+                continue;
+            }
+            addKey(elem, position);
+
+            if (elem.type() == BSONType::Array) {
+                for (auto&& arrayElem : elem.Obj()) {
+                    if (arrayElem.isNull() || arrayElem.type() == BSONType::Undefined) {
+                        mayMatchNull = true;
+                    } else {
+                        addKey(arrayElem, position);
+                    }
+                }
+            }
+        }
+
+        if (mayMatchNull) {
+            table->nullCandidates.push_back(position);
+            table->memoryUsageBytes += sizeof(size_t);
+        }
+
+        if (table->memoryUsageBytes > maxMemoryUsageBytes) {
+            return nullptr;
+        }
+    }
+
+    return table;
+}
+
+std::vector<Document> DocumentSourceLookUp::probeHashJoinTable(const HashJoinTable& table,
+                                                               const Document& inputDoc,
+                                                               const BSONObj& matchStage) {
+    // Parse the query first, so that an invalid local value fails just as it would if the query
+    // were run against the foreign collection.
+    auto matcher = uassertStatusOK(
+        MatchExpressionParser::parse(matchStage.firstElement().embeddedObject(), _fromExpCtx));
+
+    std::vector<size_t> candidates;
+    auto addCandidates = [&candidates](const std::vector<size_t>& positions) {
+        candidates.insert(candidates.end(), positions.begin(), positions.end());
+    };
+
+    bool sawValue = false;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        sawValue = true;
+        if (value.nullish()) {
+            addCandidates(table.nullCandidates);
+            return;
+        }
+        auto it = table.positionsByKey.find(value);
+        if (it != table.positionsByKey.end()) {
+            addCandidates(it->second);
+        }
+    });
+
+    if (!sawValue) {
+        // Missing values are treated as null.
+        addCandidates(table.nullCandidates);
+    }
+
+    // Return each document once, in the order it was read from the foreign collection.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<Document> results;
+    for (auto position : candidates) {
+        const BSONObj& foreignDoc = table.documents[position];
+        if (matcher->matchesBSON(foreignDoc)) {
+            results.emplace_back(foreignDoc);
+        }
+    }
+    return results;
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -433,6 +719,10 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoinTable.reset();
+    _batch.clear();
+    _batchedJoinResults = boost::none;
+    _bufferedJoinResults.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -443,21 +733,28 @@ BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
     // field with an array in its path, we may need to join on multiple values, so we add each
     // element to 'localFieldList'.
     BSONArrayBuilder arrBuilder;
-    bool containsRegex = false;
-    document_path_support::visitAllValuesAtPath(input, localFieldPath, [&](const Value& nextValue) {
-        arrBuilder << nextValue;
-        if (!containsRegex && nextValue.getType() == BSONType::RegEx) {
-            containsRegex = true;
-        }
-    });
+    document_path_support::visitAllValuesAtPath(
+        input, localFieldPath, [&](const Value& nextValue) { arrBuilder << nextValue; });
 
     if (arrBuilder.arrSize() == 0) {
         // Missing values are treated as null.
         arrBuilder << BSONNULL;
     }
 
-    const auto localFieldListSize = arrBuilder.arrSize();
-    const auto localFieldList = arrBuilder.arr();
+    return makeMatchStageFromValues(arrBuilder.arr(), foreignFieldName, additionalFilter);
+}
+
+BSONObj DocumentSourceLookUp::makeMatchStageFromValues(const BSONArray& localFieldList,
+                                                       const std::string& foreignFieldName,
+                                                       const BSONObj& additionalFilter) {
+    invariant(!localFieldList.isEmpty());
+
+    bool containsRegex = false;
+    int localFieldListSize = 0;
+    for (auto&& value : localFieldList) {
+        containsRegex = containsRegex || value.type() == BSONType::RegEx;
+        ++localFieldListSize;
+    }
 
     // We construct a query of one of the following forms, depending on the contents of
     // 'localFieldList'.
@@ -525,35 +822,50 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
-        auto nextInput = pSource->getNext();
+    while (!_nextValue) {
+        const BSONObj filter = _additionalFilter.value_or(BSONObj());
+        auto nextInput = getNextInput(filter);
         if (!nextInput.isAdvanced()) {
             return nextInput;
         }
 
         _input = nextInput.releaseDocument();
 
+        if (_pipeline) {
+            _pipeline->dispose(pExpCtx->opCtx);
+            _pipeline.reset();
+        }
+
+        bool joinedInMemory = false;
         if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
             auto matchStage =
                 makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
             // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
             _resolvedPipeline.back() = matchStage;
-        }
 
-        if (_pipeline) {
-            _pipeline->dispose(pExpCtx->opCtx);
+            boost::optional<std::vector<Document>> joined = std::move(_batchedJoinResults);
+            if (!joined && _joinStrategy == JoinStrategy::kHashJoin) {
+                joined = probeHashJoinTable(*_hashJoinTable, *_input, matchStage);
+            }
+
+            if (joined) {
+                _bufferedJoinResults.assign(std::make_move_iterator(joined->begin()),
+                                            std::make_move_iterator(joined->end()));
+                joinedInMemory = true;
+            }
         }
 
-        _pipeline = buildPipeline(*_input);
+        if (!joinedInMemory) {
+            _pipeline = buildPipeline(*_input);
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = getNextJoinedDocument();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -571,7 +883,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = getNextJoinedDocument();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -585,6 +897,19 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     return output.freeze();
 }
 
+boost::optional<Document> DocumentSourceLookUp::getNextJoinedDocument() {
+    if (_pipeline) {
+        return _pipeline->getNext();
+    }
+
+    if (_bufferedJoinResults.empty()) {
+        return boost::none;
+    }
+    auto next = std::move(_bufferedJoinResults.front());
+    _bufferedJoinResults.pop_front();
+    return next;
+}
+
 void DocumentSourceLookUp::copyVariablesToExpCtx(const Variables& vars,
                                                  const VariablesParseState& vps,
                                                  ExpressionContext* expCtx) {
@@ -662,6 +987,12 @@ void DocumentSourceLookUp::serializeToArray(
             output[getSourceName()]["matching"] = Value(*_additionalFilter);
         }
 
+        if (!wasConstructedWithPipelineSyntax() &&
+            *explain >= ExplainOptions::Verbosity::kExecStats) {
+            output[getSourceName()]["usedHashJoin"] = Value(usedHashJoin());
+            output[getSourceName()]["usedBatchedLookup"] = Value(usedBatchedLookup());
+        }
+
         array.push_back(Value(output.freeze()));
     } else {
         array.push_back(Value(output.freeze()));
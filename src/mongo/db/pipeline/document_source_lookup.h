@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_match.h"
@@ -158,6 +159,14 @@ public:
                                            const std::string& foreignFieldName,
                                            const BSONObj& additionalFilter);
 
+    /**
+     * Builds the $match used to query the foreign collection for documents whose 'foreignFieldName'
+     * equals any of the values in the non-empty array 'localFieldList'.
+     */
+    static BSONObj makeMatchStageFromValues(const BSONArray& localFieldList,
+                                            const std::string& foreignFieldName,
+                                            const BSONObj& additionalFilter);
+
     /**
      * Helper to absorb an $unwind stage. Only used for testing this special behavior.
      */
@@ -186,6 +195,22 @@ public:
         return buildPipeline(inputDoc);
     }
 
+    /**
+     * Returns true if this stage has joined its input against an in-memory hash table of the
+     * foreign collection, rather than querying the foreign collection once per input document.
+     */
+    bool usedHashJoin() const {
+        return _joinStrategy == JoinStrategy::kHashJoin;
+    }
+
+    /**
+     * Returns true if this stage has queried the foreign collection once per batch of input
+     * documents, rather than once per input document.
+     */
+    bool usedBatchedLookup() const {
+        return _usedBatchedLookup;
+    }
+
 protected:
     void doDispose() final;
 
@@ -197,6 +222,46 @@ protected:
                                                      Pipeline::SourceContainer* container) final;
 
 private:
+    /**
+     * How the documents of the foreign collection are joined with the input documents. The
+     * strategy is chosen once the first input document arrives, after the stage is optimized.
+     */
+    enum class JoinStrategy {
+        kUndecided,         // No input document has arrived yet.
+        kHashJoin,          // The foreign collection has been loaded into '_hashJoinTable'.
+        kBatched,           // Batches of input documents are joined using one query per batch.
+        kPerDocumentQuery,  // The foreign pipeline is run once per input document.
+    };
+
+    /**
+     * An in-memory copy of foreign documents, indexed by each value at the 'foreignField'
+     * path. Since an equality match on null also matches documents on which the path is missing,
+     * documents which may match null are tracked separately in 'nullCandidates' rather than under
+     * a key.
+     */
+    struct HashJoinTable {
+        explicit HashJoinTable(const ValueComparator& comparator)
+            : positionsByKey(comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+        // The foreign documents, in the order in which the foreign collection returned them.
+        std::vector<BSONObj> documents;
+        ValueUnorderedMap<std::vector<size_t>> positionsByKey;
+        std::vector<size_t> nullCandidates;
+        size_t memoryUsageBytes = 0;
+    };
+
+    /**
+     * An input document read ahead as part of a batch, along with the foreign documents it joins
+     * with.
+     */
+    struct BatchedInput {
+        explicit BatchedInput(Document input) : input(std::move(input)) {}
+
+        Document input;
+        // boost::none if 'input' must be joined by querying the foreign collection on its own.
+        boost::optional<std::vector<Document>> joined;
+    };
+
     struct LetVariable {
         LetVariable(std::string name, boost::intrusive_ptr<Expression> expression, Variables::Id id)
             : name(std::move(name)), expression(std::move(expression)), id(id) {}
@@ -243,6 +308,61 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Returns the next foreign document joined with the current input document while unwinding,
+     * or boost::none once they are exhausted.
+     */
+    boost::optional<Document> getNextJoinedDocument();
+
+    /**
+     * Returns the next result from the source. When input documents are joined in batches, a
+     * batch is read ahead as needed, and the documents joined with the returned input document
+     * are stored in '_batchedJoinResults'. 'filter' is an additional predicate the foreign
+     * documents must satisfy, and must be the same on every call.
+     */
+    GetNextResult getNextInput(const BSONObj& filter);
+
+    /**
+     * Sets '_joinStrategy', building the hash table if this $lookup executes as a hash join.
+     */
+    void chooseJoinStrategy(const BSONObj& filter);
+
+    /**
+     * Returns true if foreign documents retrieved by a query other than the per-document one can
+     * be joined with input documents in memory. Requires localField/foreignField syntax and a
+     * 'foreignField' without numeric path components, which may address array positions.
+     */
+    bool canJoinInMemory() const;
+
+    /**
+     * Returns true if this $lookup may be executed as a hash join: the foreign namespace must not
+     * be a view, and the foreign collection must have no index which could answer the
+     * per-document equality queries.
+     */
+    bool canUseHashJoin() const;
+
+    /**
+     * Reads the input documents of the next batch into '_batch', and queries the foreign
+     * collection once for the documents joining with any of them.
+     */
+    void loadNextBatch(const BSONObj& filter);
+
+    /**
+     * Reads every document returned by 'pipeline' into a hash table keyed on 'foreignField'.
+     * Returns nullptr if the table would exceed the 'internalDocumentSourceLookupHashJoinMaxBytes'
+     * limit.
+     */
+    std::unique_ptr<HashJoinTable> loadHashJoinTable(Pipeline* pipeline);
+
+    /**
+     * Returns the foreign documents from 'table' which join with 'inputDoc' and satisfy
+     * 'matchStage', the $match which would otherwise be run against the foreign collection. They
+     * are returned in the order in which they were read from the foreign collection.
+     */
+    std::vector<Document> probeHashJoinTable(const HashJoinTable& table,
+                                             const Document& inputDoc,
+                                             const BSONObj& matchStage);
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -322,6 +442,23 @@ private:
 
     std::vector<LetVariable> _letVariables;
 
+    JoinStrategy _joinStrategy = JoinStrategy::kUndecided;
+    std::unique_ptr<HashJoinTable> _hashJoinTable;
+
+    // Input documents read ahead when joining in batches, and the non-advanced result which ended
+    // the most recent batch, if any. The latter is returned once '_batch' is drained.
+    std::deque<BatchedInput> _batch;
+    boost::optional<GetNextResult> _batchEndResult;
+    // The documents joined with the input document most recently returned by getNextInput(), if
+    // it was joined as part of a batch.
+    boost::optional<std::vector<Document>> _batchedJoinResults;
+    bool _usedBatchedLookup = false;
+
+    // Used in place of '_pipeline' to hold the joined documents across getNext() calls when
+    // '_unwindSrc' is not null and they have already been retrieved, in which case '_pipeline' is
+    // null.
+    std::deque<Document> _bufferedJoinResults;
+
     boost::intrusive_ptr<DocumentSourceMatch> _matchSrc;
     boost::intrusive_ptr<DocumentSourceUnwind> _unwindSrc;
 
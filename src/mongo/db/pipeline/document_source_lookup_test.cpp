@@ -47,6 +47,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -497,10 +498,30 @@ public:
         return false;
     }
 
+    CollectionIndexUsageMap getIndexStats(OperationContext* opCtx,
+                                          const NamespaceString& ns) final {
+        return _indexStats;
+    }
+
+    /**
+     * Returns the number of pipelines constructed through this interface.
+     */
+    int numPipelinesMade() const {
+        return _numPipelinesMade;
+    }
+
+    /**
+     * Makes the mocked foreign collection report an index with key pattern 'keyPattern'.
+     */
+    void addIndex(StringData name, const BSONObj& keyPattern) {
+        _indexStats[name] = CollectionIndexUsageTracker::IndexUsageStats(Date_t(), keyPattern);
+    }
+
     StatusWith<std::unique_ptr<Pipeline, PipelineDeleter>> makePipeline(
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         const MakePipelineOptions opts) final {
+        ++_numPipelinesMade;
         auto pipeline = Pipeline::parse(rawPipeline, expCtx);
         if (!pipeline.isOK()) {
             return pipeline.getStatus();
@@ -535,6 +556,8 @@ public:
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    CollectionIndexUsageMap _indexStats;
+    int _numPipelinesMade = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -1105,5 +1128,249 @@ TEST_F(DocumentSourceLookUpTest, ShouldNotCacheIfCorrelatedStageIsAbsorbedIntoPl
     ASSERT_VALUE_EQ(Value(subPipeline->writeExplainOps(kExplain)), Value(BSONArray(expectedPipe)));
 }
 
+/**
+ * Runs the localField/foreignField $lookup 'lookupSpec' against the mocked collection 'foreign' on
+ * each of 'localDocs' and returns the results.
+ */
+std::vector<Document> runLocalFieldForeignFieldLookup(
+    const boost::intrusive_ptr<ExpressionContextForTest>& expCtx,
+    const std::shared_ptr<MockMongoInterface>& mongoInterface,
+    const BSONObj& lookupSpec,
+    deque<DocumentSource::GetNextResult> localDocs,
+    bool* usedHashJoin) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    auto mockLocalSource = DocumentSourceMock::create(std::move(localDocs));
+    lookup->setSource(mockLocalSource.get());
+
+    std::vector<Document> results;
+    for (auto next = lookup->getNext(); next.isAdvanced(); next = lookup->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+    *usedHashJoin = lookup->usedHashJoin();
+    lookup->dispose();
+    return results;
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldJoinWithHashTableWhenForeignFieldIsNotIndexed) {
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{fromjson("{_id: 0, b: 1}")},
+        Document{fromjson("{_id: 1, b: [1, 2]}")},
+        Document{fromjson("{_id: 2, b: null}")},
+        Document{fromjson("{_id: 3}")},
+        Document{fromjson("{_id: 4, b: [[1, 2], 3]}")},
+        Document{fromjson("{_id: 5, b: 2.0}")}};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    mongoInterface->addIndex("_id_", BSON("_id" << 1));
+
+    bool usedHashJoin = false;
+    auto results = runLocalFieldForeignFieldLookup(
+        getExpCtx(),
+        mongoInterface,
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'as'}}"),
+        {Document{fromjson("{_id: 0, a: 1}")},
+         Document{fromjson("{_id: 1, a: [2, 3]}")},
+         Document{fromjson("{_id: 2}")},
+         Document{fromjson("{_id: 3, a: [[1, 2]]}")},
+         Document{fromjson("{_id: 4, a: 'x'}")}},
+        &usedHashJoin);
+
+    ASSERT_TRUE(usedHashJoin);
+    ASSERT_EQ(results.size(), 5UL);
+    ASSERT_DOCUMENT_EQ(
+        results[0],
+        Document{fromjson("{_id: 0, a: 1, as: [{_id: 0, b: 1}, {_id: 1, b: [1, 2]}]}")});
+    ASSERT_DOCUMENT_EQ(
+        results[1],
+        Document{fromjson("{_id: 1, a: [2, 3], as: [{_id: 1, b: [1, 2]}, {_id: 4, b: [[1, 2], 3]}, "
+                          "{_id: 5, b: 2.0}]}")});
+    ASSERT_DOCUMENT_EQ(results[2],
+                       Document{fromjson("{_id: 2, as: [{_id: 2, b: null}, {_id: 3}]}")});
+    ASSERT_DOCUMENT_EQ(
+        results[3],
+        Document{fromjson("{_id: 3, a: [[1, 2]], as: [{_id: 1, b: [1, 2]}, {_id: 4, b: [[1, 2], "
+                          "3]}]}")});
+    ASSERT_DOCUMENT_EQ(results[4], Document{fromjson("{_id: 4, a: 'x', as: []}")});
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldNotJoinWithHashTableWhenForeignFieldIsIndexed) {
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{fromjson("{_id: 0, b: 1}")},
+                                                             Document{fromjson("{_id: 1, b: 2}")}};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    mongoInterface->addIndex("b_1_c_1", BSON("b" << 1 << "c" << 1));
+
+    bool usedHashJoin = true;
+    auto results = runLocalFieldForeignFieldLookup(
+        getExpCtx(),
+        mongoInterface,
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'as'}}"),
+        {Document{fromjson("{_id: 0, a: 2}")}},
+        &usedHashJoin);
+
+    ASSERT_FALSE(usedHashJoin);
+    ASSERT_EQ(results.size(), 1UL);
+    ASSERT_DOCUMENT_EQ(results[0], Document{fromjson("{_id: 0, a: 2, as: [{_id: 1, b: 2}]}")});
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldQueryPerDocumentWhenHashJoinExceedsMemoryLimit) {
+    const auto originalMaxBytes = internalDocumentSourceLookupHashJoinMaxBytes.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceLookupHashJoinMaxBytes.store(originalMaxBytes); });
+    internalDocumentSourceLookupHashJoinMaxBytes.store(64);
+
+    deque<DocumentSource::GetNextResult> mockForeignContents;
+    for (int i = 0; i < 10; ++i) {
+        mockForeignContents.push_back(Document{{"_id", i}, {"b", i % 2}});
+    }
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+
+    bool usedHashJoin = true;
+    auto results = runLocalFieldForeignFieldLookup(
+        getExpCtx(),
+        mongoInterface,
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'as'}}"),
+        {Document{fromjson("{_id: 0, a: 1}")}},
+        &usedHashJoin);
+
+    ASSERT_FALSE(usedHashJoin);
+    ASSERT_EQ(results.size(), 1UL);
+    ASSERT_VALUE_EQ(results[0]["as"],
+                    Value(std::vector<Value>{Value(Document{{"_id", 1}, {"b", 1}}),
+                                             Value(Document{{"_id", 3}, {"b", 1}}),
+                                             Value(Document{{"_id", 5}, {"b", 1}}),
+                                             Value(Document{{"_id", 7}, {"b", 1}}),
+                                             Value(Document{{"_id", 9}, {"b", 1}})}));
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldUnwindHashJoinResults) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec =
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'as'}}");
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    const bool preserveNullAndEmptyArrays = true;
+    const boost::optional<std::string> includeArrayIndex = std::string("idx");
+    lookup->setUnwindStage(DocumentSourceUnwind::create(
+        expCtx, "as", preserveNullAndEmptyArrays, includeArrayIndex));
+
+    auto mockLocalSource = DocumentSourceMock::create(
+        {Document{fromjson("{_id: 0, a: 1}")}, Document{fromjson("{_id: 1, a: 5}")}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{fromjson("{_id: 0, b: 1}")},
+                                                             Document{fromjson("{_id: 1, b: 2}")},
+                                                             Document{fromjson("{_id: 2, b: 1}")}};
+    expCtx->mongoProcessInterface =
+        std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       Document{fromjson("{_id: 0, a: 1, as: {_id: 0, b: 1}, idx: 0}")});
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       Document{fromjson("{_id: 0, a: 1, as: {_id: 2, b: 1}, idx: 1}")});
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document{fromjson("{_id: 1, a: 5, idx: null}")});
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_TRUE(lookup->usedHashJoin());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldJoinBatchesOfInputDocumentsWithOneQueryEach) {
+    const auto originalBatchSize = internalDocumentSourceLookupBatchSize.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceLookupBatchSize.store(originalBatchSize); });
+    internalDocumentSourceLookupBatchSize.store(3);
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{fromjson("{_id: 0, b: 1}")},
+        Document{fromjson("{_id: 1, b: [1, 2]}")},
+        Document{fromjson("{_id: 2, b: null}")},
+        Document{fromjson("{_id: 3, b: 3}")}};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    mongoInterface->addIndex("b_1", BSON("b" << 1));
+
+    bool usedHashJoin = true;
+    auto results = runLocalFieldForeignFieldLookup(
+        getExpCtx(),
+        mongoInterface,
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'as'}}"),
+        {Document{fromjson("{_id: 0, a: 1}")},
+         Document{fromjson("{_id: 1, a: 2}")},
+         Document{fromjson("{_id: 2, a: 1}")},
+         Document{fromjson("{_id: 3}")},
+         Document{fromjson("{_id: 4, a: [3, 4]}")}},
+        &usedHashJoin);
+
+    // Five input documents are joined in two batches.
+    ASSERT_FALSE(usedHashJoin);
+    ASSERT_EQ(mongoInterface->numPipelinesMade(), 2);
+    ASSERT_EQ(results.size(), 5UL);
+    ASSERT_DOCUMENT_EQ(
+        results[0],
+        Document{fromjson("{_id: 0, a: 1, as: [{_id: 0, b: 1}, {_id: 1, b: [1, 2]}]}")});
+    ASSERT_DOCUMENT_EQ(results[1], Document{fromjson("{_id: 1, a: 2, as: [{_id: 1, b: [1, 2]}]}")});
+    ASSERT_DOCUMENT_EQ(
+        results[2],
+        Document{fromjson("{_id: 2, a: 1, as: [{_id: 0, b: 1}, {_id: 1, b: [1, 2]}]}")});
+    ASSERT_DOCUMENT_EQ(results[3], Document{fromjson("{_id: 3, as: [{_id: 2, b: null}]}")});
+    ASSERT_DOCUMENT_EQ(results[4], Document{fromjson("{_id: 4, a: [3, 4], as: [{_id: 3, b: 3}]}")});
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldReturnBatchedDocumentsBeforePropagatingPauses) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec =
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'as'}}");
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"a", 0}},
+                                    Document{{"a", 1}},
+                                    DocumentSource::GetNextResult::makePauseExecution(),
+                                    Document{{"a", 2}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"b", 1}}};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    mongoInterface->addIndex("b_1", BSON("b" << 1));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document{fromjson("{a: 0, as: []}")});
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document{fromjson("{a: 1, as: [{b: 1}]}")});
+
+    ASSERT_TRUE(lookup->getNext().isPaused());
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document{fromjson("{a: 2, as: []}")});
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_TRUE(lookup->usedBatchedLookup());
+    ASSERT_EQ(mongoInterface->numPipelinesMade(), 2);
+    lookup->dispose();
+}
+
 }  // namespace
 }  // namespace mongo
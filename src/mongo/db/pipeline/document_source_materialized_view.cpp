@@ -0,0 +1,99 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_materialized_view.h"
+
+#include "mongo/db/pipeline/mongo_process_interface.h"
+
+namespace mongo {
+
+constexpr StringData DocumentSourceMaterializedView::kStageName;
+
+REGISTER_DOCUMENT_SOURCE(_internalMaterializedView,
+                         DocumentSourceMaterializedView::LiteParsed::parse,
+                         DocumentSourceMaterializedView::createFromBson);
+
+namespace {
+const char kViewField[] = "view";
+
+NamespaceString parseViewNss(const BSONElement& spec) {
+    const auto stageName = DocumentSourceMaterializedView::kStageName;
+    uassert(50705,
+            str::stream() << stageName << " must be an object of the form {view: <namespace>}",
+            spec.type() == Object && spec.Obj().nFields() == 1 &&
+                spec.Obj()[kViewField].type() == String);
+    NamespaceString viewNss(spec.Obj()[kViewField].valueStringData());
+    uassert(50706,
+            str::stream() << stageName << " was given an invalid namespace: " << viewNss.ns(),
+            viewNss.isValid());
+    return viewNss;
+}
+}  // namespace
+
+std::unique_ptr<DocumentSourceMaterializedView::LiteParsed>
+DocumentSourceMaterializedView::LiteParsed::parse(const AggregationRequest& request,
+                                                  const BSONElement& spec) {
+    return stdx::make_unique<LiteParsed>(parseViewNss(spec));
+}
+
+BSONObj DocumentSourceMaterializedView::createSpec(const NamespaceString& viewNss) {
+    return BSON(kStageName << BSON(kViewField << viewNss.ns()));
+}
+
+boost::intrusive_ptr<DocumentSource> DocumentSourceMaterializedView::createFromBson(
+    BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx) {
+    return new DocumentSourceMaterializedView(pExpCtx, parseViewNss(elem));
+}
+
+DocumentSourceMaterializedView::DocumentSourceMaterializedView(
+    const boost::intrusive_ptr<ExpressionContext>& pExpCtx, NamespaceString viewNss)
+    : DocumentSource(pExpCtx), _viewNss(std::move(viewNss)) {}
+
+DocumentSource::GetNextResult DocumentSourceMaterializedView::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_populated) {
+        _results = pExpCtx->mongoProcessInterface->readMaterializedView(pExpCtx, _viewNss);
+        _resultsIt = _results.begin();
+        _populated = true;
+    }
+
+    if (_resultsIt == _results.end()) {
+        return GetNextResult::makeEOF();
+    }
+    return std::move(*_resultsIt++);
+}
+
+Value DocumentSourceMaterializedView::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(DOC(getSourceName() << DOC(kViewField << _viewNss.ns())));
+}
+
+}  // namespace mongo
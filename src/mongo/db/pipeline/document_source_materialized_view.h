@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/lite_parsed_document_source.h"
+
+namespace mongo {
+
+/**
+ * Produces the incrementally maintained results of the leading stages of a materialized view. The
+ * view catalog substitutes this stage for those stages when resolving the view, so that reading
+ * it does not re-run them over the whole of the view's collection. The maintained results include
+ * every committed write, so reading them requires read concern level "local".
+ */
+class DocumentSourceMaterializedView final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalMaterializedView"_sd;
+
+    class LiteParsed final : public LiteParsedDocumentSource {
+    public:
+        static std::unique_ptr<LiteParsed> parse(const AggregationRequest& request,
+                                                 const BSONElement& spec);
+
+        explicit LiteParsed(NamespaceString viewNss) : _viewNss(std::move(viewNss)) {}
+
+        stdx::unordered_set<NamespaceString> getInvolvedNamespaces() const final {
+            return stdx::unordered_set<NamespaceString>();
+        }
+
+        PrivilegeVector requiredPrivileges(bool isMongos) const final {
+            return {Privilege(ResourcePattern::forExactNamespace(_viewNss), ActionType::find)};
+        }
+
+        bool isInitialSource() const final {
+            return true;
+        }
+
+    private:
+        const NamespaceString _viewNss;
+    };
+
+    /**
+     * Returns the specification of a stage reading the materialized view 'viewNss'.
+     */
+    static BSONObj createSpec(const NamespaceString& viewNss);
+
+    static boost::intrusive_ptr<DocumentSource> createFromBson(
+        BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kLocalOnly,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed);
+
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+private:
+    DocumentSourceMaterializedView(const boost::intrusive_ptr<ExpressionContext>& pExpCtx,
+                                   NamespaceString viewNss);
+
+    const NamespaceString _viewNss;
+
+    bool _populated = false;
+    std::vector<Document> _results;
+    std::vector<Document>::iterator _resultsIt;
+};
+
+}  // namespace mongo
@@ -0,0 +1,293 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_group.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/pipeline_worker_pool.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/future.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+using std::vector;
+
+constexpr StringData DocumentSourceParallelGroup::kStageName;
+
+namespace {
+/**
+ * The names of the stages which transform each document on its own, and which may therefore be
+ * computed by several workers, each over part of the input.
+ */
+const StringData kPerDocumentStages[] = {"$match"_sd,
+                                         "$project"_sd,
+                                         "$addFields"_sd,
+                                         "$replaceRoot"_sd,
+                                         "$unwind"_sd,
+                                         "$redact"_sd};
+
+/**
+ * The accumulators whose result does not depend on the order of the input, other than by
+ * floating point rounding. The workers do not see their documents in the order of the input, so
+ * only these are computed in parallel. Accumulators such as $first, $last, $push and
+ * $mergeObjects depend on the order, as does the digest built by $approxPercentile.
+ */
+const StringData kOrderIndependentAccumulators[] = {"$sum"_sd,
+                                                    "$avg"_sd,
+                                                    "$min"_sd,
+                                                    "$max"_sd,
+                                                    "$addToSet"_sd,
+                                                    "$stdDevPop"_sd,
+                                                    "$stdDevSamp"_sd,
+                                                    "$approxCountDistinct"_sd};
+
+bool isOneOf(StringData name, const StringData* begin, const StringData* end) {
+    return std::find(begin, end, name) != end;
+}
+}  // namespace
+
+DocumentSource::GetNextResult DocumentSourceParallelGroup::Feed::getNext() {
+    if (input.empty()) {
+        return isEOF ? GetNextResult::makeEOF() : GetNextResult::makePauseExecution();
+    }
+    auto next = std::move(input.front());
+    input.pop_front();
+    return std::move(next);
+}
+
+DocumentSourceParallelGroup::DocumentSourceParallelGroup(
+    const intrusive_ptr<ExpressionContext>& expCtx, vector<Worker> workers)
+    : DocumentSource(expCtx), _workers(std::move(workers)) {}
+
+Pipeline::SourceContainer::const_iterator DocumentSourceParallelGroup::findParallelizableGroup(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    Pipeline::SourceContainer::const_iterator begin,
+    Pipeline::SourceContainer::const_iterator end) {
+    for (auto it = begin; it != end; ++it) {
+        auto group = dynamic_cast<DocumentSourceGroup*>(it->get());
+        if (!group) {
+            if (!isOneOf((*it)->getSourceName(),
+                         std::begin(kPerDocumentStages),
+                         std::end(kPerDocumentStages))) {
+                return end;
+            }
+            continue;
+        }
+
+        if (group->canStream() || group->isDoingMerge()) {
+            return end;
+        }
+        for (auto&& accumulatedField : group->getAccumulatedFields()) {
+            if (!isOneOf(accumulatedField.makeAccumulator(expCtx)->getOpName(),
+                         std::begin(kOrderIndependentAccumulators),
+                         std::end(kOrderIndependentAccumulators))) {
+                return end;
+            }
+        }
+        return it;
+    }
+    return end;
+}
+
+intrusive_ptr<DocumentSourceParallelGroup> DocumentSourceParallelGroup::create(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    const Pipeline::SourceContainer& stages,
+    size_t nWorkers) {
+    invariant(nWorkers > 0);
+
+    // The workers hold their partial groups at the same time, so they share the memory limit of
+    // the $group they compute.
+    auto group = dynamic_cast<DocumentSourceGroup*>(stages.back().get());
+    invariant(group);
+    const size_t workerMaxMemoryUsageBytes =
+        std::max(size_t(1), group->getMaxMemoryUsageBytes() / nWorkers);
+
+    vector<Value> serializedStages;
+    for (auto&& stage : stages) {
+        stage->serializeToArray(serializedStages);
+    }
+    vector<BSONObj> rawStages;
+    for (auto&& stage : serializedStages) {
+        rawStages.push_back(stage.getDocument().toBson());
+    }
+
+    vector<Worker> workers(nWorkers);
+    for (auto&& worker : workers) {
+        // Each worker evaluates its expressions with its own variables, and its $group produces
+        // partial groups to be merged.
+        auto workerExpCtx = expCtx->copyWith(expCtx->ns, expCtx->uuid);
+        workerExpCtx->needsMerge = true;
+
+        worker.pipeline = uassertStatusOK(Pipeline::parse(rawStages, workerExpCtx));
+        worker.pipeline->optimizePipeline();
+        auto workerGroup =
+            dynamic_cast<DocumentSourceGroup*>(worker.pipeline->getSources().back().get());
+        invariant(workerGroup);
+        workerGroup->setMaxMemoryUsageBytes(workerMaxMemoryUsageBytes);
+        worker.feed = new Feed(workerExpCtx);
+        worker.pipeline->addInitialSource(worker.feed);
+    }
+    return new DocumentSourceParallelGroup(expCtx, std::move(workers));
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelGroup::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_computedGroups) {
+        computeGroups();
+        _computedGroups = true;
+    }
+
+    for (; _nextWorker < _workers.size(); ++_nextWorker) {
+        auto& results = _workers[_nextWorker].results;
+        if (!results.empty()) {
+            auto next = std::move(results.front());
+            results.pop_front();
+            return std::move(next);
+        }
+    }
+    return GetNextResult::makeEOF();
+}
+
+void DocumentSourceParallelGroup::computeGroups() {
+    const size_t chunkSizeBytes =
+        std::max(1, internalDocumentSourceCursorBatchSizeBytes.load());
+
+    // Reads the next chunk of the input for each worker. Each chunk holds consecutive documents.
+    vector<std::deque<Document>> chunks(_workers.size());
+    bool inputEOF = false;
+    auto readChunks = [&] {
+        for (auto&& chunk : chunks) {
+            size_t chunkBytes = 0;
+            while (chunkBytes < chunkSizeBytes) {
+                auto next = pSource->getNext();
+                if (next.isEOF()) {
+                    inputEOF = true;
+                    return;
+                }
+                // Only a TeeBuffer returns paused inputs, and this stage never follows one.
+                invariant(next.isAdvanced());
+                chunkBytes += next.getDocument().getApproximateSize();
+                chunk.push_back(next.releaseDocument());
+            }
+        }
+    };
+
+    readChunks();
+    bool lastRound = false;
+    while (!lastRound) {
+        lastRound = inputEOF;
+        for (size_t workerId = 0; workerId < _workers.size(); ++workerId) {
+            auto& feed = *_workers[workerId].feed;
+            feed.input = std::move(chunks[workerId]);
+            chunks[workerId].clear();
+            feed.isEOF = lastRound;
+        }
+
+        // The workers process the chunks they were handed while this thread, which alone may use
+        // the OperationContext, reads the next chunks.
+        vector<stdx::future<void>> pending;
+        for (auto&& worker : _workers) {
+            auto workerPtr = &worker;
+            pending.push_back(runOnPipelineWorkerPool([this, workerPtr] { runWorker(workerPtr); }));
+        }
+
+        std::exception_ptr firstError;
+        if (!lastRound) {
+            try {
+                readChunks();
+            } catch (...) {
+                firstError = std::current_exception();
+            }
+        }
+
+        // Every worker must stop using its pipeline before any error escapes.
+        for (auto&& future : pending) {
+            try {
+                future.get();
+            } catch (...) {
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+        }
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+    }
+}
+
+void DocumentSourceParallelGroup::runWorker(Worker* worker) {
+    auto& lastStage = worker->pipeline->getSources().back();
+    auto next = lastStage->getNext();
+    for (; next.isAdvanced(); next = lastStage->getNext()) {
+        worker->results.push_back(next.releaseDocument());
+    }
+}
+
+Value DocumentSourceParallelGroup::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    auto& pipeline = _workers.front().pipeline;
+    MutableDocument spec;
+    spec["workers"] = Value(static_cast<long long>(_workers.size()));
+    spec["pipeline"] =
+        Value(explain ? pipeline->writeExplainOps(*explain) : pipeline->serialize());
+    return Value(Document{{getSourceName(), spec.freezeToValue()}});
+}
+
+void DocumentSourceParallelGroup::detachFromOperationContext() {
+    for (auto&& worker : _workers) {
+        worker.pipeline->detachFromOperationContext();
+    }
+}
+
+void DocumentSourceParallelGroup::reattachToOperationContext(OperationContext* opCtx) {
+    for (auto&& worker : _workers) {
+        worker.pipeline->reattachToOperationContext(opCtx);
+    }
+}
+
+void DocumentSourceParallelGroup::doDispose() {
+    for (auto&& worker : _workers) {
+        worker.pipeline.get_deleter().dismissDisposal();
+        worker.pipeline->dispose(pExpCtx->opCtx);
+        worker.results.clear();
+    }
+}
+
+}  // namespace mongo
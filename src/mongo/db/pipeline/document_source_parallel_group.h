@@ -0,0 +1,162 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/pipeline.h"
+
+namespace mongo {
+
+/**
+ * An internal stage which computes a $group, along with the stages preceding it, on several threads
+ * at once. The input is split into chunks of consecutive documents, and each worker feeds the
+ * chunks it is given through its own copy of the stages. The output is the partial groups computed
+ * by every worker, which must be combined by the merging $group returned by
+ * DocumentSourceGroup::getMergeSources(), just like the partial groups computed by each shard.
+ *
+ * This stage is not parsed from a user's request. It is only created by PipelineD, for the stages
+ * which directly follow the collection scan.
+ */
+class DocumentSourceParallelGroup final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelGroup"_sd;
+
+    /**
+     * Returns the position of the $group in the range ['begin', 'end') which can be computed by
+     * several workers together with all of the stages before it, or 'end' if there is none. This
+     * requires every stage before the $group to transform each document independently of the
+     * others, and the $group to not depend on the order of its input.
+     */
+    static Pipeline::SourceContainer::const_iterator findParallelizableGroup(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        Pipeline::SourceContainer::const_iterator begin,
+        Pipeline::SourceContainer::const_iterator end);
+
+    /**
+     * Creates a stage computing 'stages', which must be a range accepted by
+     * findParallelizableGroup(), with 'nWorkers' workers. Each worker parses its own copy of the
+     * stages.
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelGroup> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const Pipeline::SourceContainer& stages,
+        size_t nWorkers);
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        return {StreamType::kBlocking,
+                PositionRequirement::kNone,
+                HostTypeRequirement::kNone,
+                DiskUseRequirement::kWritesTmpData,
+                FacetRequirement::kNotAllowed};
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    // The following are overridden just to forward calls to the workers' pipelines.
+    void detachFromOperationContext() final;
+    void reattachToOperationContext(OperationContext* opCtx) final;
+
+protected:
+    void doDispose() final;
+
+private:
+    /**
+     * The first stage of each worker's pipeline, which returns the documents handed to the worker
+     * and then pauses until it is given more.
+     */
+    class Feed final : public DocumentSource {
+    public:
+        explicit Feed(const boost::intrusive_ptr<ExpressionContext>& expCtx)
+            : DocumentSource(expCtx) {}
+
+        GetNextResult getNext() final;
+
+        const char* getSourceName() const final {
+            return "$_internalParallelGroupFeed";
+        }
+
+        StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+            StageConstraints constraints(StreamType::kStreaming,
+                                         PositionRequirement::kFirst,
+                                         HostTypeRequirement::kNone,
+                                         DiskUseRequirement::kNoDiskUse,
+                                         FacetRequirement::kNotAllowed);
+            constraints.requiresInputDocSource = false;
+            return constraints;
+        }
+
+        Value serialize(
+            boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final {
+            return Value();
+        }
+
+        std::deque<Document> input;
+
+        // Set once 'input' holds the last of the documents for this worker.
+        bool isEOF = false;
+    };
+
+    struct Worker {
+        boost::intrusive_ptr<Feed> feed;
+        std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
+        std::deque<Document> results;
+    };
+
+    DocumentSourceParallelGroup(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                std::vector<Worker> workers);
+
+    /**
+     * Reads all of the input, and computes the partial groups of every worker.
+     */
+    void computeGroups();
+
+    /**
+     * Runs the pipeline of 'worker' until it has consumed the documents it was handed.
+     */
+    void runWorker(Worker* worker);
+
+    std::vector<Worker> _workers;
+
+    bool _computedGroups = false;
+
+    // The worker whose results getNext() is returning.
+    size_t _nextWorker = 0;
+};
+
+}  // namespace mongo
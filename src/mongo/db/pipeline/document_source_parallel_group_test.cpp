@@ -0,0 +1,202 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_group.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+using boost::intrusive_ptr;
+using std::deque;
+using std::vector;
+
+using DocumentSourceParallelGroupTest = AggregationContextFixture;
+
+deque<DocumentSource::GetNextResult> makeInputs() {
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 200; ++i) {
+        inputs.emplace_back(Document{
+            {"_id", i}, {"k", i % 7}, {"x", i}, {"arr", vector<Value>{Value(i), Value(i % 3)}}});
+    }
+    return inputs;
+}
+
+vector<BSONObj> makeStages(std::initializer_list<const char*> jsons) {
+    vector<BSONObj> stages;
+    for (auto&& json : jsons) {
+        stages.push_back(fromjson(json));
+    }
+    return stages;
+}
+
+vector<Document> drainSortedById(DocumentSource* source) {
+    vector<Document> results;
+    for (auto next = source->getNext(); next.isAdvanced(); next = source->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+    std::sort(results.begin(), results.end(), [](const Document& lhs, const Document& rhs) {
+        return ValueComparator().evaluate(lhs["_id"] < rhs["_id"]);
+    });
+    return results;
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ShouldProduceSameGroupsAsSerialGroup) {
+    auto ctx = getExpCtx();
+
+    const auto originalChunkSize = internalDocumentSourceCursorBatchSizeBytes.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceCursorBatchSizeBytes.store(originalChunkSize); });
+    // Use small chunks so that each worker is handed several of them.
+    internalDocumentSourceCursorBatchSizeBytes.store(300);
+
+    const auto rawStages = makeStages(
+        {"{$match: {x: {$gte: 10}}}",
+         "{$unwind: '$arr'}",
+         "{$addFields: {y: {$multiply: ['$x', 2]}}}",
+         "{$group: {_id: '$k', total: {$sum: '$y'}, avg: {$avg: '$arr'}, n: {$sum: 1},"
+         " max: {$max: '$x'}, set: {$addToSet: '$arr'}}}"});
+
+    auto serial = uassertStatusOK(Pipeline::parse(rawStages, ctx));
+    serial->optimizePipeline();
+    auto serialSource = DocumentSourceMock::create(makeInputs());
+    serial->addInitialSource(serialSource);
+    auto expected = drainSortedById(serial->getSources().back().get());
+    ASSERT_EQ(expected.size(), 7UL);
+
+    auto stages = uassertStatusOK(Pipeline::parse(rawStages, ctx));
+    stages->optimizePipeline();
+    auto& sources = stages->getSources();
+    ASSERT_TRUE(DocumentSourceParallelGroup::findParallelizableGroup(
+                    ctx, sources.begin(), sources.end()) == std::prev(sources.end()));
+
+    auto parallelGroup = DocumentSourceParallelGroup::create(ctx, sources, 4);
+    auto parallelSource = DocumentSourceMock::create(makeInputs());
+    parallelGroup->setSource(parallelSource.get());
+    auto mergeSources =
+        dynamic_cast<SplittableDocumentSource*>(sources.back().get())->getMergeSources();
+    ASSERT_EQ(mergeSources.size(), 1UL);
+    mergeSources.front()->setSource(parallelGroup.get());
+
+    auto actual = drainSortedById(mergeSources.front().get());
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        // The order of the elements of $addToSet is unspecified.
+        MutableDocument expectedDoc(expected[i]);
+        MutableDocument actualDoc(actual[i]);
+        ASSERT_EQ(expectedDoc.peek()["set"].getArrayLength(),
+                  actualDoc.peek()["set"].getArrayLength());
+        expectedDoc.remove("set");
+        actualDoc.remove("set");
+        ASSERT_DOCUMENT_EQ(expectedDoc.freeze(), actualDoc.freeze());
+    }
+    ASSERT_TRUE(parallelGroup->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ShouldProduceNoGroupsForEmptyInput) {
+    auto ctx = getExpCtx();
+    auto stages = uassertStatusOK(
+        Pipeline::parse(makeStages({"{$group: {_id: '$k', n: {$sum: 1}}}"}), ctx));
+
+    auto parallelGroup = DocumentSourceParallelGroup::create(ctx, stages->getSources(), 3);
+    auto source = DocumentSourceMock::create();
+    parallelGroup->setSource(source.get());
+    ASSERT_TRUE(parallelGroup->getNext().isEOF());
+    ASSERT_TRUE(parallelGroup->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ShouldNotParallelizeStagesWhichDependOnOrder) {
+    auto ctx = getExpCtx();
+    auto assertNotParallelizable = [&](vector<BSONObj> rawStages) {
+        auto stages = uassertStatusOK(Pipeline::parse(rawStages, ctx));
+        auto& sources = stages->getSources();
+        ASSERT_TRUE(DocumentSourceParallelGroup::findParallelizableGroup(
+                        ctx, sources.begin(), sources.end()) == sources.end());
+    };
+
+    assertNotParallelizable(makeStages({"{$match: {x: 1}}"}));
+    assertNotParallelizable(
+        makeStages({"{$sort: {x: 1}}", "{$group: {_id: '$k', n: {$sum: 1}}}"}));
+    assertNotParallelizable(
+        makeStages({"{$limit: 10}", "{$group: {_id: '$k', n: {$sum: 1}}}"}));
+    assertNotParallelizable(makeStages({"{$group: {_id: '$k', x: {$first: '$x'}}}"}));
+    assertNotParallelizable(makeStages({"{$group: {_id: '$k', x: {$last: '$x'}}}"}));
+    assertNotParallelizable(makeStages({"{$group: {_id: '$k', x: {$push: '$x'}}}"}));
+    assertNotParallelizable(makeStages({"{$group: {_id: '$k', x: {$mergeObjects: '$$ROOT'}}}"}));
+    assertNotParallelizable(
+        makeStages({"{$group: {_id: '$k', n: {$sum: 1}, x: {$push: '$x'}}}"}));
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ShouldDivideMemoryLimitBetweenWorkers) {
+    auto ctx = getExpCtx();
+    ASSERT_FALSE(ctx->allowDiskUse);
+
+    const auto originalChunkSize = internalDocumentSourceCursorBatchSizeBytes.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceCursorBatchSizeBytes.store(originalChunkSize); });
+    internalDocumentSourceCursorBatchSizeBytes.store(300);
+
+    const auto rawStages = makeStages({"{$group: {_id: '$k', n: {$sum: 1}}}"});
+    const size_t maxMemoryUsageBytes = 2000;
+    auto makeStagesWithMemoryLimit = [&] {
+        auto stages = uassertStatusOK(Pipeline::parse(rawStages, ctx));
+        auto group = dynamic_cast<DocumentSourceGroup*>(stages->getSources().back().get());
+        ASSERT(group);
+        group->setMaxMemoryUsageBytes(maxMemoryUsageBytes);
+        return stages;
+    };
+
+    // The seven groups fit in the memory limit of a single $group.
+    auto serial = makeStagesWithMemoryLimit();
+    serial->addInitialSource(DocumentSourceMock::create(makeInputs()));
+    ASSERT_EQ(drainSortedById(serial->getSources().back().get()).size(), 7UL);
+
+    // Each worker may only use a fortieth of the memory, which is less than one group needs.
+    auto stages = makeStagesWithMemoryLimit();
+    auto parallelGroup = DocumentSourceParallelGroup::create(ctx, stages->getSources(), 40);
+    auto source = DocumentSourceMock::create(makeInputs());
+    parallelGroup->setSource(source.get());
+    ASSERT_THROWS_CODE(parallelGroup->getNext(), AssertionException, 16945);
+}
+
+}  // namespace
+}  // namespace mongo
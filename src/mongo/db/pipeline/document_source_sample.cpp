@@ -30,6 +30,10 @@
 
 #include "mongo/db/pipeline/document_source_sample.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "mongo/db/client.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
@@ -49,36 +53,138 @@ REGISTER_DOCUMENT_SOURCE(sample,
                          LiteParsedDocumentSourceDefault::parse,
                          DocumentSourceSample::createFromBson);
 
+namespace {
+/**
+ * Orders documents such that a heap built with this comparator has the document with the smallest
+ * random value at its front.
+ */
+bool hasLargerRandVal(const Document& lhs, const Document& rhs) {
+    return lhs.getRandMetaField() > rhs.getRandMetaField();
+}
+}  // namespace
+
 DocumentSource::GetNextResult DocumentSourceSample::getNext() {
     if (_size == 0)
         return GetNextResult::makeEOF();
 
     pExpCtx->checkForInterrupt();
 
-    if (!_sortStage->isPopulated()) {
-        // Exhaust source stage, add random metadata, and push all into sorter.
-        PseudoRandom& prng = pExpCtx->opCtx->getClient()->getPrng();
-        auto nextInput = pSource->getNext();
-        for (; nextInput.isAdvanced(); nextInput = pSource->getNext()) {
+    if (!_populated) {
+        auto endOfInput = populate();
+        if (endOfInput.isPaused()) {
+            return endOfInput;  // Propagate the pause.
+        }
+        invariant(endOfInput.isEOF());
+        _populated = true;
+
+        if (_usingSortStage) {
+            _sortStage->loadingDone();
+        } else {
+            std::sort(_reservoir.begin(), _reservoir.end(), hasLargerRandVal);
+        }
+    }
+
+    if (_usingSortStage) {
+        invariant(_sortStage->isPopulated());
+        return _sortStage->getNext();
+    }
+
+    if (_nextResultIndex == _reservoir.size()) {
+        return GetNextResult::makeEOF();
+    }
+
+    MutableDocument result(std::move(_reservoir[_nextResultIndex++]));
+    if (pExpCtx->needsMerge) {
+        // The samples will be merged by sorting on the random values, but the merging logic
+        // expects to sort by the sort key metadata.
+        result.setSortKeyMetaField(BSON("" << result.peek().getRandMetaField()));
+    }
+    return result.freeze();
+}
+
+DocumentSource::GetNextResult DocumentSourceSample::populate() {
+    PseudoRandom& prng = pExpCtx->opCtx->getClient()->getPrng();
+    auto nextInput = pSource->getNext();
+    for (; nextInput.isAdvanced(); nextInput = pSource->getNext()) {
+        if (_usingSortStage) {
             MutableDocument doc(nextInput.releaseDocument());
             doc.setRandMetaField(prng.nextCanonicalDouble());
             _sortStage->loadDocument(doc.freeze());
+            continue;
         }
-        switch (nextInput.getStatus()) {
-            case GetNextResult::ReturnStatus::kAdvanced: {
-                MONGO_UNREACHABLE;  // We consumed all advances above.
-            }
-            case GetNextResult::ReturnStatus::kPauseExecution: {
-                return nextInput;  // Propagate the pause.
-            }
-            case GetNextResult::ReturnStatus::kEOF: {
-                _sortStage->loadingDone();
+
+        if (_reservoir.size() < static_cast<size_t>(_size)) {
+            addToReservoir(nextInput.releaseDocument(), prng.nextCanonicalDouble());
+            if (_reservoir.size() == static_cast<size_t>(_size)) {
+                drawNextCandidate();
             }
+            continue;
+        }
+
+        if (_numToSkip > 0) {
+            --_numToSkip;
+            continue;
         }
+
+        addToReservoir(nextInput.releaseDocument(), _nextRandVal);
+        drawNextCandidate();
+    }
+    return nextInput;
+}
+
+void DocumentSourceSample::addToReservoir(Document&& doc, double randVal) {
+    MutableDocument withRandVal(std::move(doc));
+    withRandVal.setRandMetaField(randVal);
+    Document toAdd = withRandVal.freeze();
+
+    if (_reservoir.size() == static_cast<size_t>(_size)) {
+        std::pop_heap(_reservoir.begin(), _reservoir.end(), hasLargerRandVal);
+        _reservoirBytes -= _reservoir.back().getApproximateSize();
+        _reservoir.pop_back();
     }
 
-    invariant(_sortStage->isPopulated());
-    return _sortStage->getNext();
+    _reservoirBytes += toAdd.getApproximateSize();
+    _reservoir.push_back(std::move(toAdd));
+    std::push_heap(_reservoir.begin(), _reservoir.end(), hasLargerRandVal);
+
+    if (_reservoirBytes > DocumentSourceSort::kMaxMemoryUsageBytes) {
+        switchToSortStage();
+    }
+}
+
+void DocumentSourceSample::drawNextCandidate() {
+    if (_usingSortStage) {
+        return;
+    }
+
+    // A document enters the full reservoir if its random value exceeds the smallest one held,
+    // which happens with probability 1 - threshold. The number of documents skipped before that
+    // is geometrically distributed, and the value of the entering document is uniform over the
+    // values above the threshold.
+    PseudoRandom& prng = pExpCtx->opCtx->getClient()->getPrng();
+    const double threshold = _reservoir.front().getRandMetaField();
+    const double u = 1.0 - prng.nextCanonicalDouble();  // In (0, 1].
+    if (threshold <= 0) {
+        _numToSkip = 0;
+    } else if (threshold >= 1) {
+        _numToSkip = std::numeric_limits<long long>::max();
+    } else {
+        const double skip = std::floor(std::log(u) / std::log(threshold));
+        _numToSkip = skip >= static_cast<double>(std::numeric_limits<long long>::max())
+            ? std::numeric_limits<long long>::max()
+            : static_cast<long long>(skip);
+    }
+    _nextRandVal = threshold + (1.0 - threshold) * prng.nextCanonicalDouble();
+}
+
+void DocumentSourceSample::switchToSortStage() {
+    _usingSortStage = true;
+    for (auto&& doc : _reservoir) {
+        _sortStage->loadDocument(std::move(doc));
+    }
+    _reservoir.clear();
+    _reservoir.shrink_to_fit();
+    _reservoirBytes = 0;
 }
 
 Value DocumentSourceSample::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
@@ -28,11 +28,24 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_sort.h"
 
 namespace mongo {
 
+/**
+ * Selects '_size' documents uniformly at random from its input. Each document is given a random
+ * value, and the documents with the largest values are returned in descending order of their value,
+ * so that the samples of several shards can be merged by sorting on it.
+ *
+ * The documents with the largest values are kept in a bounded reservoir. Once it is full, the
+ * number of documents to skip before the next one enters the reservoir is drawn directly, so that
+ * skipped documents need neither a random value nor a comparison. If the reservoir outgrows the
+ * memory limit of a blocking sort, the remaining input is sorted by a $sort stage instead, which
+ * may spill to disk.
+ */
 class DocumentSourceSample final : public DocumentSource, public SplittableDocumentSource {
 public:
     static constexpr StringData kStageName = "$sample"_sd;
@@ -68,9 +81,48 @@ public:
 private:
     explicit DocumentSourceSample(const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
+    /**
+     * Consumes the input into the reservoir, or into '_sortStage' once the reservoir has been
+     * abandoned. Returns the pause or EOF which ended the input.
+     */
+    GetNextResult populate();
+
+    /**
+     * Assigns 'randVal' to 'doc' and adds it to the reservoir, evicting the document with the
+     * smallest random value if the reservoir is full.
+     */
+    void addToReservoir(Document&& doc, double randVal);
+
+    /**
+     * Draws the number of documents to skip before the next one that belongs in the full
+     * reservoir, and the random value that document will be given.
+     */
+    void drawNextCandidate();
+
+    /**
+     * Moves the documents of the reservoir into '_sortStage', which receives all further input.
+     */
+    void switchToSortStage();
+
     long long _size;
 
-    // Uses a $sort stage to randomly sort the documents.
+    // A min-heap on the random values of the documents, so that its front holds the value which a
+    // new document needs to exceed in order to enter the full reservoir.
+    std::vector<Document> _reservoir;
+    size_t _reservoirBytes = 0;
+
+    // Once the reservoir is full, the number of input documents to skip before the next one to
+    // enter it, and the random value that document will be given.
+    long long _numToSkip = 0;
+    double _nextRandVal = 0;
+
+    // Set once the input is exhausted; the reservoir is then sorted in descending order of random
+    // values and returned from '_nextResultIndex' on.
+    bool _populated = false;
+    size_t _nextResultIndex = 0;
+
+    // Uses a $sort stage to randomly sort the documents if the reservoir exceeds the memory limit.
+    bool _usingSortStage = false;
     boost::intrusive_ptr<DocumentSourceSort> _sortStage;
 };
 
@@ -204,6 +204,46 @@ TEST_F(SampleBasics, ShouldPropagatePauses) {
     assertEOF();
 }
 
+/**
+ * Every input document should be equally likely to be sampled, including those which arrive after
+ * the sample is full.
+ */
+TEST_F(SampleBasics, EveryDocumentCanBeSampled) {
+    const int nDocs = 100;
+    std::vector<int> timesSampled(nDocs, 0);
+    for (int trial = 0; trial < 200; ++trial) {
+        _mock = DocumentSourceMock::create();
+        loadDocuments(nDocs);
+        createSample(10);
+        for (auto next = sample()->getNext(); next.isAdvanced(); next = sample()->getNext()) {
+            ++timesSampled[next.getDocument()["_id"].getInt()];
+        }
+    }
+
+    // Each document is expected to be sampled 20 times.
+    for (int i = 0; i < nDocs; ++i) {
+        ASSERT_GT(timesSampled[i], 0);
+    }
+}
+
+/**
+ * When the samples of several shards are to be merged, each result should carry its random value
+ * as the sort key.
+ */
+TEST_F(SampleBasics, ShouldSetSortKeyToRandValWhenNeedsMerge) {
+    getExpCtx()->needsMerge = true;
+    loadDocuments(20);
+    createSample(5);
+    for (int i = 0; i < 5; ++i) {
+        auto next = sample()->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        auto doc = next.releaseDocument();
+        ASSERT_TRUE(doc.hasSortKeyMetaField());
+        ASSERT_BSONOBJ_EQ(BSON("" << doc.getRandMetaField()), doc.getSortKeyMetaField());
+    }
+    assertEOF();
+}
+
 /**
  * Fixture to test error cases of the $sample stage.
  */
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/collation/collation_index_key.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -324,6 +325,8 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     if (pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
+        opts.parallelism = std::max(1, internalQueryExecSorterParallelism.load());
+        opts.readAhead = true;
     }
 
     return opts;
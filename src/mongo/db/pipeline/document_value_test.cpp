@@ -111,6 +111,70 @@ TEST(DocumentConstruction, FromEmptyDocumentClone) {
     ASSERT_DOCUMENT_EQ(document, documentClone);
 }
 
+TEST(DocumentConstruction, FromBsonLazy) {
+    BSONObj obj = BSON("a" << 1 << "b"
+                           << "q"
+                           << "c"
+                           << BSON("d" << 2));
+    Document document = Document::fromBsonLazy(obj);
+    ASSERT_VALUE_EQ(mongo::Value("q"_sd), document["b"]);
+    ASSERT_VALUE_EQ(mongo::Value(2), document.getNestedField(FieldPath("c.d")));
+    ASSERT_TRUE(document["x"].missing());
+    ASSERT_EQUALS(3U, document.size());
+    ASSERT_EQUALS("a", getNthField(document, 0).first.toString());
+    ASSERT_EQUALS("c", getNthField(document, 2).first.toString());
+    ASSERT_DOCUMENT_EQ(fromBson(obj), document);
+    assertRoundTrips(document);
+}
+
+TEST(DocumentConstruction, FromBsonLazyLooksUpFieldsOutOfOrder) {
+    BSONObjBuilder builder;
+    for (int i = 0; i < 20; ++i) {
+        builder.append(std::string(str::stream() << "f" << i), i);
+    }
+    builder.append("f3", 100);
+    BSONObj obj = builder.obj();
+
+    Document document = Document::fromBsonLazy(obj);
+    for (int i : {7, 19, 0, 12, 3}) {
+        ASSERT_VALUE_EQ(mongo::Value(i), document[std::string(str::stream() << "f" << i)]);
+    }
+    ASSERT_EQUALS(21U, document.size());
+    ASSERT_BSONOBJ_EQ(obj, toBson(document));
+    ASSERT_DOCUMENT_EQ(fromBson(obj), document);
+}
+
+TEST(DocumentConstruction, FromBsonLazyReturnsOriginalBsonWhileUnmodified) {
+    BSONObj obj = BSON("a" << 1 << "b" << BSON("c" << 2));
+    Document document = Document::fromBsonLazy(obj);
+    ASSERT_VALUE_EQ(mongo::Value(1), document["a"]);
+    ASSERT_TRUE(obj.objdata() == toBson(document).objdata());
+    ASSERT_TRUE(obj["b"].embeddedObject().objdata() ==
+                document["b"].getDocument().toBson().objdata());
+
+    MutableDocument md(document);
+    md.setField("a", mongo::Value(5));
+    md.addField("d", mongo::Value(3));
+    Document modified = md.freeze();
+    ASSERT_BSONOBJ_EQ(BSON("a" << 5 << "b" << BSON("c" << 2) << "d" << 3), toBson(modified));
+
+    // The original document is not affected.
+    ASSERT_TRUE(obj.objdata() == toBson(document).objdata());
+    ASSERT_VALUE_EQ(mongo::Value(1), document["a"]);
+}
+
+TEST(DocumentConstruction, FromBsonLazyParsesMetaData) {
+    BSONObj obj = BSON("a" << 1 << Document::metaFieldTextScore << 2.0);
+    Document document = Document::fromBsonLazy(obj);
+    ASSERT_TRUE(document.hasTextScore());
+    ASSERT_EQ(2.0, document.getTextScore());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1), toBson(document));
+
+    Document withoutMetaData = Document::fromBsonLazy(obj, false);
+    ASSERT_FALSE(withoutMetaData.hasTextScore());
+    ASSERT_TRUE(obj.objdata() == toBson(withoutMetaData).objdata());
+}
+
 /**
  * Appends to 'builder' an object nested 'depth' levels deep.
  */
@@ -227,6 +227,8 @@ protected:
     virtual void _doAddDependencies(DepsTracker* deps) const = 0;
 
 private:
+    friend class CompiledExpression;
+
     boost::optional<Variables::Id> _boundaryVariableId;
     boost::intrusive_ptr<ExpressionContext> _expCtx;
 };
@@ -0,0 +1,365 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_compiler.h"
+
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/platform/overflow_arithmetic.h"
+#include "mongo/util/summation.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+namespace {
+/**
+ * Returns true if 'value' has one of the types the arithmetic instructions handle themselves.
+ */
+bool hasFastPathType(const Value& value) {
+    const BSONType type = value.getType();
+    return type == NumberInt || type == NumberLong || type == NumberDouble;
+}
+}  // namespace
+
+std::unique_ptr<CompiledExpression> CompiledExpression::compile(
+    intrusive_ptr<Expression> expression) {
+    if (!internalQueryCompileAggregationExpressions.load()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CompiledExpression> compiled(new CompiledExpression(std::move(expression)));
+    if (!compiled->compileNode(compiled->_source.get()) || compiled->_program.size() < 2) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+CompiledExpression::CompiledExpression(intrusive_ptr<Expression> source)
+    : _source(std::move(source)) {}
+
+bool CompiledExpression::compileNode(const Expression* expression) {
+    if (auto constant = dynamic_cast<const ExpressionConstant*>(expression)) {
+        append(OpCode::kPushConstant, addConstant(constant->getValue()));
+        return true;
+    } else if (auto fieldPath = dynamic_cast<const ExpressionFieldPath*>(expression)) {
+        // Paths relative to a variable other than $$ROOT, and $$ROOT itself, are left to the
+        // expression.
+        if (fieldPath->isRootFieldPath() && fieldPath->getFieldPath().getPathLength() > 1) {
+            append(OpCode::kPushField, addFieldSlot(fieldPath));
+            return true;
+        }
+    } else if (auto add = dynamic_cast<const ExpressionAdd*>(expression)) {
+        compileArithmetic(OpCode::kAdd, add);
+        return true;
+    } else if (auto multiply = dynamic_cast<const ExpressionMultiply*>(expression)) {
+        compileArithmetic(OpCode::kMultiply, multiply);
+        return true;
+    } else if (auto subtract = dynamic_cast<const ExpressionSubtract*>(expression)) {
+        compileArithmetic(OpCode::kSubtract, subtract);
+        return true;
+    } else if (auto divide = dynamic_cast<const ExpressionDivide*>(expression)) {
+        compileArithmetic(OpCode::kDivide, divide);
+        return true;
+    } else if (auto compare = dynamic_cast<const ExpressionCompare*>(expression)) {
+        const auto& operands = compare->getOperandList();
+        compileNode(operands[0].get());
+        compileNode(operands[1].get());
+        append(OpCode::kCompare, compare->getOp(), compare);
+        return true;
+    } else if (auto andExpression = dynamic_cast<const ExpressionAnd*>(expression)) {
+        compileShortCircuit(OpCode::kJumpIfFalse, andExpression);
+        return true;
+    } else if (auto orExpression = dynamic_cast<const ExpressionOr*>(expression)) {
+        compileShortCircuit(OpCode::kJumpIfTrue, orExpression);
+        return true;
+    } else if (auto cond = dynamic_cast<const ExpressionCond*>(expression)) {
+        const auto& operands = cond->getOperandList();
+        compileNode(operands[0].get());
+        const size_t jumpToElse = append(OpCode::kJumpIfFalse);
+        compileNode(operands[1].get());
+        const size_t jumpToEnd = append(OpCode::kJump);
+        _program[jumpToElse].target = _program.size();
+        compileNode(operands[2].get());
+        _program[jumpToEnd].target = _program.size();
+        return true;
+    }
+
+    append(OpCode::kEvaluate, 0, expression);
+    return false;
+}
+
+void CompiledExpression::compileArithmetic(OpCode opCode, const ExpressionNary* expression) {
+    // The expression evaluates its operands one at a time, and may return or throw before it has
+    // evaluated all of them. To behave the same, check the type of each operand as soon as it is
+    // pushed.
+    const auto& operands = expression->getOperandList();
+    std::vector<size_t> checks;
+    for (size_t i = 0; i < operands.size(); ++i) {
+        compileNode(operands[i].get());
+        checks.push_back(append(OpCode::kCheckNumericOperand, i + 1, expression));
+    }
+    append(opCode, operands.size(), expression);
+
+    for (auto check : checks) {
+        _program[check].target = _program.size();
+    }
+}
+
+void CompiledExpression::compileShortCircuit(OpCode jumpOpCode, const ExpressionNary* expression) {
+    // $and results in false as soon as an operand is false, and in true otherwise. $or is the
+    // opposite.
+    const bool shortCircuitResult = jumpOpCode == OpCode::kJumpIfTrue;
+
+    std::vector<size_t> jumps;
+    for (auto&& operand : expression->getOperandList()) {
+        compileNode(operand.get());
+        jumps.push_back(append(jumpOpCode));
+    }
+    append(OpCode::kPushConstant, addConstant(Value(!shortCircuitResult)));
+    const size_t jumpToEnd = append(OpCode::kJump);
+
+    for (auto jump : jumps) {
+        _program[jump].target = _program.size();
+    }
+    append(OpCode::kPushConstant, addConstant(Value(shortCircuitResult)));
+    _program[jumpToEnd].target = _program.size();
+}
+
+uint32_t CompiledExpression::addConstant(Value value) {
+    _constants.push_back(std::move(value));
+    return _constants.size() - 1;
+}
+
+uint32_t CompiledExpression::addFieldSlot(const ExpressionFieldPath* expression) {
+    // All of the paths are relative to $$ROOT, so compare them without the variable name.
+    const std::string path = expression->getFieldPath().tail().fullPath();
+    for (size_t i = 0; i < _fieldSlots.size(); ++i) {
+        if (_fieldSlots[i].node->getFieldPath().tail().fullPath() == path) {
+            return i;
+        }
+    }
+
+    _fieldSlots.push_back({expression, Value(), 0});
+    return _fieldSlots.size() - 1;
+}
+
+size_t CompiledExpression::append(OpCode opCode, uint32_t arg, const Expression* node) {
+    _program.push_back({opCode, arg, 0, node});
+    return _program.size() - 1;
+}
+
+const Value& CompiledExpression::getField(FieldSlot& slot, const Document& root) {
+    if (slot.generation != _generation) {
+        const FieldPath& path = slot.node->getFieldPath();
+        slot.value =
+            path.getPathLength() == 2 ? root[path.getFieldName(1)] : slot.node->evaluate(root);
+        slot.generation = _generation;
+    }
+    return slot.value;
+}
+
+Value CompiledExpression::evaluate(const Document& root) {
+    ++_generation;
+    _stack.clear();
+
+    size_t pc = 0;
+    while (pc < _program.size()) {
+        const Instruction& instruction = _program[pc++];
+        switch (instruction.opCode) {
+            case OpCode::kPushConstant:
+                _stack.push_back(_constants[instruction.arg]);
+                break;
+            case OpCode::kPushField:
+                _stack.push_back(getField(_fieldSlots[instruction.arg], root));
+                break;
+            case OpCode::kEvaluate:
+                _stack.push_back(instruction.node->evaluate(root));
+                break;
+            case OpCode::kCheckNumericOperand:
+                if (!hasFastPathType(_stack.back())) {
+                    _stack.resize(_stack.size() - instruction.arg);
+                    _stack.push_back(instruction.node->evaluate(root));
+                    pc = instruction.target;
+                }
+                break;
+            case OpCode::kAdd:
+            case OpCode::kMultiply: {
+                const size_t numOperands = instruction.arg;
+                const Value* operands = _stack.data() + _stack.size() - numOperands;
+                Value result = instruction.opCode == OpCode::kAdd
+                    ? add(operands, numOperands)
+                    : multiply(operands, numOperands);
+                _stack.resize(_stack.size() - numOperands);
+                _stack.push_back(std::move(result));
+                break;
+            }
+            case OpCode::kSubtract: {
+                Value result = subtract(_stack[_stack.size() - 2], _stack.back());
+                _stack.pop_back();
+                _stack.back() = std::move(result);
+                break;
+            }
+            case OpCode::kDivide: {
+                const double denominator = _stack.back().coerceToDouble();
+                _stack.pop_back();
+                if (denominator == 0.0) {
+                    // Let the expression report the error.
+                    _stack.back() = instruction.node->evaluate(root);
+                } else {
+                    _stack.back() = Value(_stack.back().coerceToDouble() / denominator);
+                }
+                break;
+            }
+            case OpCode::kCompare: {
+                Value result = compare(static_cast<ExpressionCompare::CmpOp>(instruction.arg),
+                                       _stack[_stack.size() - 2],
+                                       _stack.back());
+                _stack.pop_back();
+                _stack.back() = std::move(result);
+                break;
+            }
+            case OpCode::kJumpIfFalse:
+            case OpCode::kJumpIfTrue: {
+                const bool value = _stack.back().coerceToBool();
+                _stack.pop_back();
+                if (value == (instruction.opCode == OpCode::kJumpIfTrue)) {
+                    pc = instruction.target;
+                }
+                break;
+            }
+            case OpCode::kJump:
+                pc = instruction.target;
+                break;
+        }
+    }
+
+    invariant(_stack.size() == 1);
+    Value result = std::move(_stack.back());
+    _stack.pop_back();
+    return result;
+}
+
+// The arithmetic below mirrors the evaluate() methods of the corresponding expressions, restricted
+// to int, long and double operands.
+
+Value CompiledExpression::add(const Value* operands, size_t numOperands) const {
+    DoubleDoubleSummation nonDecimalTotal;
+    BSONType totalType = NumberInt;
+    for (size_t i = 0; i < numOperands; ++i) {
+        const Value& val = operands[i];
+        switch (val.getType()) {
+            case NumberDouble:
+                nonDecimalTotal.addDouble(val.getDouble());
+                totalType = NumberDouble;
+                break;
+            case NumberLong:
+                nonDecimalTotal.addLong(val.getLong());
+                if (totalType == NumberInt)
+                    totalType = NumberLong;
+                break;
+            case NumberInt:
+                nonDecimalTotal.addDouble(val.getInt());
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+    switch (totalType) {
+        case NumberLong:
+            if (nonDecimalTotal.fitsLong())
+                return Value(nonDecimalTotal.getLong());
+        // Fallthrough.
+        case NumberInt:
+            if (nonDecimalTotal.fitsLong())
+                return Value::createIntOrLong(nonDecimalTotal.getLong());
+        // Fallthrough.
+        case NumberDouble:
+            return Value(nonDecimalTotal.getDouble());
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+Value CompiledExpression::multiply(const Value* operands, size_t numOperands) const {
+    double doubleProduct = 1;
+    long long longProduct = 1;
+    BSONType productType = NumberInt;
+    for (size_t i = 0; i < numOperands; ++i) {
+        const Value& val = operands[i];
+        productType = Value::getWidestNumeric(productType, val.getType());
+        doubleProduct *= val.coerceToDouble();
+        if (mongoSignedMultiplyOverflow64(longProduct, val.coerceToLong(), &longProduct)) {
+            productType = NumberDouble;
+        }
+    }
+
+    if (productType == NumberDouble)
+        return Value(doubleProduct);
+    else if (productType == NumberLong)
+        return Value(longProduct);
+    return Value::createIntOrLong(longProduct);
+}
+
+Value CompiledExpression::subtract(const Value& lhs, const Value& rhs) const {
+    const BSONType diffType = Value::getWidestNumeric(rhs.getType(), lhs.getType());
+    if (diffType == NumberDouble) {
+        return Value(lhs.coerceToDouble() - rhs.coerceToDouble());
+    } else if (diffType == NumberLong) {
+        return Value(lhs.coerceToLong() - rhs.coerceToLong());
+    }
+    return Value::createIntOrLong(lhs.coerceToLong() - rhs.coerceToLong());
+}
+
+Value CompiledExpression::compare(ExpressionCompare::CmpOp cmpOp,
+                                  const Value& lhs,
+                                  const Value& rhs) const {
+    const int cmp = _source->getExpressionContext()->getValueComparator().compare(lhs, rhs);
+    switch (cmpOp) {
+        case ExpressionCompare::EQ:
+            return Value(cmp == 0);
+        case ExpressionCompare::NE:
+            return Value(cmp != 0);
+        case ExpressionCompare::GT:
+            return Value(cmp > 0);
+        case ExpressionCompare::GTE:
+            return Value(cmp >= 0);
+        case ExpressionCompare::LT:
+            return Value(cmp < 0);
+        case ExpressionCompare::LTE:
+            return Value(cmp <= 0);
+        case ExpressionCompare::CMP:
+            return Value(cmp < 0 ? -1 : (cmp > 0 ? 1 : 0));
+    }
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace mongo
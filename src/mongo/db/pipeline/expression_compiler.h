@@ -0,0 +1,165 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+/**
+ * A program compiled from an optimized Expression tree, which evaluates to the same Value as the
+ * tree does for every input document.
+ *
+ * Evaluating an Expression walks the tree with a virtual call per node. A CompiledExpression
+ * instead runs a flat sequence of instructions against a stack of Values:
+ *  - Field paths relative to $$ROOT are looked up at most once per document, into a slot shared
+ *    by every reference to the same path.
+ *  - $add, $subtract, $multiply and $divide have typed fast paths for int, long and double
+ *    operands. Operands of any other type make the instruction fall back to evaluating the
+ *    original node.
+ *  - Comparisons compare their operands directly, and $and, $or and $cond short-circuit with
+ *    jumps.
+ *  - Any other node is evaluated as a whole, by calling its evaluate().
+ *
+ * A CompiledExpression keeps the tree it was compiled from alive and reuses its evaluation stack
+ * across calls to evaluate(), so it must not be used by several threads at once.
+ */
+class CompiledExpression {
+    MONGO_DISALLOW_COPYING(CompiledExpression);
+
+public:
+    /**
+     * Compiles 'expression', which should already be optimized. Returns nullptr if compiling
+     * expressions is disabled, or if the compiled program would not be any faster than evaluating
+     * 'expression' directly, e.g. because it is a constant, a lone field path or an expression
+     * which cannot be compiled.
+     */
+    static std::unique_ptr<CompiledExpression> compile(boost::intrusive_ptr<Expression> expression);
+
+    /**
+     * Returns the result of evaluating the expression this was compiled from against 'root'.
+     */
+    Value evaluate(const Document& root);
+
+    /**
+     * Returns the expression this was compiled from.
+     */
+    const Expression* getSource() const {
+        return _source.get();
+    }
+
+    /**
+     * Returns the number of instructions in the program, for testing.
+     */
+    size_t getNumInstructions() const {
+        return _program.size();
+    }
+
+private:
+    enum class OpCode : uint8_t {
+        // Pushes '_constants[arg]'.
+        kPushConstant,
+        // Pushes the value of the field path in '_fieldSlots[arg]', looking it up in the current
+        // document if this is the first time it is used.
+        kPushField,
+        // Pushes the result of 'node->evaluate()'.
+        kEvaluate,
+        // Falls back to evaluating 'node' if the top of the stack is not an int, long or double:
+        // pops the 'arg' operands of 'node' evaluated so far, pushes 'node->evaluate()' and jumps
+        // to 'target'.
+        kCheckNumericOperand,
+        // Pop 'arg' numeric operands and push the result of applying the operator to them.
+        kAdd,
+        kMultiply,
+        kSubtract,
+        kDivide,
+        // Pops two operands and pushes the result of comparing them with the CmpOp in 'arg'.
+        kCompare,
+        // Pops the top of the stack and jumps to 'target' if it converts to false (or to true).
+        kJumpIfFalse,
+        kJumpIfTrue,
+        // Jumps to 'target'.
+        kJump,
+    };
+
+    struct Instruction {
+        OpCode opCode;
+        uint32_t arg;
+        uint32_t target;
+        const Expression* node;
+    };
+
+    struct FieldSlot {
+        const ExpressionFieldPath* node;
+        Value value;
+        // The value of '_generation' when 'value' was looked up.
+        uint64_t generation;
+    };
+
+    explicit CompiledExpression(boost::intrusive_ptr<Expression> source);
+
+    /**
+     * Appends the instructions which push the value of 'expression' to the program. Returns false
+     * if 'expression' could only be compiled to a single kEvaluate instruction.
+     */
+    bool compileNode(const Expression* expression);
+
+    void compileArithmetic(OpCode opCode, const ExpressionNary* expression);
+    void compileShortCircuit(OpCode jumpOpCode, const ExpressionNary* expression);
+
+    uint32_t addConstant(Value value);
+    uint32_t addFieldSlot(const ExpressionFieldPath* expression);
+    size_t append(OpCode opCode, uint32_t arg = 0, const Expression* node = nullptr);
+
+    const Value& getField(FieldSlot& slot, const Document& root);
+
+    Value add(const Value* operands, size_t numOperands) const;
+    Value multiply(const Value* operands, size_t numOperands) const;
+    Value subtract(const Value& lhs, const Value& rhs) const;
+    Value compare(ExpressionCompare::CmpOp cmpOp, const Value& lhs, const Value& rhs) const;
+
+    boost::intrusive_ptr<Expression> _source;
+
+    std::vector<Instruction> _program;
+    std::vector<Value> _constants;
+    std::vector<FieldSlot> _fieldSlots;
+
+    // Reused across calls to evaluate().
+    std::vector<Value> _stack;
+    uint64_t _generation = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_compiler.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+using boost::intrusive_ptr;
+
+intrusive_ptr<Expression> parseOptimized(const intrusive_ptr<ExpressionContextForTest>& expCtx,
+                                         const BSONObj& spec) {
+    VariablesParseState vps = expCtx->variablesParseState;
+    return Expression::parseOperand(expCtx, spec.firstElement(), vps)->optimize();
+}
+
+/**
+ * Asserts that the compiled form of the expression 'spec' evaluates to the same values, or throws
+ * the same errors, as the expression itself, for each of 'documents'.
+ */
+void assertCompiledMatchesInterpreted(const BSONObj& spec, const std::vector<Document>& documents) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expression = parseOptimized(expCtx, spec);
+    auto compiled = CompiledExpression::compile(expression);
+    ASSERT(compiled) << spec;
+
+    for (auto&& document : documents) {
+        Value expected;
+        int expectedCode = 0;
+        try {
+            expected = expression->evaluate(document);
+        } catch (const DBException& ex) {
+            expectedCode = ex.code();
+        }
+
+        if (expectedCode) {
+            ASSERT_THROWS_CODE(compiled->evaluate(document), DBException, expectedCode);
+            continue;
+        }
+        Value actual = compiled->evaluate(document);
+        ASSERT_VALUE_EQ(expected, actual);
+        ASSERT_EQ(expected.getType(), actual.getType()) << spec << " " << document.toString();
+    }
+}
+
+/**
+ * Compiling expressions is off by default, so each test turns it on.
+ */
+class CompiledExpressionTest : public unittest::Test {
+protected:
+    void setUp() final {
+        internalQueryCompileAggregationExpressions.store(true);
+    }
+
+    void tearDown() final {
+        internalQueryCompileAggregationExpressions.store(false);
+    }
+};
+
+std::vector<Document> makeTestDocuments() {
+    return {Document(BSON("a" << 1 << "b" << 2)),
+            Document(BSON("a" << 2147483647 << "b" << -1)),
+            Document(BSON("a" << std::numeric_limits<long long>::max() << "b" << 3)),
+            Document(BSON("a" << 1.5 << "b" << 3LL)),
+            Document(BSON("a" << Decimal128("1.1") << "b" << 2)),
+            Document(BSON("a" << BSONNULL << "b"
+                              << "str")),
+            Document(BSON("a"
+                          << "str"
+                          << "b"
+                          << BSONNULL)),
+            Document(BSON("a" << Date_t::fromMillisSinceEpoch(5) << "b" << 2)),
+            Document(BSON("a" << 4 << "b" << 0)),
+            Document(BSON("a" << 4 << "b" << 0.0)),
+            Document(),
+            Document(BSON("a" << 1 << "x" << BSON_ARRAY(BSON("y" << 1) << BSON("y" << 2)))),
+            Document(BSON("a" << 2 << "b" << 2 << "x" << BSON("y" << 3)))};
+}
+
+TEST_F(CompiledExpressionTest, ArithmeticMatchesInterpretedExpression) {
+    const auto documents = makeTestDocuments();
+    for (auto&& spec : {fromjson("{'': {$add: ['$a', '$b', 1]}}"),
+                        fromjson("{'': {$add: ['$a', {$multiply: ['$b', 2]}]}}"),
+                        fromjson("{'': {$subtract: ['$a', '$b']}}"),
+                        fromjson("{'': {$divide: ['$a', '$b']}}"),
+                        fromjson("{'': {$multiply: ['$a', '$a', '$b']}}"),
+                        fromjson("{'': {$add: ['$x.y', '$a']}}")}) {
+        assertCompiledMatchesInterpreted(spec, documents);
+    }
+}
+
+TEST_F(CompiledExpressionTest, ComparisonsAndConditionalsMatchInterpretedExpression) {
+    const auto documents = makeTestDocuments();
+    for (auto&& spec :
+         {fromjson("{'': {$cond: [{$gt: ['$a', '$b']}, {$subtract: ['$a', '$b']}, "
+                   "{$subtract: ['$b', '$a']}]}}"),
+          fromjson("{'': {$and: [{$gte: ['$a', 0]}, {$lt: ['$b', 10]}]}}"),
+          fromjson("{'': {$or: [{$eq: ['$a', null]}, {$ne: ['$x.y', 1]}]}}"),
+          fromjson("{'': {$cmp: ['$a', '$b']}}"),
+          fromjson("{'': {$lte: ['$a', '$b']}}")}) {
+        assertCompiledMatchesInterpreted(spec, documents);
+    }
+}
+
+TEST_F(CompiledExpressionTest, UncompiledSubexpressionsMatchInterpretedExpression) {
+    const auto documents = makeTestDocuments();
+    for (auto&& spec :
+         {fromjson("{'': {$add: ['$a', {$size: {$ifNull: ['$x', []]}}]}}"),
+          fromjson("{'': {$add: [{$let: {vars: {CURRENT: '$x'}, in: '$y'}}, 1]}}"),
+          fromjson("{'': {$eq: ['$$ROOT', {a: 1, b: 2}]}}")}) {
+        assertCompiledMatchesInterpreted(spec, documents);
+    }
+}
+
+TEST_F(CompiledExpressionTest, RepeatedFieldsAreLookedUpForEachDocument) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto compiled =
+        CompiledExpression::compile(parseOptimized(expCtx, fromjson("{'': {$add: ['$a', '$a']}}")));
+    ASSERT(compiled);
+    ASSERT_VALUE_EQ(Value(2), compiled->evaluate(Document(BSON("a" << 1))));
+    ASSERT_VALUE_EQ(Value(6), compiled->evaluate(Document(BSON("a" << 3))));
+    ASSERT_VALUE_EQ(Value(BSONNULL), compiled->evaluate(Document()));
+}
+
+TEST_F(CompiledExpressionTest, DoesNotCompileExpressionsWhichWouldNotBenefit) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ASSERT_FALSE(CompiledExpression::compile(parseOptimized(expCtx, BSON("" << "$a"))));
+    ASSERT_FALSE(CompiledExpression::compile(parseOptimized(expCtx, BSON("" << 5))));
+    ASSERT_FALSE(CompiledExpression::compile(
+        parseOptimized(expCtx, fromjson("{'': {$concat: ['$a', '$b']}}"))));
+    ASSERT_FALSE(
+        CompiledExpression::compile(parseOptimized(expCtx, fromjson("{'': {$add: [1, 2]}}"))));
+}
+
+TEST_F(CompiledExpressionTest, DoesNotCompileWhenDisabled) {
+    internalQueryCompileAggregationExpressions.store(false);
+
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ASSERT_FALSE(CompiledExpression::compile(
+        parseOptimized(expCtx, fromjson("{'': {$add: ['$a', '$b']}}"))));
+}
+
+TEST_F(CompiledExpressionTest, CopiedAccumulationStatementsDoNotShareCompiledExpression) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    VariablesParseState vps = expCtx->variablesParseState;
+    auto statement = AccumulationStatement::parseAccumulationStatement(
+        expCtx, fromjson("{total: {$sum: {$add: ['$a', '$b']}}}").firstElement(), vps);
+    statement.compileExpression();
+    ASSERT_TRUE(statement.hasCompiledExpression());
+
+    AccumulationStatement copy = statement;
+    ASSERT_FALSE(copy.hasCompiledExpression());
+    const Document document(BSON("a" << 1 << "b" << 2));
+    ASSERT_VALUE_EQ(Value(3), copy.evaluateExpression(document));
+
+    copy.compileExpression();
+    ASSERT_TRUE(copy.hasCompiledExpression());
+    ASSERT_VALUE_EQ(Value(3), copy.evaluateExpression(document));
+    ASSERT_VALUE_EQ(Value(3), statement.evaluateExpression(document));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -79,7 +79,25 @@ ExpressionContext::ExpressionContext(NamespaceString nss,
       timeZoneDatabase(tzDb),
       variablesParseState(variables.useIdGenerator()) {}
 
+namespace {
+// Whether the current thread is running part of a pipeline on behalf of another thread.
+thread_local bool isPipelineWorkerThread = false;
+}  // namespace
+
+ExpressionContext::WorkerThreadScope::WorkerThreadScope() {
+    invariant(!isPipelineWorkerThread);
+    isPipelineWorkerThread = true;
+}
+
+ExpressionContext::WorkerThreadScope::~WorkerThreadScope() {
+    isPipelineWorkerThread = false;
+}
+
 void ExpressionContext::checkForInterrupt() {
+    if (isPipelineWorkerThread) {
+        return;
+    }
+
     // This check could be expensive, at least in relative terms, so don't check every time.
     if (--_interruptCounter == 0) {
         invariant(opCtx);
@@ -116,6 +116,20 @@ public:
      */
     void checkForInterrupt();
 
+    /**
+     * Marks the current thread, until destroyed, as a worker running part of a pipeline on behalf
+     * of the thread which owns 'opCtx'. An OperationContext may only be used by its own thread, so
+     * checkForInterrupt() does nothing on worker threads and the owning thread remains responsible
+     * for checking for interrupts.
+     */
+    class WorkerThreadScope {
+        MONGO_DISALLOW_COPYING(WorkerThreadScope);
+
+    public:
+        WorkerThreadScope();
+        ~WorkerThreadScope();
+    };
+
     const CollatorInterface* getCollator() const {
         return _collator;
     }
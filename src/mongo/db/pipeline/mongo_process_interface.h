@@ -205,6 +205,14 @@ public:
      */
     virtual std::vector<GenericCursor> getCursors(
         const boost::intrusive_ptr<ExpressionContext>& expCtx) const = 0;
+
+    /**
+     * Returns the output of the incrementally maintained stages of the materialized view
+     * 'viewNss'. If the maintained results are stale, they are recomputed from the view's
+     * collection.
+     */
+    virtual std::vector<Document> readMaterializedView(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx, const NamespaceString& viewNss) = 0;
 };
 
 }  // namespace mongo
@@ -46,8 +46,12 @@ using std::unique_ptr;
 InclusionNode::InclusionNode(std::string pathToNode) : _pathToNode(std::move(pathToNode)) {}
 
 void InclusionNode::optimize() {
+    _compiledExpressions.clear();
     for (auto&& expressionIt : _expressions) {
         _expressions[expressionIt.first] = expressionIt.second->optimize();
+        if (auto compiled = CompiledExpression::compile(_expressions[expressionIt.first])) {
+            _compiledExpressions[expressionIt.first] = std::move(compiled);
+        }
     }
     for (auto&& childPair : _children) {
         childPair.second->optimize();
@@ -148,6 +152,11 @@ void InclusionNode::addComputedFields(MutableDocument* outputDoc, const Document
             outputDoc->setField(field,
                                 childIt->second->addComputedFields(outputDoc->peek()[field], root));
         } else {
+            auto compiledIt = _compiledExpressions.find(field);
+            if (compiledIt != _compiledExpressions.end()) {
+                outputDoc->setField(field, compiledIt->second->evaluate(root));
+                continue;
+            }
             auto expressionIt = _expressions.find(field);
             invariant(expressionIt != _expressions.end());
             outputDoc->setField(field, expressionIt->second->evaluate(root));
@@ -194,6 +203,7 @@ void InclusionNode::addComputedField(const FieldPath& path, boost::intrusive_ptr
     if (path.getPathLength() == 1) {
         auto fieldName = path.fullPath();
         _expressions[fieldName] = expr;
+        _compiledExpressions.erase(fieldName);
         _orderToProcessAdditionsAndChildren.push_back(fieldName);
         return;
     }
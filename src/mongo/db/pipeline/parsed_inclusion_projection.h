@@ -31,6 +31,7 @@
 #include <memory>
 
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_compiler.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/parsed_aggregation_projection.h"
 #include "mongo/stdx/memory.h"
@@ -55,7 +56,7 @@ public:
     InclusionNode(std::string pathToNode = "");
 
     /**
-     * Optimize any computed expressions.
+     * Optimize any computed expressions, and compile them for evaluation.
      */
     void optimize();
 
@@ -169,6 +170,9 @@ private:
     std::vector<std::string> _orderToProcessAdditionsAndChildren;
 
     StringMap<boost::intrusive_ptr<Expression>> _expressions;
+    // Programs compiled from the expressions in '_expressions' by optimize(), for those that can be
+    // compiled.
+    stdx::unordered_map<std::string, std::unique_ptr<CompiledExpression>> _compiledExpressions;
     stdx::unordered_set<std::string> _inclusions;
 
     // TODO use StringMap once SERVER-23700 is resolved.
@@ -209,7 +213,7 @@ public:
     }
 
     /**
-     * Optimize any computed expressions.
+     * Optimize any computed expressions, and compile them for evaluation.
      */
     void optimize() final {
         _root->optimize();
@@ -50,13 +50,16 @@
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
+#include "mongo/db/pipeline/document_source_parallel_group.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
@@ -65,7 +68,9 @@
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
@@ -76,6 +81,9 @@
 #include "mongo/db/stats/top.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/db/views/view.h"
+#include "mongo/db/views/view_catalog.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
@@ -335,6 +343,8 @@ void PipelineD::prepareCursorSource(Collection* collection,
 
     addCursorSource(
         collection, pipeline, expCtx, std::move(exec), deps, queryObj, sortObj, projForQuery);
+    enableStreamingGroup(collection, pipeline);
+    parallelizeGroup(pipeline);
 }
 
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prepareExecutor(
@@ -538,6 +548,92 @@ void PipelineD::addCursorSource(Collection* collection,
     pipeline->addInitialSource(pSource);
 }
 
+void PipelineD::enableStreamingGroup(Collection* collection, Pipeline* pipeline) {
+    Pipeline::SourceContainer& sources = pipeline->_sources;
+    auto cursor = dynamic_cast<DocumentSourceCursor*>(sources.front().get());
+    if (!collection || !cursor || sources.size() < 2) {
+        return;
+    }
+    auto group = dynamic_cast<DocumentSourceGroup*>(std::next(sources.begin())->get());
+    if (!group || group->isDoingMerge()) {
+        return;
+    }
+
+    // Only an order provided by scanning a single index is known to keep equal values adjacent.
+    const auto& indexesUsed = cursor->getPlanSummaryStats().indexesUsed;
+    if (indexesUsed.size() != 1) {
+        return;
+    }
+    auto opCtx = pipeline->getContext()->opCtx;
+    auto indexCatalog = collection->getIndexCatalog();
+    auto descriptor = indexCatalog->findIndexByName(opCtx, *indexesUsed.begin());
+    if (!descriptor) {
+        return;
+    }
+
+    // An index orders an array by each of its elements, so documents holding equal arrays need not
+    // be adjacent. Only the fields which the index records as never holding arrays qualify.
+    MultikeyPaths multikeyPaths;
+    if (indexCatalog->isMultikey(opCtx, descriptor)) {
+        multikeyPaths = indexCatalog->getMultikeyPaths(opCtx, descriptor);
+        if (multikeyPaths.empty()) {
+            // The index does not record which of its fields hold arrays.
+            return;
+        }
+    }
+    std::set<std::string> fieldsWithoutArrays;
+    size_t position = 0;
+    for (auto&& keyElem : descriptor->keyPattern()) {
+        if (multikeyPaths.empty() || multikeyPaths[position].empty()) {
+            fieldsWithoutArrays.insert(keyElem.fieldName());
+        }
+        ++position;
+    }
+
+    BSONObjSet streamableSorts = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    for (auto&& sort : cursor->getOutputSorts()) {
+        bool onFieldsWithoutArrays = true;
+        for (auto&& sortElem : sort) {
+            onFieldsWithoutArrays =
+                onFieldsWithoutArrays && fieldsWithoutArrays.count(sortElem.fieldName());
+        }
+        if (onFieldsWithoutArrays) {
+            streamableSorts.insert(sort);
+        }
+    }
+    group->setStreamableInputSorts(std::move(streamableSorts));
+}
+
+void PipelineD::parallelizeGroup(Pipeline* pipeline) {
+    auto expCtx = pipeline->getContext();
+    const int maxParallelism = internalDocumentSourceGroupMaxParallelism.load();
+
+    // Sub-pipelines, such as those of $lookup, may be executed once per input document, which
+    // would not leave the workers enough to do.
+    if (maxParallelism < 2 || expCtx->subPipelineDepth > 0) {
+        return;
+    }
+
+    Pipeline::SourceContainer& sources = pipeline->_sources;
+    invariant(dynamic_cast<DocumentSourceCursor*>(sources.front().get()));
+    const auto begin = std::next(sources.cbegin());
+    const auto group =
+        DocumentSourceParallelGroup::findParallelizableGroup(expCtx, begin, sources.end());
+    if (group == sources.end()) {
+        return;
+    }
+
+    const auto end = std::next(group);
+    auto mergeSources = static_cast<DocumentSourceGroup*>(group->get())->getMergeSources();
+    auto parallelGroup = DocumentSourceParallelGroup::create(
+        expCtx, Pipeline::SourceContainer(begin, end), static_cast<size_t>(maxParallelism));
+
+    sources.erase(begin, end);
+    sources.insert(end, parallelGroup);
+    sources.insert(end, mergeSources.begin(), mergeSources.end());
+    pipeline->stitch();
+}
+
 Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
     if (auto docSourceCursor =
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
@@ -893,6 +989,79 @@ boost::optional<Document> PipelineD::MongoDInterface::lookupSingleDocument(
     return lookedUpDocument;
 }
 
+std::vector<Document> PipelineD::MongoDInterface::readMaterializedView(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, const NamespaceString& viewNss) {
+    auto opCtx = expCtx->opCtx;
+
+    // The maintained totals include every committed write, so they cannot serve a read which must
+    // only observe majority-committed data or a point in time.
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    uassert(ErrorCodes::InvalidOptions,
+            str::stream() << "Read concern " << readConcernArgs.toString()
+                          << " is not supported for materialized view "
+                          << viewNss.ns()
+                          << ". Only read concern level \"local\" is supported.",
+            readConcernArgs.getLevel() == repl::ReadConcernLevel::kLocalReadConcern);
+
+    std::shared_ptr<ViewDefinition> view;
+    bool maintained = false;
+    {
+        AutoGetDb autoDb(opCtx, viewNss.db(), MODE_IS);
+        Database* db = autoDb.getDb();
+        view = db ? db->getViewCatalog()->lookup(opCtx, viewNss.ns()) : nullptr;
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << viewNss.ns() << " is not a materialized view",
+                view && view->materializedView());
+
+        // The removal of documents from a capped collection to make room for new ones is not
+        // observed, so its materialized views are always recomputed.
+        Lock::CollectionLock collLock(opCtx->lockState(), view->viewOn().ns(), MODE_IS);
+        Collection* collection = db->getCollection(opCtx, view->viewOn());
+        maintained = !collection || !collection->isCapped();
+    }
+
+    const auto& materialized = view->materializedView();
+    if (maintained) {
+        if (auto results = materialized->getResults()) {
+            return std::move(*results);
+        }
+    }
+
+    // The rebuilt results can only be maintained from here on if they are read from a snapshot
+    // taken after the rebuild began.
+    const bool canAbandonSnapshot = !opCtx->lockState()->inAWriteUnitOfWork();
+    if (canAbandonSnapshot) {
+        opCtx->recoveryUnit()->abandonSnapshot();
+    }
+    auto ticket = materialized->beginRebuild();
+    ticket->installable = ticket->installable && maintained && canAbandonSnapshot;
+
+    // Holding the collection lock keeps the rebuild pipeline from yielding, so that it reads the
+    // backing collection from the snapshot opened here, and the writes which commit meanwhile can
+    // be replayed onto its results. Without document-level locking there are no snapshots, and
+    // the lock would block writers for the whole rebuild.
+    boost::optional<AutoGetCollectionForRead> autoColl;
+    if (supportsDocLocking()) {
+        autoColl.emplace(opCtx, view->viewOn());
+        if (Collection* collection = autoColl->getCollection()) {
+            collection->getCursor(opCtx)->next();
+            materialized->rebuildSnapshotOpened(ticket.get());
+        }
+    }
+
+    auto rebuildExpCtx = expCtx->copyWith(
+        view->viewOn(), boost::none, CollatorInterface::cloneCollator(view->defaultCollator()));
+    // The workers of a parallel $group would each read from a snapshot of their own.
+    rebuildExpCtx->subPipelineDepth = expCtx->subPipelineDepth + 1;
+    auto pipeline =
+        uassertStatusOK(makePipeline(materialized->getRebuildPipeline(), rebuildExpCtx));
+    std::vector<Document> rebuildResults;
+    while (auto next = pipeline->getNext()) {
+        rebuildResults.push_back(std::move(*next));
+    }
+    return materialized->finishRebuild(*ticket, rebuildResults);
+}
+
 std::unique_ptr<CollatorInterface> PipelineD::MongoDInterface::_getCollectionDefaultCollator(
     OperationContext* opCtx, StringData dbName, UUID collectionUUID) {
     auto it = _collatorCache.find(collectionUUID);
@@ -113,6 +113,9 @@ public:
             boost::optional<BSONObj> readConcern) final;
         std::vector<GenericCursor> getCursors(
             const boost::intrusive_ptr<ExpressionContext>& expCtx) const final;
+        std::vector<Document> readMaterializedView(
+            const boost::intrusive_ptr<ExpressionContext>& expCtx,
+            const NamespaceString& viewNss) final;
 
     private:
         /**
@@ -198,6 +201,20 @@ private:
                                 const BSONObj& queryObj = BSONObj(),
                                 const BSONObj& sortObj = BSONObj(),
                                 const BSONObj& projectionObj = BSONObj());
+
+    /**
+     * Lets a $group which directly follows the DocumentSourceCursor at the front of 'pipeline'
+     * stream its output, if the cursor's plan scans an index which provides an order on the fields
+     * of the _id, and those fields hold no arrays.
+     */
+    static void enableStreamingGroup(Collection* collection, Pipeline* pipeline);
+
+    /**
+     * Replaces a $group which directly follows the DocumentSourceCursor at the front of 'pipeline',
+     * along with the stages between them, with a DocumentSourceParallelGroup and the $group
+     * merging its output, if the $group can be computed in parallel.
+     */
+    static void parallelizeGroup(Pipeline* pipeline);
 };
 
 }  // namespace mongo
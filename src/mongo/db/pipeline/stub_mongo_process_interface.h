@@ -143,5 +143,11 @@ public:
         const boost::intrusive_ptr<ExpressionContext>& expCtx) const {
         MONGO_UNREACHABLE;
     }
+
+    std::vector<Document> readMaterializedView(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const NamespaceString& viewNss) override {
+        MONGO_UNREACHABLE;
+    }
 };
 }  // namespace mongo
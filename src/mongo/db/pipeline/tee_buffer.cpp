@@ -49,6 +49,16 @@ boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers, int bufferS
 }
 
 DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
+    if (_consumingConcurrently) {
+        // Only this consumer's own state may be modified, since the others may be running.
+        auto& consumer = _consumers[consumerId];
+        if (consumer.nLeftToReturn == 0) {
+            return _buffer.empty() ? DocumentSource::GetNextResult::makeEOF()
+                                   : DocumentSource::GetNextResult::makePauseExecution();
+        }
+        return _buffer[_buffer.size() - consumer.nLeftToReturn--];
+    }
+
     size_t nConsumersStillProcessingThisBatch =
         std::count_if(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
             return info.nLeftToReturn > 0;
@@ -75,6 +85,26 @@ DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
     return _buffer[bufferIndex];
 }
 
+void TeeBuffer::beginConcurrentConsumption() {
+    invariant(!_consumingConcurrently);
+    if (std::any_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+            return info.stillInUse;
+        })) {
+        loadNextBatch();
+    }
+
+    for (auto&& input : _buffer) {
+        input.getDocument().loadLazyFields();
+    }
+    _consumingConcurrently = true;
+}
+
+void TeeBuffer::endConcurrentConsumption() {
+    invariant(_consumingConcurrently);
+    _consumingConcurrently = false;
+    disposeSourceIfUnused();
+}
+
 void TeeBuffer::loadNextBatch() {
     _buffer.clear();
     size_t bytesInBuffer = 0;
@@ -65,16 +65,26 @@ public:
     void dispose(size_t consumerId) {
         _consumers[consumerId].stillInUse = false;
         _consumers[consumerId].nLeftToReturn = 0;
-        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
-                return info.stillInUse;
-            })) {
-            _buffer.clear();
-            if (_source) {
-                _source->dispose();
-            }
+        if (!_consumingConcurrently) {
+            disposeSourceIfUnused();
         }
     }
 
+    /**
+     * Loads the next batch for consumers which will run concurrently, each on its own thread, until
+     * endConcurrentConsumption() is called. In the meantime, getNext() returns the documents of
+     * this batch, and then pauses, or reports EOF if the input is exhausted. It never loads another
+     * batch, and dispose() only removes the consumer. The documents in the batch are fully loaded,
+     * so consumers may read them at the same time.
+     */
+    void beginConcurrentConsumption();
+
+    /**
+     * Must be called once the consumers which started running after beginConcurrentConsumption()
+     * have all stopped.
+     */
+    void endConcurrentConsumption();
+
     /**
      * Retrieves the next document meant to be consumed by the pipeline given by 'consumerId'.
      * Returns GetNextState::ResultState::kPauseExecution if this pipeline has consumed the whole
@@ -92,6 +102,20 @@ private:
      */
     void loadNextBatch();
 
+    /**
+     * Clears '_buffer' and disposes of '_source' if no consumer is still using this buffer.
+     */
+    void disposeSourceIfUnused() {
+        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+                return info.stillInUse;
+            })) {
+            _buffer.clear();
+            if (_source) {
+                _source->dispose();
+            }
+        }
+    }
+
     DocumentSource* _source = nullptr;
 
     const size_t _bufferSizeBytes;
@@ -102,5 +126,8 @@ private:
         int nLeftToReturn = 0;
     };
     std::vector<ConsumerInfo> _consumers;
+
+    // Set between beginConcurrentConsumption() and endConcurrentConsumption().
+    bool _consumingConcurrently = false;
 };
 }  // namespace mongo
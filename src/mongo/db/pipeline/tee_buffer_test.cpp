@@ -166,5 +166,35 @@ TEST(TeeBufferTest, ShouldAllowOtherConsumersToAdvanceOnceTrailingConsumerIsDisp
     ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
     ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
 }
+
+TEST(TeeBufferTest, ShouldOnlyReturnCurrentBatchWhenConsumingConcurrently) {
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"a", 1}}, Document{{"a", 2}}};
+    auto mock = DocumentSourceMock::create(inputs);
+    const size_t bufferBytes = 1;  // Both docs won't fit in a single batch.
+    auto teeBuffer = TeeBuffer::create(2, bufferBytes);
+    teeBuffer->setSource(mock.get());
+
+    teeBuffer->beginConcurrentConsumption();
+    auto next0 = teeBuffer->getNext(0);
+    ASSERT_TRUE(next0.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next0.getDocument(), inputs.front().getDocument());
+
+    // Consumer #0 must wait for the next batch, even if consumer #1 is disposed in the meantime.
+    teeBuffer->dispose(1);
+    ASSERT_TRUE(teeBuffer->getNext(0).isPaused());
+    teeBuffer->endConcurrentConsumption();
+
+    teeBuffer->beginConcurrentConsumption();
+    next0 = teeBuffer->getNext(0);
+    ASSERT_TRUE(next0.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next0.getDocument(), inputs.back().getDocument());
+    ASSERT_TRUE(teeBuffer->getNext(0).isPaused());
+    teeBuffer->endConcurrentConsumption();
+
+    teeBuffer->beginConcurrentConsumption();
+    ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
+    ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
+    teeBuffer->endConcurrentConsumption();
+}
 }  // namespace
 }  // namespace mongo
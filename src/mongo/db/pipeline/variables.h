@@ -56,6 +56,13 @@ public:
             return _nextId++;
         }
 
+        /**
+         * Returns the Id the next call to generateId() will return.
+         */
+        Variables::Id peekNextId() const {
+            return _nextId;
+        }
+
     private:
         Variables::Id _nextId;
     };
@@ -118,6 +125,18 @@ public:
         return &_idGenerator;
     }
 
+    /**
+     * Makes room for the values of all of the variables whose Ids have been generated so far.
+     * Setting one of them then no longer modifies the list of values itself, so expressions which
+     * set different variables may be evaluated on separate threads.
+     */
+    void reserveValuesForGeneratedIds() {
+        const auto numIds = static_cast<size_t>(_idGenerator.peekNextId());
+        if (_valueList.size() < numIds) {
+            _valueList.resize(numIds);
+        }
+    }
+
 private:
     struct ValueAndState {
         ValueAndState() = default;
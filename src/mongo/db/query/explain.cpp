@@ -538,6 +538,10 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            if (spec->usedDisk) {
+                bob->appendBool("usedDisk", true);
+                bob->appendNumber("spills", spec->spills);
+            }
         }
 
         if (spec->limit > 0) {
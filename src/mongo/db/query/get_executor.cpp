@@ -340,7 +340,14 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         collection->infoCache()->getPlanCache()->get(*canonicalQuery, &rawCS).isOK()) {
         // We have a CachedSolution.  Have the planner turn it into a QuerySolution.
         unique_ptr<CachedSolution> cs(rawCS);
-        auto statusWithQs = QueryPlanner::planFromCache(*canonicalQuery, plannerParams, *cs);
+        std::unique_ptr<QuerySolutionNode> accessPlanTemplate;
+        auto statusWithQs = QueryPlanner::planFromCache(
+            *canonicalQuery, plannerParams, *cs, &accessPlanTemplate);
+        if (accessPlanTemplate) {
+            // Later queries with this shape can re-bind the data access plan to their constants.
+            collection->infoCache()->getPlanCache()->setAccessPlanTemplate(
+                *cs, std::move(accessPlanTemplate));
+        }
 
         if (statusWithQs.isOK()) {
             auto querySolution = std::move(statusWithQs.getValue());
@@ -805,7 +812,10 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorDelete(
     // This is the regular path for when we have a CanonicalQuery.
     unique_ptr<CanonicalQuery> cq(parsedDelete->releaseParsedQuery());
 
-    const size_t defaultPlannerOptions = 0;
+    // A delete of a single document, including one by findAndModify, removes the first match in
+    // natural order.
+    const size_t defaultPlannerOptions =
+        request->isMulti() ? 0 : QueryPlannerParams::PRESERVE_NATURAL_ORDER;
     StatusWith<PrepareExecutionResult> executionResult =
         prepareExecution(opCtx, collection, ws.get(), std::move(cq), defaultPlannerOptions);
     if (!executionResult.isOK()) {
@@ -946,7 +956,10 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorUpdate(
     // This is the regular path for when we have a CanonicalQuery.
     unique_ptr<CanonicalQuery> cq(parsedUpdate->releaseParsedQuery());
 
-    const size_t defaultPlannerOptions = 0;
+    // An update of a single document, including one by findAndModify, modifies the first match in
+    // natural order.
+    const size_t defaultPlannerOptions =
+        request->isMulti() ? 0 : QueryPlannerParams::PRESERVE_NATURAL_ORDER;
     StatusWith<PrepareExecutionResult> executionResult =
         prepareExecution(opCtx, collection, ws.get(), std::move(cq), defaultPlannerOptions);
     if (!executionResult.isOK()) {
@@ -49,11 +49,104 @@ const char kBatchSizeField[] = "batchSize";
 const char kAwaitDataTimeoutField[] = "maxTimeMS";
 const char kTermField[] = "term";
 const char kLastKnownCommittedOpTimeField[] = "lastKnownCommittedOpTime";
+const char kSortKeyBoundField[] = "$_internalSortKeyBound";
+
+const char kSortKeyBoundSortKeyField[] = "sortKey";
+const char kSortKeyBoundSortPatternField[] = "sortPattern";
+const char kSortKeyBoundCompareWholeSortKeyField[] = "compareWholeSortKey";
+
+// The field in which a result carries its sort key.
+const char kSortKeyField[] = "$sortKey";
 
 }  // namespace
 
 const char GetMoreRequest::kGetMoreCommandName[] = "getMore";
 
+// static
+StatusWith<GetMoreRequest::SortKeyBound> GetMoreRequest::SortKeyBound::parseFromBSON(
+    const BSONObj& obj) {
+    SortKeyBound bound;
+    bool hasSortKey = false;
+    bool hasSortPattern = false;
+
+    for (BSONElement el : obj) {
+        const auto fieldName = el.fieldNameStringData();
+        if (fieldName == kSortKeyBoundSortKeyField || fieldName == kSortKeyBoundSortPatternField) {
+            if (el.type() != BSONType::Object) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << "Field '" << fieldName << "' of '" << kSortKeyBoundField
+                                      << "' must be of type object in: "
+                                      << obj};
+            }
+
+            if (fieldName == kSortKeyBoundSortKeyField) {
+                bound.sortKey = el.Obj().getOwned();
+                hasSortKey = true;
+            } else {
+                bound.sortPattern = el.Obj().getOwned();
+                hasSortPattern = true;
+            }
+        } else if (fieldName == kSortKeyBoundCompareWholeSortKeyField) {
+            if (el.type() != BSONType::Bool) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << "Field '" << fieldName << "' of '" << kSortKeyBoundField
+                                      << "' must be of type bool in: "
+                                      << obj};
+            }
+            bound.compareWholeSortKey = el.Bool();
+        } else {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Unrecognized field '" << fieldName << "' in '"
+                                  << kSortKeyBoundField
+                                  << "': "
+                                  << obj};
+        }
+    }
+
+    if (!hasSortKey || !hasSortPattern) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "'" << kSortKeyBoundField << "' must specify both '"
+                              << kSortKeyBoundSortKeyField
+                              << "' and '"
+                              << kSortKeyBoundSortPatternField
+                              << "': "
+                              << obj};
+    }
+
+    return bound;
+}
+
+BSONObj GetMoreRequest::SortKeyBound::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append(kSortKeyBoundSortKeyField, sortKey);
+    builder.append(kSortKeyBoundSortPatternField, sortPattern);
+    if (compareWholeSortKey) {
+        builder.append(kSortKeyBoundCompareWholeSortKeyField, true);
+    }
+    return builder.obj();
+}
+
+bool GetMoreRequest::SortKeyBound::isExceededBy(const BSONObj& obj) const {
+    BSONElement key = obj[kSortKeyField];
+    if (!key) {
+        return false;
+    }
+
+    BSONObj keyObj;
+    if (compareWholeSortKey) {
+        keyObj = key.wrap();
+    } else if (key.type() == BSONType::Object) {
+        keyObj = key.Obj();
+    } else {
+        return false;
+    }
+
+    // Strings in the sort key have already been mapped to their collation comparison keys, so
+    // there is no need to compare with a collator.
+    const bool considerFieldName = false;
+    return keyObj.woCompare(sortKey, sortPattern, considerFieldName) > 0;
+}
+
 GetMoreRequest::GetMoreRequest() : cursorid(0), batchSize(0) {}
 
 GetMoreRequest::GetMoreRequest(NamespaceString namespaceString,
@@ -61,13 +154,15 @@ GetMoreRequest::GetMoreRequest(NamespaceString namespaceString,
                                boost::optional<long long> sizeOfBatch,
                                boost::optional<Milliseconds> awaitDataTimeout,
                                boost::optional<long long> term,
-                               boost::optional<repl::OpTime> lastKnownCommittedOpTime)
+                               boost::optional<repl::OpTime> lastKnownCommittedOpTime,
+                               boost::optional<SortKeyBound> sortKeyBound)
     : nss(std::move(namespaceString)),
       cursorid(id),
       batchSize(sizeOfBatch),
       awaitDataTimeout(awaitDataTimeout),
       term(term),
-      lastKnownCommittedOpTime(lastKnownCommittedOpTime) {}
+      lastKnownCommittedOpTime(lastKnownCommittedOpTime),
+      sortKeyBound(std::move(sortKeyBound)) {}
 
 Status GetMoreRequest::isValid() const {
     if (!nss.isValid()) {
@@ -111,6 +206,7 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
     boost::optional<Milliseconds> awaitDataTimeout;
     boost::optional<long long> term;
     boost::optional<repl::OpTime> lastKnownCommittedOpTime;
+    boost::optional<SortKeyBound> sortKeyBound;
 
     for (BSONElement el : cmdObj) {
         const auto fieldName = el.fieldNameStringData();
@@ -158,6 +254,19 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
                 return status;
             }
             lastKnownCommittedOpTime = ot;
+        } else if (fieldName == kSortKeyBoundField) {
+            if (el.type() != BSONType::Object) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << "Field '" << kSortKeyBoundField
+                                      << "' must be of type object in: "
+                                      << cmdObj};
+            }
+
+            auto parsedBound = SortKeyBound::parseFromBSON(el.Obj());
+            if (!parsedBound.isOK()) {
+                return parsedBound.getStatus();
+            }
+            sortKeyBound = std::move(parsedBound.getValue());
         } else if (!CommandHelpers::isGenericArgument(fieldName)) {
             return {ErrorCodes::FailedToParse,
                     str::stream() << "Failed to parse: " << cmdObj << ". "
@@ -177,8 +286,13 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
                 str::stream() << "Field 'collection' missing in: " << cmdObj};
     }
 
-    GetMoreRequest request(
-        std::move(*nss), *cursorid, batchSize, awaitDataTimeout, term, lastKnownCommittedOpTime);
+    GetMoreRequest request(std::move(*nss),
+                           *cursorid,
+                           batchSize,
+                           awaitDataTimeout,
+                           term,
+                           lastKnownCommittedOpTime,
+                           std::move(sortKeyBound));
     Status validStatus = request.isValid();
     if (!validStatus.isOK()) {
         return validStatus;
@@ -209,6 +323,10 @@ BSONObj GetMoreRequest::toBSON() const {
         lastKnownCommittedOpTime->append(&builder, kLastKnownCommittedOpTimeField);
     }
 
+    if (sortKeyBound) {
+        builder.append(kSortKeyBoundField, sortKeyBound->toBSON());
+    }
+
     return builder.obj();
 }
 
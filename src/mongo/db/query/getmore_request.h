@@ -33,6 +33,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/util/time_support.h"
@@ -42,6 +43,38 @@ namespace mongo {
 struct GetMoreRequest {
     static const char kGetMoreCommandName[];
 
+    /**
+     * Sent by mongos when it merges sorted results from several shards and the merged stream is
+     * cut off by a limit. Once the merger holds enough results that sort at or before 'sortKey',
+     * no result sorting after it can be returned to the client, so a remote whose results are
+     * sorted may close its cursor as soon as it produces one.
+     */
+    struct SortKeyBound {
+        /**
+         * Parses a bound from the object held by the '$_internalSortKeyBound' field of a getMore.
+         */
+        static StatusWith<SortKeyBound> parseFromBSON(const BSONObj& obj);
+
+        BSONObj toBSON() const;
+
+        /**
+         * Returns true if the '$sortKey' field of the result 'obj' sorts after this bound. Results
+         * without a '$sortKey' of the expected type never exceed the bound.
+         */
+        bool isExceededBy(const BSONObj& obj) const;
+
+        // The sort key of the last result that the merger still needs, extracted from the
+        // '$sortKey' field in the same way as the merger does.
+        BSONObj sortKey;
+
+        // The pattern according to which 'sortKey' is compared against the keys of results.
+        BSONObj sortPattern;
+
+        // When true, '$sortKey' is a scalar rather than an object, and 'sortKey' is of the form
+        // {$sortKey: <value>} to be compared against the pattern {$sortKey: 1}.
+        bool compareWholeSortKey = false;
+    };
+
     /**
      * Construct an empty request.
      */
@@ -55,7 +88,8 @@ struct GetMoreRequest {
                    boost::optional<long long> sizeOfBatch,
                    boost::optional<Milliseconds> awaitDataTimeout,
                    boost::optional<long long> term,
-                   boost::optional<repl::OpTime> lastKnownCommittedOpTime);
+                   boost::optional<repl::OpTime> lastKnownCommittedOpTime,
+                   boost::optional<SortKeyBound> sortKeyBound = boost::none);
 
     /**
      * Construct a GetMoreRequest from the command specification and db name.
@@ -87,6 +121,10 @@ struct GetMoreRequest {
     // Only internal queries from replication will have a last known committed optime.
     const boost::optional<repl::OpTime> lastKnownCommittedOpTime;
 
+    // Only internal getMores issued by mongos while merging sorted results under a limit will
+    // have a sort key bound.
+    const boost::optional<SortKeyBound> sortKeyBound;
+
 private:
     /**
      * Returns a non-OK status if there are semantic errors in the parsed request
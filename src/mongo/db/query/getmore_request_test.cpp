@@ -280,4 +280,61 @@ TEST(GetMoreRequestTest, toBSONHasMaxTimeMS) {
     ASSERT_BSONOBJ_EQ(requestObj, expectedRequest);
 }
 
+TEST(GetMoreRequestTest, toBSONHasSortKeyBound) {
+    GetMoreRequest::SortKeyBound bound;
+    bound.sortKey = BSON("" << 5);
+    bound.sortPattern = BSON("a" << -1);
+    GetMoreRequest request(NamespaceString("testdb.testcoll"),
+                           123,
+                           boost::none,
+                           boost::none,
+                           boost::none,
+                           boost::none,
+                           bound);
+    BSONObj requestObj = request.toBSON();
+    BSONObj expectedRequest =
+        BSON("getMore" << CursorId(123) << "collection"
+                       << "testcoll"
+                       << "$_internalSortKeyBound"
+                       << BSON("sortKey" << BSON("" << 5) << "sortPattern" << BSON("a" << -1)));
+    ASSERT_BSONOBJ_EQ(requestObj, expectedRequest);
+
+    auto parsed = unittest::assertGet(GetMoreRequest::parseFromBSON("testdb", requestObj));
+    ASSERT(parsed.sortKeyBound);
+    ASSERT_BSONOBJ_EQ(parsed.sortKeyBound->sortKey, bound.sortKey);
+    ASSERT_BSONOBJ_EQ(parsed.sortKeyBound->sortPattern, bound.sortPattern);
+    ASSERT_FALSE(parsed.sortKeyBound->compareWholeSortKey);
+}
+
+TEST(GetMoreRequestTest, parseFromBSONSortKeyBoundMissingSortPattern) {
+    StatusWith<GetMoreRequest> result = GetMoreRequest::parseFromBSON(
+        "db",
+        BSON("getMore" << CursorId(123) << "collection"
+                       << "coll"
+                       << "$_internalSortKeyBound"
+                       << BSON("sortKey" << BSON("" << 5))));
+    ASSERT_NOT_OK(result.getStatus());
+    ASSERT_EQUALS(ErrorCodes::FailedToParse, result.getStatus().code());
+}
+
+TEST(GetMoreRequestTest, SortKeyBoundIsExceededByLaterSortKeysOnly) {
+    GetMoreRequest::SortKeyBound bound;
+    bound.sortKey = BSON("" << 5 << "" << 1);
+    bound.sortPattern = BSON("a" << -1 << "b" << 1);
+
+    ASSERT_TRUE(bound.isExceededBy(fromjson("{$sortKey: {'': 4, '': 0}}")));
+    ASSERT_TRUE(bound.isExceededBy(fromjson("{$sortKey: {'': 5, '': 2}}")));
+    ASSERT_FALSE(bound.isExceededBy(fromjson("{$sortKey: {'': 5, '': 1}}")));
+    ASSERT_FALSE(bound.isExceededBy(fromjson("{$sortKey: {'': 6, '': 9}}")));
+    ASSERT_FALSE(bound.isExceededBy(fromjson("{a: 0}")));
+
+    GetMoreRequest::SortKeyBound wholeKeyBound;
+    wholeKeyBound.sortKey = BSON("$sortKey" << 2.5);
+    wholeKeyBound.sortPattern = BSON("$sortKey" << 1);
+    wholeKeyBound.compareWholeSortKey = true;
+
+    ASSERT_TRUE(wholeKeyBound.isExceededBy(fromjson("{$sortKey: 3}")));
+    ASSERT_FALSE(wholeKeyBound.isExceededBy(fromjson("{$sortKey: 2}")));
+}
+
 }  // namespace
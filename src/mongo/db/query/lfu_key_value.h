@@ -0,0 +1,316 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A key-value store structure with a least frequently used (LFU) replacement policy. The store is
+ * bounded by a number of entries, set upon construction, and by a number of bytes which the
+ * caller passes to add() along with the estimated size of each entry.
+ *
+ * Frequencies are aged using LFU with dynamic aging (LFU-DA). Every entry has a priority equal to
+ * the number of times it has been retrieved plus an "inflation" value, which is raised to the
+ * priority of each entry as it is evicted. Entries which have been popular in the past therefore
+ * do not stay cached forever once they stop being used. Ties between entries with the same
+ * priority are broken by evicting the least recently used one.
+ *
+ * Caveat:
+ * This kv-store is NOT thread safe! The client to this utility is responsible for protecting
+ * concurrent access to the LFU store if used in a threaded context.
+ *
+ * The add(), get(), and remove() operations are O(log n) in the number of entries.
+ *
+ * The keys of generic type K map to values of type V*. The V* pointers are owned by the kv-store.
+ */
+template <class K, class V>
+class LFUKeyValue {
+public:
+    struct Entry {
+        std::unique_ptr<V> value;
+
+        // The estimated size of 'value' in bytes, as supplied by the caller.
+        size_t sizeBytes = 0;
+
+        // The number of times this entry has been retrieved with get().
+        uint64_t numHits = 0;
+
+        // The eviction priority of this entry. Entries with the lowest priority are evicted first.
+        uint64_t priority = 0;
+
+        // A logical timestamp of the last time this entry was added or retrieved.
+        uint64_t lastUse = 0;
+    };
+
+    typedef stdx::unordered_map<K, Entry> KVMap;
+    typedef typename KVMap::iterator KVMapIt;
+    typedef typename KVMap::const_iterator KVMapConstIt;
+
+    LFUKeyValue(size_t maxEntries) : _maxEntries(maxEntries) {}
+
+    /**
+     * Add an (K, V*) pair to the store, where 'key' can be used to retrieve value 'entry' from the
+     * store. 'entrySizeBytes' is the estimated size of 'entry', and 'maxSizeBytes' is the number
+     * of bytes which the kv-store may hold once 'entry' has been added.
+     *
+     * Takes ownership of 'entry'.
+     *
+     * If 'key' already exists in the kv-store, 'entry' will replace what is already there and
+     * inherit its hit count.
+     *
+     * Entries other than 'entry' are evicted, lowest priority first, until the kv-store is within
+     * both of its bounds. 'entry' itself is only evicted if it alone exceeds them.
+     *
+     * The evicted entries are returned for the caller to use before disposing.
+     */
+    std::vector<std::unique_ptr<V>> add(
+        const K& key,
+        V* entry,
+        size_t entrySizeBytes,
+        size_t maxSizeBytes = std::numeric_limits<size_t>::max()) {
+        std::unique_ptr<V> ownedEntry(entry);
+        uint64_t numHits = 0;
+
+        KVMapIt i = _kvMap.find(key);
+        if (i != _kvMap.end()) {
+            numHits = i->second.numHits;
+            _erase(i);
+        }
+
+        KVMapIt added = _kvMap.emplace(key, Entry()).first;
+        added->second.value = std::move(ownedEntry);
+        added->second.sizeBytes = entrySizeBytes;
+        added->second.numHits = numHits;
+        _totalSizeBytes += entrySizeBytes;
+        _reprioritize(added->first, &added->second);
+
+        std::vector<std::unique_ptr<V>> evicted;
+        while (_kvMap.size() > _maxEntries || _totalSizeBytes > maxSizeBytes) {
+            auto victim = _byPriority.begin();
+            invariant(victim != _byPriority.end());
+            if (*std::get<2>(*victim) == key && _kvMap.size() > 1) {
+                ++victim;
+            }
+
+            evicted.push_back(_evict(victim));
+        }
+        return evicted;
+    }
+
+    /**
+     * Evicts entries, lowest priority first, until the kv-store holds at most 'maxSizeBytes'.
+     * Used when the bytes held by the kv-store are needed elsewhere.
+     *
+     * The evicted entries are returned for the caller to use before disposing.
+     */
+    std::vector<std::unique_ptr<V>> evict(size_t maxSizeBytes) {
+        std::vector<std::unique_ptr<V>> evicted;
+        while (_totalSizeBytes > maxSizeBytes) {
+            invariant(!_byPriority.empty());
+            evicted.push_back(_evict(_byPriority.begin()));
+        }
+        return evicted;
+    }
+
+    /**
+     * Retrieve the value associated with 'key' from the kv-store. The value is returned through
+     * the out-parameter 'entryOut'.
+     *
+     * The kv-store retains ownership of 'entryOut', so it should not be deleted by the caller.
+     *
+     * As a side effect, the hit count and the priority of the retrieved entry are raised.
+     */
+    Status get(const K& key, V** entryOut) {
+        KVMapIt i = _kvMap.find(key);
+        if (i == _kvMap.end()) {
+            return Status(ErrorCodes::NoSuchKey, "no such key in LFU key-value store");
+        }
+        ++i->second.numHits;
+        _reprioritize(i->first, &i->second);
+
+        *entryOut = i->second.value.get();
+        return Status::OK();
+    }
+
+    /**
+     * Like get(), but does not count as a use of the entry. If 'numHitsOut' is non-null, it is
+     * set to the number of times the entry has been retrieved with get().
+     */
+    Status peek(const K& key, V** entryOut, uint64_t* numHitsOut = nullptr) const {
+        KVMapConstIt i = _kvMap.find(key);
+        if (i == _kvMap.end()) {
+            return Status(ErrorCodes::NoSuchKey, "no such key in LFU key-value store");
+        }
+        *entryOut = i->second.value.get();
+        if (numHitsOut) {
+            *numHitsOut = i->second.numHits;
+        }
+        return Status::OK();
+    }
+
+    /**
+     * Updates the estimated size of the entry keyed by 'key', for use when the caller has modified
+     * the value in place. Does not evict anything.
+     */
+    Status setSizeBytes(const K& key, size_t sizeBytes) {
+        KVMapIt i = _kvMap.find(key);
+        if (i == _kvMap.end()) {
+            return Status(ErrorCodes::NoSuchKey, "no such key in LFU key-value store");
+        }
+        _totalSizeBytes -= i->second.sizeBytes;
+        _totalSizeBytes += sizeBytes;
+        i->second.sizeBytes = sizeBytes;
+        return Status::OK();
+    }
+
+    /**
+     * Remove the kv-store entry keyed by 'key'.
+     */
+    Status remove(const K& key) {
+        KVMapIt i = _kvMap.find(key);
+        if (i == _kvMap.end()) {
+            return Status(ErrorCodes::NoSuchKey, "no such key in LFU key-value store");
+        }
+        _erase(i);
+        return Status::OK();
+    }
+
+    /**
+     * Deletes all entries in the kv-store.
+     */
+    void clear() {
+        _byPriority.clear();
+        _kvMap.clear();
+        _totalSizeBytes = 0;
+        _inflation = 0;
+    }
+
+    /**
+     * Returns true if entry is found in the kv-store.
+     */
+    bool hasKey(const K& key) const {
+        return _kvMap.find(key) != _kvMap.end();
+    }
+
+    /**
+     * Returns the number of entries currently in the kv-store.
+     */
+    size_t size() const {
+        return _kvMap.size();
+    }
+
+    /**
+     * Returns the sum of the estimated sizes of the entries currently in the kv-store.
+     */
+    size_t sizeBytes() const {
+        return _totalSizeBytes;
+    }
+
+    /**
+     * Iterates over the entries in no particular order.
+     */
+    KVMapConstIt begin() const {
+        return _kvMap.begin();
+    }
+
+    KVMapConstIt end() const {
+        return _kvMap.end();
+    }
+
+private:
+    // Orders entries by (priority, lastUse), pointing at the key owned by '_kvMap'. Since
+    // 'lastUse' is unique, so is every element.
+    typedef std::tuple<uint64_t, uint64_t, const K*> PriorityKey;
+
+    static PriorityKey _priorityKey(const K& key, const Entry& entry) {
+        return PriorityKey(entry.priority, entry.lastUse, &key);
+    }
+
+    /**
+     * Recomputes the priority of 'entry' after it has been added or used. 'key' must be the key
+     * stored in '_kvMap', since '_byPriority' refers to it.
+     */
+    void _reprioritize(const K& key, Entry* entry) {
+        if (entry->lastUse != 0) {
+            _byPriority.erase(_priorityKey(key, *entry));
+        }
+        entry->priority = _inflation + entry->numHits + 1;
+        entry->lastUse = ++_clock;
+        _byPriority.insert(_priorityKey(key, *entry));
+    }
+
+    /**
+     * Removes the entry 'victim' refers to and raises the inflation to its priority. Returns the
+     * evicted value.
+     */
+    std::unique_ptr<V> _evict(typename std::set<PriorityKey>::const_iterator victim) {
+        KVMapIt found = _kvMap.find(*std::get<2>(*victim));
+        invariant(found != _kvMap.end());
+        _inflation = std::max(_inflation, found->second.priority);
+        std::unique_ptr<V> value = std::move(found->second.value);
+        _erase(found);
+        return value;
+    }
+
+    void _erase(KVMapIt it) {
+        _byPriority.erase(_priorityKey(it->first, it->second));
+        _totalSizeBytes -= it->second.sizeBytes;
+        _kvMap.erase(it);
+    }
+
+    // The maximum allowable number of entries in the kv-store.
+    const size_t _maxEntries;
+
+    // The sum of the estimated sizes of all entries.
+    size_t _totalSizeBytes = 0;
+
+    // The priority of the most recently evicted entry, added to the priority of entries as they
+    // are used so that newer entries can compete with ones which accumulated hits long ago.
+    uint64_t _inflation = 0;
+
+    // Source of the 'lastUse' timestamps.
+    uint64_t _clock = 0;
+
+    KVMap _kvMap;
+
+    std::set<PriorityKey> _byPriority;
+};
+
+}  // namespace mongo
@@ -0,0 +1,252 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/lfu_key_value.h"
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+
+using namespace mongo;
+
+namespace {
+
+//
+// Convenience functions
+//
+
+void assertInKVStore(LFUKeyValue<int, int>& cache, int key, int value) {
+    int* cachedValue = NULL;
+    ASSERT_TRUE(cache.hasKey(key));
+    Status s = cache.get(key, &cachedValue);
+    ASSERT_OK(s);
+    ASSERT_EQUALS(*cachedValue, value);
+}
+
+void assertNotInKVStore(LFUKeyValue<int, int>& cache, int key) {
+    int* cachedValue = NULL;
+    ASSERT_FALSE(cache.hasKey(key));
+    Status s = cache.get(key, &cachedValue);
+    ASSERT_NOT_OK(s);
+}
+
+/**
+ * Test that we can add an entry and get it back out.
+ */
+TEST(LFUKeyValueTest, BasicAddGet) {
+    LFUKeyValue<int, int> cache(100);
+    ASSERT_TRUE(cache.add(1, new int(2), 10).empty());
+    assertInKVStore(cache, 1, 2);
+    ASSERT_EQUALS(cache.size(), 1U);
+    ASSERT_EQUALS(cache.sizeBytes(), 10U);
+}
+
+/**
+ * A kv-store with a max size of 0 isn't too useful, but test that at the very least we don't blow
+ * up.
+ */
+TEST(LFUKeyValueTest, SizeZeroCache) {
+    LFUKeyValue<int, int> cache(0);
+    auto evicted = cache.add(1, new int(2), 10);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(*evicted[0], 2);
+    assertNotInKVStore(cache, 1);
+    ASSERT_EQUALS(cache.sizeBytes(), 0U);
+}
+
+/**
+ * Replacing an entry keeps its hit count and updates the size of the kv-store.
+ */
+TEST(LFUKeyValueTest, ReplaceEntry) {
+    LFUKeyValue<int, int> cache(10);
+    cache.add(1, new int(1), 10);
+    assertInKVStore(cache, 1, 1);
+    assertInKVStore(cache, 1, 1);
+
+    ASSERT_TRUE(cache.add(1, new int(2), 30).empty());
+    ASSERT_EQUALS(cache.size(), 1U);
+    ASSERT_EQUALS(cache.sizeBytes(), 30U);
+
+    int* value = nullptr;
+    uint64_t numHits = 0;
+    ASSERT_OK(cache.peek(1, &value, &numHits));
+    ASSERT_EQUALS(*value, 2);
+    ASSERT_EQUALS(numHits, 2U);
+}
+
+/**
+ * Fill up a kv-store and retrieve every entry but one a few times. Adding more entries must evict
+ * the entry which was never retrieved, and then each of the new entries in turn, rather than any
+ * of the frequently used ones.
+ */
+TEST(LFUKeyValueTest, EvictsLeastFrequentlyUsed) {
+    const int maxSize = 10;
+    const int coldKey = 5;
+    LFUKeyValue<int, int> cache(maxSize);
+    for (int i = 0; i < maxSize; ++i) {
+        ASSERT_TRUE(cache.add(i, new int(i), 1).empty());
+    }
+    for (int hit = 0; hit < 3; ++hit) {
+        for (int i = 0; i < maxSize; ++i) {
+            if (i != coldKey) {
+                assertInKVStore(cache, i, i);
+            }
+        }
+    }
+
+    auto evicted = cache.add(maxSize, new int(maxSize), 1);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(*evicted[0], coldKey);
+
+    evicted = cache.add(maxSize + 1, new int(maxSize + 1), 1);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(*evicted[0], maxSize);
+
+    for (int i = 0; i < maxSize; ++i) {
+        if (i != coldKey) {
+            assertInKVStore(cache, i, i);
+        }
+    }
+    assertInKVStore(cache, maxSize + 1, maxSize + 1);
+}
+
+/**
+ * Without any hits, ties in priority are broken by evicting the least recently used entry.
+ */
+TEST(LFUKeyValueTest, TiesEvictLeastRecentlyUsed) {
+    LFUKeyValue<int, int> cache(3);
+    cache.add(1, new int(1), 1);
+    cache.add(2, new int(2), 1);
+    cache.add(3, new int(3), 1);
+
+    auto evicted = cache.add(4, new int(4), 1);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(*evicted[0], 1);
+}
+
+/**
+ * Dynamic aging lets entries which keep being used displace an entry whose hits all happened in
+ * the past.
+ */
+TEST(LFUKeyValueTest, OldHitsAgeOut) {
+    LFUKeyValue<int, int> cache(2);
+    cache.add(0, new int(0), 1);
+    for (int hit = 0; hit < 3; ++hit) {
+        assertInKVStore(cache, 0, 0);
+    }
+
+    // Keep replacing the other slot with new entries, each of which is used twice.
+    bool evictedOldEntry = false;
+    for (int i = 1; i < 10 && !evictedOldEntry; ++i) {
+        for (auto&& evicted : cache.add(i, new int(i), 1)) {
+            evictedOldEntry = evictedOldEntry || *evicted == 0;
+        }
+        if (cache.hasKey(i)) {
+            assertInKVStore(cache, i, i);
+            assertInKVStore(cache, i, i);
+        }
+    }
+    ASSERT_TRUE(evictedOldEntry);
+    assertNotInKVStore(cache, 0);
+}
+
+/**
+ * Entries are evicted until the kv-store fits in the byte bound passed to add(), but the entry
+ * being added is kept unless it alone exceeds the bound.
+ */
+TEST(LFUKeyValueTest, EvictsToFitByteBound) {
+    LFUKeyValue<int, int> cache(100);
+    cache.add(1, new int(1), 40);
+    cache.add(2, new int(2), 40);
+    assertInKVStore(cache, 2, 2);
+
+    auto evicted = cache.add(3, new int(3), 40, 100);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(*evicted[0], 1);
+    ASSERT_EQUALS(cache.sizeBytes(), 80U);
+
+    evicted = cache.add(4, new int(4), 90, 100);
+    ASSERT_EQUALS(evicted.size(), 2U);
+    ASSERT_EQUALS(cache.size(), 1U);
+    assertInKVStore(cache, 4, 4);
+
+    evicted = cache.add(5, new int(5), 200, 100);
+    ASSERT_EQUALS(evicted.size(), 2U);
+    ASSERT_EQUALS(cache.size(), 0U);
+    ASSERT_EQUALS(cache.sizeBytes(), 0U);
+}
+
+/**
+ * evict() releases bytes from the kv-store, lowest priority entries first.
+ */
+TEST(LFUKeyValueTest, EvictReleasesLowestPriorityEntries) {
+    LFUKeyValue<int, int> cache(10);
+    cache.add(1, new int(1), 40);
+    cache.add(2, new int(2), 40);
+    cache.add(3, new int(3), 40);
+    int* entry;
+    ASSERT_OK(cache.get(1, &entry));
+
+    auto evicted = cache.evict(120);
+    ASSERT_EQUALS(evicted.size(), 0U);
+
+    evicted = cache.evict(50);
+    ASSERT_EQUALS(evicted.size(), 2U);
+    ASSERT_EQUALS(*evicted[0], 2);
+    ASSERT_EQUALS(*evicted[1], 3);
+    assertInKVStore(cache, 1, 1);
+    ASSERT_EQUALS(cache.sizeBytes(), 40U);
+
+    evicted = cache.evict(0);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(cache.size(), 0U);
+}
+
+/**
+ * Test that removing, resizing and clearing entries keep the size of the kv-store up to date.
+ */
+TEST(LFUKeyValueTest, RemoveAndClear) {
+    LFUKeyValue<int, int> cache(10);
+    cache.add(1, new int(1), 10);
+    cache.add(2, new int(2), 20);
+    ASSERT_EQUALS(cache.sizeBytes(), 30U);
+
+    ASSERT_OK(cache.setSizeBytes(2, 25));
+    ASSERT_EQUALS(cache.sizeBytes(), 35U);
+
+    ASSERT_OK(cache.remove(1));
+    ASSERT_NOT_OK(cache.remove(1));
+    assertNotInKVStore(cache, 1);
+    ASSERT_EQUALS(cache.sizeBytes(), 25U);
+
+    cache.clear();
+    ASSERT_EQUALS(cache.size(), 0U);
+    ASSERT_EQUALS(cache.sizeBytes(), 0U);
+    ASSERT(cache.begin() == cache.end());
+}
+
+}  // namespace
@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <math.h>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -43,6 +44,7 @@
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/planner_parameterization.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/assert_util.h"
@@ -308,6 +310,20 @@ void encodeGeoNearMatchExpression(const GeoNearMatchExpression* tree, StringBuil
     }
 }
 
+// The estimated size of the entries in the plan caches of all collections.
+AtomicInt64 planCacheTotalSizeBytes;
+
+// Every live plan cache, so that one cache can make the others give back the memory budget they
+// have borrowed. Must be locked before the '_cacheMutex' of any cache.
+stdx::mutex planCacheRegistryMutex;
+std::set<const PlanCache*> planCacheRegistry;
+
+// Returns the part of 'maxTotalSizeBytes' each plan cache may use regardless of the others. Must be
+// called with 'planCacheRegistryMutex' held.
+long long planCacheFairShareSizeBytes(long long maxTotalSizeBytes) {
+    return maxTotalSizeBytes / std::max(static_cast<long long>(planCacheRegistry.size()), 1LL);
+}
+
 }  // namespace
 
 //
@@ -374,9 +390,11 @@ CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& en
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
       collation(entry.collation.getOwned()),
-      decisionWorks(entry.decision->stats[0]->common.works) {
+      decisionWorks(entry.decision->stats[0]->common.works),
+      accessPlanTemplate(entry.accessPlanTemplate) {
     // CachedSolution should not having any references into
-    // cache entry. All relevant data should be cloned/copied.
+    // cache entry. All relevant data should be cloned/copied, except for the access plan
+    // template, which is never modified once it is in the cache.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
         verify(entry.plannerData[i]);
         plannerData[i] = entry.plannerData[i]->clone();
@@ -437,6 +455,7 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
     entry->projection = projection.getOwned();
     entry->collation = collation.getOwned();
     entry->timeOfCreation = timeOfCreation;
+    entry->accessPlanTemplate = accessPlanTemplate;
 
     // Copy performance stats.
     for (size_t i = 0; i < feedback.size(); ++i) {
@@ -456,6 +475,33 @@ std::string PlanCacheEntry::toString() const {
                          << ";timeOfCreation: " << timeOfCreation.toString() << ")";
 }
 
+size_t PlanCacheEntry::estimateObjectSizeInBytes() const {
+    size_t size = sizeof(*this);
+    size += plannerData.capacity() * sizeof(SolutionCacheData*);
+    for (auto&& data : plannerData) {
+        size += data->estimateObjectSizeInBytes();
+    }
+    size += query.objsize() + sort.objsize() + projection.objsize() + collation.objsize();
+
+    size += sizeof(PlanRankingDecision);
+    size += decision->stats.capacity() * sizeof(std::unique_ptr<PlanStageStats>);
+    for (auto&& stats : decision->stats) {
+        size += stats->estimateObjectSizeInBytes();
+    }
+    size += decision->scores.capacity() * sizeof(double);
+    size += decision->candidateOrder.capacity() * sizeof(size_t);
+
+    size += feedback.capacity() * sizeof(PlanCacheEntryFeedback*);
+    for (auto&& fb : feedback) {
+        size += sizeof(*fb) + fb->stats->estimateObjectSizeInBytes();
+    }
+
+    if (accessPlanTemplate) {
+        size += QueryPlannerParameterization::estimateTemplateSizeInBytes(*accessPlanTemplate);
+    }
+    return size;
+}
+
 std::string CachedSolution::toString() const {
     return str::stream() << "key: " << key << '\n';
 }
@@ -465,14 +511,14 @@ std::string CachedSolution::toString() const {
 //
 
 void PlanCacheIndexTree::setIndexEntry(const IndexEntry& ie) {
-    entry.reset(new IndexEntry(ie));
+    indexName = ie.name;
 }
 
 PlanCacheIndexTree* PlanCacheIndexTree::clone() const {
     PlanCacheIndexTree* root = new PlanCacheIndexTree();
-    if (NULL != entry.get()) {
+    if (indexName) {
         root->index_pos = index_pos;
-        root->setIndexEntry(*entry.get());
+        root->indexName = indexName;
         root->canCombineBounds = canCombineBounds;
     }
     root->orPushdowns = orPushdowns;
@@ -486,6 +532,22 @@ PlanCacheIndexTree* PlanCacheIndexTree::clone() const {
     return root;
 }
 
+size_t PlanCacheIndexTree::estimateObjectSizeInBytes() const {
+    size_t size = sizeof(*this);
+    size += children.capacity() * sizeof(PlanCacheIndexTree*);
+    for (auto&& child : children) {
+        size += child->estimateObjectSizeInBytes();
+    }
+    if (indexName) {
+        size += indexName->capacity();
+    }
+    size += orPushdowns.capacity() * sizeof(OrPushdown);
+    for (auto&& orPushdown : orPushdowns) {
+        size += orPushdown.indexName.capacity() + orPushdown.route.size() * sizeof(size_t);
+    }
+    return size;
+}
+
 std::string PlanCacheIndexTree::toString(int indents) const {
     StringBuilder result;
     if (!children.empty()) {
@@ -499,8 +561,8 @@ std::string PlanCacheIndexTree::toString(int indents) const {
         return result.str();
     } else {
         result << std::string(3 * indents, '-') << "Leaf ";
-        if (NULL != entry.get()) {
-            result << entry->name << ", pos: " << index_pos << ", can combine? "
+        if (indexName) {
+            result << *indexName << ", pos: " << index_pos << ", can combine? "
                    << canCombineBounds;
         }
         for (const auto& orPushdown : orPushdowns) {
@@ -538,6 +600,10 @@ SolutionCacheData* SolutionCacheData::clone() const {
     return other;
 }
 
+size_t SolutionCacheData::estimateObjectSizeInBytes() const {
+    return sizeof(*this) + (tree ? tree->estimateObjectSizeInBytes() : 0);
+}
+
 std::string SolutionCacheData::toString() const {
     switch (this->solnType) {
         case WHOLE_IXSCAN_SOLN:
@@ -559,11 +625,18 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+PlanCache::PlanCache() : PlanCache("") {}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {
+    stdx::lock_guard<stdx::mutex> registryLock(planCacheRegistryMutex);
+    planCacheRegistry.insert(this);
+}
 
-PlanCache::~PlanCache() {}
+PlanCache::~PlanCache() {
+    stdx::lock_guard<stdx::mutex> registryLock(planCacheRegistryMutex);
+    planCacheRegistry.erase(this);
+    planCacheTotalSizeBytes.subtractAndFetch(static_cast<long long>(_cache.sizeBytes()));
+}
 
 /**
  * Traverses expression tree pre-order.
@@ -741,12 +814,45 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    const long long maxTotalSizeBytes = std::max(0, internalQueryCacheMaxSizeBytes.load());
+    const size_t entrySizeBytes = entry->estimateObjectSizeInBytes();
+    PlanCacheKey key = computeKey(query);
+
+    long long fairShareSizeBytes;
+    {
+        stdx::lock_guard<stdx::mutex> registryLock(planCacheRegistryMutex);
+        fairShareSizeBytes = planCacheFairShareSizeBytes(maxTotalSizeBytes);
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+        const size_t bytesBefore = _cache.sizeBytes();
+
+        // The byte budget is shared with the plan caches of other collections. This cache may use
+        // its fair share of it, plus whatever the other caches leave over. It is allowed to keep
+        // the entry being added regardless, so that a collection is not prevented from caching
+        // plans by the others.
+        const long long usedElsewhere =
+            planCacheTotalSizeBytes.load() - static_cast<long long>(bytesBefore);
+        size_t maxSizeBytes = static_cast<size_t>(
+            std::max({0LL, fairShareSizeBytes, maxTotalSizeBytes - usedElsewhere}));
+        if (static_cast<long long>(entrySizeBytes) <= maxTotalSizeBytes) {
+            maxSizeBytes = std::max(maxSizeBytes, entrySizeBytes);
+        }
+
+        auto evictedEntries = _cache.add(key, entry, entrySizeBytes, maxSizeBytes);
+        _updateTotalSizeBytes(bytesBefore);
 
-    if (NULL != evictedEntry.get()) {
-        LOG(1) << _ns << ": plan cache maximum size exceeded - "
-               << "removed least recently used entry " << redact(evictedEntry->toString());
+        for (auto&& evictedEntry : evictedEntries) {
+            LOG(1) << _ns << ": plan cache maximum size exceeded - "
+                   << "removed least frequently used entry " << redact(evictedEntry->toString());
+        }
+    }
+
+    // If this cache grew within its fair share, the caches of all collections may now exceed the
+    // budget because others have borrowed beyond theirs. Make them give it back.
+    if (planCacheTotalSizeBytes.load() > maxTotalSizeBytes) {
+        _reclaimFromOtherCaches(maxTotalSizeBytes);
     }
 
     return Status::OK();
@@ -778,7 +884,7 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = _cache.peek(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -787,19 +893,51 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     // We store up to a constant number of feedback entries.
     if (entry->feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
         entry->feedback.push_back(autoFeedback.release());
+
+        const size_t bytesBefore = _cache.sizeBytes();
+        invariantOK(_cache.setSizeBytes(ck, entry->estimateObjectSizeInBytes()));
+        _updateTotalSizeBytes(bytesBefore);
     }
 
     return Status::OK();
 }
 
+void PlanCache::setAccessPlanTemplate(const CachedSolution& cachedSoln,
+                                      std::unique_ptr<QuerySolutionNode> accessPlanTemplate) {
+    invariant(accessPlanTemplate);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry;
+    if (!_cache.peek(cachedSoln.key, &entry).isOK() || entry->accessPlanTemplate) {
+        return;
+    }
+
+    // The entry may have been replaced since 'cachedSoln' was retrieved. The template is only
+    // valid for the winning plan it was built from.
+    invariant(!entry->plannerData.empty() && !cachedSoln.plannerData.empty());
+    if (entry->plannerData[0]->toString() != cachedSoln.plannerData[0]->toString()) {
+        return;
+    }
+
+    const size_t bytesBefore = _cache.sizeBytes();
+    entry->accessPlanTemplate = std::move(accessPlanTemplate);
+    invariantOK(_cache.setSizeBytes(cachedSoln.key, entry->estimateObjectSizeInBytes()));
+    _updateTotalSizeBytes(bytesBefore);
+}
+
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    const size_t bytesBefore = _cache.sizeBytes();
+    Status status = _cache.remove(computeKey(canonicalQuery));
+    _updateTotalSizeBytes(bytesBefore);
+    return status;
 }
 
 void PlanCache::clear() {
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    const size_t bytesBefore = _cache.sizeBytes();
     _cache.clear();
+    _updateTotalSizeBytes(bytesBefore);
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -816,13 +954,16 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    uint64_t numHits;
+    Status cacheStatus = _cache.peek(key, &entry, &numHits);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
     invariant(entry);
 
     *entryOut = entry->clone();
+    (*entryOut)->numHits = numHits;
+    (*entryOut)->estimatedSizeBytes = entry->estimateObjectSizeInBytes();
 
     return Status::OK();
 }
@@ -830,10 +971,11 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
-    typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (auto i = _cache.begin(); i != _cache.end(); i++) {
+        PlanCacheEntry* entry = i->second.value->clone();
+        entry->numHits = i->second.numHits;
+        entry->estimatedSizeBytes = i->second.sizeBytes;
+        entries.push_back(entry);
     }
 
     return entries;
@@ -849,6 +991,53 @@ size_t PlanCache::size() const {
     return _cache.size();
 }
 
+size_t PlanCache::estimatedSizeBytes() const {
+    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    return _cache.sizeBytes();
+}
+
+// static
+long long PlanCache::totalEstimatedSizeBytes() {
+    return planCacheTotalSizeBytes.load();
+}
+
+void PlanCache::_updateTotalSizeBytes(size_t bytesBefore) const {
+    planCacheTotalSizeBytes.fetchAndAdd(static_cast<long long>(_cache.sizeBytes()) -
+                                        static_cast<long long>(bytesBefore));
+}
+
+void PlanCache::_reclaimFromOtherCaches(long long maxTotalSizeBytes) const {
+    stdx::lock_guard<stdx::mutex> registryLock(planCacheRegistryMutex);
+    const long long fairShareSizeBytes = planCacheFairShareSizeBytes(maxTotalSizeBytes);
+
+    for (const PlanCache* other : planCacheRegistry) {
+        const long long excessSizeBytes = planCacheTotalSizeBytes.load() - maxTotalSizeBytes;
+        if (excessSizeBytes <= 0) {
+            break;
+        }
+        if (other == this) {
+            continue;
+        }
+
+        stdx::lock_guard<stdx::mutex> cacheLock(other->_cacheMutex);
+        const size_t bytesBefore = other->_cache.sizeBytes();
+        const long long sizeBytes = static_cast<long long>(bytesBefore);
+        if (sizeBytes <= fairShareSizeBytes) {
+            continue;
+        }
+
+        auto evictedEntries = other->_cache.evict(
+            static_cast<size_t>(std::max(fairShareSizeBytes, sizeBytes - excessSizeBytes)));
+        other->_updateTotalSizeBytes(bytesBefore);
+
+        for (auto&& evictedEntry : evictedEntries) {
+            LOG(1) << other->_ns << ": plan cache share of maximum size needed by " << _ns
+                   << " - removed least frequently used entry "
+                   << redact(evictedEntry->toString());
+        }
+    }
+}
+
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
     _indexabilityState.updateDiscriminators(indexEntries);
 }
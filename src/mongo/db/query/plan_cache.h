@@ -34,7 +34,7 @@
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
-#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/lfu_key_value.h"
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
@@ -99,7 +99,7 @@ struct PlanCacheIndexTree {
         std::deque<size_t> route;
     };
 
-    PlanCacheIndexTree() : entry(nullptr), index_pos(0), canCombineBounds(true) {}
+    PlanCacheIndexTree() : index_pos(0), canCombineBounds(true) {}
 
     ~PlanCacheIndexTree() {
         for (std::vector<PlanCacheIndexTree*>::const_iterator it = children.begin();
@@ -110,7 +110,7 @@ struct PlanCacheIndexTree {
     }
 
     /**
-     * Clone 'ie' and set 'this->entry' to be the clone.
+     * Set 'this->indexName' to the name of 'ie'.
      */
     void setIndexEntry(const IndexEntry& ie);
 
@@ -124,11 +124,18 @@ struct PlanCacheIndexTree {
      */
     std::string toString(int indents = 0) const;
 
+    /**
+     * Returns an estimate of the memory used by this tree, including its children.
+     */
+    size_t estimateObjectSizeInBytes() const;
+
     // Children owned here.
     std::vector<PlanCacheIndexTree*> children;
 
-    // Owned here.
-    std::unique_ptr<IndexEntry> entry;
+    // The name of the index assigned to this node, if any. Like the indexes of 'orPushdowns', it
+    // is kept by name rather than as a copy of its IndexEntry, so that cache entries stay small.
+    // The planner looks it up among the collection's indexes when planning from the cache.
+    boost::optional<std::string> indexName;
 
     size_t index_pos;
 
@@ -159,6 +166,9 @@ struct SolutionCacheData {
     // For debugging.
     std::string toString() const;
 
+    // Returns an estimate of the memory used by this object.
+    size_t estimateObjectSizeInBytes() const;
+
     // Owned here. If 'wholeIXSoln' is false, then 'tree'
     // can be used to tag an isomorphic match expression. If 'wholeIXSoln'
     // is true, then 'tree' is used to store the relevant IndexEntry.
@@ -221,6 +231,10 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     size_t decisionWorks;
+
+    // A data access plan for the winning solution which can be re-bound to the constants of the
+    // query being planned, if the cache entry has one. Shared with the cache entry.
+    std::shared_ptr<const QuerySolutionNode> accessPlanTemplate;
 };
 
 /**
@@ -249,6 +263,12 @@ public:
     // For debugging.
     std::string toString() const;
 
+    /**
+     * Returns an estimate of the memory used by this entry, including the planner data and the
+     * stats of every candidate plan and cached run. Used to bound the size of the plan cache.
+     */
+    size_t estimateObjectSizeInBytes() const;
+
     //
     // Planner data
     //
@@ -280,6 +300,21 @@ public:
     // Annotations from cached runs.  The CachedPlanStage provides these stats about its
     // runs when they complete.
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    // Set after the entry is first used, if the data access plan of the winning solution can be
+    // re-bound to the constants of each query with this shape. Immutable once set.
+    std::shared_ptr<const QuerySolutionNode> accessPlanTemplate;
+
+    //
+    // Cache usage, filled in on the copies returned by PlanCache::getEntry() and
+    // PlanCache::getAllEntries() for display by the plan cache commands.
+    //
+
+    // The number of times this entry has been used to plan a query.
+    uint64_t numHits = 0;
+
+    // The estimated size of the entry at the time it was last updated in the cache.
+    size_t estimatedSizeBytes = 0;
 };
 
 /**
@@ -287,6 +322,12 @@ public:
  * mapping, the cache contains information on why that mapping was made and statistics on the
  * cache entry's actual performance on subsequent runs.
  *
+ * Each cache holds at most 'internalQueryCacheSize' entries. In addition, the estimated size of
+ * the entries in all plan caches is bounded by 'internalQueryCacheMaxSizeBytes', which is shared
+ * by every collection. Each cache may use an equal share of that budget, and may borrow beyond it
+ * what the other caches leave unused. When a cache needs its share back, the caches which have
+ * borrowed are made to evict entries. Entries are always evicted least frequently used first, so
+ * that a few hot query shapes are not evicted by a stream of one-off ones.
  */
 class PlanCache {
 private:
@@ -353,6 +394,14 @@ public:
      */
     Status feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* feedback);
 
+    /**
+     * Stores 'accessPlanTemplate', built by QueryPlanner::planFromCache() from 'cachedSoln', in
+     * the cache entry 'cachedSoln' was retrieved from. Does nothing if the entry has been removed
+     * or replaced by one with a different winning plan, or already has a template.
+     */
+    void setAccessPlanTemplate(const CachedSolution& cachedSoln,
+                               std::unique_ptr<QuerySolutionNode> accessPlanTemplate);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -396,7 +445,7 @@ public:
 
     /**
      * Returns true if there is an entry in the cache for the 'query'.
-     * Internally calls hasKey() on the LRU cache.
+     * Internally calls hasKey() on the LFU cache.
      */
     bool contains(const CanonicalQuery& cq) const;
 
@@ -406,6 +455,16 @@ public:
      */
     size_t size() const;
 
+    /**
+     * Returns the estimated size in bytes of the entries in this cache.
+     */
+    size_t estimatedSizeBytes() const;
+
+    /**
+     * Returns the estimated size in bytes of the entries in the plan caches of all collections.
+     */
+    static long long totalEstimatedSizeBytes();
+
     /**
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
@@ -419,7 +478,17 @@ private:
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    // Adds the change in '_cache.sizeBytes()' since it was 'bytesBefore' to the total size of all
+    // plan caches. Must be called with '_cacheMutex' held.
+    void _updateTotalSizeBytes(size_t bytesBefore) const;
+
+    // Makes the other plan caches which use more than their share of 'maxTotalSizeBytes' evict
+    // entries, until the caches of all collections fit in 'maxTotalSizeBytes' or none of the
+    // others is over its share. Must be called without '_cacheMutex' held.
+    void _reclaimFromOtherCaches(long long maxTotalSizeBytes) const;
+
+    // Mutable because looking up an entry counts as a use of it.
+    mutable LFUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
 
     // Protects _cache.
     mutable stdx::mutex _cacheMutex;
@@ -449,6 +449,115 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+// When the entries of all plan caches exceed their shared memory budget, adding an entry evicts the
+// least frequently used entries of the cache being added to.
+TEST(PlanCacheTest, AddEvictsLeastFrequentlyUsedEntriesToFitMemoryBudget) {
+    QueryTestServiceContext serviceContext;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+
+    const long long totalBefore = PlanCache::totalEstimatedSizeBytes();
+    PlanCache planCache;
+    ASSERT_OK(planCache.add(*cqA, solns, createDecision(1U), Date_t{}));
+    const size_t entrySizeBytes = planCache.estimatedSizeBytes();
+    ASSERT_GT(entrySizeBytes, 0U);
+    ASSERT_EQUALS(PlanCache::totalEstimatedSizeBytes(),
+                  totalBefore + static_cast<long long>(entrySizeBytes));
+
+    // Leave room for two entries.
+    const int oldMaxSizeBytes = internalQueryCacheMaxSizeBytes.load();
+    ON_BLOCK_EXIT([oldMaxSizeBytes] { internalQueryCacheMaxSizeBytes.store(oldMaxSizeBytes); });
+    internalQueryCacheMaxSizeBytes.store(
+        static_cast<int>(totalBefore + 2 * entrySizeBytes + entrySizeBytes / 2));
+
+    // Use the entry for {a: 1} a few times, so that {b: 1} is evicted in its place.
+    for (int i = 0; i < 3; ++i) {
+        CachedSolution* rawCachedSolution;
+        ASSERT_OK(planCache.get(*cqA, &rawCachedSolution));
+        delete rawCachedSolution;
+    }
+    ASSERT_OK(planCache.add(*cqB, solns, createDecision(1U), Date_t{}));
+    ASSERT_OK(planCache.add(*cqC, solns, createDecision(1U), Date_t{}));
+    ASSERT_EQUALS(planCache.size(), 2U);
+    ASSERT_TRUE(planCache.contains(*cqA));
+    ASSERT_FALSE(planCache.contains(*cqB));
+    ASSERT_TRUE(planCache.contains(*cqC));
+
+    // The budget is shared with the caches of other collections. Once there are two caches,
+    // 'planCache' holds more than its share of the budget, so it has to evict its least frequently
+    // used entry to make room for an entry in the other cache.
+    {
+        PlanCache otherPlanCache;
+        ASSERT_OK(otherPlanCache.add(*cqB, solns, createDecision(1U), Date_t{}));
+        ASSERT_TRUE(otherPlanCache.contains(*cqB));
+        ASSERT_EQUALS(planCache.size(), 1U);
+        ASSERT_TRUE(planCache.contains(*cqA));
+        ASSERT_LTE(PlanCache::totalEstimatedSizeBytes(), internalQueryCacheMaxSizeBytes.load());
+    }
+
+    // Destroying or clearing a cache releases its share of the budget.
+    ASSERT_EQUALS(PlanCache::totalEstimatedSizeBytes(),
+                  totalBefore + static_cast<long long>(planCache.estimatedSizeBytes()));
+    planCache.clear();
+    ASSERT_EQUALS(planCache.estimatedSizeBytes(), 0U);
+    ASSERT_EQUALS(PlanCache::totalEstimatedSizeBytes(), totalBefore);
+}
+
+// A cache which has filled the memory budget shared by all plan caches does not keep the other
+// caches from holding their fair share of it.
+TEST(PlanCacheTest, CachesGetFairShareOfMemoryBudget) {
+    QueryTestServiceContext serviceContext;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    std::vector<unique_ptr<CanonicalQuery>> cqs;
+    for (auto&& query : {"{a: 1}", "{b: 1}", "{c: 1}", "{d: 1}"}) {
+        cqs.push_back(canonicalize(query));
+    }
+
+    const long long totalBefore = PlanCache::totalEstimatedSizeBytes();
+    PlanCache busyPlanCache;
+    ASSERT_OK(busyPlanCache.add(*cqs[0], solns, createDecision(1U), Date_t{}));
+    const size_t entrySizeBytes = busyPlanCache.estimatedSizeBytes();
+
+    // Leave room for four and a half entries, and fill four of them with a single cache.
+    const int oldMaxSizeBytes = internalQueryCacheMaxSizeBytes.load();
+    ON_BLOCK_EXIT([oldMaxSizeBytes] { internalQueryCacheMaxSizeBytes.store(oldMaxSizeBytes); });
+    internalQueryCacheMaxSizeBytes.store(
+        static_cast<int>(totalBefore + 4 * entrySizeBytes + entrySizeBytes / 2));
+    for (size_t i = 1; i < cqs.size(); ++i) {
+        ASSERT_OK(busyPlanCache.add(*cqs[i], solns, createDecision(1U), Date_t{}));
+    }
+    ASSERT_EQUALS(busyPlanCache.size(), 4U);
+
+    // Another cache may hold two entries, its share of the budget, at the expense of the entries
+    // the busy cache uses least.
+    CachedSolution* rawCachedSolution;
+    ASSERT_OK(busyPlanCache.get(*cqs[2], &rawCachedSolution));
+    delete rawCachedSolution;
+    ASSERT_OK(busyPlanCache.get(*cqs[3], &rawCachedSolution));
+    delete rawCachedSolution;
+
+    PlanCache otherPlanCache;
+    ASSERT_OK(otherPlanCache.add(*cqs[0], solns, createDecision(1U), Date_t{}));
+    ASSERT_OK(otherPlanCache.add(*cqs[1], solns, createDecision(1U), Date_t{}));
+    ASSERT_EQUALS(otherPlanCache.size(), 2U);
+    ASSERT_EQUALS(busyPlanCache.size(), 2U);
+    ASSERT_TRUE(busyPlanCache.contains(*cqs[2]));
+    ASSERT_TRUE(busyPlanCache.contains(*cqs[3]));
+    ASSERT_LTE(PlanCache::totalEstimatedSizeBytes(), internalQueryCacheMaxSizeBytes.load());
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -1180,6 +1289,76 @@ TEST_F(CachePlanSelectionTest, CachedPlanForIntersectionWithNonMultikeyIndexCanI
         "{ixscan: {pattern: {'a.c': 1}, bounds: {'a.c': [[0, 10, true, false]]}}}]}}}}");
 }
 
+//
+// Auto-parameterization of cached plans.
+//
+
+TEST_F(CachePlanSelectionTest, AccessPlanTemplateIsReboundToNewConstants) {
+    addIndex(BSON("a" << 1 << "b" << 1), "a_1_b_1");
+    runQuery(fromjson("{a: 3, b: {$gt: 5}}"));
+    QuerySolution* bestSoln = firstMatchingSolution(
+        "{fetch: {filter: null, node: {ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}");
+
+    QuerySolution qs;
+    qs.cacheData.reset(bestSoln->cacheData->clone());
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(&qs);
+    PlanCacheEntry entry(solutions, createDecision(1U));
+    CachedSolution cachedSoln(ck, entry);
+    CachedSolution parameterizedSoln(ck, entry);
+
+    // Planning from an entry without a template offers one.
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 3, b: {$gt: 5}}"));
+    std::unique_ptr<QuerySolutionNode> accessPlanTemplate;
+    ASSERT_OK(
+        QueryPlanner::planFromCache(*cq, params, cachedSoln, &accessPlanTemplate).getStatus());
+    ASSERT(accessPlanTemplate);
+    parameterizedSoln.accessPlanTemplate = std::move(accessPlanTemplate);
+
+    // Binding the template to other constants must produce the same solution as planning from the
+    // cache entry without it, including when the new bounds are not exact and the planner has to
+    // add a filter.
+    for (auto&& query : {"{a: 7, b: {$gt: 1}}",
+                         "{a: 'x', b: {$gt: 'y'}}",
+                         "{a: null, b: {$gt: 5}}",
+                         "{a: [1, 2], b: {$gt: 5}}"}) {
+        cq = canonicalize(query);
+        auto withTemplate = QueryPlanner::planFromCache(*cq, params, parameterizedSoln);
+        ASSERT_OK(withTemplate.getStatus());
+        auto withoutTemplate = QueryPlanner::planFromCache(*cq, params, cachedSoln);
+        ASSERT_OK(withoutTemplate.getStatus());
+        ASSERT_EQUALS(withTemplate.getValue()->toString(), withoutTemplate.getValue()->toString());
+    }
+
+    cq = canonicalize("{a: 7, b: {$gt: 1}}");
+    auto statusWithQs = QueryPlanner::planFromCache(*cq, params, parameterizedSoln);
+    ASSERT_OK(statusWithQs.getStatus());
+    assertSolutionMatches(statusWithQs.getValue().get(),
+                          "{fetch: {filter: null, node: {ixscan: {filter: null, pattern: {a: 1, "
+                          "b: 1}, bounds: {a: [[7, 7, true, true]], b: [[1, Infinity, false, "
+                          "true]]}}}}}");
+}
+
+TEST_F(CachePlanSelectionTest, NoAccessPlanTemplateForPlanWithFilter) {
+    addIndex(BSON("a" << 1), "a_1");
+    runQuery(fromjson("{a: 3, b: 5}"));
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1}}}}}");
+
+    QuerySolution qs;
+    qs.cacheData.reset(bestSoln->cacheData->clone());
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(&qs);
+    PlanCacheEntry entry(solutions, createDecision(1U));
+    CachedSolution cachedSoln(ck, entry);
+
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 3, b: 5}"));
+    std::unique_ptr<QuerySolutionNode> accessPlanTemplate;
+    ASSERT_OK(
+        QueryPlanner::planFromCache(*cq, params, cachedSoln, &accessPlanTemplate).getStatus());
+    ASSERT_FALSE(accessPlanTemplate);
+}
+
 //
 // Check queries that, at least for now, are not cached.
 //
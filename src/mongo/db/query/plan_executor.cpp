@@ -48,6 +48,7 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
@@ -207,6 +208,15 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PlanExecutor::make(
         return status;
     }
 
+    // Working the plan ahead of the caller is only safe if nothing depends on the plan having
+    // done exactly as much work as needed to produce the results returned so far. That is not the
+    // case for plans which write, for tailable cursors, or for scans of the oplog whose latest
+    // timestamp is read between results.
+    PlanStage* root = exec->_root.get();
+    exec->_canWorkInBatches = !getStageByType(root, STAGE_UPDATE) &&
+        !getStageByType(root, STAGE_DELETE) && !exec->_nss.isOplog() &&
+        !(exec->_cq && exec->_cq->getQueryRequest().isTailable());
+
     return std::move(exec);
 }
 
@@ -488,6 +498,13 @@ PlanExecutor::ExecState PlanExecutor::waitForInserts(CappedInsertNotifierData* n
     return DEAD;
 }
 
+size_t PlanExecutor::getWorkBatchSize() const {
+    if (!_canWorkInBatches) {
+        return 1;
+    }
+    return std::max(1, internalQueryExecWorkBatchSize.load());
+}
+
 PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut) {
     if (MONGO_FAIL_POINT(planExecutorAlwaysFails)) {
         Status status(ErrorCodes::OperationFailed,
@@ -525,6 +542,10 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
     // Incremented on every writeConflict, reset to 0 on any successful call to _root->work.
     size_t writeConflictsInARow = 0;
 
+    // Callers which want RecordIds observe the plan's position, so only callers which want
+    // documents alone get their results from batches.
+    const size_t workBatchSize = (objOut && !dlOut) ? getWorkBatchSize() : 1;
+
     // Capped insert data; declared outside the loop so we hold a shared pointer to the capped
     // insert notifier the entire time we are in the loop.  Holding a shared pointer to the capped
     // insert notifier is necessary for the notifierVersion to advance.
@@ -553,8 +574,39 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         // use the same RecordFetcher twice.
         fetcher.reset();
 
+        if (!_batchedResults.empty()) {
+            *objOut = std::move(_batchedResults.front());
+            _batchedResults.pop_front();
+            return PlanExecutor::ADVANCED;
+        }
+
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code;
+        if (workBatchSize > 1) {
+            // Buffer owned copies of the results, which are returned at the top of the loop once
+            // any yield the batch ended with has been handled.
+            std::vector<WorkingSetID> batch;
+            code = _root->workBatch(_workingSet.get(), workBatchSize, &batch, &id);
+            for (auto resultId : batch) {
+                WorkingSetMember* member = _workingSet->get(resultId);
+                if (WorkingSetMember::RID_AND_IDX == member->getState()) {
+                    if (1 == member->keyData.size()) {
+                        _batchedResults.emplace_back(SnapshotId(),
+                                                     member->keyData[0].keyData.getOwned());
+                    }
+                } else if (member->hasObj()) {
+                    _batchedResults.emplace_back(member->obj.snapshotId(),
+                                                 member->obj.value().getOwned());
+                }
+                _workingSet->free(resultId);
+            }
+
+            if (PlanStage::ADVANCED == code) {
+                code = PlanStage::NEED_TIME;
+            }
+        } else {
+            code = _root->work(&id);
+        }
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
@@ -618,6 +670,10 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         } else if (PlanStage::NEED_TIME == code) {
             // Fall through to yield check at end of large conditional.
         } else if (PlanStage::IS_EOF == code) {
+            if (!_batchedResults.empty()) {
+                // Return the rest of the final batch before reporting EOF.
+                continue;
+            }
             if (!shouldWaitForInserts()) {
                 return PlanExecutor::IS_EOF;
             }
@@ -629,6 +685,7 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
             return waitResult;
         } else {
             invariant(PlanStage::DEAD == code || PlanStage::FAILURE == code);
+            _batchedResults.clear();
 
             if (NULL != objOut) {
                 BSONObj statusObj;
@@ -643,7 +700,8 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
 
 bool PlanExecutor::isEOF() {
     invariant(_currentState == kUsable);
-    return isMarkedAsKilled() || (_stash.empty() && _root->isEOF());
+    return isMarkedAsKilled() ||
+        (_stash.empty() && _batchedResults.empty() && _root->isEOF());
 }
 
 void PlanExecutor::markAsKilled(string reason) {
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 #include <queue>
 
 #include "mongo/base/status.h"
@@ -493,6 +494,12 @@ private:
 
     ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
 
+    /**
+     * Returns the number of units of work to perform on the plan at once when the caller of
+     * getNext() only wants documents, or 1 if the plan must be worked one unit at a time.
+     */
+    size_t getWorkBatchSize() const;
+
     /**
      * New PlanExecutor instances are created with the static make() methods above.
      */
@@ -567,6 +574,14 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Results of working the plan in batches which have yet to be returned. These are returned
+    // after any stashed results and before the plan is worked again.
+    std::deque<Snapshotted<BSONObj>> _batchedResults;
+
+    // Whether the plan may be worked in batches. Plans which write, and plans whose progress is
+    // observed by the caller between results, must be worked one unit at a time.
+    bool _canWorkInBatches = false;
+
     enum { kUsable, kSaved, kDetached, kDisposed } _currentState = kUsable;
 
     // Set if this PlanExecutor is registered with the CursorManager.
@@ -154,12 +154,22 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
     csn->shouldTrackLatestOplogTimestamp =
         params.options & QueryPlannerParams::TRACK_LATEST_OPLOG_TS;
 
+    // Unless the query asks for natural order with a $natural hint or sort below, the scan may
+    // share its reads with other scans of the collection by starting part way through it. A skip
+    // or limit would then select different documents from one run to the next, so paging through
+    // the results with them requires natural order.
+    const auto& qr = query.getQueryRequest();
+    csn->allowSharedScan = !tailable && !csn->shouldTrackLatestOplogTimestamp && !csn->maxScan &&
+        !(params.options & QueryPlannerParams::PRESERVE_NATURAL_ORDER) && !qr.getSkip() &&
+        !qr.getLimit() && !qr.getNToReturn();
+
     // If the hint is {$natural: +-1} this changes the direction of the collection scan.
     if (!query.getQueryRequest().getHint().isEmpty()) {
         BSONElement natural =
             dps::extractElementAtPath(query.getQueryRequest().getHint(), "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            csn->allowSharedScan = false;
         }
     }
 
@@ -170,6 +180,7 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         BSONElement natural = dps::extractElementAtPath(sortObj, "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            csn->allowSharedScan = false;
         }
     }
 
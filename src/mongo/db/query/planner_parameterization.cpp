@@ -0,0 +1,206 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/planner_parameterization.h"
+
+#include <vector>
+
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/index_bounds_builder.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns the IXSCAN of 'accessPlan' if it is an IXSCAN, or a FETCH of one, which can be re-bound
+ * to new constants, and null otherwise.
+ */
+IndexScanNode* getParameterizableIndexScan(QuerySolutionNode* accessPlan) {
+    QuerySolutionNode* node = accessPlan;
+    if (STAGE_FETCH == node->getType()) {
+        if (node->filter || node->children.size() != 1U) {
+            return nullptr;
+        }
+        node = node->children[0];
+    }
+
+    if (STAGE_IXSCAN != node->getType() || node->filter) {
+        return nullptr;
+    }
+
+    IndexScanNode* isn = static_cast<IndexScanNode*>(node);
+    const IndexEntry& index = isn->index;
+    if (INDEX_BTREE != index.type || index.multikey || index.filterExpr ||
+        isn->bounds.isSimpleRange) {
+        return nullptr;
+    }
+    return isn;
+}
+
+bool isParameterizablePredicate(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::MATCH_IN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Replaces the bounds of 'isn' with bounds built from the predicates of 'query', the same way the
+ * planner builds them for an index scan which every predicate is assigned to. Returns false,
+ * leaving 'isn' in an unspecified state, if 'query' has a predicate which does not translate into
+ * exact bounds over one of the index's fields.
+ */
+bool bindIndexBounds(const CanonicalQuery& query, IndexScanNode* isn) {
+    const MatchExpression* root = query.root();
+    std::vector<const MatchExpression*> predicates;
+    if (MatchExpression::AND == root->matchType()) {
+        for (size_t i = 0; i < root->numChildren(); ++i) {
+            predicates.push_back(root->getChild(i));
+        }
+    } else {
+        predicates.push_back(root);
+    }
+
+    const BSONObj& keyPattern = isn->index.keyPattern;
+    IndexBounds bounds;
+    bounds.fields.resize(keyPattern.nFields());
+
+    for (auto predicate : predicates) {
+        if (!isParameterizablePredicate(predicate)) {
+            return false;
+        }
+
+        size_t pos = 0;
+        BSONElement kpElt;
+        for (BSONObjIterator it(keyPattern); it.more(); ++pos) {
+            kpElt = it.next();
+            if (kpElt.fieldNameStringData() == predicate->path()) {
+                break;
+            }
+        }
+        if (pos == bounds.fields.size()) {
+            return false;
+        }
+
+        OrderedIntervalList* oil = &bounds.fields[pos];
+        IndexBoundsBuilder::BoundsTightness tightness;
+        if (oil->name.empty()) {
+            IndexBoundsBuilder::translate(predicate, kpElt, isn->index, oil, &tightness);
+        } else {
+            IndexBoundsBuilder::translateAndIntersect(
+                predicate, kpElt, isn->index, oil, &tightness);
+        }
+        if (IndexBoundsBuilder::EXACT != tightness) {
+            return false;
+        }
+    }
+
+    // Fields without predicates are scanned in full.
+    size_t pos = 0;
+    for (BSONObjIterator it(keyPattern); it.more(); ++pos) {
+        BSONElement kpElt = it.next();
+        if (bounds.fields[pos].name.empty()) {
+            IndexBoundsBuilder::allValuesForField(kpElt, &bounds.fields[pos]);
+        }
+    }
+    IndexBoundsBuilder::alignBounds(&bounds, keyPattern);
+
+    isn->bounds = std::move(bounds);
+    isn->maxScan = query.getQueryRequest().getMaxScan();
+    isn->addKeyMetadata = query.getQueryRequest().returnKey();
+    isn->queryCollator = query.getCollator();
+    return true;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<QuerySolutionNode> QueryPlannerParameterization::makeAccessPlanTemplate(
+    const CanonicalQuery& query, const QuerySolutionNode& accessPlan) {
+    std::unique_ptr<QuerySolutionNode> accessPlanTemplate(accessPlan.clone());
+    IndexScanNode* isn = getParameterizableIndexScan(accessPlanTemplate.get());
+    if (!isn) {
+        return nullptr;
+    }
+
+    // Only keep the template if re-binding it to 'query' itself reproduces the bounds built by the
+    // planner. This confirms that every predicate of the query shape ends up in the bounds, and
+    // does so in the same way as when the planner builds the bounds.
+    const IndexBounds plannerBounds = isn->bounds;
+    if (!bindIndexBounds(query, isn) || isn->bounds != plannerBounds) {
+        return nullptr;
+    }
+    return accessPlanTemplate;
+}
+
+// static
+std::unique_ptr<QuerySolutionNode> QueryPlannerParameterization::bindAccessPlanTemplate(
+    const CanonicalQuery& query, const QuerySolutionNode& accessPlanTemplate) {
+    std::unique_ptr<QuerySolutionNode> accessPlan(accessPlanTemplate.clone());
+    IndexScanNode* isn = getParameterizableIndexScan(accessPlan.get());
+    invariant(isn);
+    if (!bindIndexBounds(query, isn)) {
+        return nullptr;
+    }
+    return accessPlan;
+}
+
+// static
+size_t QueryPlannerParameterization::estimateTemplateSizeInBytes(
+    const QuerySolutionNode& accessPlanTemplate) {
+    size_t size = 0;
+    const QuerySolutionNode* node = &accessPlanTemplate;
+    if (STAGE_FETCH == node->getType()) {
+        size += sizeof(FetchNode) + node->children.capacity() * sizeof(QuerySolutionNode*);
+        node = node->children[0];
+    }
+
+    invariant(STAGE_IXSCAN == node->getType());
+    const IndexScanNode* isn = static_cast<const IndexScanNode*>(node);
+    size += sizeof(IndexScanNode) + isn->index.keyPattern.objsize() +
+        isn->index.infoObj.objsize() + isn->index.name.capacity();
+    for (auto&& oil : isn->bounds.fields) {
+        size += sizeof(oil) + oil.name.capacity();
+        for (auto&& interval : oil.intervals) {
+            size += sizeof(interval) + interval._intervalData.objsize();
+        }
+    }
+    return size;
+}
+
+}  // namespace mongo
@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+/**
+ * Auto-parameterization of cached plans.
+ *
+ * Queries which share a plan cache entry have the same shape, and differ only in the constants
+ * they compare against. For the simplest plans, a scan of a single index whose bounds answer the
+ * entire predicate, the data access plan only depends on those constants through the index
+ * bounds. Such a plan can be kept as a template and re-bound to the constants of each new query,
+ * which is much cheaper than tagging the match expression according to the cache and building the
+ * data access plan from scratch.
+ */
+class QueryPlannerParameterization {
+public:
+    /**
+     * Returns a template which can be re-bound to other queries with the same shape as 'query',
+     * where 'accessPlan' is the data access plan the planner built for 'query' from the cache.
+     * Returns a null pointer if 'accessPlan' cannot be parameterized.
+     *
+     * A plan can be parameterized if it is an IXSCAN, optionally under a FETCH, which has no
+     * residual filters, over a single-field or compound btree index which is neither multikey nor
+     * partial. 'accessPlan' is not modified.
+     */
+    static std::unique_ptr<QuerySolutionNode> makeAccessPlanTemplate(
+        const CanonicalQuery& query, const QuerySolutionNode& accessPlan);
+
+    /**
+     * Returns a copy of 'accessPlanTemplate' whose index bounds are built from the constants in
+     * 'query', which must have the same plan cache key as the query the template was made from.
+     * Returns a null pointer if the bounds for 'query' are not exact, in which case the plan needs
+     * a filter and must be built by the planner.
+     */
+    static std::unique_ptr<QuerySolutionNode> bindAccessPlanTemplate(
+        const CanonicalQuery& query, const QuerySolutionNode& accessPlanTemplate);
+
+    /**
+     * Returns an estimate of the memory used by a template returned from makeAccessPlanTemplate().
+     */
+    static size_t estimateTemplateSizeInBytes(const QuerySolutionNode& accessPlanTemplate);
+};
+
+}  // namespace mongo
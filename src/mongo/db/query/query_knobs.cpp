@@ -40,10 +40,14 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheMaxSizeBytes, int, 100 * 1024 * 1024);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheAutoParameterization, bool, true);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -62,12 +66,22 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecSorterParallelism, int, 1);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecWorkBatchSize, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnableSharedCollectionScans, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQuerySharedCollectionScanMinSizeMB, int, 100);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetBufferSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetMaxParallelism, int, 1);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
                               int,
                               internalQueryExecYieldIterations.load() / 2);
@@ -76,6 +90,16 @@ MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMaxBytes, int, 100 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupBatchSize, int, 100);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupSpillPartitions, int, 16);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMaxParallelism, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCompileAggregationExpressions, bool, false);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
@@ -64,6 +64,10 @@ extern AtomicBool internalQueryPlannerEnableHashIntersection;
 // How many entries in the cache?
 extern AtomicInt32 internalQueryCacheSize;
 
+// How many bytes may the cached entries of all collections use, in total? When exceeded, the
+// least frequently used entries of the cache being added to are evicted.
+extern AtomicInt32 internalQueryCacheMaxSizeBytes;
+
 // How many feedback entries do we collect before possibly evicting from the cache based on bad
 // performance?
 extern AtomicInt32 internalQueryCacheFeedbacksStored;
@@ -72,6 +76,10 @@ extern AtomicInt32 internalQueryCacheFeedbacksStored;
 // and replanning?
 extern AtomicDouble internalQueryCacheEvictionRatio;
 
+// Should cached index scans be re-bound to the constants of new queries, rather than being planned
+// again from the cached index assignments?
+extern AtomicBool internalQueryCacheAutoParameterization;
+
 //
 // Planning and enumeration.
 //
@@ -104,23 +112,73 @@ extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
 extern AtomicInt32 internalQueryExecMaxBlockingSortBytes;
 
+// Number of threads a single external sort may use to sort and spill runs and to read spilled runs
+// ahead of the merge. Values below 1 are treated as 1.
+extern AtomicInt32 internalQueryExecSorterParallelism;
+
 // Yield after this many "should yield?" checks.
 extern AtomicInt32 internalQueryExecYieldIterations;
 
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
+// Maximum number of units of work a read-only PlanExecutor performs on its plan at once, buffering
+// the results, when the caller only wants documents. Values below 2 disable batching, in which
+// case the plan is worked one unit at a time.
+extern AtomicInt32 internalQueryExecWorkBatchSize;
+
+// Allows a collection scan which need not return documents in natural order to start at the
+// position of a scan of the collection which is already in progress, so that the two share the
+// records they read from disk. Off by default, since such scans return documents in a different
+// order from one run to the next.
+extern AtomicBool internalQueryEnableSharedCollectionScans;
+
+// Minimum size in megabytes of a collection for its collection scans to be shared, when
+// internalQueryEnableSharedCollectionScans is set. Values below 0 disable sharing.
+extern AtomicInt32 internalQuerySharedCollectionScanMinSizeMB;
+
 // Limit the size that we write without yielding to 16MB / 64 (max expected number of indexes)
 const int64_t insertVectorMaxBytes = 256 * 1024;
 
 // The number of bytes to buffer at once during a $facet stage.
 extern AtomicInt32 internalQueryFacetBufferSizeBytes;
 
+// The maximum number of $facet sub-pipelines to run at once, on a shared pool of worker threads.
+// Only sub-pipelines made up of stages which do not access storage are run concurrently. A value
+// of 1 runs the sub-pipelines one after another on the thread running the aggregation.
+extern AtomicInt32 internalQueryFacetMaxParallelism;
+
 extern AtomicInt32 internalInsertMaxBatchSize;
 
 extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// Maximum size in bytes of the in-memory copy of the foreign collection that a localField/
+// foreignField $lookup builds to execute as a hash join. A $lookup whose foreign collection exceeds
+// this falls back to querying the foreign collection once per input document. A value of 0
+// disables hash joins.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxBytes;
+
+// Number of input documents a localField/foreignField $lookup which does not execute as a hash join
+// reads ahead and joins using a single query against the foreign collection. The documents joined
+// with a batch are bounded by 'internalDocumentSourceLookupHashJoinMaxBytes'. Values below 2
+// disable batching.
+extern AtomicInt32 internalDocumentSourceLookupBatchSize;
+
+// Number of partitions an unsorted $group hashes its groups into when it spills to disk. Each
+// partition is re-aggregated on its own once the input is exhausted. Values below 2 make $group
+// spill sorted runs and merge them instead.
+extern AtomicInt32 internalDocumentSourceGroupSpillPartitions;
+
+// The number of worker threads which compute a $group directly following a collection scan, along
+// with the stages before it, each over chunks of the scanned documents. The partial groups of the
+// workers are then merged. A value of 1 computes the $group on the thread running the aggregation.
+extern AtomicInt32 internalDocumentSourceGroupMaxParallelism;
+
+// Whether $project, $addFields and $group evaluate their expressions with programs compiled from
+// the optimized expression trees, rather than by walking the trees.
+extern AtomicBool internalQueryCompileAggregationExpressions;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
 }  // namespace mongo
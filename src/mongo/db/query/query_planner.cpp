@@ -32,6 +32,7 @@
 
 #include "mongo/db/query/query_planner.h"
 
+#include <algorithm>
 #include <boost/optional.hpp>
 #include <vector>
 
@@ -50,6 +51,8 @@
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/planner_parameterization.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/log.h"
@@ -135,6 +138,10 @@ string optionString(size_t options) {
                 break;
             case QueryPlannerParams::TRACK_LATEST_OPLOG_TS:
                 ss << "TRACK_LATEST_OPLOG_TS ";
+                break;
+            case QueryPlannerParams::PRESERVE_NATURAL_ORDER:
+                ss << "PRESERVE_NATURAL_ORDER ";
+                break;
             case QueryPlannerParams::DEFAULT:
                 MONGO_UNREACHABLE;
                 break;
@@ -320,8 +327,7 @@ StatusWith<std::unique_ptr<PlanCacheIndexTree>> QueryPlanner::cacheDataFromTagge
             return Status(ErrorCodes::BadValue, "can't cache '2d' index");
         }
 
-        IndexEntry* ientry = new IndexEntry(relevantIndices[itag->index]);
-        indexTree->entry.reset(ientry);
+        indexTree->setIndexEntry(relevantIndices[itag->index]);
         indexTree->index_pos = itag->pos;
         indexTree->canCombineBounds = itag->canCombineBounds;
     } else if (taggedTree->getTag() &&
@@ -335,9 +341,7 @@ StatusWith<std::unique_ptr<PlanCacheIndexTree>> QueryPlanner::cacheDataFromTagge
                 return Status(ErrorCodes::BadValue, "can't cache '2d' index");
             }
 
-            std::unique_ptr<IndexEntry> indexEntry =
-                stdx::make_unique<IndexEntry>(relevantIndices[itag->index]);
-            indexTree->entry.reset(indexEntry.release());
+            indexTree->setIndexEntry(relevantIndices[itag->index]);
             indexTree->index_pos = itag->pos;
             indexTree->canCombineBounds = itag->canCombineBounds;
         }
@@ -414,11 +418,11 @@ Status QueryPlanner::tagAccordingToCache(MatchExpression* filter,
         }
     }
 
-    if (indexTree->entry.get()) {
-        map<StringData, size_t>::const_iterator got = indexMap.find(indexTree->entry->name);
+    if (indexTree->indexName) {
+        map<StringData, size_t>::const_iterator got = indexMap.find(*indexTree->indexName);
         if (got == indexMap.end()) {
             mongoutils::str::stream ss;
-            ss << "Did not find index with name: " << indexTree->entry->name;
+            ss << "Did not find index with name: " << *indexTree->indexName;
             return Status(ErrorCodes::BadValue, ss);
         }
         if (filter->getTag()) {
@@ -437,7 +441,8 @@ Status QueryPlanner::tagAccordingToCache(MatchExpression* filter,
 StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
     const CanonicalQuery& query,
     const QueryPlannerParams& params,
-    const CachedSolution& cachedSoln) {
+    const CachedSolution& cachedSoln,
+    std::unique_ptr<QuerySolutionNode>* accessPlanTemplateOut) {
     invariant(!cachedSoln.plannerData.empty());
 
     // A query not suitable for caching should not have made its way into the cache.
@@ -448,8 +453,15 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
 
     if (SolutionCacheData::WHOLE_IXSCAN_SOLN == winnerCacheData.solnType) {
         // The solution can be constructed by a scan over the entire index.
-        auto soln = buildWholeIXSoln(
-            *winnerCacheData.tree->entry, query, params, winnerCacheData.wholeIXSolnDir);
+        const std::string& indexName = *winnerCacheData.tree->indexName;
+        auto index = std::find_if(params.indices.begin(),
+                                  params.indices.end(),
+                                  [&](const IndexEntry& ie) { return ie.name == indexName; });
+        if (index == params.indices.end()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "Did not find index with name: " << indexName);
+        }
+        auto soln = buildWholeIXSoln(*index, query, params, winnerCacheData.wholeIXSolnDir);
         if (!soln) {
             return Status(ErrorCodes::BadValue,
                           "plan cache error: soln that uses index to provide sort");
@@ -471,6 +483,23 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
     // If we're here then this is neither the whole index scan or collection scan
     // cases, and we proceed by using the PlanCacheIndexTree to tag the query tree.
 
+    // If an earlier query with this shape left a parameterized data access plan in the cache, try
+    // to bind it to the constants in 'query' rather than building the data access plan again.
+    const bool autoParameterize = internalQueryCacheAutoParameterization.load();
+    if (autoParameterize && cachedSoln.accessPlanTemplate) {
+        auto accessPlan = QueryPlannerParameterization::bindAccessPlanTemplate(
+            query, *cachedSoln.accessPlanTemplate);
+        if (accessPlan) {
+            auto soln =
+                QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(accessPlan));
+            if (soln) {
+                LOG(5) << "Planner: solution bound from the cached access plan template:\n"
+                       << redact(soln->toString());
+                return {std::move(soln)};
+            }
+        }
+    }
+
     // Create a copy of the expression tree.  We use cachedSoln to annotate this with indices.
     unique_ptr<MatchExpression> clone = query.root()->shallowClone();
 
@@ -509,6 +538,11 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
                                     << query.toStringShort());
     }
 
+    if (autoParameterize && accessPlanTemplateOut && !cachedSoln.accessPlanTemplate) {
+        *accessPlanTemplateOut =
+            QueryPlannerParameterization::makeAccessPlanTemplate(query, *solnRoot);
+    }
+
     auto soln = QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
     if (!soln) {
         return Status(ErrorCodes::BadValue,
@@ -60,11 +60,15 @@ public:
      * @param query -- query for which we are generating a plan
      * @param params -- planning parameters
      * @param cachedSoln -- the CachedSolution retrieved from the plan cache.
+     * @param accessPlanTemplateOut -- if non-null, and 'cachedSoln' has no access plan template
+     *   yet, set to a template of the data access plan built for 'query' if it can be re-bound
+     *   to the constants of other queries. The caller should store it in the plan cache entry.
      */
     static StatusWith<std::unique_ptr<QuerySolution>> planFromCache(
         const CanonicalQuery& query,
         const QueryPlannerParams& params,
-        const CachedSolution& cachedSoln);
+        const CachedSolution& cachedSoln,
+        std::unique_ptr<QuerySolutionNode>* accessPlanTemplateOut = nullptr);
 
     /**
      * Generates and returns the index tag tree that will be inserted into the plan cache. This data
@@ -101,6 +101,11 @@ struct QueryPlannerParams {
 
         // Set this to track the most recent timestamp seen by this cursor while scanning the oplog.
         TRACK_LATEST_OPLOG_TS = 1 << 12,
+
+        // Set this if a collection scan must visit documents in natural order, for instance
+        // because only the first matching document is used. This prevents the scan from sharing
+        // its reads with other scans of the collection.
+        PRESERVE_NATURAL_ORDER = 1 << 13,
     };
 
     // See Options enum above.
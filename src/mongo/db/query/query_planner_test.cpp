@@ -5559,4 +5559,35 @@ TEST_F(QueryPlannerTest, EmptyQueryWithProjectionUsesCollscanIfIndexCollationDif
         "{proj: {spec: {_id: 0, a: 1}, node: "
         "{cscan: {dir: 1}}}}");
 }
+
+const CollectionScanNode* findCollectionScan(const QuerySolutionNode* node) {
+    while (node->getType() != STAGE_COLLSCAN) {
+        ASSERT_EQ(node->children.size(), 1U);
+        node = node->children[0];
+    }
+    return static_cast<const CollectionScanNode*>(node);
+}
+
+TEST_F(QueryPlannerTest, CollscanSharesReadsOnlyWhenNaturalOrderIsNotNeeded) {
+    runQuery(BSON("a" << 1));
+    assertNumSolutions(1U);
+    ASSERT_TRUE(findCollectionScan(solns[0]->root.get())->allowSharedScan);
+
+    runQuerySkipNToReturn(BSON("a" << 1), 5, 0);
+    assertNumSolutions(1U);
+    ASSERT_FALSE(findCollectionScan(solns[0]->root.get())->allowSharedScan);
+
+    runQuerySkipNToReturn(BSON("a" << 1), 0, 5);
+    assertNumSolutions(1U);
+    ASSERT_FALSE(findCollectionScan(solns[0]->root.get())->allowSharedScan);
+
+    runQueryHint(BSON("a" << 1), BSON("$natural" << 1));
+    assertNumSolutions(1U);
+    ASSERT_FALSE(findCollectionScan(solns[0]->root.get())->allowSharedScan);
+
+    params.options |= QueryPlannerParams::PRESERVE_NATURAL_ORDER;
+    runQuery(BSON("a" << 1));
+    assertNumSolutions(1U);
+    ASSERT_FALSE(findCollectionScan(solns[0]->root.get())->allowSharedScan);
+}
 }  // namespace
@@ -389,6 +389,14 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -520,6 +528,10 @@ private:
     bool _exhaust = false;
     bool _allowPartialResults = false;
 
+    // Whether blocking stages may spill to disk rather than fail once they exceed their memory
+    // limit.
+    bool _allowDiskUse = false;
+
     boost::optional<long long> _replicationTerm;
 };
 
@@ -451,6 +451,19 @@ TEST(QueryRequestTest, ParseFromCommandAllFlagsTrue) {
     ASSERT(qr->isAllowPartialResults());
 }
 
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUse) {
+    BSONObj cmdObj = fromjson("{find: 'testns', sort: {a: 1}, allowDiskUse: true}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<QueryRequest> qr(
+        assertGet(QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain)));
+
+    ASSERT(qr->allowDiskUse());
+
+    // The option should survive a round trip through the find command.
+    ASSERT_TRUE(qr->asFindCommand()["allowDiskUse"].trueValue());
+}
+
 TEST(QueryRequestTest, ParseFromCommandCommentWithValidMinMax) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -801,6 +814,17 @@ TEST(QueryRequestTest, ParseFromCommandPartialWrongType) {
     ASSERT_NOT_OK(result.getStatus());
 }
 
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUseWrongType) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "allowDiskUse: 3}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
 TEST(QueryRequestTest, ParseFromCommandReadConcernWrongType) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -1286,6 +1310,19 @@ TEST(QueryRequestTest, ConvertToAggregationWithPipeline) {
                       SimpleBSONObjComparator::kInstance.makeEqualTo()));
 }
 
+TEST(QueryRequestTest, ConvertToAggregationWithAllowDiskUse) {
+    QueryRequest qr(testns);
+    qr.setSort(BSON("y" << -1));
+    qr.setAllowDiskUse(true);
+
+    auto agg = qr.asAggregationCommand();
+    ASSERT_OK(agg);
+
+    auto ar = AggregationRequest::parseFromBSON(testns, agg.getValue());
+    ASSERT_OK(ar.getStatus());
+    ASSERT(ar.getValue().shouldAllowDiskUse());
+}
+
 TEST(QueryRequestTest, ConvertToAggregationWithBatchSize) {
     QueryRequest qr(testns);
     qr.setBatchSize(4);
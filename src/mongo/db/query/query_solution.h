@@ -305,6 +305,10 @@ struct CollectionScanNode : public QuerySolutionNode {
 
     // maxScan option to .find() limits how many docs we look at.
     int maxScan;
+
+    // Whether the scan may start part way through the collection, because the query does not ask
+    // for its results in natural order.
+    bool allowSharedScan = false;
 };
 
 struct AndHashNode : public QuerySolutionNode {
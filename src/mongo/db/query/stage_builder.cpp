@@ -58,6 +58,7 @@
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -82,6 +83,7 @@ PlanStage* buildStages(OperationContext* opCtx,
             params.direction = (csn->direction == 1) ? CollectionScanParams::FORWARD
                                                      : CollectionScanParams::BACKWARD;
             params.maxScan = csn->maxScan;
+            params.allowSharedScan = csn->allowSharedScan;
             return new CollectionScan(opCtx, params, ws, csn->filter.get());
         }
         case STAGE_IXSCAN: {
@@ -122,6 +124,10 @@ PlanStage* buildStages(OperationContext* opCtx,
             params.collection = collection;
             params.pattern = sn->pattern;
             params.limit = sn->limit;
+            if (cq.getQueryRequest().allowDiskUse() && !storageGlobalParams.readOnly) {
+                params.allowDiskUse = true;
+                params.tempDir = storageGlobalParams.dbpath + "/_tmp";
+            }
             return new SortStage(opCtx, params, ws, childStage);
         }
         case STAGE_SORT_KEY_GENERATOR: {
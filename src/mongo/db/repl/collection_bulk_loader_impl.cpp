@@ -152,6 +152,13 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
             if (_secondaryIndexesBlock) {
                 indexers.push_back(_secondaryIndexesBlock.get());
             }
+            if (!indexers.empty() && !_triedBulkBuilder) {
+                // The collection was created for this load and is dropped if it fails, so its
+                // records need not be written transactionally.
+                _triedBulkBuilder = true;
+                _bulkBuilder =
+                    _autoColl->getCollection()->getRecordStore()->makeBulkBuilder(_opCtx.get());
+            }
 
             Status status = writeConflictRetry(
                 _opCtx.get(), "CollectionBulkLoaderImpl::insertDocuments", _nss.ns(), [&] {
@@ -160,7 +167,7 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
                         // This flavor of insertDocument will not update any pre-existing indexes,
                         // only the indexers passed in.
                         const auto status = _autoColl->getCollection()->insertDocument(
-                            _opCtx.get(), *iter, indexers, false);
+                            _opCtx.get(), *iter, indexers, false, _bulkBuilder.get());
                         if (!status.isOK()) {
                             return status;
                         }
@@ -195,6 +202,9 @@ Status CollectionBulkLoaderImpl::commit() {
         LOG(2) << "Creating indexes for ns: " << _nss.ns();
         UnreplicatedWritesBlock uwb(_opCtx.get());
 
+        // Make the bulk loaded records visible before deleting the duplicates among them.
+        _bulkBuilder.reset();
+
         // Commit before deleting dups, so the dups will be removed from secondary indexes when
         // deleted.
         if (_secondaryIndexesBlock) {
@@ -268,6 +278,8 @@ void CollectionBulkLoaderImpl::_releaseResources() {
         _idIndexBlock.reset();
     }
 
+    _bulkBuilder.reset();
+
     // release locks.
     _autoColl.reset();
 }
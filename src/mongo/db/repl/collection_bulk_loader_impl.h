@@ -88,6 +88,9 @@ private:
     NamespaceString _nss;
     std::unique_ptr<MultiIndexBlock> _idIndexBlock;
     std::unique_ptr<MultiIndexBlock> _secondaryIndexesBlock;
+    // Appends records to the empty collection outside of any WriteUnitOfWork, when supported.
+    std::unique_ptr<RecordStoreBulkBuilder> _bulkBuilder;
+    bool _triedBulkBuilder = false;
     BSONObj _idIndexSpec;
     Stats _stats;
 };
@@ -59,11 +59,16 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/future.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/unowned_ptr.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 namespace sorter {
@@ -79,6 +84,13 @@ inline std::string myErrnoWithDescription() {
     return sb.str();
 }
 
+/** Checksum of a spill file block as it is stored on disk. */
+inline uint32_t blockChecksum(const char* data, int32_t size) {
+    uint32_t checksum;
+    MurmurHash3_x86_32(data, size, 0, &checksum);
+    return checksum;
+}
+
 template <typename Data, typename Comparator>
 void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs) {
 #if defined(MONGO_CONFIG_DEBUG_BUILD) && !defined(_MSC_VER)
@@ -114,6 +126,37 @@ private:
     const std::string _fileName;
 };
 
+/**
+ * Returns the pool of worker threads shared by every Sorter running with a parallelism above 1.
+ * The pool is created on first use and lives for the rest of the process.
+ */
+inline ThreadPool& workerPool() {
+    static ThreadPool* pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "SorterWorkers";
+        options.minThreads = 0;
+        options.maxThreads = std::max(1U, stdx::thread::hardware_concurrency());
+        auto newPool = new ThreadPool(options);
+        newPool->startup();
+        return newPool;
+    }();
+    return *pool;
+}
+
+/**
+ * Runs 'task' on the worker pool, or inline if the pool no longer accepts work. Exceptions thrown
+ * by 'task' are rethrown by get() on the returned future.
+ */
+template <typename Result>
+stdx::future<Result> runOnWorkerPool(stdx::function<Result()> task) {
+    auto packagedTask = std::make_shared<stdx::packaged_task<Result()>>(std::move(task));
+    auto future = packagedTask->get_future();
+    if (!workerPool().schedule([packagedTask] { (*packagedTask)(); }).isOK()) {
+        (*packagedTask)();
+    }
+    return future;
+}
+
 /** Returns results from sorted in-memory storage */
 template <typename Key, typename Value>
 class InMemIterator : public SortIteratorInterface<Key, Value> {
@@ -152,11 +195,17 @@ public:
         Settings;
     typedef std::pair<Key, Value> Data;
 
+    /**
+     * If 'readAhead' is true, the block following the one being iterated over is read, verified
+     * and decompressed on the worker pool.
+     */
     FileIterator(const std::string& fileName,
                  const Settings& settings,
-                 std::shared_ptr<FileDeleter> fileDeleter)
+                 std::shared_ptr<FileDeleter> fileDeleter,
+                 bool readAhead = false)
         : _settings(settings),
           _done(false),
+          _readAhead(readAhead),
           _fileName(fileName),
           _fileDeleter(fileDeleter),
           _file(_fileName.c_str(), std::ios::in | std::ios::binary) {
@@ -170,6 +219,12 @@ public:
                 boost::filesystem::file_size(_fileName) != 0);
     }
 
+    ~FileIterator() {
+        // A read-ahead may still be using _file.
+        if (_nextBlock.valid())
+            _nextBlock.wait();
+    }
+
     bool more() {
         if (!_done)
             fillIfNeeded();  // may change _done
@@ -187,6 +242,12 @@ public:
     }
 
 private:
+    /** A decoded block of the file. A null 'data' means the end of the file was reached. */
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
     void fillIfNeeded() {
         verify(!_done);
 
@@ -195,25 +256,47 @@ private:
     }
 
     void fill() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
-        if (_done)
+        Block block = _nextBlock.valid() ? _nextBlock.get() : readBlock();
+        if (!block.data) {
+            _done = true;
             return;
+        }
+
+        // hold on to the decoded data and throw out the previous block
+        _buffer = std::move(block.data);
+        _reader.reset(new BufReader(_buffer.get(), block.size));
+
+        if (_readAhead) {
+            _nextBlock = runOnWorkerPool<Block>([this] { return readBlock(); });
+        }
+    }
+
+    Block readBlock() {
+        Block block;
+
+        int32_t rawSize;
+        if (!read(&rawSize, sizeof(rawSize)))
+            return block;
 
         // negative size means compressed
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
 
-        _buffer.reset(new char[blockSize]);
-        read(_buffer.get(), blockSize);
-        massert(16816, "file too short?", !_done);
+        uint32_t checksum;
+        std::unique_ptr<char[]> buffer(new char[blockSize]);
+        massert(16816,
+                "file too short?",
+                read(&checksum, sizeof(checksum)) && read(buffer.get(), blockSize));
+        massert(50701,
+                str::stream() << "checksum mismatch in file \"" << _fileName << "\"",
+                blockChecksum(buffer.get(), blockSize) == checksum);
 
         auto encryptionHooks = EncryptionHooks::get(getGlobalServiceContext());
         if (encryptionHooks->enabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
             size_t outLen;
             Status status =
-                encryptionHooks->unprotectTmpData(reinterpret_cast<uint8_t*>(_buffer.get()),
+                encryptionHooks->unprotectTmpData(reinterpret_cast<uint8_t*>(buffer.get()),
                                                   blockSize,
                                                   reinterpret_cast<uint8_t*>(out.get()),
                                                   blockSize,
@@ -222,38 +305,36 @@ private:
                     str::stream() << "Failed to unprotect data: " << status.toString(),
                     status.isOK());
             blockSize = outLen;
-            _buffer.swap(out);
+            buffer.swap(out);
         }
 
         if (!compressed) {
-            _reader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
+            block.data = std::move(buffer);
+            block.size = blockSize;
+            return block;
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+        dassert(snappy::IsValidCompressedBuffer(buffer.get(), blockSize));
 
         size_t uncompressedSize;
         massert(17061,
                 "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                snappy::GetUncompressedLength(buffer.get(), blockSize, &uncompressedSize));
 
-        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
+        block.data.reset(new char[uncompressedSize]);
+        block.size = uncompressedSize;
         massert(17062,
                 "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
-
-        // hold on to decompressed data and throw out compressed data at block exit
-        _buffer.swap(decompressionBuffer);
-        _reader.reset(new BufReader(_buffer.get(), uncompressedSize));
+                snappy::RawUncompress(buffer.get(), blockSize, block.data.get()));
+        return block;
     }
 
-    // sets _done to true on EOF - asserts on any other error
-    void read(void* out, size_t size) {
+    // returns false on EOF - asserts on any other error
+    bool read(void* out, size_t size) {
         _file.read(reinterpret_cast<char*>(out), size);
         if (!_file.good()) {
             if (_file.eof()) {
-                _done = true;
-                return;
+                return false;
             }
 
             msgasserted(16817,
@@ -261,18 +342,27 @@ private:
                                       << myErrnoWithDescription());
         }
         verify(_file.gcount() == static_cast<std::streamsize>(size));
+        return true;
     }
 
     const Settings _settings;
     bool _done;
+    const bool _readAhead;
     std::unique_ptr<char[]> _buffer;
     std::unique_ptr<BufReader> _reader;
     std::string _fileName;
     std::shared_ptr<FileDeleter> _fileDeleter;  // Must outlive _file
     std::ifstream _file;
+    stdx::future<Block> _nextBlock;  // Only valid while a read-ahead is outstanding.
 };
 
-/** Merge-sorts results from 0 or more FileIterators */
+/**
+ * Merge-sorts results from 0 or more FileIterators.
+ *
+ * The inputs are merged with a tournament tree rather than a heap: picking the next result only
+ * replays the matches along the path of the input that produced the previous one, which costs a
+ * single comparison per level of the tree. This keeps wide merges (many spilled runs) cheap.
+ */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
 public:
@@ -286,32 +376,34 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_shared<Stream>(iters[i]->next(), iters[i]));
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numActive = _streams.size();
+        _tree.resize(_streams.size());
+        if (_streams.size() > 1)
+            playMatches(1);
+        else
+            _tree[0] = 0;
     }
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _numActive > 1 || winner()->more()))
             return true;
 
         // We are done so clean up resources.
         // Can't do this in next() due to lifetime guarantees of unowned Data.
-        _heap.clear();
-        _current.reset();
+        _streams.clear();
+        _tree.clear();
         _remaining = 0;
 
         return false;
@@ -324,30 +416,27 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return winner()->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        const size_t previous = winnerIndex();
+        if (!_streams[previous]->advance()) {
+            verify(_numActive > 1);
+            // Release the exhausted input, and with it any file and buffer it holds. Its leaf
+            // stays in the tree as a sentinel that loses every match.
+            _streams[previous].reset();
+            _numActive--;
         }
+        replay(previous);
 
-        return _current->current();
+        return winner()->current();
     }
 
 
 private:
     class Stream {  // Data + Iterator
     public:
-        Stream(size_t fileNum, const Data& first, std::shared_ptr<Input> rest)
-            : fileNum(fileNum), _current(first), _rest(rest) {}
+        Stream(const Data& first, std::shared_ptr<Input> rest) : _current(first), _rest(rest) {}
 
         const Data& current() const {
             return _current;
@@ -363,37 +452,141 @@ private:
             return true;
         }
 
-        const size_t fileNum;
-
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
+    /**
+     * The tree has one leaf per stream: node 'k + i' is stream 'i', where 'k' is the number of
+     * streams. Internal node 'n' holds the index of the stream that won the match between its
+     * children '2n' and '2n + 1', so node 1 holds the overall winner.
+     */
+    size_t winnerIndex() const {
+        return _streams.size() > 1 ? _tree[1] : _tree[0];
+    }
 
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+    unowned_ptr<Stream> winner() const {
+        return _streams[winnerIndex()].get();
+    }
+
+    size_t streamAt(size_t node) const {
+        return node >= _streams.size() ? node - _streams.size() : _tree[node];
+    }
+
+    size_t playMatches(size_t node) {
+        if (node >= _streams.size())
+            return node - _streams.size();
+
+        const size_t left = playMatches(2 * node);
+        const size_t right = playMatches(2 * node + 1);
+        _tree[node] = beats(left, right) ? left : right;
+        return _tree[node];
+    }
+
+    /** Replays the matches from the leaf of stream 'index' up to the root. */
+    void replay(size_t index) {
+        for (size_t node = (_streams.size() + index) / 2; node >= 1; node /= 2) {
+            const size_t left = streamAt(2 * node);
+            const size_t right = streamAt(2 * node + 1);
+            _tree[node] = beats(left, right) ? left : right;
         }
+    }
 
-    private:
-        const Comparator _comp;
-    };
+    /**
+     * Exhausted streams, which have been released, lose every match. Ties go to the lower index to
+     * keep the merge stable.
+     */
+    bool beats(size_t lhs, size_t rhs) const {
+        const Stream* left = _streams[lhs].get();
+        const Stream* right = _streams[rhs].get();
+        if (!left || !right)
+            return left != nullptr;
+
+        dassertCompIsSane(_comp, left->current(), right->current());
+        int ret = _comp(left->current(), right->current());
+        if (ret)
+            return ret < 0;
+
+        return lhs < rhs;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    size_t _numActive = 0;
+    std::vector<std::shared_ptr<Stream>> _streams;
+    std::vector<size_t> _tree;
+    const Comparator _comp;
+};
+
+/**
+ * Collects the runs spilled by a Sorter. With a parallelism of 1 each run is written by the
+ * calling thread. Otherwise up to 'parallelism - 1' runs are sorted and written on the worker pool
+ * while the caller fills the next one, and runs are collected in the order they were added so the
+ * merge stays stable.
+ */
+template <typename Key, typename Value>
+class SpilledRuns {
+    MONGO_DISALLOW_COPYING(SpilledRuns);
+
+public:
+    typedef SortIteratorInterface<Key, Value> Iterator;
+    typedef stdx::function<std::shared_ptr<Iterator>()> WriteRun;
+
+    explicit SpilledRuns(size_t parallelism)
+        : _parallelism(std::max(parallelism, size_t(1))), _maxPending(_parallelism - 1) {}
+
+    ~SpilledRuns() {
+        // Don't leave runs writing into the temp directory once the Sorter is gone.
+        for (auto&& run : _pending) {
+            run.wait();
+        }
+    }
+
+    size_t parallelism() const {
+        return _parallelism;
+    }
+
+    void add(WriteRun writeRun) {
+        if (_maxPending == 0) {
+            _iters.push_back(writeRun());
+            return;
+        }
+
+        while (_pending.size() >= _maxPending) {
+            collectOldest();
+        }
+        _pending.push_back(runOnWorkerPool<std::shared_ptr<Iterator>>(std::move(writeRun)));
+    }
+
+    /** Waits for every pending run and returns all of them in the order they were added. */
+    const std::vector<std::shared_ptr<Iterator>>& finish() {
+        while (!_pending.empty()) {
+            collectOldest();
+        }
+        return _iters;
+    }
+
+    size_t size() const {
+        return _iters.size() + _pending.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    void collectOldest() {
+        auto run = std::move(_pending.front());
+        _pending.pop_front();
+        _iters.push_back(run.get());
+    }
+
+    const size_t _parallelism;
+    const size_t _maxPending;
+    std::vector<std::shared_ptr<Iterator>> _iters;                 // runs that have been written
+    std::deque<stdx::future<std::shared_ptr<Iterator>>> _pending;  // runs still being written
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -408,7 +601,7 @@ public:
     NoLimitSorter(const SortOptions& opts,
                   const Comparator& comp,
                   const Settings& settings = Settings())
-        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
+        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0), _runs(opts.parallelism) {
         verify(_opts.limit == 0);
     }
 
@@ -418,23 +611,24 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        // Every run in flight holds on to its data until it has been written.
+        if (_memUsed > _opts.maxMemoryUsageBytes / _runs.parallelism())
             spill();
     }
 
     Iterator* done() {
-        if (_iters.empty()) {
-            sort();
+        if (_runs.empty()) {
+            sort(_data, _comp);
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
-        return Iterator::merge(_iters, _opts, _comp);
+        return Iterator::merge(_runs.finish(), _opts, _comp);
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
-        return _iters.size();
+        return _runs.size();
     }
     size_t memUsed() const {
         return _memUsed;
@@ -453,9 +647,9 @@ private:
         const Comparator& _comp;
     };
 
-    void sort() {
-        STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+    static void sort(std::deque<Data>& data, const Comparator& comp) {
+        STLComparator less(comp);
+        std::stable_sort(data.begin(), data.end(), less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
@@ -479,24 +673,31 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
-        sort();
+        auto data = std::make_shared<std::deque<Data>>();
+        data->swap(_data);
+        _memUsed = 0;
 
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
-        }
+        const Comparator comp = _comp;
+        const SortOptions opts = _opts;
+        const Settings settings = _settings;
+        _runs.add([data, comp, opts, settings] {
+            sort(*data, comp);
 
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+            SortedFileWriter<Key, Value> writer(opts, settings);
+            for (; !data->empty(); data->pop_front()) {
+                writer.addAlreadySorted(data->front().first, data->front().second);
+            }
 
-        _memUsed = 0;
+            return std::shared_ptr<Iterator>(writer.done());
+        });
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
-    std::deque<Data> _data;                         // the "current" data
-    std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+    std::deque<Data> _data;         // the "current" data
+    SpilledRuns<Key, Value> _runs;  // data that has already been spilled. Must be destroyed first.
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -566,7 +767,8 @@ public:
           _memUsed(0),
           _haveCutoff(false),
           _worstCount(0),
-          _medianCount(0) {
+          _medianCount(0),
+          _runs(opts.parallelism) {
         // This also *works* with limit==1 but LimitOneSorter should be used instead
         verify(_opts.limit > 1);
 
@@ -594,7 +796,7 @@ public:
             if (_data.size() == _opts.limit)
                 std::make_heap(_data.begin(), _data.end(), less);
 
-            if (_memUsed > _opts.maxMemoryUsageBytes)
+            if (_memUsed > _opts.maxMemoryUsageBytes / _runs.parallelism())
                 spill();
 
             return;
@@ -617,23 +819,23 @@ public:
         _data.back() = contender;
         std::push_heap(_data.begin(), _data.end(), less);
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > _opts.maxMemoryUsageBytes / _runs.parallelism())
             spill();
     }
 
     Iterator* done() {
-        if (_iters.empty()) {
+        if (_runs.empty()) {
             sort();
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
-        return Iterator::merge(_iters, _opts, _comp);
+        return Iterator::merge(_runs.finish(), _opts, _comp);
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
-        return _iters.size();
+        return _runs.size();
     }
     size_t memUsed() const {
         return _memUsed;
@@ -760,20 +962,26 @@ private:
         // We should check readOnly before getting here.
         invariant(!storageGlobalParams.readOnly);
 
+        // Sorting stays on this thread since updateCutoff() needs the sorted data, but the run
+        // can be written out while the next one is filled.
         sort();
         updateCutoff();
 
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (size_t i = 0; i < _data.size(); i++) {
-            writer.addAlreadySorted(_data[i].first, _data[i].second);
-        }
-
         // clear _data and release backing array's memory
-        std::vector<Data>().swap(_data);
+        auto data = std::make_shared<std::vector<Data>>();
+        data->swap(_data);
+        _memUsed = 0;
 
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        const SortOptions opts = _opts;
+        const Settings settings = _settings;
+        _runs.add([data, opts, settings] {
+            SortedFileWriter<Key, Value> writer(opts, settings);
+            for (size_t i = 0; i < data->size(); i++) {
+                writer.addAlreadySorted((*data)[i].first, (*data)[i].second);
+            }
 
-        _memUsed = 0;
+            return std::shared_ptr<Iterator>(writer.done());
+        });
     }
 
     const Comparator _comp;
@@ -781,7 +989,6 @@ private:
     SortOptions _opts;
     size_t _memUsed;
     std::vector<Data> _data;  // the "current" data. Organized as max-heap if size == limit.
-    std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
 
     // See updateCutoff() for a full description of how these members are used.
     bool _haveCutoff;
@@ -790,6 +997,8 @@ private:
     size_t _worstCount;   // Number of docs better or equal to _worstSeen kept so far.
     Data _lastMedian;     // Median of a batch. Reset when _medianCount >= _opts.limit.
     size_t _medianCount;  // Number of docs better or equal to _lastMedian kept so far.
+
+    SpilledRuns<Key, Value> _runs;  // data that has already been spilled. Must be destroyed first.
 };
 
 inline unsigned nextFileNumber() {
@@ -806,7 +1015,7 @@ inline unsigned nextFileNumber() {
 
 template <typename Key, typename Value>
 SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Settings& settings)
-    : _settings(settings) {
+    : _settings(settings), _readAhead(opts.readAhead) {
     namespace str = mongoutils::str;
 
     // This should be checked by consumers, but if we get here don't allow writes.
@@ -884,11 +1093,15 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
+    const uint32_t checksum = sorter::blockChecksum(outBuffer, size);
+
     // negative size means compressed
     size = shouldCompress ? -size : size;
     try {
         _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
         _file.write(outBuffer, std::abs(size));
+        _bytesWritten += sizeof(size) + sizeof(checksum) + std::abs(size);
 
     } catch (const std::exception&) {
         msgasserted(16821,
@@ -903,7 +1116,7 @@ template <typename Key, typename Value>
 SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
     spill();
     _file.close();
-    return new sorter::FileIterator<Key, Value>(_fileName, _settings, _fileDeleter);
+    return new sorter::FileIterator<Key, Value>(_fileName, _settings, _fileDeleter, _readAhead);
 }
 
 //
@@ -98,8 +98,19 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
-
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    size_t parallelism;          /// Number of threads that may work on this sort at once.
+                                 /// Above 1, runs are sorted and spilled on worker threads
+                                 /// while the next run is filled. The memory limit is shared
+                                 /// between all runs in flight.
+    bool readAhead;              /// If true, iterators over spill files read, verify and
+                                 /// decompress the next block in the background.
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          parallelism(1),
+          readAhead(false) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -122,6 +133,16 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& Parallelism(size_t newParallelism) {
+        parallelism = newParallelism;
+        return *this;
+    }
+
+    SortOptions& ReadAhead(bool newReadAhead = true) {
+        readAhead = newReadAhead;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -180,7 +201,13 @@ protected:
     Sorter() {}  // can only be constructed as a base
 };
 
-/// Writes pre-sorted data to a sorted file and hands-back an Iterator over that file.
+/**
+ * Writes pre-sorted data to a sorted file and hands-back an Iterator over that file.
+ *
+ * The file is a sequence of blocks, each holding about 64KB of serialized data. A block starts with
+ * its int32 size, which is negative if the block is snappy-compressed, followed by the uint32
+ * checksum of the block's bytes as stored on disk.
+ */
 template <typename Key, typename Value>
 class SortedFileWriter {
     MONGO_DISALLOW_COPYING(SortedFileWriter);
@@ -196,6 +223,11 @@ public:
     void addAlreadySorted(const Key&, const Value&);
     Iterator* done();  /// Can't add more data after calling done()
 
+    /// Number of bytes written to the file so far, including block headers.
+    size_t bytesWritten() const {
+        return _bytesWritten;
+    }
+
 private:
     void spill();
 
@@ -204,6 +236,8 @@ private:
     std::shared_ptr<sorter::FileDeleter> _fileDeleter;  // Must outlive _file
     std::ofstream _file;
     BufBuilder _buffer;
+    bool _readAhead;  // Whether the FileIterator returned by done() should read ahead.
+    size_t _bytesWritten = 0;
 };
 }
 
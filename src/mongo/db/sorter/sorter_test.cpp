@@ -271,6 +271,42 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
                                         make_shared<IntIterator>(0, 10 * 1000 * 1000));
         }
+        {  // big with read-ahead
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(SortOptions(opts).ReadAhead());
+            for (int i = 0; i < 10 * 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        make_shared<IntIterator>(0, 10 * 1000 * 1000));
+        }
+        {  // read-ahead abandoned part way through
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(SortOptions(opts).ReadAhead());
+            for (int i = 0; i < 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            std::shared_ptr<IWIterator> it(sorter.done());
+            ASSERT(it->more());
+            ASSERT_EQ(it->next().first, 0);
+        }
+        {  // corrupted block
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+            for (int i = 0; i < 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            std::shared_ptr<IWIterator> it(sorter.done());
+
+            // Flip a byte past the block's size and checksum.
+            boost::filesystem::directory_iterator file(tempDir.path());
+            std::fstream stream(file->path().string().c_str(),
+                                std::ios::in | std::ios::out | std::ios::binary);
+            stream.seekg(16);
+            const char byte = stream.get();
+            stream.seekp(16);
+            stream.put(~byte);
+            stream.close();
+
+            ASSERT_THROWS_CODE(it->more(), AssertionException, 50701);
+        }
 
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
@@ -330,6 +366,47 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test many inputs, which is not a power of two, with some empty
+            std::vector<std::shared_ptr<IWIterator>> iterators;
+            for (int i = 0; i < 37; i++) {
+                iterators.push_back(make_shared<IntIterator>(i, 37 * 100, 37));
+            }
+            iterators.push_back(make_shared<EmptyIterator>());
+            iterators.insert(iterators.begin() + 5, make_shared<EmptyIterator>());
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(iterators, SortOptions(), IWComparator(ASC)));
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, make_shared<IntIterator>(0, 37 * 100, 1));
+        }
+        {  // test that an input is released as soon as it is exhausted
+            std::weak_ptr<IWIterator> shortInput;
+            std::vector<std::shared_ptr<IWIterator>> iterators;
+            iterators.push_back(make_shared<IntIterator>(0, 3));  // 0, 1, 2
+            iterators.push_back(make_shared<IntIterator>(0, 10));
+            shortInput = iterators[0];
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(iterators, SortOptions(), IWComparator(ASC)));
+            iterators.clear();
+
+            // 0, 0, 1, 1, 2: the short input still holds its last value.
+            for (int i = 0; i < 5; i++) {
+                ASSERT(mergeIter->more());
+                mergeIter->next();
+            }
+            ASSERT(!shortInput.expired());
+
+            // The next value comes from the other input, after the short one runs out.
+            ASSERT(mergeIter->more());
+            ASSERT_EQUALS(2, static_cast<int>(mergeIter->next().first));
+            ASSERT(shortInput.expired());
+        }
+        {  // test one input
+            std::shared_ptr<IWIterator> iterators[] = {make_shared<IntIterator>(0, 20, 1)};
+
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        make_shared<IntIterator>(0, 20, 1));
+        }
     }
 };
 
@@ -518,6 +595,15 @@ public:
 };
 
 
+template <bool Random = true>
+class LotsOfDataLittleMemoryParallel : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).Parallelism(2).ReadAhead();
+    }
+};
+
+
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     typedef LotsOfDataLittleMemory<Random> Parent;
@@ -556,6 +642,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallel</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallel</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
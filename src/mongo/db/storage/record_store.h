@@ -270,6 +270,20 @@ public:
     }
 };
 
+/**
+ * Appends records to an empty RecordStore. See RecordStore::makeBulkBuilder().
+ */
+class RecordStoreBulkBuilder {
+public:
+    virtual ~RecordStoreBulkBuilder() {}
+
+    /**
+     * Appends a record, and returns its RecordId. The RecordId is greater than those of all the
+     * records appended before it.
+     */
+    virtual StatusWith<RecordId> addRecord(const char* data, int len) = 0;
+};
+
 /**
  * A RecordStore provides an abstraction used for storing documents in a collection,
  * or entries in an index. In storage engines implementing the KVEngine, record stores
@@ -411,6 +425,20 @@ public:
                                               size_t nDocs,
                                               RecordId* idsOut = nullptr) = 0;
 
+    /**
+     * Returns a builder which loads records into this RecordStore more cheaply than inserting
+     * them, or {} if the storage engine does not support that or this RecordStore is not empty.
+     * The caller must then insert the records as usual.
+     *
+     * Records added through the builder are not part of the caller's unit of work and cannot be
+     * rolled back, so the caller must discard the whole RecordStore if loading it fails. Nothing
+     * else may read from or write to this RecordStore until the builder is destroyed, which is
+     * when the records it added become visible.
+     */
+    virtual std::unique_ptr<RecordStoreBulkBuilder> makeBulkBuilder(OperationContext* opCtx) {
+        return {};
+    }
+
     /**
      * A thin wrapper around insertRecordsWithDocWriter() to simplify handling of single DocWriters.
      */
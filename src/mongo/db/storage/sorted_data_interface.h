@@ -381,6 +381,26 @@ public:
         return {};
     }
 
+    /**
+     * Returns the RecordId that a cache of recent exact-match lookups on 'this' unique index
+     * remembers for 'key', or a null RecordId if the key isn't cached. Implementations that don't
+     * keep such a cache return a null RecordId.
+     *
+     * The cache is not transactional: in the caller's snapshot, the record may not exist or may
+     * no longer have 'key'. Callers must check the record before using it, and otherwise look
+     * the key up with a cursor.
+     */
+    virtual RecordId findCachedLoc(const BSONObj& key) const {
+        return RecordId();
+    }
+
+    /**
+     * Returns true if 'this' keeps the cache consulted by findCachedLoc().
+     */
+    virtual bool hasLookupCache() const {
+        return false;
+    }
+
     //
     // Index creation
     //
@@ -43,11 +43,13 @@
 #include "mongo/db/json.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_index_lookup_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -90,6 +92,10 @@ static const int kKeyStringV1Version = 8;
 static const int kMinimumIndexVersion = kKeyStringV0Version;
 static const int kMaximumIndexVersion = kKeyStringV1Version;
 
+// Memory bound, per collection, of the cache of recent lookups on the _id index. 0 disables the
+// cache.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerIdIndexLookupCacheSizeMB, int, 0);
+
 bool hasFieldNames(const BSONObj& obj) {
     BSONForEach(e, obj) {
         if (e.fieldName()[0])
@@ -270,6 +276,11 @@ WiredTigerIndex::WiredTigerIndex(OperationContext* ctx,
     _keyStringVersion =
         version.getValue() == kKeyStringV1Version ? KeyString::Version::V1 : KeyString::Version::V0;
 
+    if (desc->isIdIndex() && wiredTigerIdIndexLookupCacheSizeMB > 0) {
+        _lookupCache = std::make_shared<WiredTigerIndexLookupCache>(
+            static_cast<size_t>(wiredTigerIdIndexLookupCacheSizeMB) * 1024 * 1024);
+    }
+
     if (!isReadOnly) {
         uassertStatusOK(WiredTigerUtil::setTableLogging(
             ctx,
@@ -294,6 +305,7 @@ Status WiredTigerIndex::insert(OperationContext* opCtx,
     curwrap.assertInActiveTxn();
     WT_CURSOR* c = curwrap.get();
 
+    invalidateCachedLoc(opCtx, key);
     return _insert(c, key, id, dupsAllowed);
 }
 
@@ -309,6 +321,7 @@ void WiredTigerIndex::unindex(OperationContext* opCtx,
     WT_CURSOR* c = curwrap.get();
     invariant(c);
 
+    invalidateCachedLoc(opCtx, key);
     _unindex(c, key, id, dupsAllowed);
 }
 
@@ -387,9 +400,34 @@ bool WiredTigerIndex::appendCustomStats(OperationContext* opCtx,
         output->append("code", static_cast<int>(status.code()));
         output->append("reason", status.reason());
     }
+    if (_lookupCache) {
+        BSONObjBuilder lookupCache(output->subobjStart("lookupCache"));
+        _lookupCache->appendStats(&lookupCache);
+    }
     return true;
 }
 
+RecordId WiredTigerIndex::findCachedLoc(const BSONObj& key) const {
+    if (!_lookupCache) {
+        return RecordId();
+    }
+    const KeyString keyString(_keyStringVersion, key, _ordering);
+    return _lookupCache->find(StringData(keyString.getBuffer(), keyString.getSize()));
+}
+
+void WiredTigerIndex::invalidateCachedLoc(OperationContext* opCtx, const BSONObj& key) {
+    if (!_lookupCache) {
+        return;
+    }
+    const KeyString keyString(_keyStringVersion, key, _ordering);
+    std::string cacheKey(keyString.getBuffer(), keyString.getSize());
+    _lookupCache->erase(cacheKey);
+
+    // A lookup in a snapshot older than this write may cache the key again before it commits.
+    opCtx->recoveryUnit()->onCommit(
+        [ lookupCache = _lookupCache, cacheKey ]() { lookupCache->erase(cacheKey); });
+}
+
 Status WiredTigerIndex::dupKeyCheck(OperationContext* opCtx,
                                     const BSONObj& key,
                                     const RecordId& id) {
@@ -955,6 +993,14 @@ protected:
         }
     }
 
+    // Remembers the RecordId of the entry the cursor is positioned on, for exact-match lookups on
+    // unique indexes that keep a lookup cache.
+    void cacheLoc() {
+        if (auto lookupCache = _idx.lookupCache()) {
+            lookupCache->insert(StringData(_key.getBuffer(), _key.getSize()), _id);
+        }
+    }
+
     void getKey(WT_CURSOR* cursor, WT_ITEM* key) {
         if (_prefix == KVPrefix::kNotPrefixed) {
             invariantWTOK(cursor->get_key(cursor, key));
@@ -1204,6 +1250,9 @@ public:
         _cursorAtEof = ret == WT_NOTFOUND;
         updatePosition();
         dassert(_eof || _key.compare(_query) == 0);
+        if (!_eof) {
+            cacheLoc();
+        }
         return curr(parts);
     }
 };
@@ -1252,6 +1301,9 @@ public:
         _cursorAtEof = ret == WT_NOTFOUND;
         updatePosition();
         dassert(_eof || _key.compare(_query) == 0);
+        if (!_eof) {
+            cacheLoc();
+        }
         return curr(parts);
     }
 };
@@ -41,6 +41,7 @@ namespace mongo {
 
 class IndexCatalogEntry;
 class IndexDescriptor;
+class WiredTigerIndexLookupCache;
 struct WiredTigerItem;
 
 class WiredTigerIndex : public SortedDataInterface {
@@ -110,6 +111,12 @@ public:
 
     virtual Status compact(OperationContext* opCtx);
 
+    RecordId findCachedLoc(const BSONObj& key) const override;
+
+    bool hasLookupCache() const override {
+        return _lookupCache != nullptr;
+    }
+
     const std::string& uri() const {
         return _uri;
     }
@@ -142,6 +149,13 @@ public:
 
     Status dupKeyError(const BSONObj& key);
 
+    /**
+     * Returns the cache of exact-match lookups, or nullptr if this index doesn't keep one.
+     */
+    WiredTigerIndexLookupCache* lookupCache() const {
+        return _lookupCache.get();
+    }
+
 protected:
     virtual Status _insert(WT_CURSOR* c,
                            const BSONObj& key,
@@ -155,6 +169,11 @@ protected:
 
     void setKey(WT_CURSOR* cursor, const WT_ITEM* item);
 
+    /**
+     * Removes 'key' from the lookup cache, now and when the write to it commits.
+     */
+    void invalidateCachedLoc(OperationContext* opCtx, const BSONObj& key);
+
     class BulkBuilder;
     class StandardBulkBuilder;
     class UniqueBulkBuilder;
@@ -168,6 +187,8 @@ protected:
     std::string _collectionNamespace;
     std::string _indexName;
     KVPrefix _prefix;
+    // Shared with commit handlers, which may run after the index is destroyed.
+    std::shared_ptr<WiredTigerIndexLookupCache> _lookupCache;
 };
 
 
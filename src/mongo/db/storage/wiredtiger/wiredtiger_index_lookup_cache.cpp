@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_index_lookup_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+
+WiredTigerIndexLookupCache::WiredTigerIndexLookupCache(size_t maxSizeBytes)
+    : _maxPartitionSizeBytes(maxSizeBytes / kNumPartitions) {}
+
+RecordId WiredTigerIndexLookupCache::find(StringData key) {
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+    auto it = partition.index.find(key);
+    if (it == partition.index.end()) {
+        _misses.fetchAndAdd(1);
+        return RecordId();
+    }
+
+    _hits.fetchAndAdd(1);
+    partition.entries.splice(partition.entries.begin(), partition.entries, it->second);
+    return it->second->second;
+}
+
+void WiredTigerIndexLookupCache::insert(StringData key, const RecordId& id) {
+    const size_t entrySize = key.size() + kEntryOverheadBytes;
+    if (entrySize > _maxPartitionSizeBytes) {
+        return;
+    }
+
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+    auto it = partition.index.find(key);
+    if (it != partition.index.end()) {
+        it->second->second = id;
+        partition.entries.splice(partition.entries.begin(), partition.entries, it->second);
+        return;
+    }
+
+    while (partition.sizeBytes + entrySize > _maxPartitionSizeBytes) {
+        _erase_inlock(&partition, std::prev(partition.entries.end()));
+    }
+
+    partition.entries.emplace_front(key.toString(), id);
+    partition.index.emplace(partition.entries.front().first, partition.entries.begin());
+    partition.sizeBytes += entrySize;
+}
+
+void WiredTigerIndexLookupCache::erase(StringData key) {
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+    auto it = partition.index.find(key);
+    if (it != partition.index.end()) {
+        _erase_inlock(&partition, it->second);
+    }
+}
+
+size_t WiredTigerIndexLookupCache::sizeBytes() const {
+    size_t sizeBytes = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        sizeBytes += partition.sizeBytes;
+    }
+    return sizeBytes;
+}
+
+void WiredTigerIndexLookupCache::appendStats(BSONObjBuilder* builder) const {
+    builder->appendNumber("maxSizeBytes",
+                          static_cast<long long>(_maxPartitionSizeBytes * kNumPartitions));
+    builder->appendNumber("sizeBytes", static_cast<long long>(sizeBytes()));
+    builder->appendNumber("hits", static_cast<long long>(_hits.load()));
+    builder->appendNumber("misses", static_cast<long long>(_misses.load()));
+}
+
+WiredTigerIndexLookupCache::Partition& WiredTigerIndexLookupCache::_partitionFor(StringData key) {
+    return _partitions[StringMapTraits::hash(key) % kNumPartitions];
+}
+
+void WiredTigerIndexLookupCache::_erase_inlock(Partition* partition,
+                                               Partition::Entries::iterator it) {
+    partition->sizeBytes -= it->first.size() + kEntryOverheadBytes;
+    partition->index.erase(StringData(it->first));
+    partition->entries.erase(it);
+}
+
+}  // namespace mongo
@@ -0,0 +1,112 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <list>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * A byte-bounded cache of the RecordIds that exact-match lookups on a unique index found, keyed
+ * by the KeyString of the looked-up key. Least recently used entries are evicted first.
+ *
+ * The cache is not transactional: an entry may be missing from, or not yet visible in, the
+ * snapshot of a reader that finds it. See SortedDataInterface::findCachedLoc().
+ *
+ * This class is thread-safe. Entries are spread over independently locked partitions so that
+ * concurrent lookups of different keys rarely contend.
+ */
+class WiredTigerIndexLookupCache {
+    MONGO_DISALLOW_COPYING(WiredTigerIndexLookupCache);
+
+public:
+    explicit WiredTigerIndexLookupCache(size_t maxSizeBytes);
+
+    /**
+     * Returns the RecordId cached for 'key', or a null RecordId.
+     */
+    RecordId find(StringData key);
+
+    void insert(StringData key, const RecordId& id);
+
+    void erase(StringData key);
+
+    /**
+     * Returns the memory used by the cached entries.
+     */
+    size_t sizeBytes() const;
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    static const size_t kNumPartitions = 16;
+
+    // Approximate per-entry memory used by the list node, hash table node and string header.
+    static const size_t kEntryOverheadBytes = 96;
+
+    struct KeyHasher {
+        size_t operator()(StringData key) const {
+            return StringMapTraits::hash(key);
+        }
+    };
+
+    struct Partition {
+        using Entries = std::list<std::pair<std::string, RecordId>>;
+
+        mutable stdx::mutex mutex;
+        Entries entries;  // Most recently used first.
+        // Keys point into 'entries'.
+        stdx::unordered_map<StringData, Entries::iterator, KeyHasher> index;
+        size_t sizeBytes = 0;
+    };
+
+    Partition& _partitionFor(StringData key);
+
+    void _erase_inlock(Partition* partition, Partition::Entries::iterator it);
+
+    const size_t _maxPartitionSizeBytes;
+    std::array<Partition, kNumPartitions> _partitions;
+
+    AtomicUInt64 _hits;
+    AtomicUInt64 _misses;
+};
+
+}  // namespace mongo
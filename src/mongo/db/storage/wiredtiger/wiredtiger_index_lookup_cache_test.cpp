@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_index_lookup_cache.h"
+
+#include <string>
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(WiredTigerIndexLookupCacheTest, FindReturnsInsertedRecordId) {
+    WiredTigerIndexLookupCache cache(1024 * 1024);
+    ASSERT(cache.find("a").isNull());
+
+    cache.insert("a", RecordId(1));
+    cache.insert("b", RecordId(2));
+    ASSERT_EQ(RecordId(1), cache.find("a"));
+    ASSERT_EQ(RecordId(2), cache.find("b"));
+
+    cache.insert("a", RecordId(3));
+    ASSERT_EQ(RecordId(3), cache.find("a"));
+}
+
+TEST(WiredTigerIndexLookupCacheTest, EraseRemovesEntry) {
+    WiredTigerIndexLookupCache cache(1024 * 1024);
+    cache.insert("a", RecordId(1));
+    const size_t sizeBytes = cache.sizeBytes();
+    ASSERT_GT(sizeBytes, 0U);
+
+    cache.erase("a");
+    ASSERT(cache.find("a").isNull());
+    ASSERT_EQ(0U, cache.sizeBytes());
+
+    // Erasing a missing key is a no-op.
+    cache.erase("a");
+    ASSERT_EQ(0U, cache.sizeBytes());
+}
+
+TEST(WiredTigerIndexLookupCacheTest, EvictsLeastRecentlyUsedEntriesToStayWithinBound) {
+    const size_t maxSizeBytes = 64 * 1024;
+    WiredTigerIndexLookupCache cache(maxSizeBytes);
+
+    const int numKeys = 10000;
+    for (int i = 0; i < numKeys; i++) {
+        const std::string key = std::to_string(i);
+        cache.insert(key, RecordId(i + 1));
+        // Keep the first key recently used.
+        ASSERT_EQ(RecordId(1), cache.find("0"));
+        ASSERT_LTE(cache.sizeBytes(), maxSizeBytes);
+    }
+
+    ASSERT_EQ(RecordId(1), cache.find("0"));
+    ASSERT_EQ(RecordId(numKeys), cache.find(std::to_string(numKeys - 1)));
+    ASSERT(cache.find("1").isNull());
+}
+
+TEST(WiredTigerIndexLookupCacheTest, DoesNotCacheKeysLargerThanBound) {
+    WiredTigerIndexLookupCache cache(16 * 1024);
+    const std::string key(16 * 1024, 'a');
+    cache.insert(key, RecordId(1));
+    ASSERT(cache.find(key).isNull());
+    ASSERT_EQ(0U, cache.sizeBytes());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -93,6 +93,10 @@ using std::string;
 
 namespace dps = ::mongo::dotted_path_support;
 
+// How often, in seconds, the sizes and counts of changed record stores are written to the size
+// storer table.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerSizeStorerSyncIntervalSecs, int, 1);
+
 class WiredTigerKVEngine::WiredTigerJournalFlusher : public BackgroundJob {
 public:
     explicit WiredTigerJournalFlusher(WiredTigerSessionCache* sessionCache)
@@ -106,35 +110,17 @@ public:
         Client::initThread(name().c_str());
 
         LOG(1) << "starting " << name() << " thread";
-
-        while (!_shuttingDown.load()) {
-            try {
-                const bool forceCheckpoint = false;
-                const bool stableCheckpoint = false;
-                _sessionCache->waitUntilDurable(forceCheckpoint, stableCheckpoint);
-            } catch (const AssertionException& e) {
-                invariant(e.code() == ErrorCodes::ShutdownInProgress);
-            }
-
-            int ms = storageGlobalParams.journalCommitIntervalMs.load();
-            if (!ms) {
-                ms = 100;
-            }
-
-            MONGO_IDLE_THREAD_BLOCK;
-            sleepmillis(ms);
-        }
+        _sessionCache->runJournalFlusher();
         LOG(1) << "stopping " << name() << " thread";
     }
 
     void shutdown() {
-        _shuttingDown.store(true);
+        _sessionCache->stopJournalFlusher();
         wait();
     }
 
 private:
     WiredTigerSessionCache* _sessionCache;
-    AtomicBool _shuttingDown{false};
 };
 
 class WiredTigerKVEngine::WiredTigerCheckpointThread : public BackgroundJob {
@@ -254,6 +240,58 @@ private:
     AtomicWord<std::uint64_t> _initialDataTimestamp;
 };
 
+/**
+ * Periodically writes the sizes and counts of the record stores that changed since the last sync
+ * to the size storer table, so that user operations don't have to.
+ */
+class WiredTigerKVEngine::WiredTigerSizeStorerSyncer : public BackgroundJob {
+public:
+    explicit WiredTigerSizeStorerSyncer(WiredTigerKVEngine* engine)
+        : BackgroundJob(false /* deleteSelf */), _engine(engine) {}
+
+    virtual string name() const {
+        return "WTSizeStorerSyncer";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+
+        LOG(1) << "starting " << name() << " thread";
+
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait_for(lock,
+                                  stdx::chrono::seconds(static_cast<std::int64_t>(std::max(
+                                      1, wiredTigerSizeStorerSyncIntervalSecs.load()))));
+            }
+
+            if (!_shuttingDown.load()) {
+                _engine->syncSizeInfo(false);
+            }
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            _shuttingDown.store(true);
+        }
+        _condvar.notify_one();
+        wait();
+    }
+
+private:
+    WiredTigerKVEngine* const _engine;
+
+    // _mutex/_condvar used to notify when _shuttingDown is flipped.
+    stdx::mutex _mutex;
+    stdx::condition_variable _condvar;
+    AtomicBool _shuttingDown{false};
+};
+
 namespace {
 
 class TicketServerParameter : public ServerParameter {
@@ -320,7 +358,6 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
       _oplogManager(stdx::make_unique<WiredTigerOplogManager>()),
       _canonicalName(canonicalName),
       _path(path),
-      _sizeStorerSyncTracker(cs, 100000, Seconds(60)),
       _durable(durable),
       _ephemeral(ephemeral),
       _readOnly(readOnly) {
@@ -430,6 +467,11 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
         new WiredTigerSizeStorer(_conn, _sizeStorerUri, sizeStorerLoggingEnabled, _readOnly));
     _sizeStorer->fillCache();
 
+    if (!_readOnly) {
+        _sizeStorerSyncer = stdx::make_unique<WiredTigerSizeStorerSyncer>(this);
+        _sizeStorerSyncer->go();
+    }
+
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
 }
 
@@ -463,6 +505,10 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
 
 void WiredTigerKVEngine::cleanShutdown() {
     log() << "WiredTigerKVEngine shutting down";
+    if (_sizeStorerSyncer) {
+        _sizeStorerSyncer->shutdown();
+        _sizeStorerSyncer.reset();
+    }
     if (!_readOnly)
         syncSizeInfo(true);
     if (_conn) {
@@ -852,11 +898,6 @@ bool WiredTigerKVEngine::haveDropsQueued() const {
     Date_t now = _clockSource->now();
     Milliseconds delta = now - _previousCheckedDropsQueued;
 
-    if (!_readOnly && _sizeStorerSyncTracker.intervalHasElapsed()) {
-        _sizeStorerSyncTracker.resetLastTime();
-        syncSizeInfo(false);
-    }
-
     // We only want to check the queue max once per second or we'll thrash
     if (delta < Milliseconds(1000))
         return false;
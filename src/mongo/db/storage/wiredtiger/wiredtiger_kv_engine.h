@@ -44,7 +44,6 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
-#include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
 
@@ -253,6 +252,7 @@ public:
 private:
     class WiredTigerJournalFlusher;
     class WiredTigerCheckpointThread;
+    class WiredTigerSizeStorerSyncer;
 
     Status _salvageIfNeeded(const char* uri);
     void _checkIdentPath(StringData ident);
@@ -286,7 +286,7 @@ private:
 
     std::unique_ptr<WiredTigerSizeStorer> _sizeStorer;
     std::string _sizeStorerUri;
-    mutable ElapsedTracker _sizeStorerSyncTracker;
+    std::unique_ptr<WiredTigerSizeStorerSyncer> _sizeStorerSyncer;  // Depends on _sizeStorer
 
     bool _durable;
     bool _ephemeral;
@@ -33,12 +33,21 @@
 
 #include "mongo/db/storage/kv/kv_engine_test_harness.h"
 
+#include <vector>
+
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace {
@@ -80,5 +89,60 @@ MONGO_INITIALIZER(RegisterKVHarnessFactory)(InitializerContext*) {
     return Status::OK();
 }
 
+BSONObj getJournalFlusherStats(WiredTigerSessionCache* sessionCache) {
+    BSONObjBuilder builder;
+    sessionCache->appendJournalFlusherStats(&builder);
+    return builder.obj()["journalFlusher"].Obj().getOwned();
+}
+
+TEST(WiredTigerKVEngineTest, JournalFlusherServesConcurrentWaitersInBatches) {
+    unittest::TempDir dbpath("wt-journal-flusher");
+    ClockSourceMock cs;
+    WiredTigerKVEngine engine(
+        kWiredTigerEngineName, dbpath.path(), &cs, "", 1, true, false, false, false);
+    std::unique_ptr<WiredTigerRecoveryUnit> ru(
+        checked_cast<WiredTigerRecoveryUnit*>(engine.newRecoveryUnit()));
+    WiredTigerSessionCache* sessionCache = ru->getSessionCache();
+
+    // Callers only queue for the journal flusher once it is running, which it is by the time it
+    // has made its first periodic flush.
+    while (getJournalFlusherStats(sessionCache)["flushes"].numberLong() == 0) {
+        sleepmillis(10);
+    }
+    const BSONObj before = getJournalFlusherStats(sessionCache);
+
+    const int kNumThreads = 8;
+    const int kWaitsPerThread = 20;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < kWaitsPerThread; ++j) {
+                sessionCache->waitUntilDurable(false, false);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    const BSONObj after = getJournalFlusherStats(sessionCache);
+    ASSERT_EQ(kNumThreads * kWaitsPerThread,
+              after["waitersServed"].numberLong() - before["waitersServed"].numberLong());
+    const long long flushes = after["flushes"].numberLong();
+    ASSERT_GT(flushes, before["flushes"].numberLong());
+
+    long long batchSizeCount = 0;
+    for (auto&& bucket : after["batchSizes"].Obj()) {
+        batchSizeCount += bucket["count"].numberLong();
+    }
+    ASSERT_EQ(flushes, batchSizeCount);
+
+    long long latencyCount = 0;
+    for (auto&& bucket : after["flushLatencies"].Obj()) {
+        latencyCount += bucket["count"].numberLong();
+    }
+    ASSERT_EQ(flushes, latencyCount);
+}
+
 }  // namespace
 }  // namespace mongo
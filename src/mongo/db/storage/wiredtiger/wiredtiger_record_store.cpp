@@ -620,7 +620,6 @@ WiredTigerRecordStore::WiredTigerRecordStore(WiredTigerKVEngine* kvEngine,
       _shuttingDown(false),
       _cappedDeleteCheckCount(0),
       _sizeStorer(params.sizeStorer),
-      _sizeStorerCounter(0),
       _kvEngine(kvEngine) {
     Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
                                ctx, _uri, kMinimumRecordStoreVersion, kMaximumRecordStoreVersion)
@@ -697,8 +696,8 @@ void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
             _dataSize.store(0);
 
             do {
-                _numRecords.fetchAndAdd(1);
-                _dataSize.fetchAndAdd(record->data.size());
+                _numRecords.add(1);
+                _dataSize.add(record->data.size());
             } while ((record = cursor->next()));
         }
     } else {
@@ -730,11 +729,12 @@ bool WiredTigerRecordStore::inShutdown() const {
 }
 
 long long WiredTigerRecordStore::dataSize(OperationContext* opCtx) const {
-    return _dataSize.load();
+    // The stripes are not read atomically, so concurrent updates can make the sum negative.
+    return std::max(_dataSize.load(), int64_t(0));
 }
 
 long long WiredTigerRecordStore::numRecords(OperationContext* opCtx) const {
-    return _numRecords.load();
+    return std::max(_numRecords.load(), int64_t(0));
 }
 
 bool WiredTigerRecordStore::isCapped() const {
@@ -1329,6 +1329,69 @@ std::vector<std::unique_ptr<RecordCursor>> WiredTigerRecordStore::getManyCursors
     return cursors;
 }
 
+/**
+ * Appends records to an empty table through a WiredTiger bulk cursor.
+ *
+ * Bulk cursors are not transactional, so the record count and data size are updated without
+ * registering changes with the caller's recovery unit.
+ */
+class WiredTigerRecordStore::BulkBuilder final : public RecordStoreBulkBuilder {
+public:
+    BulkBuilder(WiredTigerRecordStore* rs, UniqueWiredTigerSession session, WT_CURSOR* cursor)
+        : _rs(rs), _session(std::move(session)), _cursor(cursor) {}
+
+    ~BulkBuilder() {
+        _cursor->close(_cursor);
+    }
+
+    StatusWith<RecordId> addRecord(const char* data, int len) final {
+        const RecordId id = _rs->_nextId();
+        _rs->setKey(_cursor, id);
+        WiredTigerItem value(data, len);
+        _cursor->set_value(_cursor, value.Get());
+        int ret = WT_OP_CHECK(_cursor->insert(_cursor));
+        if (ret)
+            return wtRCToStatus(ret, "WiredTigerRecordStore::BulkBuilder::addRecord");
+
+        _rs->_numRecords.add(1);
+        _rs->_increaseDataSize(nullptr, len);
+        return {id};
+    }
+
+private:
+    WiredTigerRecordStore* const _rs;
+    UniqueWiredTigerSession const _session;
+    WT_CURSOR* const _cursor;
+};
+
+std::unique_ptr<RecordStoreBulkBuilder> WiredTigerRecordStore::makeBulkBuilder(
+    OperationContext* opCtx) {
+    // Bulk cursors can only be opened on newly created tables, and don't support the deletes
+    // capped collections make as they insert.
+    if (_isCapped || _isOplog || numRecords(opCtx) != 0) {
+        return {};
+    }
+
+    // Open cursors can cause bulk open_cursor to fail with EBUSY.
+    WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(opCtx);
+    ru->getSession()->closeAllCursors(_uri);
+    ru->getSessionCache()->closeAllCursors(_uri);
+
+    // Use a different session to ensure we don't hijack an existing transaction. A checkpoint
+    // underway also holds the table, so wait for it to complete: unlike an index build, the load
+    // can only use a bulk cursor if it gets one before inserting its first record.
+    UniqueWiredTigerSession session = ru->getSessionCache()->getSession();
+    WT_SESSION* s = session->getSession();
+    WT_CURSOR* cursor;
+    int ret = s->open_cursor(s, _uri.c_str(), NULL, "bulk", &cursor);
+    if (ret) {
+        warning() << "not bulk loading " << _uri
+                  << ", failed to create WiredTiger bulk cursor: " << wiredtiger_strerror(ret);
+        return {};
+    }
+    return stdx::make_unique<BulkBuilder>(this, std::move(session), cursor);
+}
+
 Status WiredTigerRecordStore::truncate(OperationContext* opCtx) {
     WiredTigerCursor startWrap(_uri, _tableId, true, opCtx);
     WT_CURSOR* start = startWrap.get();
@@ -1548,7 +1611,7 @@ public:
     NumRecordsChange(WiredTigerRecordStore* rs, int64_t diff) : _rs(rs), _diff(diff) {}
     virtual void commit() {}
     virtual void rollback() {
-        _rs->_numRecords.fetchAndAdd(-_diff);
+        _rs->_numRecords.add(-_diff);
     }
 
 private:
@@ -1558,8 +1621,11 @@ private:
 
 void WiredTigerRecordStore::_changeNumRecords(OperationContext* opCtx, int64_t diff) {
     opCtx->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
-    if (_numRecords.fetchAndAdd(diff) < 0)
-        _numRecords.store(std::max(diff, int64_t(0)));
+    _numRecords.add(diff);
+    // Only deletes can take the count below zero, which means it was inaccurate to begin with.
+    if (diff < 0) {
+        _numRecords.clampAtZero();
+    }
 }
 
 class WiredTigerRecordStore::DataSizeChange : public RecoveryUnit::Change {
@@ -1579,11 +1645,9 @@ void WiredTigerRecordStore::_increaseDataSize(OperationContext* opCtx, int64_t a
     if (opCtx)
         opCtx->recoveryUnit()->registerChange(new DataSizeChange(this, amount));
 
-    if (_dataSize.fetchAndAdd(amount) < 0)
-        _dataSize.store(std::max(amount, int64_t(0)));
-
-    if (_sizeStorer && _sizeStorerCounter++ % 1000 == 0) {
-        _sizeStorer->storeToCache(_uri, _numRecords.load(), _dataSize.load());
+    _dataSize.add(amount);
+    if (amount < 0) {
+        _dataSize.clampAtZero();
     }
 }
 
@@ -41,6 +41,7 @@
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_striped_counter.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
@@ -178,6 +179,8 @@ public:
 
     std::vector<std::unique_ptr<RecordCursor>> getManyCursors(OperationContext* opCtx) const final;
 
+    virtual std::unique_ptr<RecordStoreBulkBuilder> makeBulkBuilder(OperationContext* opCtx);
+
     virtual Status truncate(OperationContext* opCtx);
 
     virtual bool compactSupported() const {
@@ -275,6 +278,7 @@ protected:
     virtual void setKey(WT_CURSOR* cursor, RecordId id) const = 0;
 
 private:
+    class BulkBuilder;
     class RandomCursor;
 
     class NumRecordsChange;
@@ -321,11 +325,11 @@ private:
     mutable stdx::timed_mutex _cappedDeleterMutex;
 
     AtomicInt64 _nextIdNum;
-    AtomicInt64 _dataSize;
-    AtomicInt64 _numRecords;
+    // Updated by every insert and delete, and read by the size storer when it syncs.
+    WiredTigerStripedCounter _dataSize;
+    WiredTigerStripedCounter _numRecords;
 
     WiredTigerSizeStorer* _sizeStorer;  // not owned, can be NULL
-    int _sizeStorerCounter;
 
     WiredTigerKVEngine* _kvEngine;  // not owned.
 
@@ -369,6 +373,11 @@ public:
         return _prefix;
     }
 
+    // Grouped collections share a table, which bulk cursors cannot be opened on.
+    std::unique_ptr<RecordStoreBulkBuilder> makeBulkBuilder(OperationContext* opCtx) override {
+        return {};
+    }
+
 protected:
     virtual RecordId getKey(WT_CURSOR* cursor) const;
 
@@ -32,6 +32,7 @@
 #include <sstream>
 #include <string>
 #include <time.h>
+#include <vector>
 
 #include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
@@ -46,8 +47,10 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_striped_counter.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point.h"
@@ -101,6 +104,68 @@ TEST(WiredTigerRecordStoreTest, GenerateCreateStringValidConfigStringOption) {
               std::string("prefix_compression=true,"));
 }
 
+TEST(WiredTigerRecordStoreTest, StripedCounterSumsConcurrentUpdates) {
+    WiredTigerStripedCounter counter;
+    counter.store(10);
+
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&counter] {
+            for (int j = 0; j < 10000; j++) {
+                counter.add(2);
+                counter.add(-1);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(10 + 8 * 10000, counter.load());
+
+    counter.store(5);
+    ASSERT_EQ(5, counter.load());
+    counter.add(-7);
+    ASSERT_EQ(-2, counter.load());
+    counter.clampAtZero();
+    ASSERT_EQ(0, counter.load());
+    counter.clampAtZero();
+    ASSERT_EQ(0, counter.load());
+}
+
+TEST(WiredTigerRecordStoreTest, DeletePastZeroThenInsertCountsFromZero) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+    RecordId id;
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp(), false);
+        ASSERT_OK(res.getStatus());
+        id = res.getValue();
+        uow.commit();
+    }
+
+    // Make the stats inaccurate, so that deleting the record takes them below zero.
+    rs->updateStatsAfterRepair(opCtx.get(), 0, 0);
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        rs->deleteRecord(opCtx.get(), id);
+        uow.commit();
+    }
+    ASSERT_EQUALS(0, rs->numRecords(opCtx.get()));
+    ASSERT_EQUALS(0, rs->dataSize(opCtx.get()));
+
+    // The deficit is not carried over to hide the next insert.
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        ASSERT_OK(rs->insertRecord(opCtx.get(), "bc", 3, Timestamp(), false).getStatus());
+        uow.commit();
+    }
+    ASSERT_EQUALS(1, rs->numRecords(opCtx.get()));
+    ASSERT_EQUALS(3, rs->dataSize(opCtx.get()));
+}
+
 TEST(WiredTigerRecordStoreTest, Isolation1) {
     const auto harnessHelper(newRecordStoreHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
@@ -375,6 +440,37 @@ TEST(WiredTigerRecordStoreTest, AppendCustomStatsMetadata) {
     ASSERT_EQUALS(creationStringElement.type(), String);
 }
 
+TEST(WiredTigerRecordStoreTest, BulkBuilderAppendsToEmptyTable) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    RecordId id1;
+    RecordId id2;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        auto bulkBuilder = rs->makeBulkBuilder(opCtx.get());
+        ASSERT(bulkBuilder);
+
+        StatusWith<RecordId> res = bulkBuilder->addRecord("a", 2);
+        ASSERT_OK(res.getStatus());
+        id1 = res.getValue();
+
+        res = bulkBuilder->addRecord("bc", 3);
+        ASSERT_OK(res.getStatus());
+        id2 = res.getValue();
+        ASSERT_LT(id1, id2);
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    ASSERT_EQUALS(2, rs->numRecords(opCtx.get()));
+    ASSERT_EQUALS(5, rs->dataSize(opCtx.get()));
+    ASSERT_EQUALS(string("a"), rs->dataFor(opCtx.get(), id1).data());
+    ASSERT_EQUALS(string("bc"), rs->dataFor(opCtx.get(), id2).data());
+
+    // Only empty tables can be bulk loaded.
+    ASSERT_FALSE(rs->makeBulkBuilder(opCtx.get()));
+}
+
 TEST(WiredTigerRecordStoreTest, CappedCursorYieldFirst) {
     unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 10000, 50));
@@ -78,6 +78,7 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
     }
 
     WiredTigerKVEngine::appendGlobalStats(bob);
+    WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->appendJournalFlusherStats(&bob);
 
     return bob.obj();
 }
@@ -35,19 +35,65 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/journal_listener.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/bits.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+// How long a flush of the journal by the journal flusher waits, after the first caller of
+// waitUntilDurable() queues for it, for more callers to join it. 0 flushes as soon as a caller
+// queues; callers which queue while a flush is underway are still served together by the next.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerJournalGroupCommitDelayMicros, int, 0);
+
+// The number of queued callers at which the journal flusher flushes without waiting out
+// 'wiredTigerJournalGroupCommitDelayMicros'. 0 means no limit.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerJournalGroupCommitMaxWaiters, int, 0);
+
+namespace {
+
+template <size_t N>
+void incrementJournalFlusherHistogram(uint64_t value, std::array<uint64_t, N>* buckets) {
+    const size_t bucket = value == 0 ? 0 : 64 - countLeadingZeros64(value);
+    ++(*buckets)[std::min(bucket, N - 1)];
+}
+
+template <size_t N>
+void appendJournalFlusherHistogram(StringData name,
+                                   StringData lowerBoundName,
+                                   const std::array<uint64_t, N>& buckets,
+                                   BSONObjBuilder* builder) {
+    BSONArrayBuilder arrayBuilder(builder->subarrayStart(name));
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        BSONObjBuilder entryBuilder(arrayBuilder.subobjStart());
+        entryBuilder.append(lowerBoundName, static_cast<long long>(i == 0 ? 0 : 1ULL << (i - 1)));
+        entryBuilder.append("count", static_cast<long long>(buckets[i]));
+        entryBuilder.doneFast();
+    }
+    arrayBuilder.doneFast();
+}
+
+}  // namespace
+
 WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, uint64_t epoch, uint64_t cursorEpoch)
     : _epoch(epoch),
       _cursorEpoch(cursorEpoch),
@@ -194,6 +240,12 @@ void WiredTigerSessionCache::shuttingDown() {
 }
 
 void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableCheckpoint) {
+    _waitUntilDurable(forceCheckpoint, stableCheckpoint, true /* useJournalFlusher */);
+}
+
+void WiredTigerSessionCache::_waitUntilDurable(bool forceCheckpoint,
+                                               bool stableCheckpoint,
+                                               bool useJournalFlusher) {
     // For inMemory storage engines, the data is "as durable as it's going to get".
     // That is, a restart is equivalent to a complete node failure.
     if (isEphemeral()) {
@@ -238,6 +290,10 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
         return;
     }
 
+    if (useJournalFlusher && _engine && _engine->isDurable() && _waitForJournalFlusher()) {
+        return;
+    }
+
     uint32_t start = _lastSyncTime.load();
     // Do the remainder in a critical section that ensures only a single thread at a time
     // will attempt to synchronize.
@@ -273,6 +329,114 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
     _journalListener->onDurable(token);
 }
 
+bool WiredTigerSessionCache::_waitForJournalFlusher() {
+    stdx::shared_future<bool> nextFlush;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_flusherMutex);
+        if (!_flusherRunning) {
+            return false;
+        }
+
+        // A flush already underway may have read the journal before this caller's writes reached
+        // it, so the caller waits for the next one.
+        if (_flushWaiters++ == 0) {
+            _firstWaiterQueued = stdx::chrono::steady_clock::now();
+        }
+        nextFlush = _nextFlush;
+        _flushRequested.notify_one();
+    }
+    return nextFlush.get();
+}
+
+void WiredTigerSessionCache::runJournalFlusher() {
+    stdx::unique_lock<stdx::mutex> lk(_flusherMutex);
+    _nextFlushPromise = stdx::promise<bool>();
+    _nextFlush = _nextFlushPromise.get_future().share();
+    ON_BLOCK_EXIT([&] {
+        // The callers queued for the next flush make it themselves.
+        _flusherRunning = false;
+        _nextFlushPromise.set_value(false);
+    });
+    _flusherRunning = !_flusherStopRequested;
+
+    while (!_flusherStopRequested) {
+        int ms = storageGlobalParams.journalCommitIntervalMs.load();
+        if (!ms) {
+            ms = 100;
+        }
+        const auto periodicFlush =
+            stdx::chrono::steady_clock::now() + stdx::chrono::milliseconds(ms);
+        {
+            MONGO_IDLE_THREAD_BLOCK;
+            _flushRequested.wait_until(
+                lk, periodicFlush, [&] { return _flusherStopRequested || _flushWaiters > 0; });
+        }
+
+        const int delayMicros = wiredTigerJournalGroupCommitDelayMicros.load();
+        if (_flushWaiters > 0 && delayMicros > 0) {
+            // Let more callers join the flush.
+            const uint64_t maxWaiters = std::max(wiredTigerJournalGroupCommitMaxWaiters.load(), 0);
+            _flushRequested.wait_until(
+                lk, _firstWaiterQueued + stdx::chrono::microseconds(delayMicros), [&] {
+                    return _flusherStopRequested || (maxWaiters && _flushWaiters >= maxWaiters);
+                });
+        }
+
+        if (_flusherStopRequested) {
+            break;
+        }
+
+        // Callers which queue from here on wait for the flush after this one.
+        auto flush = std::move(_nextFlushPromise);
+        _nextFlushPromise = stdx::promise<bool>();
+        _nextFlush = _nextFlushPromise.get_future().share();
+        const uint64_t batchSize = std::exchange(_flushWaiters, 0);
+        lk.unlock();
+
+        Timer timer;
+        try {
+            _waitUntilDurable(false, false, false /* useJournalFlusher */);
+        } catch (const AssertionException& e) {
+            // The callers served by this flush make it themselves, and report the shutdown.
+            invariant(e.code() == ErrorCodes::ShutdownInProgress);
+            flush.set_value(false);
+            lk.lock();
+            break;
+        }
+        const uint64_t micros = timer.micros();
+
+        lk.lock();
+        _flusherStats.record(batchSize, micros);
+        flush.set_value(true);
+    }
+}
+
+void WiredTigerSessionCache::stopJournalFlusher() {
+    stdx::lock_guard<stdx::mutex> lk(_flusherMutex);
+    _flusherStopRequested = true;
+    _flushRequested.notify_all();
+}
+
+void WiredTigerSessionCache::JournalFlusherStats::record(uint64_t batchSize, uint64_t micros) {
+    ++flushes;
+    waitersServed += batchSize;
+    totalMicros += micros;
+    incrementJournalFlusherHistogram(batchSize, &batchSizes);
+    incrementJournalFlusherHistogram(micros, &latencies);
+}
+
+void WiredTigerSessionCache::appendJournalFlusherStats(BSONObjBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> lk(_flusherMutex);
+    BSONObjBuilder statsBuilder(builder->subobjStart("journalFlusher"));
+    statsBuilder.append("flushes", static_cast<long long>(_flusherStats.flushes));
+    statsBuilder.append("waitersServed", static_cast<long long>(_flusherStats.waitersServed));
+    statsBuilder.append("totalFlushMicros", static_cast<long long>(_flusherStats.totalMicros));
+    appendJournalFlusherHistogram("batchSizes", "waiters", _flusherStats.batchSizes, &statsBuilder);
+    appendJournalFlusherHistogram(
+        "flushLatencies", "micros", _flusherStats.latencies, &statsBuilder);
+    statsBuilder.doneFast();
+}
+
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
     stdx::lock_guard<stdx::mutex> lock(_cacheLock);
     for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
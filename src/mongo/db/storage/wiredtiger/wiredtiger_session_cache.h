@@ -31,6 +31,7 @@
 
 #pragma once
 
+#include <array>
 #include <list>
 #include <string>
 
@@ -39,11 +40,15 @@
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/chrono.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/future.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
@@ -194,9 +199,34 @@ public:
      * Waits until all commits that happened before this call are durable, either by flushing
      * the log or forcing a checkpoint if forceCheckpoint is true or the journal is disabled.
      * Uses a temporary session. Safe to call without any locks, even during shutdown.
+     *
+     * While the journal flusher runs, a flush of the journal is left to it, and the caller waits
+     * for the next flush it makes.
      */
     void waitUntilDurable(bool forceCheckpoint, bool stableCheckpoint);
 
+    /**
+     * Runs the journal flusher until stopJournalFlusher() is called. Each flush of the journal it
+     * makes serves all the callers of waitUntilDurable() which queued for it since the previous
+     * flush began. When 'wiredTigerJournalGroupCommitDelayMicros' is set, a flush waits for up to
+     * that long after the first caller queues for more callers to join it, or until
+     * 'wiredTigerJournalGroupCommitMaxWaiters' have. When no caller is waiting, the journal is
+     * flushed every 'journalCommitIntervalMs'.
+     */
+    void runJournalFlusher();
+
+    /**
+     * Stops the journal flusher. Callers of waitUntilDurable() waiting for it flush the journal
+     * themselves instead.
+     */
+    void stopJournalFlusher();
+
+    /**
+     * Appends the number of flushes made by the journal flusher, with histograms of how many
+     * callers each served and how long each took.
+     */
+    void appendJournalFlusherStats(BSONObjBuilder* builder);
+
     WT_CONNECTION* conn() const {
         return _conn;
     }
@@ -219,6 +249,34 @@ public:
     }
 
 private:
+    /**
+     * Histograms of the flushes made by the journal flusher. Bucket 0 counts zeros, and bucket i
+     * the values in [2^(i-1), 2^i).
+     */
+    struct JournalFlusherStats {
+        static const int kNumBuckets = 32;
+
+        void record(uint64_t batchSize, uint64_t micros);
+
+        uint64_t flushes = 0;
+        uint64_t waitersServed = 0;
+        uint64_t totalMicros = 0;
+        std::array<uint64_t, kNumBuckets> batchSizes{};
+        std::array<uint64_t, kNumBuckets> latencies{};
+    };
+
+    /**
+     * Implements waitUntilDurable(). If 'useJournalFlusher' is false, flushes the journal itself
+     * even if the journal flusher is running.
+     */
+    void _waitUntilDurable(bool forceCheckpoint, bool stableCheckpoint, bool useJournalFlusher);
+
+    /**
+     * Waits for the journal flusher to complete a flush which starts after this call. Returns
+     * false if the journal flusher is not running, or stopped before making that flush.
+     */
+    bool _waitForJournalFlusher();
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -251,6 +309,22 @@ private:
     WT_SESSION* _waitUntilDurableSession = nullptr;  // owned, and never explicitly closed
                                                      // (uses connection close to clean up)
 
+    // Protects the state of the journal flusher below.
+    stdx::mutex _flusherMutex;
+    // Notified when a caller queues for a flush, and when the journal flusher is asked to stop.
+    stdx::condition_variable _flushRequested;
+    bool _flusherRunning = false;
+    bool _flusherStopRequested = false;
+    // Set when the next flush to start completes: true if it flushed the journal, and false if
+    // the journal flusher stopped first. Replaced as each flush starts, so that a caller waits for
+    // the first flush which starts after it queues.
+    stdx::promise<bool> _nextFlushPromise;
+    stdx::shared_future<bool> _nextFlush;
+    // The callers queued for the next flush, and when the first of them queued.
+    uint64_t _flushWaiters = 0;
+    stdx::chrono::steady_clock::time_point _firstWaiterQueued;
+    JournalFlusherStats _flusherStats;
+
     /**
      * Returns a session to the cache for later reuse. If closeAll was called between getting this
      * session and releasing it, the session is directly released. This method is thread safe.
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/new.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/with_alignment.h"
+
+namespace mongo {
+
+/**
+ * A 64-bit counter for statistics that many threads update at once, such as the number of records
+ * in a collection. Updates are spread over stripes on separate cache lines, so that threads
+ * running on different cores rarely write to the same line. Reads sum the stripes, which makes
+ * them more expensive than updates and not atomic with respect to concurrent updates.
+ */
+class WiredTigerStripedCounter {
+    MONGO_DISALLOW_COPYING(WiredTigerStripedCounter);
+
+public:
+    WiredTigerStripedCounter() {
+        // Operator new only guarantees the alignment of std::max_align_t, so the stripes are
+        // placed at the first cache line boundary within a buffer which has room to spare.
+        const std::size_t stripesSize = _numStripes() * sizeof(Stripe);
+        std::size_t bufferSize = stripesSize + alignof(Stripe) - 1;
+        _buffer.reset(new char[bufferSize]);
+        void* stripes = _buffer.get();
+        _stripes =
+            static_cast<Stripe*>(std::align(alignof(Stripe), stripesSize, stripes, bufferSize));
+        for (std::size_t i = 0; i < _numStripes(); ++i) {
+            new (&_stripes[i]) Stripe(0);
+        }
+    }
+
+    void add(std::int64_t diff) {
+        _stripes[_stripeIndex()].fetchAndAdd(diff);
+    }
+
+    std::int64_t load() const {
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i < _numStripes(); ++i) {
+            sum += _stripes[i].load();
+        }
+        return sum;
+    }
+
+    /**
+     * If the counter is below zero, adds the deficit to the first stripe so that it reads zero.
+     * Unlike store(), this keeps the updates made concurrently to the other stripes.
+     */
+    void clampAtZero() {
+        const std::int64_t sum = load();
+        if (sum < 0) {
+            _stripes[0].fetchAndAdd(-sum);
+        }
+    }
+
+    /**
+     * Resets the counter to 'value'. Updates made concurrently may be lost.
+     */
+    void store(std::int64_t value) {
+        for (std::size_t i = 1; i < _numStripes(); ++i) {
+            _stripes[i].store(0);
+        }
+        _stripes[0].store(value);
+    }
+
+private:
+    // More stripes than this rarely reduce contention further, but cost a cache line each.
+    static const std::size_t kMaxStripes = 8;
+
+    using Stripe = CacheAligned<AtomicInt64>;
+    static_assert(std::is_trivially_destructible<Stripe>::value,
+                  "stripes are never explicitly destroyed");
+
+    /**
+     * The number of stripes in every counter: the number of cores rounded up to a power of two,
+     * up to kMaxStripes.
+     */
+    static std::size_t _numStripes() {
+        static const std::size_t numStripes = [] {
+            const std::size_t cores = std::max(stdx::thread::hardware_concurrency(), 1U);
+            std::size_t stripes = 1;
+            while (stripes < cores && stripes < kMaxStripes) {
+                stripes *= 2;
+            }
+            return stripes;
+        }();
+        return numStripes;
+    }
+
+    /**
+     * Threads are assigned stripes round-robin the first time they update any counter.
+     */
+    static std::size_t _stripeIndex() {
+        static AtomicUInt32 nextStripe;
+        static thread_local const std::size_t stripe = nextStripe.fetchAndAdd(1) % _numStripes();
+        return stripe;
+    }
+
+    std::unique_ptr<char[]> _buffer;
+    Stripe* _stripes;
+};
+
+}  // namespace mongo
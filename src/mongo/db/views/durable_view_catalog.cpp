@@ -89,7 +89,8 @@ Status DurableViewCatalogImpl::iterate(OperationContext* opCtx, Callback callbac
         bool valid = true;
         for (const BSONElement& e : viewDef) {
             std::string name(e.fieldName());
-            valid &= name == "_id" || name == "viewOn" || name == "pipeline" || name == "collation";
+            valid &= name == "_id" || name == "viewOn" || name == "pipeline" ||
+                name == "collation" || name == "materialized";
         }
 
         const auto viewName = viewDef["_id"].str();
@@ -113,6 +114,8 @@ Status DurableViewCatalogImpl::iterate(OperationContext* opCtx, Callback callbac
 
         valid &=
             (!viewDef.hasField("collation") || viewDef["collation"].type() == BSONType::Object);
+        valid &= (!viewDef.hasField("materialized") ||
+                  viewDef["materialized"].type() == BSONType::Bool);
 
         if (!valid) {
             return {ErrorCodes::InvalidViewDefinition,
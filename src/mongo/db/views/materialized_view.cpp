@@ -0,0 +1,657 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view.h"
+
+#include <cmath>
+#include <limits>
+
+#include "mongo/base/counter.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/db/views/view.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+Counter64 changesApplied;
+Counter64 invalidations;
+Counter64 readsOfCurrentResults;
+Counter64 rebuildsInstalled;
+Counter64 rebuildsAbandoned;
+Counter64 refreshLagMillis;
+
+ServerStatusMetricField<Counter64> displayChangesApplied("materializedViews.changesApplied",
+                                                         &changesApplied);
+ServerStatusMetricField<Counter64> displayInvalidations("materializedViews.invalidations",
+                                                        &invalidations);
+ServerStatusMetricField<Counter64> displayReadsOfCurrentResults("materializedViews.currentReads",
+                                                                &readsOfCurrentResults);
+ServerStatusMetricField<Counter64> displayRebuildsInstalled("materializedViews.rebuilds.installed",
+                                                            &rebuildsInstalled);
+ServerStatusMetricField<Counter64> displayRebuildsAbandoned("materializedViews.rebuilds.abandoned",
+                                                            &rebuildsAbandoned);
+// The total time views spent stale before a rebuild made their totals current again.
+ServerStatusMetricField<Counter64> displayRefreshLagMillis("materializedViews.refreshLagMillis",
+                                                           &refreshLagMillis);
+
+// The fields of the rebuild pipeline's $group holding the number of documents in the group, and
+// for the i-th $sum its total and the number of its inputs of each numeric type.
+const char kCountField[] = "n";
+std::string totalField(size_t i) {
+    return str::stream() << "s" << i;
+}
+std::string typeCountField(StringData typeName, size_t i) {
+    return str::stream() << typeName << i;
+}
+const std::vector<std::pair<StringData, StringData>> kNumericTypes = {
+    {"int"_sd, "i"_sd}, {"long"_sd, "l"_sd}, {"double"_sd, "d"_sd}, {"decimal"_sd, "m"_sd}};
+
+/**
+ * Parses the _id of a $group the same way $group does.
+ */
+boost::intrusive_ptr<Expression> parseIdExpression(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    BSONElement idSpec,
+    const VariablesParseState& vps) {
+    if (idSpec.type() == Object && !idSpec.Obj().isEmpty()) {
+        const BSONObj idKeyObj = idSpec.Obj();
+        if (idKeyObj.firstElementFieldName()[0] == '$') {
+            return Expression::parseObject(expCtx, idKeyObj, vps);
+        }
+        return ExpressionObject::parse(expCtx, idKeyObj, vps);
+    } else if (idSpec.type() == String && idSpec.valuestr()[0] == '$') {
+        return ExpressionFieldPath::parse(expCtx, idSpec.str(), vps);
+    }
+    return ExpressionConstant::create(expCtx, Value(idSpec));
+}
+
+bool isFinite(const Value& value) {
+    switch (value.getType()) {
+        case NumberDouble:
+            return std::isfinite(value.getDouble());
+        case NumberDecimal:
+            return !value.getDecimal().isNaN() && !value.getDecimal().isInfinite();
+        default:
+            return true;
+    }
+}
+
+Status notSupported(StringData reason) {
+    return {ErrorCodes::OptionNotSupportedOnView,
+            str::stream() << "Cannot materialize view: " << reason};
+}
+
+}  // namespace
+
+void MaterializedView::Sum::add(const Value& input, int sign) {
+    switch (input.getType()) {
+        case NumberInt:
+            numInts += sign;
+            nonDecimalTotal.addLong(sign * static_cast<long long>(input.getInt()));
+            break;
+        case NumberLong: {
+            numLongs += sign;
+            const long long value = input.getLong();
+            if (sign < 0 && value == std::numeric_limits<long long>::min()) {
+                // The negation does not fit a long long, but is exactly representable as a double.
+                nonDecimalTotal.addDouble(-static_cast<double>(value));
+            } else {
+                nonDecimalTotal.addLong(sign * value);
+            }
+            break;
+        }
+        case NumberDouble:
+            numDoubles += sign;
+            nonDecimalTotal.addDouble(sign * input.getDouble());
+            break;
+        case NumberDecimal:
+            numDecimals += sign;
+            decimalTotal = sign > 0 ? decimalTotal.add(input.getDecimal())
+                                    : decimalTotal.subtract(input.getDecimal());
+            break;
+        default:
+            // $sum ignores non-numeric inputs.
+            break;
+    }
+}
+
+Value MaterializedView::Sum::getValue() const {
+    // Gives the total the type AccumulatorSum would, based on the widest type among the inputs.
+    if (numDecimals > 0) {
+        double sum, error;
+        std::tie(sum, error) = nonDecimalTotal.getDoubleDouble();
+        Decimal128 total;  // zero
+        if (sum != 0) {
+            total = total.add(Decimal128(sum, Decimal128::kRoundTo34Digits));
+            total = total.add(Decimal128(error, Decimal128::kRoundTo34Digits));
+        }
+        return Value(total.add(decimalTotal));
+    }
+    if (numDoubles > 0 || ((numLongs > 0 || numInts > 0) && !nonDecimalTotal.fitsLong())) {
+        return Value(nonDecimalTotal.getDouble());
+    }
+    if (numLongs > 0) {
+        return Value(nonDecimalTotal.getLong());
+    }
+    if (numInts > 0) {
+        return Value::createIntOrLong(nonDecimalTotal.getLong());
+    }
+    return Value(0);
+}
+
+MaterializedView::MaterializedView(std::unique_ptr<CollatorInterface> collator)
+    : _collator(std::move(collator)),
+      _valueComparator(_collator.get()),
+      _staleSince(Date_t::now()),
+      _groups(_valueComparator.makeUnorderedValueMap<Group>()) {}
+
+MaterializedView::~MaterializedView() = default;
+
+StatusWith<std::shared_ptr<MaterializedView>> MaterializedView::parse(OperationContext* opCtx,
+                                                                      const ViewDefinition& view) {
+    std::shared_ptr<MaterializedView> materialized(
+        new MaterializedView(CollatorInterface::cloneCollator(view.defaultCollator())));
+    const auto& pipeline = view.pipeline();
+    size_t stage = 0;
+
+    if (stage < pipeline.size() &&
+        pipeline[stage].firstElement().fieldNameStringData() == "$match") {
+        auto filterSpec = pipeline[stage].firstElement();
+        if (filterSpec.type() != Object) {
+            return notSupported("the $match specification must be an object");
+        }
+        materialized->_filterSpec = filterSpec.Obj().getOwned();
+        ++stage;
+    }
+
+    if (stage == pipeline.size() ||
+        pipeline[stage].firstElement().fieldNameStringData() != "$group" ||
+        pipeline[stage].firstElement().type() != Object) {
+        return notSupported(
+            "the pipeline must start with a $group, optionally preceded by a $match");
+    }
+    materialized->_groupSpec = pipeline[stage].firstElement().Obj().getOwned();
+    ++stage;
+
+    bool hasId = false;
+    for (auto&& field : materialized->_groupSpec) {
+        if (field.fieldNameStringData() == "_id") {
+            hasId = true;
+            continue;
+        }
+        if (field.type() != Object || field.Obj().nFields() != 1 ||
+            field.Obj().firstElement().fieldNameStringData() != "$sum" ||
+            field.Obj().firstElement().type() == Array) {
+            return notSupported(str::stream() << "only $sum accumulators can be maintained, "
+                                                 "but the $group computes "
+                                              << field);
+        }
+        materialized->_fieldNames.push_back(field.fieldName());
+    }
+    if (!hasId) {
+        return notSupported("the $group must specify an _id");
+    }
+
+    materialized->_numMaterializedStages = stage;
+
+    try {
+        materialized->_idleEvaluators.push_back(materialized->_makeEvaluator(opCtx));
+    } catch (const DBException& ex) {
+        return ex.toStatus();
+    }
+
+    return {std::move(materialized)};
+}
+
+std::unique_ptr<MaterializedView::Evaluator> MaterializedView::_makeEvaluator(
+    OperationContext* opCtx) const {
+    auto evaluator = stdx::make_unique<Evaluator>();
+    evaluator->expCtx = new ExpressionContext(opCtx, _collator.get());
+
+    if (!_filterSpec.isEmpty()) {
+        auto filter = MatchExpressionParser::parse(_filterSpec,
+                                                   evaluator->expCtx,
+                                                   ExtensionsCallbackNoop(),
+                                                   MatchExpressionParser::kBanAllSpecialFeatures);
+        if (!filter.isOK()) {
+            uassertStatusOK(notSupported(str::stream()
+                                         << "the $match cannot be evaluated per document: "
+                                         << filter.getStatus().reason()));
+        }
+        evaluator->filter = std::move(filter.getValue());
+    }
+
+    auto vps = evaluator->expCtx->variablesParseState;
+    for (auto&& field : _groupSpec) {
+        if (field.fieldNameStringData() == "_id") {
+            evaluator->idExpression = parseIdExpression(evaluator->expCtx, field, vps);
+        } else {
+            evaluator->sumExpressions.push_back(
+                Expression::parseOperand(evaluator->expCtx, field.Obj().firstElement(), vps));
+        }
+    }
+
+    // The expressions outlive this operation, and never need it for evaluation.
+    evaluator->expCtx->opCtx = nullptr;
+    return evaluator;
+}
+
+std::unique_ptr<MaterializedView::Evaluator> MaterializedView::_acquireEvaluator(
+    OperationContext* opCtx) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_evaluatorsMutex);
+        if (!_idleEvaluators.empty()) {
+            auto evaluator = std::move(_idleEvaluators.back());
+            _idleEvaluators.pop_back();
+            return evaluator;
+        }
+    }
+    return _makeEvaluator(opCtx);
+}
+
+void MaterializedView::_releaseEvaluator(std::unique_ptr<Evaluator> evaluator) {
+    stdx::lock_guard<stdx::mutex> lk(_evaluatorsMutex);
+    _idleEvaluators.push_back(std::move(evaluator));
+}
+
+void MaterializedView::onInsert(OperationContext* opCtx, const BSONObj& doc) {
+    _observeWrite(opCtx, nullptr, &doc);
+}
+
+void MaterializedView::onUpdate(OperationContext* opCtx,
+                                const BSONObj& preImage,
+                                const BSONObj& postImage) {
+    _observeWrite(opCtx, &preImage, &postImage);
+}
+
+void MaterializedView::onDelete(OperationContext* opCtx, const BSONObj& doc) {
+    _observeWrite(opCtx, &doc, nullptr);
+}
+
+void MaterializedView::_observeWrite(OperationContext* opCtx,
+                                     const BSONObj* preImage,
+                                     const BSONObj* postImage) {
+    bool evaluate;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        evaluate = _current || _activeRebuilds > 0;
+    }
+
+    // The filter and accumulator expressions are evaluated without holding '_mutex', so that
+    // concurrent writers and readers only contend to apply the changes.
+    ChangeList changes;
+    bool applicable = true;
+    bool evaluated = false;
+    if (evaluate) {
+        try {
+            auto evaluator = _acquireEvaluator(opCtx);
+            applicable = (!preImage || _makeChange(*evaluator, *preImage, -1, &changes)) &&
+                (!postImage || _makeChange(*evaluator, *postImage, 1, &changes));
+            _releaseEvaluator(std::move(evaluator));
+            evaluated = true;
+        } catch (const DBException&) {
+            applicable = false;
+        }
+        if (applicable && changes.empty()) {
+            return;  // The write does not affect the view.
+        }
+    }
+
+    unsigned long long writeNumber;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        // A rebuild installed or begun since the write was found to need no evaluation cannot
+        // have seen it, as it has not committed, so the changes it makes are needed after all.
+        applicable = applicable && (evaluated || (!_current && _activeRebuilds == 0));
+
+        // While the totals are stale there is nothing to apply, but a rebuild which began before
+        // the write commits must still account for it.
+        writeNumber = ++_writeCount;
+        ++_writesPending;
+    }
+
+    auto self = shared_from_this();
+    opCtx->recoveryUnit()->onCommit([self, changes, applicable, writeNumber]() {
+        stdx::lock_guard<stdx::mutex> lk(self->_mutex);
+        --self->_writesPending;
+        if (!applicable) {
+            self->_invalidate_inlock();
+            return;
+        }
+        if (self->_current) {
+            self->_applyChanges_inlock(changes);
+        }
+        if (self->_activeRebuilds > 0) {
+            self->_logWrite_inlock(writeNumber, changes);
+        }
+    });
+    opCtx->recoveryUnit()->onRollback([self]() {
+        stdx::lock_guard<stdx::mutex> lk(self->_mutex);
+        --self->_writesPending;
+    });
+}
+
+bool MaterializedView::_makeChange(const Evaluator& evaluator,
+                                   const BSONObj& doc,
+                                   int sign,
+                                   ChangeList* changes) {
+    try {
+        if (evaluator.filter && !evaluator.filter->matchesBSON(doc)) {
+            return true;
+        }
+
+        const Document root(doc);
+        Change change;
+        change.sign = sign;
+        change.groupKey = evaluator.idExpression->evaluate(root);
+        if (change.groupKey.missing()) {
+            change.groupKey = Value(BSONNULL);
+        }
+        for (auto&& expression : evaluator.sumExpressions) {
+            Value input = expression->evaluate(root);
+            if (!isFinite(input)) {
+                // Removing an infinite or NaN input cannot restore the total it was added to.
+                return false;
+            }
+            change.inputs.push_back(std::move(input));
+        }
+        changes->push_back(std::move(change));
+        return true;
+    } catch (const DBException&) {
+        // The write must not fail because of the view. Reading it will report the error instead.
+        return false;
+    }
+}
+
+bool MaterializedView::_applyChanges(const ChangeList& changes,
+                                     GroupMap* groups,
+                                     size_t* groupsBytes) const {
+    for (auto&& change : changes) {
+        auto it = groups->find(change.groupKey);
+        if (it == groups->end()) {
+            if (change.sign < 0) {
+                return false;
+            }
+            it = groups->emplace(change.groupKey, Group()).first;
+            it->second.sums.resize(_fieldNames.size());
+            *groupsBytes += _groupBytes(change.groupKey);
+        }
+
+        Group& group = it->second;
+        group.count += change.sign;
+        for (size_t i = 0; i < change.inputs.size(); ++i) {
+            group.sums[i].add(change.inputs[i], change.sign);
+        }
+
+        if (group.count == 0) {
+            *groupsBytes -= _groupBytes(it->first);
+            groups->erase(it);
+        } else if (group.count < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MaterializedView::_applyChanges_inlock(const ChangeList& changes) {
+    if (!_applyChanges(changes, &_groups, &_groupsBytes)) {
+        // Removing a document from a group which does not exist means the totals are wrong;
+        // rebuild them.
+        _invalidate_inlock();
+        return;
+    }
+    changesApplied.increment(changes.size());
+
+    if (_groupsBytes > DocumentSourceGroup::kDefaultMaxMemoryUsageBytes) {
+        _invalidate_inlock();
+    }
+}
+
+void MaterializedView::_logWrite_inlock(unsigned long long writeNumber,
+                                        const ChangeList& changes) {
+    if (changes.empty() || writeNumber <= _rebuildLogCompleteAfter) {
+        return;
+    }
+
+    for (auto&& change : changes) {
+        _rebuildLogBytes += sizeof(Change) + change.groupKey.getApproximateSize();
+        for (auto&& input : change.inputs) {
+            _rebuildLogBytes += input.getApproximateSize();
+        }
+    }
+    if (_rebuildLogBytes > DocumentSourceGroup::kDefaultMaxMemoryUsageBytes) {
+        // The rebuilds in progress can no longer be completed, but those which begin from now on
+        // only need the writes observed after them.
+        _rebuildLog.clear();
+        _rebuildLogBytes = 0;
+        _rebuildLogCompleteAfter = _writeCount;
+        return;
+    }
+    _rebuildLog.push_back({writeNumber, changes});
+}
+
+size_t MaterializedView::_groupBytes(const Value& groupKey) const {
+    return groupKey.getApproximateSize() + sizeof(Group) + _fieldNames.size() * sizeof(Sum);
+}
+
+void MaterializedView::invalidate() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _invalidate_inlock();
+}
+
+void MaterializedView::_invalidate_inlock() {
+    ++_invalidationCount;
+    if (!_current) {
+        return;
+    }
+    _current = false;
+    _staleSince = Date_t::now();
+    _groups.clear();
+    _groupsBytes = 0;
+    invalidations.increment();
+}
+
+Document MaterializedView::_makeOutput_inlock(const Value& groupKey, const Group& group) const {
+    MutableDocument output(1 + _fieldNames.size());
+    output.addField("_id", groupKey);
+    for (size_t i = 0; i < _fieldNames.size(); ++i) {
+        output.addField(_fieldNames[i], group.sums[i].getValue());
+    }
+    return output.freeze();
+}
+
+boost::optional<std::vector<Document>> MaterializedView::getResults() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_current) {
+        return boost::none;
+    }
+
+    std::vector<Document> results;
+    results.reserve(_groups.size());
+    for (auto&& group : _groups) {
+        results.push_back(_makeOutput_inlock(group.first, group.second));
+    }
+    readsOfCurrentResults.increment();
+    return {std::move(results)};
+}
+
+std::vector<BSONObj> MaterializedView::getRebuildPipeline() const {
+    std::vector<BSONObj> pipeline;
+    if (!_filterSpec.isEmpty()) {
+        pipeline.push_back(BSON("$match" << _filterSpec));
+    }
+
+    BSONObjBuilder groupBuilder;
+    groupBuilder.append(_groupSpec["_id"]);
+    groupBuilder.append(kCountField, BSON("$sum" << 1));
+    size_t i = 0;
+    for (auto&& field : _groupSpec) {
+        if (field.fieldNameStringData() == "_id") {
+            continue;
+        }
+        auto input = field.Obj().firstElement();
+        groupBuilder.append(totalField(i), BSON("$sum" << input));
+        for (auto&& type : kNumericTypes) {
+            auto isType = BSON("$eq" << BSON_ARRAY(BSON("$type" << input) << type.first));
+            groupBuilder.append(typeCountField(type.second, i),
+                                BSON("$sum" << BSON("$cond" << BSON_ARRAY(isType << 1 << 0))));
+        }
+        ++i;
+    }
+    pipeline.push_back(BSON("$group" << groupBuilder.obj()));
+    return pipeline;
+}
+
+MaterializedView::RebuildTicket::RebuildTicket(std::shared_ptr<MaterializedView> view)
+    : _view(std::move(view)) {}
+
+MaterializedView::RebuildTicket::~RebuildTicket() {
+    _view->_endRebuild();
+}
+
+std::unique_ptr<MaterializedView::RebuildTicket> MaterializedView::beginRebuild() {
+    std::unique_ptr<RebuildTicket> ticket(new RebuildTicket(shared_from_this()));
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    ++_activeRebuilds;
+    ticket->_writeCount = _writeCount;
+    ticket->_invalidationCount = _invalidationCount;
+
+    // A write which is pending now may commit either before or after the rebuild's snapshot is
+    // opened, so it can be neither relied upon nor replayed.
+    ticket->installable = _writesPending == 0;
+    return ticket;
+}
+
+void MaterializedView::rebuildSnapshotOpened(RebuildTicket* ticket) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    // The same goes for a write observed while the snapshot was being opened.
+    ticket->installable = ticket->installable && ticket->_writeCount == _writeCount;
+    ticket->_replayable = true;
+}
+
+void MaterializedView::_endRebuild() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (--_activeRebuilds == 0) {
+        _rebuildLog.clear();
+        _rebuildLogBytes = 0;
+    }
+}
+
+std::vector<Document> MaterializedView::finishRebuild(const RebuildTicket& ticket,
+                                                      const std::vector<Document>& rebuildResults) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Without a snapshot to replay writes onto, any write observed since the rebuild began may or
+    // may not be included in its results, which makes the totals unsafe to maintain from here on.
+    bool installable = ticket.installable && ticket._invalidationCount == _invalidationCount &&
+        (ticket._replayable ? ticket._writeCount >= _rebuildLogCompleteAfter
+                            : ticket._writeCount == _writeCount);
+
+    auto groups = _valueComparator.makeUnorderedValueMap<Group>();
+    size_t groupsBytes = 0;
+    std::vector<Document> results;
+    results.reserve(rebuildResults.size());
+    for (auto&& row : rebuildResults) {
+        Group group;
+        group.count = row[kCountField].coerceToLong();
+        group.sums.resize(_fieldNames.size());
+        for (size_t i = 0; i < group.sums.size(); ++i) {
+            Sum& sum = group.sums[i];
+            sum.numInts = row[typeCountField("i", i)].coerceToLong();
+            sum.numLongs = row[typeCountField("l", i)].coerceToLong();
+            sum.numDoubles = row[typeCountField("d", i)].coerceToLong();
+            sum.numDecimals = row[typeCountField("m", i)].coerceToLong();
+
+            Value total = row[totalField(i)];
+            installable = installable && isFinite(total);
+            switch (total.getType()) {
+                case NumberInt:
+                case NumberLong:
+                    sum.nonDecimalTotal.addLong(total.coerceToLong());
+                    break;
+                case NumberDouble:
+                    sum.nonDecimalTotal.addDouble(total.getDouble());
+                    break;
+                case NumberDecimal:
+                    sum.decimalTotal = total.getDecimal();
+                    break;
+                default:
+                    MONGO_UNREACHABLE;
+            }
+        }
+
+        Value groupKey = row["_id"];
+        results.push_back(_makeOutput_inlock(groupKey, group));
+        if (installable) {
+            groupsBytes += _groupBytes(groupKey);
+            groups.emplace(std::move(groupKey), std::move(group));
+        }
+    }
+
+    if (installable && ticket._replayable) {
+        for (auto&& write : _rebuildLog) {
+            if (write.writeNumber > ticket._writeCount &&
+                !_applyChanges(write.changes, &groups, &groupsBytes)) {
+                installable = false;
+                break;
+            }
+        }
+    }
+
+    installable = installable && groupsBytes <= DocumentSourceGroup::kDefaultMaxMemoryUsageBytes;
+    if (!installable) {
+        rebuildsAbandoned.increment();
+        return results;
+    }
+
+    _groups = std::move(groups);
+    _groupsBytes = groupsBytes;
+    if (!_current) {
+        _current = true;
+        refreshLagMillis.increment(
+            durationCount<Milliseconds>(Date_t::now() - _staleSince));
+    }
+    rebuildsInstalled.increment();
+    return results;
+}
+
+}  // namespace mongo
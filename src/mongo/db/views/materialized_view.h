@@ -0,0 +1,305 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/platform/decimal128.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/summation.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class Expression;
+class ExpressionContext;
+class MatchExpression;
+class OperationContext;
+class ViewDefinition;
+
+/**
+ * The incrementally maintained contents of a materialized view. A materialized view is defined by
+ * an optional $match followed by a $group whose accumulators are all $sum, and possibly further
+ * stages which are applied when the view is read. The per-group totals are kept in memory and
+ * updated by the OpObserver as writes to the view's backing collection commit, so that reads of
+ * the view need not re-run the aggregation over the whole collection.
+ *
+ * The totals start out stale, and become current once rebuilt by a full aggregation over the
+ * backing collection. They become stale again when a write cannot be applied incrementally, or
+ * when the backing collection is dropped, renamed or truncated. Reads of a stale view recompute
+ * its contents from a snapshot of the backing collection, and install them as current with the
+ * writes which committed after the snapshot was opened replayed onto them.
+ *
+ * This class is thread-safe.
+ */
+class MaterializedView : public std::enable_shared_from_this<MaterializedView> {
+    MONGO_DISALLOW_COPYING(MaterializedView);
+
+public:
+    /**
+     * Identifies a rebuild of the totals, so that its results are installed only if every write to
+     * the backing collection is either included in the snapshot the rebuild reads, or replayed
+     * onto its results. The caller clears 'installable' if the rebuild cannot read a snapshot taken
+     * after it began. The rebuild ends when its ticket is destroyed.
+     */
+    class RebuildTicket {
+        MONGO_DISALLOW_COPYING(RebuildTicket);
+
+    public:
+        ~RebuildTicket();
+
+        bool installable = false;
+
+    private:
+        friend class MaterializedView;
+
+        explicit RebuildTicket(std::shared_ptr<MaterializedView> view);
+
+        std::shared_ptr<MaterializedView> _view;
+        unsigned long long _writeCount = 0;
+        unsigned long long _invalidationCount = 0;
+
+        // Set once the rebuild's snapshot is open, after which the writes which commit are
+        // replayed onto its results.
+        bool _replayable = false;
+    };
+
+    /**
+     * Returns a MaterializedView maintaining the contents of 'view', or an
+     * OptionNotSupportedOnView error if the view's pipeline cannot be maintained incrementally.
+     */
+    static StatusWith<std::shared_ptr<MaterializedView>> parse(OperationContext* opCtx,
+                                                               const ViewDefinition& view);
+
+    ~MaterializedView();
+
+    /**
+     * Returns the number of leading stages of the view's pipeline which are materialized. The
+     * remaining stages are applied to the materialized contents when the view is read.
+     */
+    size_t numMaterializedStages() const {
+        return _numMaterializedStages;
+    }
+
+    /**
+     * Record that 'doc' was inserted into, updated in or deleted from the backing collection. Must
+     * be called within the writer's unit of work; the totals change when it commits.
+     */
+    void onInsert(OperationContext* opCtx, const BSONObj& doc);
+    void onUpdate(OperationContext* opCtx, const BSONObj& preImage, const BSONObj& postImage);
+    void onDelete(OperationContext* opCtx, const BSONObj& doc);
+
+    /**
+     * Marks the totals as stale, to be rebuilt by the next read.
+     */
+    void invalidate();
+
+    /**
+     * Returns the output of the materialized stages, or boost::none if the totals are stale.
+     */
+    boost::optional<std::vector<Document>> getResults();
+
+    /**
+     * Returns the pipeline which computes, over the backing collection, the totals from which
+     * finishRebuild() produces the output of the materialized stages.
+     */
+    std::vector<BSONObj> getRebuildPipeline() const;
+
+    /**
+     * Must be called before the rebuild pipeline opens its snapshot of the backing collection.
+     */
+    std::unique_ptr<RebuildTicket> beginRebuild();
+
+    /**
+     * Must be called once the snapshot of the backing collection which the rebuild pipeline reads
+     * throughout has been opened, if the storage engine provides one. The writes which commit from
+     * then on are replayed onto the rebuilt totals. Otherwise any write observed during the rebuild
+     * keeps its results from being installed.
+     */
+    void rebuildSnapshotOpened(RebuildTicket* ticket);
+
+    /**
+     * Converts the results of the rebuild pipeline into the output of the materialized stages.
+     * They become the current totals, with the writes the snapshot missed replayed onto them,
+     * unless a write raced with the rebuild in a way which cannot be accounted for.
+     */
+    std::vector<Document> finishRebuild(const RebuildTicket& ticket,
+                                        const std::vector<Document>& rebuildResults);
+
+private:
+    /**
+     * The running total of one $sum accumulator within a group. Tracks how many inputs of each
+     * numeric type it includes, so that inputs can be removed again and the total keeps the type
+     * $sum would give it.
+     */
+    struct Sum {
+        void add(const Value& input, int sign);
+        Value getValue() const;
+
+        long long numInts = 0;
+        long long numLongs = 0;
+        long long numDoubles = 0;
+        long long numDecimals = 0;
+        DoubleDoubleSummation nonDecimalTotal;
+        Decimal128 decimalTotal;
+    };
+
+    struct Group {
+        long long count = 0;
+        std::vector<Sum> sums;
+    };
+
+    using GroupMap = ValueUnorderedMap<Group>;
+
+    /**
+     * The contribution of one document to its group, added with 'sign' 1 or removed with -1.
+     */
+    struct Change {
+        Value groupKey;
+        int sign;
+        std::vector<Value> inputs;
+    };
+
+    using ChangeList = std::vector<Change>;
+
+    /**
+     * The changes of a write which committed while a rebuild was in progress, numbered in the
+     * order writes were observed.
+     */
+    struct LoggedWrite {
+        unsigned long long writeNumber;
+        ChangeList changes;
+    };
+
+    /**
+     * The parsed filter, group key and $sum expressions of the materialized stages. Evaluating
+     * them modifies the variables of their ExpressionContext, so each Evaluator is used by one
+     * writer at a time.
+     */
+    struct Evaluator {
+        boost::intrusive_ptr<ExpressionContext> expCtx;
+        std::unique_ptr<MatchExpression> filter;
+        boost::intrusive_ptr<Expression> idExpression;
+        std::vector<boost::intrusive_ptr<Expression>> sumExpressions;
+    };
+
+    explicit MaterializedView(std::unique_ptr<CollatorInterface> collator);
+
+    /**
+     * Parses the materialized stages from '_filterSpec' and '_groupSpec'. Throws if they are
+     * invalid.
+     */
+    std::unique_ptr<Evaluator> _makeEvaluator(OperationContext* opCtx) const;
+
+    /**
+     * Takes an idle Evaluator, or makes a new one if all are in use, and returns it to the pool
+     * when done.
+     */
+    std::unique_ptr<Evaluator> _acquireEvaluator(OperationContext* opCtx);
+    void _releaseEvaluator(std::unique_ptr<Evaluator> evaluator);
+
+    /**
+     * Computes the changes that replacing 'preImage' with 'postImage' makes to the totals, where
+     * either may be null, and arranges for them to be applied when the writer's unit of work
+     * commits.
+     */
+    void _observeWrite(OperationContext* opCtx, const BSONObj* preImage, const BSONObj* postImage);
+
+    /**
+     * Appends the change made by adding or removing 'doc' to 'changes', if 'doc' belongs to the
+     * view. Returns false if the change cannot be applied incrementally.
+     */
+    static bool _makeChange(const Evaluator& evaluator,
+                            const BSONObj& doc,
+                            int sign,
+                            ChangeList* changes);
+
+    /**
+     * Applies 'changes' to 'groups'. Returns false if they remove a document from a group which
+     * does not exist, which means the totals are wrong.
+     */
+    bool _applyChanges(const ChangeList& changes, GroupMap* groups, size_t* groupsBytes) const;
+
+    void _applyChanges_inlock(const ChangeList& changes);
+    void _logWrite_inlock(unsigned long long writeNumber, const ChangeList& changes);
+    void _endRebuild();
+    void _invalidate_inlock();
+    size_t _groupBytes(const Value& groupKey) const;
+    Document _makeOutput_inlock(const Value& groupKey, const Group& group) const;
+
+    std::unique_ptr<CollatorInterface> _collator;
+    ValueComparator _valueComparator;
+    size_t _numMaterializedStages = 0;
+
+    // The materialized stages: an optional filter, then the group key and the $sum accumulators.
+    BSONObj _filterSpec;
+    BSONObj _groupSpec;
+    std::vector<std::string> _fieldNames;
+
+    // Writers evaluate the materialized stages without holding '_mutex', each with an Evaluator
+    // of its own.
+    stdx::mutex _evaluatorsMutex;
+    std::vector<std::unique_ptr<Evaluator>> _idleEvaluators;
+
+    // Protects the members below. Held only to apply changes which were computed beforehand.
+    stdx::mutex _mutex;
+
+    bool _current = false;
+    Date_t _staleSince;
+    GroupMap _groups;
+    size_t _groupsBytes = 0;
+
+    // The number of observed writes which affect the view, and the number of times the totals
+    // have been invalidated. A rebuild which cannot account for a change in either did not observe
+    // a consistent state of the backing collection.
+    unsigned long long _writeCount = 0;
+    unsigned long long _invalidationCount = 0;
+
+    // The number of observed writes whose unit of work has not yet committed or rolled back.
+    long long _writesPending = 0;
+
+    // While rebuilds are in progress, writes are evaluated even though the totals are stale, and
+    // the changes of those which commit are logged to be replayed onto the rebuilt totals. The
+    // log is complete for the writes numbered after '_rebuildLogCompleteAfter'; it is emptied
+    // when it grows too large, and once no rebuild is in progress.
+    int _activeRebuilds = 0;
+    std::vector<LoggedWrite> _rebuildLog;
+    size_t _rebuildLogBytes = 0;
+    unsigned long long _rebuildLogCompleteAfter = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,440 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/storage/recovery_unit_noop.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/db/views/view.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+class MaterializedViewTest : public unittest::Test {
+public:
+    MaterializedViewTest() : _opCtx(_serviceContext.makeOperationContext()) {
+        _opCtx->setRecoveryUnit(new RecoveryUnitNoop(), OperationContext::kNotInUnitOfWork);
+    }
+
+protected:
+    StatusWith<std::shared_ptr<MaterializedView>> parse(const BSONArray& pipeline) {
+        ViewDefinition view("test", "view", "coll", pipeline, nullptr);
+        return MaterializedView::parse(_opCtx.get(), view);
+    }
+
+    std::shared_ptr<MaterializedView> parseOK(const BSONArray& pipeline) {
+        auto swView = parse(pipeline);
+        ASSERT_OK(swView.getStatus());
+        return swView.getValue();
+    }
+
+    /**
+     * Makes the view current, as though rebuilt over an empty collection.
+     */
+    void rebuildEmpty(MaterializedView* view) {
+        auto ticket = view->beginRebuild();
+        ASSERT(ticket->installable);
+        ASSERT(view->finishRebuild(*ticket, {}).empty());
+        ASSERT(view->getResults());
+    }
+
+    /**
+     * Returns the row the rebuild pipeline of a view grouping by "$a" and summing integers "$b"
+     * would produce for a group of 'count' documents totalling 'total'.
+     */
+    Document rebuildRow(int groupKey, long long count, long long total) {
+        return Document{{"_id", groupKey},
+                        {"n", count},
+                        {"s0", total},
+                        {"i0", count},
+                        {"l0", 0},
+                        {"d0", 0},
+                        {"m0", 0}};
+    }
+
+    /**
+     * Runs 'write' within a unit of work, which commits if 'commit' is true.
+     */
+    template <typename Write>
+    void inUnitOfWork(Write write, bool commit = true) {
+        auto ru = _opCtx->recoveryUnit();
+        ru->beginUnitOfWork(_opCtx.get());
+        write();
+        if (commit) {
+            ru->commitUnitOfWork();
+        } else {
+            ru->abortUnitOfWork();
+        }
+    }
+
+    OperationContext* opCtx() {
+        return _opCtx.get();
+    }
+
+    ServiceContext* serviceContext() {
+        return _serviceContext.getServiceContext();
+    }
+
+private:
+    QueryTestServiceContext _serviceContext;
+    ServiceContext::UniqueOperationContext _opCtx;
+};
+
+TEST_F(MaterializedViewTest, ParsesMatchFollowedByGroup) {
+    auto view = parseOK(BSON_ARRAY(BSON("$match" << BSON("a" << 1))
+                                   << BSON("$group" << BSON("_id"
+                                                            << "$b"
+                                                            << "total"
+                                                            << BSON("$sum"
+                                                                    << "$c")))
+                                   << BSON("$sort" << BSON("_id" << 1))));
+    ASSERT_EQ(view->numMaterializedStages(), 2U);
+}
+
+TEST_F(MaterializedViewTest, ParsesGroupWithoutMatch) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id" << BSONNULL << "count"
+                                                               << BSON("$sum" << 1)))));
+    ASSERT_EQ(view->numMaterializedStages(), 1U);
+}
+
+TEST_F(MaterializedViewTest, RejectsPipelinesWhichCannotBeMaintained) {
+    ASSERT_EQ(parse(BSON_ARRAY(BSON("$match" << BSON("a" << 1)))).getStatus(),
+              ErrorCodes::OptionNotSupportedOnView);
+    ASSERT_EQ(parse(BSON_ARRAY(BSON("$project" << BSON("a" << 1)))).getStatus(),
+              ErrorCodes::OptionNotSupportedOnView);
+    ASSERT_EQ(parse(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$a"
+                                                     << "m"
+                                                     << BSON("$max"
+                                                             << "$b")))))
+                  .getStatus(),
+              ErrorCodes::OptionNotSupportedOnView);
+    ASSERT_EQ(parse(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$a"
+                                                     << "s"
+                                                     << BSON("$sum" << BSON_ARRAY("$b"
+                                                                                  << "$c"))))))
+                  .getStatus(),
+              ErrorCodes::OptionNotSupportedOnView);
+}
+
+TEST_F(MaterializedViewTest, StartsStale) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"))));
+    ASSERT_FALSE(view->getResults());
+}
+
+TEST_F(MaterializedViewTest, RebuildPipelineCountsInputTypes) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"
+                                                         << "s"
+                                                         << BSON("$sum"
+                                                                 << "$b")))));
+    auto pipeline = view->getRebuildPipeline();
+    ASSERT_EQ(pipeline.size(), 1U);
+    auto group = pipeline[0]["$group"].Obj();
+    ASSERT_BSONOBJ_EQ(group["n"].Obj(), BSON("$sum" << 1));
+    ASSERT_BSONOBJ_EQ(group["s0"].Obj(),
+                      BSON("$sum"
+                           << "$b"));
+    ASSERT_TRUE(group.hasField("i0"));
+    ASSERT_TRUE(group.hasField("l0"));
+    ASSERT_TRUE(group.hasField("d0"));
+    ASSERT_TRUE(group.hasField("m0"));
+}
+
+TEST_F(MaterializedViewTest, AppliesCommittedInsertsAndDeletes) {
+    auto view = parseOK(BSON_ARRAY(BSON("$match" << BSON("keep" << true))
+                                   << BSON("$group" << BSON("_id"
+                                                            << "$a"
+                                                            << "total"
+                                                            << BSON("$sum"
+                                                                    << "$b")))));
+    rebuildEmpty(view.get());
+
+    inUnitOfWork([&] {
+        view->onInsert(opCtx(), BSON("a" << 1 << "b" << 2 << "keep" << true));
+        view->onInsert(opCtx(), BSON("a" << 1 << "b" << 3 << "keep" << true));
+        view->onInsert(opCtx(), BSON("a" << 2 << "b" << 100 << "keep" << false));
+        // The totals do not change until the unit of work commits.
+        ASSERT(view->getResults()->empty());
+    });
+    auto results = view->getResults();
+    ASSERT(results);
+    ASSERT_EQ(results->size(), 1U);
+    ASSERT_DOCUMENT_EQ((*results)[0], (Document{{"_id", 1}, {"total", 5}}));
+
+    inUnitOfWork([&] { view->onDelete(opCtx(), BSON("a" << 1 << "b" << 2 << "keep" << true)); });
+    results = view->getResults();
+    ASSERT_EQ(results->size(), 1U);
+    ASSERT_DOCUMENT_EQ((*results)[0], (Document{{"_id", 1}, {"total", 3}}));
+
+    // A group disappears along with its last document.
+    inUnitOfWork([&] { view->onDelete(opCtx(), BSON("a" << 1 << "b" << 3 << "keep" << true)); });
+    ASSERT(view->getResults()->empty());
+}
+
+TEST_F(MaterializedViewTest, UpdateMovesDocumentBetweenGroups) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"
+                                                         << "count"
+                                                         << BSON("$sum" << 1)))));
+    rebuildEmpty(view.get());
+
+    inUnitOfWork([&] { view->onInsert(opCtx(), BSON("a" << 1)); });
+    inUnitOfWork([&] { view->onUpdate(opCtx(), BSON("a" << 1), BSON("a" << 2)); });
+    auto results = view->getResults();
+    ASSERT(results);
+    ASSERT_EQ(results->size(), 1U);
+    ASSERT_DOCUMENT_EQ((*results)[0], (Document{{"_id", 2}, {"count", 1}}));
+}
+
+TEST_F(MaterializedViewTest, ConcurrentWritersEvaluateIndependently) {
+    // $let binds a variable, so writers sharing the expressions would clobber each other's input.
+    auto view = parseOK(BSON_ARRAY(BSON(
+        "$group" << BSON("_id"
+                         << "$a"
+                         << "total"
+                         << BSON("$sum" << BSON("$let" << BSON("vars" << BSON("x"
+                                                                              << "$b")
+                                                                      << "in"
+                                                                      << "$$x")))))));
+    rebuildEmpty(view.get());
+
+    const int kNumWriters = 4;
+    const int kWritesPerWriter = 500;
+    std::vector<stdx::thread> writers;
+    for (int i = 0; i < kNumWriters; ++i) {
+        writers.emplace_back([&, i] {
+            auto client = serviceContext()->makeClient(str::stream() << "writer" << i);
+            auto opCtx = client->makeOperationContext();
+            opCtx->setRecoveryUnit(new RecoveryUnitNoop(), OperationContext::kNotInUnitOfWork);
+            for (int j = 0; j < kWritesPerWriter; ++j) {
+                opCtx->recoveryUnit()->beginUnitOfWork(opCtx.get());
+                view->onInsert(opCtx.get(), BSON("a" << i << "b" << i + 1));
+                opCtx->recoveryUnit()->commitUnitOfWork();
+            }
+        });
+    }
+    for (auto&& writer : writers) {
+        writer.join();
+    }
+
+    auto results = view->getResults();
+    ASSERT(results);
+    ASSERT_EQ(results->size(), static_cast<size_t>(kNumWriters));
+    for (auto&& result : *results) {
+        const int i = result["_id"].getInt();
+        ASSERT_VALUE_EQ(result["total"], Value((i + 1) * kWritesPerWriter));
+    }
+}
+
+TEST_F(MaterializedViewTest, IgnoresRolledBackWrites) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"
+                                                         << "count"
+                                                         << BSON("$sum" << 1)))));
+    rebuildEmpty(view.get());
+
+    inUnitOfWork([&] { view->onInsert(opCtx(), BSON("a" << 1)); }, false);
+    auto results = view->getResults();
+    ASSERT(results);
+    ASSERT(results->empty());
+}
+
+TEST_F(MaterializedViewTest, DeleteFromMissingGroupInvalidates) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"))));
+    rebuildEmpty(view.get());
+
+    inUnitOfWork([&] { view->onDelete(opCtx(), BSON("a" << 1)); });
+    ASSERT_FALSE(view->getResults());
+}
+
+TEST_F(MaterializedViewTest, InvalidateMakesViewStale) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"))));
+    rebuildEmpty(view.get());
+    view->invalidate();
+    ASSERT_FALSE(view->getResults());
+}
+
+TEST_F(MaterializedViewTest, RebuildRacingWithWriteIsNotInstalled) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"))));
+    auto ticket = view->beginRebuild();
+    inUnitOfWork([&] { view->onInsert(opCtx(), BSON("a" << 1)); });
+    view->finishRebuild(*ticket, {});
+    ASSERT_FALSE(view->getResults());
+}
+
+TEST_F(MaterializedViewTest, RebuildReplaysWritesCommittedAfterItsSnapshot) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"
+                                                         << "total"
+                                                         << BSON("$sum"
+                                                                 << "$b")))));
+    inUnitOfWork([&] { view->onInsert(opCtx(), BSON("a" << 1 << "b" << 1)); });
+
+    auto ticket = view->beginRebuild();
+    ASSERT(ticket->installable);
+    view->rebuildSnapshotOpened(ticket.get());
+
+    // The snapshot holds only the first document; these writes commit after it was opened.
+    inUnitOfWork([&] {
+        view->onInsert(opCtx(), BSON("a" << 1 << "b" << 2));
+        view->onInsert(opCtx(), BSON("a" << 2 << "b" << 3));
+    });
+    inUnitOfWork([&] {
+        view->onUpdate(opCtx(), BSON("a" << 1 << "b" << 1), BSON("a" << 2 << "b" << 4));
+    });
+
+    // A write which commits only after the rebuild is installed is applied to its totals.
+    auto ru = opCtx()->recoveryUnit();
+    ru->beginUnitOfWork(opCtx());
+    view->onInsert(opCtx(), BSON("a" << 3 << "b" << 5));
+
+    auto results = view->finishRebuild(*ticket, {rebuildRow(1, 1, 1)});
+    ASSERT_EQ(results.size(), 1U);
+    ASSERT_DOCUMENT_EQ(results[0], (Document{{"_id", 1}, {"total", 1}}));
+    ru->commitUnitOfWork();
+
+    auto current = view->getResults();
+    ASSERT(current);
+    ASSERT_EQ(current->size(), 3U);
+    for (auto&& result : *current) {
+        const int groupKey = result["_id"].getInt();
+        ASSERT_VALUE_EQ(result["total"], Value(groupKey == 1 ? 2 : groupKey == 2 ? 7 : 5));
+    }
+}
+
+TEST_F(MaterializedViewTest, WritesWhichDoNotAffectViewDoNotAbandonRebuild) {
+    auto view = parseOK(BSON_ARRAY(BSON("$match" << BSON("keep" << true))
+                                   << BSON("$group" << BSON("_id"
+                                                            << "$a"
+                                                            << "total"
+                                                            << BSON("$sum"
+                                                                    << "$b")))));
+    auto ticket = view->beginRebuild();
+    inUnitOfWork([&] { view->onInsert(opCtx(), BSON("a" << 1 << "b" << 1 << "keep" << false)); });
+    view->finishRebuild(*ticket, {});
+    ASSERT(view->getResults());
+}
+
+TEST_F(MaterializedViewTest, RebuildsWhileWritesRunConcurrently) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"
+                                                         << "total"
+                                                         << BSON("$sum"
+                                                                 << "$b")))));
+
+    // Writer i inserts documents {a: i, b: 1} into the collection the rebuilds read, counted in
+    // 'collection[i]'. Each write commits atomically with respect to the snapshots of it taken
+    // by the rebuilds.
+    const int kNumWriters = 4;
+    const int kNumRebuilds = 20;
+    stdx::mutex collectionMutex;
+    std::vector<long long> collection(kNumWriters);
+    AtomicBool stopWriters(false);
+    std::vector<stdx::thread> writers;
+    for (int i = 0; i < kNumWriters; ++i) {
+        writers.emplace_back([&, i] {
+            auto client = serviceContext()->makeClient(str::stream() << "writer" << i);
+            auto opCtx = client->makeOperationContext();
+            opCtx->setRecoveryUnit(new RecoveryUnitNoop(), OperationContext::kNotInUnitOfWork);
+            while (!stopWriters.load()) {
+                stdx::lock_guard<stdx::mutex> lk(collectionMutex);
+                opCtx->recoveryUnit()->beginUnitOfWork(opCtx.get());
+                view->onInsert(opCtx.get(), BSON("a" << i << "b" << 1));
+                ++collection[i];
+                opCtx->recoveryUnit()->commitUnitOfWork();
+            }
+        });
+    }
+
+    // Writes keep committing between each rebuild's snapshot and its end, yet every rebuild is
+    // installed.
+    for (int rebuild = 0; rebuild < kNumRebuilds; ++rebuild) {
+        std::unique_ptr<MaterializedView::RebuildTicket> ticket;
+        std::vector<Document> rows;
+        {
+            stdx::lock_guard<stdx::mutex> lk(collectionMutex);
+            ticket = view->beginRebuild();
+            view->rebuildSnapshotOpened(ticket.get());
+            for (int i = 0; i < kNumWriters; ++i) {
+                if (collection[i] > 0) {
+                    rows.push_back(rebuildRow(i, collection[i], collection[i]));
+                }
+            }
+        }
+        ASSERT(ticket->installable);
+        sleepmillis(1);
+        view->finishRebuild(*ticket, rows);
+        ASSERT(view->getResults());
+        if (rebuild + 1 < kNumRebuilds) {
+            view->invalidate();
+        }
+    }
+
+    stopWriters.store(true);
+    for (auto&& writer : writers) {
+        writer.join();
+    }
+
+    auto results = view->getResults();
+    ASSERT(results);
+    ASSERT_EQ(results->size(), static_cast<size_t>(kNumWriters));
+    for (auto&& result : *results) {
+        ASSERT_VALUE_EQ(result["total"], Value(collection[result["_id"].getInt()]));
+    }
+}
+
+TEST_F(MaterializedViewTest, RebuildDuringUncommittedWriteIsNotInstallable) {
+    auto view = parseOK(BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                         << "$a"))));
+    auto ru = opCtx()->recoveryUnit();
+    ru->beginUnitOfWork(opCtx());
+    view->onInsert(opCtx(), BSON("a" << 1));
+    ASSERT_FALSE(view->beginRebuild()->installable);
+    ru->abortUnitOfWork();
+    ASSERT_TRUE(view->beginRebuild()->installable);
+}
+
+}  // namespace
+}  // namespace mongo
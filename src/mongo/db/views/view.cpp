@@ -51,13 +51,15 @@ ViewDefinition::ViewDefinition(const ViewDefinition& other)
     : _viewNss(other._viewNss),
       _viewOnNss(other._viewOnNss),
       _collator(CollatorInterface::cloneCollator(other._collator.get())),
-      _pipeline(other._pipeline) {}
+      _pipeline(other._pipeline),
+      _materializedView(other._materializedView) {}
 
 ViewDefinition& ViewDefinition::operator=(const ViewDefinition& other) {
     _viewNss = other._viewNss;
     _viewOnNss = other._viewOnNss;
     _collator = CollatorInterface::cloneCollator(other._collator.get());
     _pipeline = other._pipeline;
+    _materializedView = other._materializedView;
 
     return *this;
 }
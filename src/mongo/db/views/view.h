@@ -38,6 +38,8 @@
 
 namespace mongo {
 
+class MaterializedView;
+
 /**
  * Represents a "view": a virtual collection defined by a query on a collection or another view.
  */
@@ -89,6 +91,18 @@ public:
         return _collator.get();
     }
 
+    /**
+     * Returns the incrementally maintained contents of this view, or nullptr if the view is not
+     * materialized.
+     */
+    const std::shared_ptr<MaterializedView>& materializedView() const {
+        return _materializedView;
+    }
+
+    void setMaterializedView(std::shared_ptr<MaterializedView> materializedView) {
+        _materializedView = std::move(materializedView);
+    }
+
     void setViewOn(const NamespaceString& viewOnNss);
 
     /**
@@ -101,5 +115,6 @@ private:
     NamespaceString _viewOnNss;
     std::unique_ptr<CollatorInterface> _collator;
     std::vector<BSONObj> _pipeline;
+    std::shared_ptr<MaterializedView> _materializedView;
 };
 }  // namespace mongo
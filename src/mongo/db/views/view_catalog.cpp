@@ -46,11 +46,13 @@
 #include "mongo/db/pipeline/document_source_facet.h"
 #include "mongo/db/pipeline/document_source_lookup.h"
 #include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_materialized_view.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/stub_mongo_process_interface.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/db/views/resolved_view.h"
@@ -105,14 +107,27 @@ Status ViewCatalog::_reloadIfNeeded_inlock(OperationContext* opCtx) {
             }
         }
 
-        _viewMap[viewName.ns()] = std::make_shared<ViewDefinition>(viewName.db(),
-                                                                   viewName.coll(),
-                                                                   view["viewOn"].str(),
-                                                                   pipeline,
-                                                                   std::move(collator.getValue()));
+        auto viewDef = std::make_shared<ViewDefinition>(viewName.db(),
+                                                        viewName.coll(),
+                                                        view["viewOn"].str(),
+                                                        pipeline,
+                                                        std::move(collator.getValue()));
+        if (view["materialized"].trueValue()) {
+            auto materialized = MaterializedView::parse(opCtx, *viewDef);
+            if (!materialized.isOK()) {
+                return Status(ErrorCodes::InvalidViewDefinition,
+                              str::stream() << "Materialized view " << viewName.toString()
+                                            << " cannot be maintained: "
+                                            << materialized.getStatus().reason());
+            }
+            viewDef->setMaterializedView(std::move(materialized.getValue()));
+        }
+
+        _viewMap[viewName.ns()] = std::move(viewDef);
         return Status::OK();
     });
     _valid.store(status.isOK());
+    _updateHasMaterializedViews_inlock();
 
     if (!status.isOK()) {
         LOG(0) << "could not load view catalog for database " << _durable->getName() << ": "
@@ -134,7 +149,8 @@ Status ViewCatalog::_createOrUpdateView_inlock(OperationContext* opCtx,
                                                const NamespaceString& viewName,
                                                const NamespaceString& viewOn,
                                                const BSONArray& pipeline,
-                                               std::unique_ptr<CollatorInterface> collator) {
+                                               std::unique_ptr<CollatorInterface> collator,
+                                               bool materialized) {
     _requireValidCatalog_inlock(opCtx);
 
     // Build the BSON definition for this view to be saved in the durable view catalog. If the
@@ -146,11 +162,29 @@ Status ViewCatalog::_createOrUpdateView_inlock(OperationContext* opCtx,
     if (collator) {
         viewDefBuilder.append("collation", collator->getSpec().toBSON());
     }
+    if (materialized) {
+        viewDefBuilder.append("materialized", true);
+    }
 
     BSONObj ownedPipeline = pipeline.getOwned();
     auto view = std::make_shared<ViewDefinition>(
         viewName.db(), viewName.coll(), viewOn.coll(), ownedPipeline, std::move(collator));
 
+    if (materialized) {
+        // Only writes to a collection can be observed to maintain the view.
+        if (viewOn.isSystem() || _lookup_inlock(opCtx, viewOn.ns())) {
+            return {ErrorCodes::OptionNotSupportedOnView,
+                    str::stream() << "A materialized view must be on a non-system collection, but "
+                                  << viewOn.ns()
+                                  << " is not"};
+        }
+        auto materializedView = MaterializedView::parse(opCtx, *view);
+        if (!materializedView.isOK()) {
+            return materializedView.getStatus();
+        }
+        view->setMaterializedView(std::move(materializedView.getValue()));
+    }
+
     // Check that the resulting dependency graph is acyclic and within the maximum depth.
     Status graphStatus = _upsertIntoGraph(opCtx, *(view.get()));
     if (!graphStatus.isOK()) {
@@ -159,9 +193,11 @@ Status ViewCatalog::_createOrUpdateView_inlock(OperationContext* opCtx,
 
     _durable->upsert(opCtx, viewName, viewDefBuilder.obj());
     _viewMap[viewName.ns()] = view;
+    _updateHasMaterializedViews_inlock();
     opCtx->recoveryUnit()->onRollback([this, viewName]() {
         this->_viewMap.erase(viewName.ns());
         this->_viewGraphNeedsRefresh = true;
+        this->_updateHasMaterializedViews_inlock();
     });
 
     // We may get invalidated, but we're exclusively locked, so the change must be ours.
@@ -287,7 +323,8 @@ Status ViewCatalog::createView(OperationContext* opCtx,
                                const NamespaceString& viewName,
                                const NamespaceString& viewOn,
                                const BSONArray& pipeline,
-                               const BSONObj& collation) {
+                               const BSONObj& collation,
+                               bool materialized) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     if (viewName.db() != viewOn.db())
@@ -311,7 +348,7 @@ Status ViewCatalog::createView(OperationContext* opCtx,
         return collator.getStatus();
 
     return _createOrUpdateView_inlock(
-        opCtx, viewName, viewOn, pipeline, std::move(collator.getValue()));
+        opCtx, viewName, viewOn, pipeline, std::move(collator.getValue()), materialized);
 }
 
 Status ViewCatalog::modifyView(OperationContext* opCtx,
@@ -336,6 +373,7 @@ Status ViewCatalog::modifyView(OperationContext* opCtx,
     ViewDefinition savedDefinition = *viewPtr;
     opCtx->recoveryUnit()->onRollback([this, viewName, savedDefinition]() {
         this->_viewMap[viewName.ns()] = std::make_shared<ViewDefinition>(savedDefinition);
+        this->_updateHasMaterializedViews_inlock();
     });
 
     return _createOrUpdateView_inlock(
@@ -343,7 +381,8 @@ Status ViewCatalog::modifyView(OperationContext* opCtx,
         viewName,
         viewOn,
         pipeline,
-        CollatorInterface::cloneCollator(savedDefinition.defaultCollator()));
+        CollatorInterface::cloneCollator(savedDefinition.defaultCollator()),
+        savedDefinition.materializedView() != nullptr);
 }
 
 Status ViewCatalog::dropView(OperationContext* opCtx, const NamespaceString& viewName) {
@@ -363,9 +402,11 @@ Status ViewCatalog::dropView(OperationContext* opCtx, const NamespaceString& vie
     _durable->remove(opCtx, viewName);
     _viewGraph.remove(savedDefinition.name());
     _viewMap.erase(viewName.ns());
+    _updateHasMaterializedViews_inlock();
     opCtx->recoveryUnit()->onRollback([this, viewName, savedDefinition]() {
         this->_viewGraphNeedsRefresh = true;
         this->_viewMap[viewName.ns()] = std::make_shared<ViewDefinition>(savedDefinition);
+        this->_updateHasMaterializedViews_inlock();
     });
 
     // We may get invalidated, but we're exclusively locked, so the change must be ours.
@@ -402,6 +443,35 @@ std::shared_ptr<ViewDefinition> ViewCatalog::lookup(OperationContext* opCtx, Str
     return _lookup_inlock(opCtx, ns);
 }
 
+void ViewCatalog::_updateHasMaterializedViews_inlock() {
+    bool hasMaterializedViews = false;
+    for (auto&& view : _viewMap) {
+        hasMaterializedViews = hasMaterializedViews || view.second->materializedView();
+    }
+    _hasMaterializedViews.store(hasMaterializedViews);
+}
+
+std::vector<std::shared_ptr<MaterializedView>> ViewCatalog::lookupMaterializedViewsOn(
+    OperationContext* opCtx, const NamespaceString& nss) {
+    // Writes to collections without materialized views should not contend on the mutex.
+    if (_valid.load() && !_hasMaterializedViews.load()) {
+        return {};
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_reloadIfNeeded_inlock(opCtx).isOK()) {
+        return {};
+    }
+
+    std::vector<std::shared_ptr<MaterializedView>> materializedViews;
+    for (auto&& view : _viewMap) {
+        if (view.second->materializedView() && view.second->viewOn() == nss) {
+            materializedViews.push_back(view.second->materializedView());
+        }
+    }
+    return materializedViews;
+}
+
 StatusWith<ResolvedView> ViewCatalog::resolveView(OperationContext* opCtx,
                                                   const NamespaceString& nss) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -430,8 +500,19 @@ StatusWith<ResolvedView> ViewCatalog::resolveView(OperationContext* opCtx,
         collation = view->defaultCollator() ? view->defaultCollator()->getSpec().toBSON()
                                             : CollationSpec::kSimpleSpec;
 
-        // Prepend the underlying view's pipeline to the current working pipeline.
-        const std::vector<BSONObj>& toPrepend = view->pipeline();
+        // Prepend the underlying view's pipeline to the current working pipeline. The stages of a
+        // materialized view which are maintained incrementally are replaced by a stage reading
+        // their results, unless the view's collection may be sharded, in which case each shard
+        // would only have maintained the results for its own documents.
+        std::vector<BSONObj> toPrepend = view->pipeline();
+        const auto& materialized = view->materializedView();
+        if (materialized && serverGlobalParams.clusterRole != ClusterRole::ShardServer &&
+            !_lookup_inlock(opCtx, resolvedNss->ns())) {
+            toPrepend.erase(toPrepend.begin(),
+                            toPrepend.begin() + materialized->numMaterializedStages());
+            toPrepend.insert(toPrepend.begin(),
+                             DocumentSourceMaterializedView::createSpec(view->name()));
+        }
         resolvedPipeline.insert(resolvedPipeline.begin(), toPrepend.begin(), toPrepend.end());
 
         // If the first stage is a $collStats, then we return early with the viewOn namespace.
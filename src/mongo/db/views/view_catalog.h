@@ -39,6 +39,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/views/durable_view_catalog.h"
+#include "mongo/db/views/materialized_view.h"
 #include "mongo/db/views/resolved_view.h"
 #include "mongo/db/views/view.h"
 #include "mongo/db/views/view_graph.h"
@@ -79,13 +80,18 @@ public:
      * database's catalog, so the check for an existing collection with the same name must be done
      * before calling createView.
      *
+     * If 'materialized' is true, the view must be on a collection, and its pipeline must be one
+     * whose results can be maintained incrementally as the collection is written to; see
+     * MaterializedView.
+     *
      * Must be in WriteUnitOfWork. View creation rolls back if the unit of work aborts.
      */
     Status createView(OperationContext* opCtx,
                       const NamespaceString& viewName,
                       const NamespaceString& viewOn,
                       const BSONArray& pipeline,
-                      const BSONObj& collation);
+                      const BSONObj& collation,
+                      bool materialized = false);
 
     /**
      * Drop the view named 'viewName'.
@@ -110,6 +116,13 @@ public:
      */
     std::shared_ptr<ViewDefinition> lookup(OperationContext* opCtx, StringData nss);
 
+    /**
+     * Returns the materialized views on the collection 'nss', which must be kept up to date with
+     * the writes to it. Never throws, so that it can be used on the write path.
+     */
+    std::vector<std::shared_ptr<MaterializedView>> lookupMaterializedViewsOn(
+        OperationContext* opCtx, const NamespaceString& nss);
+
     /**
      * Resolve the views on 'nss', transforming the pipeline appropriately. This function returns a
      * fully-resolved view definition containing the backing namespace, the resolved pipeline and
@@ -140,7 +153,13 @@ private:
                                       const NamespaceString& viewName,
                                       const NamespaceString& viewOn,
                                       const BSONArray& pipeline,
-                                      std::unique_ptr<CollatorInterface> collator);
+                                      std::unique_ptr<CollatorInterface> collator,
+                                      bool materialized);
+
+    /**
+     * Must be called whenever views are added to or removed from '_viewMap'.
+     */
+    void _updateHasMaterializedViews_inlock();
     /**
      * Parses the view definition pipeline, attempts to upsert into the view graph, and refreshes
      * the graph if necessary. Returns an error status if the resulting graph would be invalid.
@@ -174,6 +193,7 @@ private:
     ViewMap _viewMap;
     DurableViewCatalog* _durable;
     AtomicBool _valid;
+    AtomicBool _hasMaterializedViews;  // Whether any view in '_viewMap' is materialized.
     ViewGraph _viewGraph;
     bool _viewGraphNeedsRefresh = true;  // Defers initializing the graph until the first insert.
 };
@@ -40,14 +40,17 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/exec/collection_scan.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/shared_collection_scan.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageCollectionScan {
 
@@ -236,6 +239,144 @@ public:
     }
 };
 
+//
+// Work the scan in batches, both directly and through the PlanExecutor, and get the matching
+// objects in the order we inserted them.
+//
+
+class QueryStageCollscanObjectsInOrderBatched : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        const int originalBatchSize = internalQueryExecWorkBatchSize.load();
+        ON_BLOCK_EXIT([&] { internalQueryExecWorkBatchSize.store(originalBatchSize); });
+        internalQueryExecWorkBatchSize.store(16);
+
+        ASSERT_EQUALS(numObj(), countResults(CollectionScanParams::FORWARD, BSONObj()));
+        ASSERT_EQUALS(25, countResults(CollectionScanParams::BACKWARD, BSON("foo" << LT << 25)));
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+
+        BSONObj filterObj = BSON("foo" << GTE << 10);
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, nullptr));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(filterObj, expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        CollectionScan scan(&_opCtx, params, &ws, filterExpr.get());
+        int count = 0;
+        while (!scan.isEOF()) {
+            vector<WorkingSetID> batch;
+            WorkingSetID stateId = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan.workBatch(&ws, 7, &batch, &stateId);
+            ASSERT(PlanStage::ADVANCED == state || PlanStage::NEED_TIME == state ||
+                   PlanStage::IS_EOF == state);
+            for (auto id : batch) {
+                // The results of a batch are owned, so they remain valid as the scan advances.
+                WorkingSetMember* member = ws.get(id);
+                ASSERT(member->obj.value().isOwned());
+                ASSERT_EQUALS(10 + count, member->obj.value()["foo"].numberInt());
+                ++count;
+                ws.free(id);
+            }
+        }
+        ASSERT_EQUALS(numObj() - 10, count);
+        // One unit of work opens the cursor, one reads each record and one reports EOF.
+        ASSERT_EQUALS(static_cast<size_t>(numObj() + 2), scan.getCommonStats()->works);
+        ASSERT_EQUALS(static_cast<size_t>(count), scan.getCommonStats()->advanced);
+    }
+};
+
+//
+// A scan which may share its reads starts at the position of a scan already in progress, and wraps
+// around to return the objects before it.
+//
+
+class QueryStageCollscanSharedScanWrapsAround : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        const bool originalEnabled = internalQueryEnableSharedCollectionScans.load();
+        const int originalMinSizeMB = internalQuerySharedCollectionScanMinSizeMB.load();
+        ON_BLOCK_EXIT([&] {
+            internalQueryEnableSharedCollectionScans.store(originalEnabled);
+            internalQuerySharedCollectionScanMinSizeMB.store(originalMinSizeMB);
+        });
+        internalQueryEnableSharedCollectionScans.store(true);
+        internalQuerySharedCollectionScanMinSizeMB.store(0);
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        vector<RecordId> recordIds;
+        getRecordIds(collection, CollectionScanParams::FORWARD, &recordIds);
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), recordIds.size());
+
+        auto& sharedScans = SharedCollectionScans::get(_opCtx.getServiceContext());
+        RecordId otherStart;
+        auto otherScan = sharedScans.registerScan(nss.ns(), &otherStart);
+        ASSERT(otherStart.isNull());
+        otherScan->setPosition(recordIds[20]);
+        {
+            // A scan's position is only published every so many records, or when it yields.
+            RecordId start;
+            auto scan = sharedScans.registerScan(nss.ns(), &start);
+            ASSERT(start.isNull());
+        }
+        otherScan->publishPosition();
+
+        CollectionScanParams params;
+        params.collection = collection;
+        params.direction = CollectionScanParams::FORWARD;
+        params.allowSharedScan = true;
+
+        for (bool batched : {false, true}) {
+            WorkingSet ws;
+            CollectionScan scan(&_opCtx, params, &ws, nullptr);
+            vector<int> values;
+            while (!scan.isEOF()) {
+                vector<WorkingSetID> batch;
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                if (batched) {
+                    scan.workBatch(&ws, 7, &batch, &id);
+                } else if (PlanStage::ADVANCED == scan.work(&id)) {
+                    batch.push_back(id);
+                }
+                for (auto resultId : batch) {
+                    values.push_back(ws.get(resultId)->obj.value()["foo"].numberInt());
+                    ws.free(resultId);
+                }
+                if (!scan.isEOF()) {
+                    ASSERT_EQUALS(2U, sharedScans.numScans(nss.ns()));
+                }
+            }
+
+            ASSERT_EQUALS(static_cast<size_t>(numObj()), values.size());
+            for (int i = 0; i < numObj(); ++i) {
+                ASSERT_EQUALS((20 + i) % numObj(), values[i]);
+            }
+            ASSERT_EQUALS(1U, sharedScans.numScans(nss.ns()));
+        }
+
+        // Scans which must return objects in natural order do not join the other scan.
+        params.allowSharedScan = false;
+        WorkingSet ws;
+        CollectionScan scan(&_opCtx, params, &ws, nullptr);
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        while (PlanStage::ADVANCED != scan.work(&id)) {
+        }
+        ASSERT_EQUALS(0, ws.get(id)->obj.value()["foo"].numberInt());
+
+        otherScan.reset();
+        ASSERT_EQUALS(0U, sharedScans.numScans(nss.ns()));
+    }
+};
+
 //
 // Get objects in the reverse order we inserted them when we go backwards.
 //
@@ -412,6 +553,8 @@ public:
         add<QueryStageCollscanBasicBackwardWithMatch>();
         add<QueryStageCollscanObjectsInOrderForward>();
         add<QueryStageCollscanObjectsInOrderBackward>();
+        add<QueryStageCollscanObjectsInOrderBatched>();
+        add<QueryStageCollscanSharedScanWrapsAround>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
         add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
     }
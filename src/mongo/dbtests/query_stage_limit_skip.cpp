@@ -87,6 +87,21 @@ int countResults(PlanStage* stage) {
     return count;
 }
 
+/* Returns the 'x' values of the results of 'stage', working it in batches of 'batchSize'. */
+std::vector<int> collectBatchedResults(PlanStage* stage, WorkingSet* ws, size_t batchSize) {
+    std::vector<int> results;
+    while (!stage->isEOF()) {
+        std::vector<WorkingSetID> batch;
+        WorkingSetID stateId = WorkingSet::INVALID_ID;
+        stage->workBatch(ws, batchSize, &batch, &stateId);
+        for (auto id : batch) {
+            results.push_back(ws->get(id)->obj.value()["x"].numberInt());
+            ws->free(id);
+        }
+    }
+    return results;
+}
+
 //
 // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
 //
@@ -110,12 +125,45 @@ protected:
     OperationContext* const _opCtx = _uniqOpCtx.get();
 };
 
+//
+// Skip and limit results which are worked in batches, and expect the same results in the same
+// order as when working one result at a time.
+//
+class QueryStageLimitSkipBatchTest : public QueryStageLimitSkipBasicTest {
+public:
+    void run() {
+        for (size_t batchSize : {1, 2, 7, 1000}) {
+            for (int i = 0; i < 2 * N; ++i) {
+                WorkingSet ws;
+
+                SkipStage skip(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                auto results = collectBatchedResults(&skip, &ws, batchSize);
+                ASSERT_EQUALS(static_cast<size_t>(max(0, N - i)), results.size());
+                for (size_t j = 0; j < results.size(); ++j) {
+                    ASSERT_EQUALS(static_cast<int>(i + j), results[j]);
+                }
+                ASSERT_EQUALS(static_cast<size_t>(max(0, N - i)),
+                              skip.getCommonStats()->advanced);
+
+                LimitStage limit(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                results = collectBatchedResults(&limit, &ws, batchSize);
+                ASSERT_EQUALS(static_cast<size_t>(min(N, i)), results.size());
+                for (size_t j = 0; j < results.size(); ++j) {
+                    ASSERT_EQUALS(static_cast<int>(j), results[j]);
+                }
+                ASSERT_EQUALS(static_cast<size_t>(min(N, i)), limit.getCommonStats()->advanced);
+            }
+        }
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_limit_skip") {}
 
     void setupTests() {
         add<QueryStageLimitSkipBasicTest>();
+        add<QueryStageLimitSkipBatchTest>();
     }
 };
 
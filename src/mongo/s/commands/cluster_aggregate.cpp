@@ -525,6 +525,7 @@ BSONObj establishMergingMongosCursor(OperationContext* opCtx,
     params.tailableMode = pipelineForMerging->getContext()->tailableMode;
     params.mergePipeline = std::move(pipelineForMerging);
     params.remotes = std::move(cursors);
+    params.sendSortKeyBoundToRemotes = internalQuerySendSortKeyBoundToShards.load();
 
     // A batch size of 0 is legal for the initial aggregate, but not valid for getMores, the batch
     // size we pass here is used for getMores, so do not specify a batch size if the initial request
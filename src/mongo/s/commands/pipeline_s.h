@@ -141,6 +141,12 @@ public:
 
         std::vector<GenericCursor> getCursors(
             const boost::intrusive_ptr<ExpressionContext>& expCtx) const final;
+
+        std::vector<Document> readMaterializedView(
+            const boost::intrusive_ptr<ExpressionContext>& expCtx,
+            const NamespaceString& viewNss) final {
+            MONGO_UNREACHABLE;
+        }
     };
 
 private:
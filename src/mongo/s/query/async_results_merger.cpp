@@ -51,6 +51,10 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Sorted merges cut off by a larger limit do not track a sort key bound, since doing so requires
+// keeping as many sort keys in memory as the limit.
+const long long kMaxSortedMergeLimitForSortKeyBound = 100 * 1000;
+
 /**
  * Returns the sort key out of the $sortKey metadata field in 'obj'. This object is of the form
  * {'': 'firstSortKey', '': 'secondSortKey', ...}.
@@ -84,7 +88,8 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
     : _opCtx(opCtx),
       _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort, _params->compareWholeSortKey)) {
+      _mergeQueue(MergingComparator(_remotes, _params->sort, _params->compareWholeSortKey)),
+      _topKSortKeys(SortKeyComparator(_params->sort)) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
@@ -330,7 +335,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
-Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
+Status AsyncResultsMerger::_askForNextBatch(WithLock lk, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
     invariant(!remote.cbHandle.isValid());
@@ -344,12 +349,34 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
         adjustedBatchSize = *_params->batchSize - remote.fetchedCount;
     }
 
+    boost::optional<GetMoreRequest::SortKeyBound> sortKeyBound;
+    if (auto limit = _sortedMergeLimit(lk)) {
+        // When the merged stream is cut off by a limit, each remote contributes about its share of
+        // the limit if the results are spread evenly. Ask for that much first, so that the sort
+        // key bound is known before the remotes have produced results that cannot make the cut.
+        // The batch size then doubles with each round for remotes that hold more of the results.
+        const long long evenShare = (*limit + _remotes.size() - 1) / _remotes.size();
+        const long long topKBatchSize = std::max(evenShare, remote.fetchedCount);
+        adjustedBatchSize =
+            adjustedBatchSize ? std::min(*adjustedBatchSize, topKBatchSize) : topKBatchSize;
+
+        if (_params->sendSortKeyBoundToRemotes) {
+            if (auto bound = _sortKeyBound(lk)) {
+                sortKeyBound = GetMoreRequest::SortKeyBound();
+                sortKeyBound->sortKey = *bound;
+                sortKeyBound->sortPattern = _params->sort;
+                sortKeyBound->compareWholeSortKey = _params->compareWholeSortKey;
+            }
+        }
+    }
+
     BSONObj cmdObj = GetMoreRequest(remote.cursorNss,
                                     remote.cursorId,
                                     adjustedBatchSize,
                                     _awaitDataTimeout,
                                     boost::none,
-                                    boost::none)
+                                    boost::none,
+                                    std::move(sortKeyBound))
                          .toBSON();
 
     executor::RemoteCommandRequest request(
@@ -616,9 +643,75 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
     if (!_params->sort.isEmpty() && !response.getBatch().empty()) {
         _mergeQueue.push(remoteIndex);
     }
+
+    if (_sortedMergeLimit(lk) && !response.getBatch().empty()) {
+        _trackSortKeys(lk, response.getBatch());
+        _closeRemotesPastSortKeyBound(lk);
+    }
     return true;
 }
 
+boost::optional<long long> AsyncResultsMerger::_sortedMergeLimit(WithLock) const {
+    if (_params->sort.isEmpty() || _params->tailableMode != TailableMode::kNormal ||
+        !_params->sortedMergeLimit || *_params->sortedMergeLimit <= 0 ||
+        *_params->sortedMergeLimit > kMaxSortedMergeLimitForSortKeyBound) {
+        return boost::none;
+    }
+    return _params->sortedMergeLimit;
+}
+
+boost::optional<BSONObj> AsyncResultsMerger::_sortKeyBound(WithLock lk) const {
+    auto limit = _sortedMergeLimit(lk);
+    if (!limit || _topKSortKeys.size() < static_cast<size_t>(*limit)) {
+        return boost::none;
+    }
+    return _topKSortKeys.top();
+}
+
+void AsyncResultsMerger::_trackSortKeys(WithLock lk, const std::vector<BSONObj>& batch) {
+    const size_t limit = static_cast<size_t>(*_sortedMergeLimit(lk));
+    for (const auto& obj : batch) {
+        auto key = extractSortKey(obj, _params->compareWholeSortKey);
+        if (_topKSortKeys.size() < limit) {
+            _topKSortKeys.push(key.getOwned());
+        } else if (compareSortKeys(key, _topKSortKeys.top(), _params->sort) < 0) {
+            _topKSortKeys.pop();
+            _topKSortKeys.push(key.getOwned());
+        }
+    }
+}
+
+void AsyncResultsMerger::_closeRemotesPastSortKeyBound(WithLock lk) {
+    auto bound = _sortKeyBound(lk);
+    if (!bound) {
+        return;
+    }
+
+    for (auto& remote : _remotes) {
+        // A remote with an outstanding request is reconsidered once its response arrives.
+        if (!remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid() ||
+            !remote.hasNext()) {
+            continue;
+        }
+
+        auto lastKey =
+            extractSortKey(*remote.docBuffer.back().getResult(), _params->compareWholeSortKey);
+        if (compareSortKeys(lastKey, *bound, _params->sort) <= 0) {
+            continue;
+        }
+
+        BSONObj cmdObj = KillCursorsRequest(_params->nsString, {remote.cursorId}).toBSON();
+        executor::RemoteCommandRequest request(
+            remote.getTargetHost(), _params->nsString.db().toString(), cmdObj, _opCtx);
+
+        // Send kill request; discard callback handle, if any, or failure report, if not.
+        _executor->scheduleRemoteCommand(request, [](auto const&) {}).getStatus().ignore();
+
+        // The results already buffered for this remote are still merged as usual.
+        remote.cursorId = 0;
+    }
+}
+
 void AsyncResultsMerger::_signalCurrentEventIfReady(WithLock lk) {
     if (_ready(lk) && _currentEvent.isValid()) {
         // To prevent ourselves from signalling the event twice, we set '_currentEvent' as
@@ -725,6 +818,15 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
     return grid.shardRegistry()->getShardNoReload(shardHostAndPort.toString());
 }
 
+//
+// AsyncResultsMerger::SortKeyComparator
+//
+
+bool AsyncResultsMerger::SortKeyComparator::operator()(const BSONObj& lhs,
+                                                       const BSONObj& rhs) const {
+    return compareSortKeys(lhs, rhs, _sort) < 0;
+}
+
 //
 // AsyncResultsMerger::MergingComparator
 //
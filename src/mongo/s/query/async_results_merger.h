@@ -67,6 +67,10 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * If the sorted stream is cut off by a limit, the ARM tracks the sort key of the last result that
+ * can still make the cut. Remotes whose results have gone past that key are closed early, and, if
+ * requested, the key is sent with each getMore so that the remotes stop producing such results.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -288,6 +292,20 @@ private:
         const bool _compareWholeSortKey;
     };
 
+    /**
+     * Orders sort keys according to the sort pattern, such that a std::priority_queue using this
+     * comparator has the key that sorts last on top.
+     */
+    class SortKeyComparator {
+    public:
+        SortKeyComparator(const BSONObj& sort) : _sort(sort) {}
+
+        bool operator()(const BSONObj& lhs, const BSONObj& rhs) const;
+
+    private:
+        const BSONObj& _sort;
+    };
+
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
 
     /**
@@ -308,6 +326,30 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * Returns the number of results after which the merged stream is cut off, if this ARM merges
+     * sorted, non-tailable results under a limit. Returns boost::none otherwise.
+     */
+    boost::optional<long long> _sortedMergeLimit(WithLock) const;
+
+    /**
+     * Returns the sort key of the last result that can be among the first '_sortedMergeLimit()'
+     * merged results, once enough results have been received to know it.
+     */
+    boost::optional<BSONObj> _sortKeyBound(WithLock) const;
+
+    /**
+     * Records the sort keys of a batch of results received from a remote in '_topKSortKeys'.
+     */
+    void _trackSortKeys(WithLock, const std::vector<BSONObj>& batch);
+
+    /**
+     * Schedules a killCursors command for every remote whose last buffered result sorts after the
+     * sort key bound, and marks those remotes as exhausted. The results of such a remote are
+     * sorted, so none of its further results could be returned.
+     */
+    void _closeRemotesPastSortKeyBound(WithLock);
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -404,6 +446,11 @@ private:
     // next document to return, according to the sort order. Used only if there is a sort.
     std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
 
+    // Used only if the sorted merge is cut off by a limit. Holds the sort keys of the
+    // '_sortedMergeLimit()' results that sort first among all those received so far, with the one
+    // that sorts last on top. Once full, its top is the sort key bound.
+    std::priority_queue<BSONObj, std::vector<BSONObj>, SortKeyComparator> _topKSortKeys;
+
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
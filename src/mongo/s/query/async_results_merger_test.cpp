@@ -129,6 +129,10 @@ protected:
             _params->skip = qr->getSkip();
             _params->tailableMode = qr->getTailableMode();
             _params->isAllowPartialResults = qr->isAllowPartialResults();
+            _params->sendSortKeyBoundToRemotes = true;
+            if (qr->getLimit() && !qr->getSort().isEmpty()) {
+                _params->sortedMergeLimit = *qr->getLimit() + qr->getSkip().value_or(0);
+            }
         }
 
         arm = stdx::make_unique<AsyncResultsMerger>(operationContext(), executor(), _params.get());
@@ -1273,6 +1277,81 @@ TEST_F(AsyncResultsMergerTest, GetMoreBatchSizes) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergeWithLimitAsksEachRemoteForItsShareOfTheLimit) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, limit: 3}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    for (size_t i = 0; i < 2; ++i) {
+        auto request = unittest::assertGet(
+            GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(i).cmdObj));
+        ASSERT_EQ(*request.batchSize, 2LL);
+        ASSERT_FALSE(request.sortKeyBound);
+    }
+
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(_nss, CursorId(0), std::vector<BSONObj>{});
+    responses.emplace_back(_nss, CursorId(0), std::vector<BSONObj>{});
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, SortedMergeWithLimitClosesRemotesPastSortKeyBound) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, limit: 2}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}")};
+    responses.emplace_back(_nss, CursorId(5), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 2}}")};
+    responses.emplace_back(_nss, CursorId(6), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // The ARM knows that no result sorting after 2 can be returned, and tells the remote so.
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    auto request = unittest::assertGet(
+        GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(0).cmdObj));
+    ASSERT_EQ(request.cursorid, 5LL);
+    ASSERT_EQ(*request.batchSize, 1LL);
+    ASSERT(request.sortKeyBound);
+    ASSERT_BSONOBJ_EQ(request.sortKeyBound->sortKey, fromjson("{'': 2}"));
+    ASSERT_BSONOBJ_EQ(request.sortKeyBound->sortPattern, fromjson("{_id: 1}"));
+
+    // The first remote returns a result past the bound, so its cursor is closed.
+    responses.clear();
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': 3}}")};
+    responses.emplace_back(_nss, CursorId(5), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+    assertKillCusorsCmdHasCursorId(getNthPendingRequest(0u).cmdObj, 5);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+
+    auto killedEvent = arm->kill(operationContext());
+    executor()->waitForEvent(killedEvent);
+}
+
 TEST_F(AsyncResultsMergerTest, SendsSecondaryOkAsMetadata) {
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
     cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
@@ -246,10 +246,23 @@ std::unique_ptr<RouterExecStage> ClusterClientCursorImpl::buildMergerPlan(
     if (params->mergePipeline) {
         if (auto sort = extractLeadingSort(params->mergePipeline.get())) {
             params->sort = *sort;
+
+            // A $limit directly following the merging $sort cuts off the sorted merge.
+            const auto& sources = params->mergePipeline->getSources();
+            if (!sources.empty()) {
+                if (auto limitStage = dynamic_cast<DocumentSourceLimit*>(sources.front().get())) {
+                    params->sortedMergeLimit = limitStage->getLimit();
+                }
+            }
         }
         return buildPipelinePlan(executor, params);
     }
 
+    if (limit && !params->sort.isEmpty()) {
+        // The limit applies after the skip, so both count towards the sorted merge.
+        params->sortedMergeLimit = *limit + skip.value_or(0);
+    }
+
     std::unique_ptr<RouterExecStage> root = createInitialStage(opCtx, executor, params);
 
     if (skip) {
@@ -118,6 +118,17 @@ struct ClusterClientCursorParams {
     // Should be forwarded to the remote hosts in 'cmdObj'.
     boost::optional<long long> limit;
 
+    // Set when the results of a sorted merge are cut off by a limit: the number of results (the
+    // sum of the limit and the skip of a find, or the limit following a merging $sort) after which
+    // the merged stream is no longer read. Lets the merger stop fetching from remotes whose
+    // remaining results cannot make the cut.
+    boost::optional<long long> sortedMergeLimit;
+
+    // Whether getMores sent during a sorted merge with a 'sortedMergeLimit' may carry the sort key
+    // beyond which results are no longer needed, so that the remotes can close their cursors
+    // early. Every remote must understand the bound for this to be set.
+    bool sendSortKeyBoundToRemotes = false;
+
     // If set, we use this pipeline to merge the output of aggregations on each remote.
     std::unique_ptr<Pipeline, PipelineDeleter> mergePipeline;
 
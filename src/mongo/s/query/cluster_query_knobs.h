@@ -45,4 +45,9 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// If set to true on mongos, sorted merges cut off by a limit tell the shards, with each getMore,
+// the sort key beyond which results are no longer needed, letting them close their cursors as soon
+// as they reach it. False by default, since shards running older versions reject such getMores.
+extern AtomicBool internalQuerySendSortKeyBoundToShards;
+
 }  // namespace mongo